@@ -0,0 +1,57 @@
+# generated by ./do-scan-refpersys-pkgconfig on vm from 30 files git 82edd8c0c786+ [do-scan-refpersys-pkgconfig.c:307]
+# generated at 2026-Oct-19 01:29:28 UTC
+PACKAGES_LIST=
+# source file refpersys.hh with 1 //@@PKGCONFIG comment lines
+PKGLIST_refpersys=jsoncpp
+PACKAGES_LIST += jsoncpp
+
+
+# source file agenda_rps.cc without //@@PKGCONFIG comments
+# source file asyncio_rps.cc without //@@PKGCONFIG comments
+# source file backtrace_rps.cc without //@@PKGCONFIG comments
+# source file cmdrepl_rps.cc without //@@PKGCONFIG comments
+# source file cppgen_rps.cc without //@@PKGCONFIG comments
+# source file dump_rps.cc with 1 //@@PKGCONFIG comment lines
+PKGLIST_dump_rps=jsoncpp
+PACKAGES_LIST += jsoncpp
+
+
+# source file eventloop_rps.cc without //@@PKGCONFIG comments
+# source file fltk_rps.cc with 1 //@@PKGCONFIG comment lines
+PKGLIST_fltk_rps=glib-2.0
+PACKAGES_LIST += glib-2.0
+
+
+# source file garbcoll_rps.cc without //@@PKGCONFIG comments
+# source file gccjit_rps.cc without //@@PKGCONFIG comments
+# source file lexer_rps.cc without //@@PKGCONFIG comments
+# source file lightgen_rps.cc without //@@PKGCONFIG comments
+# source file load_rps.cc without //@@PKGCONFIG comments
+# source file magicattrs_rps.cc without //@@PKGCONFIG comments
+# source file main_rps.cc without //@@PKGCONFIG comments
+# source file morevalues_rps.cc without //@@PKGCONFIG comments
+# source file objects_rps.cc without //@@PKGCONFIG comments
+# source file output_rps.cc without //@@PKGCONFIG comments
+# source file parsrepl_rps.cc without //@@PKGCONFIG comments
+# source file primes_rps.cc without //@@PKGCONFIG comments
+# source file repl_rps.cc without //@@PKGCONFIG comments
+# source file scalar_rps.cc without //@@PKGCONFIG comments
+# source file strbufdict_rps.cc without //@@PKGCONFIG comments
+# source file suparsrepl_rps.cc without //@@PKGCONFIG comments
+# source file transientobj_rps.cc without //@@PKGCONFIG comments
+# source file userpref_rps.cc with 2 //@@PKGCONFIG comment lines
+PKGLIST_userpref_rps=INIReader inih
+PACKAGES_LIST += INIReader
+PACKAGES_LIST += inih
+
+
+# source file utf8_rps.cc without //@@PKGCONFIG comments
+# source file utilities_rps.cc with 4 //@@PKGCONFIG comment lines
+PKGLIST_utilities_rps=gmp gmpxx glib-2.0 cairo
+PACKAGES_LIST += gmp
+PACKAGES_LIST += gmpxx
+PACKAGES_LIST += glib-2.0
+PACKAGES_LIST += cairo
+
+
+# source file values_rps.cc without //@@PKGCONFIG comments
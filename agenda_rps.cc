@@ -65,6 +65,14 @@ std::atomic<bool> Rps_Agenda::agenda_needs_garbcoll_;
 std::atomic<uint64_t> Rps_Agenda::agenda_cumulw_gc_;
 std::atomic<Rps_CallFrame*> Rps_Agenda::agenda_work_gc_callframe_[RPS_NBJOBS_MAX+2];
 std::atomic<Rps_CallFrame**> Rps_Agenda::agenda_work_gc_current_callframe_ptr[RPS_NBJOBS_MAX+2];
+std::atomic<double> Rps_Agenda::agenda_gc_request_elapsed_;
+std::atomic<int> Rps_Agenda::agenda_gc_parked_count_;
+std::atomic<uint64_t> Rps_Agenda::agenda_gc_epoch_;
+std::atomic<bool> Rps_Agenda::agenda_gc_collecting_;
+double Rps_Agenda::agenda_tts_cumul_;
+double Rps_Agenda::agenda_tts_max_;
+long Rps_Agenda::agenda_tts_count_;
+
 void
 Rps_Agenda::initialize(void)
 {
@@ -237,126 +245,153 @@ Rps_Agenda::run_agenda_worker(int ix)
   ////
   while (agenda_is_running_.load())
     {
-      if (Rps_Agenda::agenda_cumulw_gc_.load() + Rps_Agenda::agenda_gc_threshold
-          > Rps_QuasiZone::cumulative_allocated_wordcount())
+      /// tasklet boundary, this is a safepoint
+      Rps_Agenda::note_allocation(Rps_QuasiZone::cumulative_allocated_wordcount());
+      Rps_Agenda::gc_safepoint(&_);
+      /// connectives which got hot are compiled here, outside of any
+      /// application
+      rps_lightning_compile_hot_connectives(&_);
+      try
         {
-          Rps_Agenda::agenda_needs_garbcoll_.store(true);
-          std::this_thread::sleep_for(1ms/2);
-        }
-      if (Rps_Agenda::agenda_needs_garbcoll_.load())
-        Rps_Agenda::do_garbage_collect(ix, &_);
-      else
-        try
-          {
-            count++;
-            switch (agenda_work_thread_state_[ix].load())
-              {
-              case WthrAg_Idle:
-              case WthrAg_Run:
-              {
-                _f.obtasklet = Rps_Agenda::fetch_tasklet_to_run();
-                Rps_PayloadTasklet*taskpayl = nullptr;
-                if (_f.obtasklet)
-                  {
-                    taskpayl = _f.obtasklet->get_dynamic_payload<Rps_PayloadTasklet>();
-                    if (taskpayl && taskpayl->owner() == _f.obtasklet)
-                      _f.clostodo = taskpayl->todo_closure();
-                    if (_f.clostodo)
+          count++;
+          switch (agenda_work_thread_state_[ix].load())
+            {
+            case WthrAg_Idle:
+            case WthrAg_Run:
+            {
+              _f.obtasklet = Rps_Agenda::fetch_tasklet_to_run();
+              Rps_PayloadTasklet*taskpayl = nullptr;
+              if (_f.obtasklet)
+                {
+                  taskpayl = _f.obtasklet->get_dynamic_payload<Rps_PayloadTasklet>();
+                  if (taskpayl && taskpayl->owner() == _f.obtasklet)
+                    _f.clostodo = taskpayl->todo_closure();
+                  if (_f.clostodo)
+                    {
+                      Rps_Agenda::agenda_work_thread_state_[ix].store(WthrAg_Run);
+                      _f.clostodo.apply1(&_, _f.obtasklet);
+                    }
+                }
+              else   // no tasklet, we wait for changes in agenda
+                {
+                  Rps_Agenda::agenda_work_thread_state_[ix].store(WthrAg_Idle);
+                  std::unique_lock<std::recursive_mutex> ulock(agenda_mtx_);
+                  if (!agenda_needs_garbcoll_.load())
+                    {
+                      /// an idle worker thread is parked at a safepoint
+                      agenda_work_gc_callframe_[ix].store(&_);
+                      agenda_gc_parked_count_.fetch_add(1);
+                      Rps_Agenda::agenda_changed_condvar_.wait_for(ulock, 500ms+ix*10ms);
+                      /// and should not resume during a garbage collection
+                      Rps_Agenda::agenda_changed_condvar_.wait(ulock, []
                       {
-                        Rps_Agenda::agenda_work_thread_state_[ix].store(WthrAg_Run);
-                        _f.clostodo.apply1(&_, _f.obtasklet);
-                      }
-                  }
-                else   // no tasklet, we wait for changes in agenda
-                  {
-                    Rps_Agenda::agenda_work_thread_state_[ix].store(WthrAg_Idle);
-                    Rps_Agenda::agenda_changed_condvar_.wait_for(agenda_mtx_, 500ms+ix*10ms);
-                  }
-              }
-              break;
-              case WthrAg_GC:
-              {
-                std::this_thread::sleep_for(1ms);
-                Rps_Agenda::agenda_changed_condvar_.notify_all();
-              }
-              break;
-              case WthrAg_EndGC:
-              {
-                agenda_work_thread_state_[ix].store(WthrAg_Idle);
-                Rps_Agenda::agenda_changed_condvar_.notify_all();
-                // so on the next loop, the worker thread will try to fetch and run a tasklet
-              }
+                        return !agenda_gc_collecting_.load();
+                      });
+                      agenda_gc_parked_count_.fetch_sub(1);
+                      agenda_work_gc_callframe_[ix].store(nullptr);
+                    }
+                }
+            }
+            break;
+            case WthrAg_GC:
+            {
+              std::this_thread::sleep_for(1ms);
+              Rps_Agenda::agenda_changed_condvar_.notify_all();
+            }
+            break;
+            case WthrAg_EndGC:
+            {
+              agenda_work_thread_state_[ix].store(WthrAg_Idle);
+              Rps_Agenda::agenda_changed_condvar_.notify_all();
+              // so on the next loop, the worker thread will try to fetch and run a tasklet
+            }
+            break;
+            default:
               break;
-              default:
-                break;
-              };      // end switch agenda_work_thread_state_[ix].load()
-          } /// ending try...
-        catch (std::exception& exc)
-          {
-            RPS_WARNOUT("run_agenda_worker " << pthname
-                        << " got exception " << exc.what()
-                        << " count#" << count
-                        << " for tasklet " << _f.obtasklet
-                        << " doing " << _f.clostodo);
-            Rps_Agenda::agenda_work_thread_state_[ix].store(WthrAg_Idle);
-          }
+            };      // end switch agenda_work_thread_state_[ix].load()
+        } /// ending try...
+      catch (std::exception& exc)
+        {
+          RPS_WARNOUT("run_agenda_worker " << pthname
+                      << " got exception " << exc.what()
+                      << " count#" << count
+                      << " for tasklet " << _f.obtasklet
+                      << " doing " << _f.clostodo);
+          Rps_Agenda::agenda_work_thread_state_[ix].store(WthrAg_Idle);
+        }
     };        // end while (agenda_is_running_.load())
   Rps_Agenda::agenda_changed_condvar_.notify_all();
   Rps_Agenda::agenda_work_thread_state_[ix].store(WthrAg__None);
 } // end Rps_Agenda::run_agenda_worker
 
 
-//// Do garbage collection from agenda worker threads. The actual GC
-//// is running when ix == 1, so in the first worker thread. Other
-//// worker threads are idle and waiting....
+/// the number of started agenda worker threads, under agenda_mtx_
+int
+Rps_Agenda::nb_running_workers(void)
+{
+  int nbrunning = 0;
+  for (int wix=1; wix<rps_nbjobs; wix++)
+    {
+      std::thread*curthr = agenda_thread_array_[wix].load();
+      if (!curthr)
+        continue;
+      if (agenda_work_thread_state_[wix].load() == Rps_Agenda::WthrAg__None)
+        continue;
+      nbrunning++;
+    };
+  return nbrunning;
+} // end Rps_Agenda::nb_running_workers
+
+//// Do garbage collection from agenda worker threads, called at
+//// safepoints (tasklet boundaries and zone allocations). Every worker
+//// thread publishes its call frame and parks; idle worker threads
+//// count as parked. The last one to park collects, without holding
+//// agenda_mtx_, while the other ones wait for the GC epoch to change.
+//// There is no timeout: a worker thread running a long tasklet
+//// reaches its safepoint at its next allocation.
 void
 Rps_Agenda::do_garbage_collect(int ix, Rps_CallFrame*callframe)
 {
-  RPS_ASSERT(ix>=0 && ix<=RPS_NBJOBS_MAX);
+  RPS_ASSERT(ix>0 && ix<=RPS_NBJOBS_MAX);
   RPS_ASSERT(ix == rps_curthread_ix);
   RPS_ASSERT(agenda_work_gc_callframe_[ix].load() == nullptr);
-  agenda_work_thread_state_[ix].store(Rps_Agenda::WthrAg_GC);
+  workthread_state_en oldstate = agenda_work_thread_state_[ix].load();
+  std::unique_lock<std::recursive_mutex> ulock(agenda_mtx_);
+  if (!agenda_needs_garbcoll_.load())
+    return; // some other thread did collect meanwhile
+  uint64_t epoch = agenda_gc_epoch_.load();
   agenda_work_gc_callframe_[ix].store(callframe);
-  using namespace std::chrono_literals;
-  std::this_thread::sleep_for(1ms/8);
+  agenda_work_thread_state_[ix].store(Rps_Agenda::WthrAg_GC);
+  agenda_gc_parked_count_.fetch_add(1);
   Rps_Agenda::agenda_changed_condvar_.notify_all();
-  std::this_thread::sleep_for(1ms/16);
-  /// at this point, we should wait for every other worker thread to be in WthrAg_GC state....
-  bool every_worker_is_gc = false;
+  agenda_changed_condvar_.wait(ulock, [=]
   {
-    constexpr int maxwaitloop = 32;
-    int loopcnt=0;
-    while (!every_worker_is_gc)
-      {
-        std::unique_lock<std::recursive_mutex> ulock(agenda_mtx_);
-        agenda_changed_condvar_.wait_for(ulock, 50ms+ix*10ms, [=,&every_worker_is_gc]
-        {
-          for (int wix=1; wix<rps_nbjobs; wix++)
-            {
-              std::thread*curthr = agenda_thread_array_[wix].load();
-              if (!curthr)
-                continue;
-              if (agenda_work_thread_state_[wix].load() != Rps_Agenda::WthrAg_GC)
-                return false;
-            };
-          every_worker_is_gc = true;
-          return true;
-        });
-        if (loopcnt++ > maxwaitloop) /// should never happen!
-          RPS_FATALOUT("Rps_Agenda::do_garbage_collect ix=" << ix
-                       << " callframe=" << Rps_ShowCallFrame(callframe)
-                       << " timed out waiting for other worker threads to GC");
-      }
-  }
-  RPS_ASSERT(every_worker_is_gc);
-  /// At this point, we do know that every worker thread is in garbage
-  /// collection state, so is NOT running, don't change the call
-  /// stack, so is NOT ALLOCATING.... The GC is then permitted to scan
-  /// the call stacks in agenda_work_gc_callframe_ ... The first
-  /// worker thread is doing the actual GC work.
-  if (ix==1)
+    return agenda_gc_epoch_.load() != epoch
+           || !agenda_is_running_.load()
+           || (!agenda_gc_collecting_.load()
+               && agenda_gc_parked_count_.load() >= nb_running_workers());
+  });
+  if (agenda_gc_epoch_.load() == epoch && agenda_is_running_.load())
     {
-      std::unique_lock<std::recursive_mutex> ulock(agenda_mtx_);
+      /// At this point, we do know that every other worker thread is
+      /// parked at a safepoint, so is NOT running, don't change the
+      /// call stack, so is NOT ALLOCATING.... The GC is then
+      /// permitted to scan the call stacks in agenda_work_gc_callframe_
+      /// ...
+      agenda_gc_collecting_.store(true);
+      double ttsafepoint = rps_elapsed_real_time() - agenda_gc_request_elapsed_.load();
+      if (ttsafepoint < 0.0)
+        ttsafepoint = 0.0;
+      agenda_tts_cumul_ += ttsafepoint;
+      agenda_tts_count_++;
+      if (ttsafepoint > agenda_tts_max_)
+        agenda_tts_max_ = ttsafepoint;
+      RPS_DEBUG_LOG(GARBAGE_COLLECTOR, "Rps_Agenda::do_garbage_collect ix=" << ix
+                    << " time to safepoint "
+                    << (ttsafepoint*1.0e6) << " µs with "
+                    << agenda_gc_parked_count_.load() << " parked worker threads");
+      /// the event loop thread may add tasklets meanwhile
+      ulock.unlock();
       std::function<void(Rps_GarbageCollector*)> gcfun([&](Rps_GarbageCollector*gc)
       {
         for (int thrix=1; thrix<rps_nbjobs; thrix++)
@@ -365,25 +400,20 @@ Rps_Agenda::do_garbage_collect(int ix, Rps_CallFrame*callframe)
             if (!pcallfr)
               continue;
             gc->mark_call_stack(pcallfr);
-            agenda_work_gc_callframe_[thrix].store(nullptr);
           }
       });
       rps_garbage_collect(&gcfun);
+      ulock.lock();
+      agenda_cumulw_gc_.store(Rps_QuasiZone::cumulative_allocated_wordcount());
+      agenda_needs_garbcoll_.store(false);
+      agenda_gc_epoch_.fetch_add(1);
+      agenda_gc_collecting_.store(false);
     };
-  std::this_thread::sleep_for(1ms/8);
-  // Every thread which is in GC state switches to EndGC state.
-  for (int wix=1; wix<rps_nbjobs; wix++)
-    {
-      std::thread*curthr = agenda_thread_array_[wix].load();
-      if (!curthr)
-        continue;
-      if (agenda_work_thread_state_[wix].load() == Rps_Agenda::WthrAg_GC)
-        agenda_work_thread_state_[wix].store(Rps_Agenda::WthrAg_EndGC);
-    };
-  std::this_thread::sleep_for(1ms/8);
+  agenda_work_gc_callframe_[ix].store(nullptr);
+  agenda_gc_parked_count_.fetch_sub(1);
+  agenda_work_thread_state_[ix].store(oldstate);
   Rps_Agenda::agenda_changed_condvar_.notify_all();
-  // at the next iteration of Rps_Agenda::run_agenda_worker, the
-  // thread will resume usual work if agenda is non-empty....
+  // the parked worker threads resume their usual work....
 } // end of Rps_Agenda::do_garbage_collect
 
 /// start and run the agenda mechanism. This does not return till the
@@ -445,11 +475,30 @@ rps_run_agenda_mechanism(int nbjobs)
     }
 } // end of rps_run_agenda_mechanism
 
+void
+Rps_Agenda::output_safepoint_statistics(std::ostream&out)
+{
+  std::lock_guard<std::recursive_mutex> gu(agenda_mtx_);
+  if (agenda_tts_count_ == 0)
+    {
+      out << "no agenda safepoint reached";
+      return;
+    }
+  out << agenda_tts_count_ << " agenda safepoints, average time to safepoint "
+      << (agenda_tts_cumul_*1.0e6/agenda_tts_count_) << " µs, maximum "
+      << (agenda_tts_max_*1.0e6) << " µs";
+} // end Rps_Agenda::output_safepoint_statistics
+
 void
 rps_stop_agenda_mechanism(void)
 {
   Rps_Agenda::agenda_is_running_.store(false);
   Rps_Agenda::agenda_changed_condvar_.notify_all();
+  RPS_INFORMOUT("stopping agenda: "
+                << Rps_Do_Output([&](std::ostream&out)
+  {
+    Rps_Agenda::output_safepoint_statistics(out);
+  }));
 } // end of rps_stop_agenda_mechanism
 
 
@@ -0,0 +1,625 @@
+/****************************************************************
+ * file asyncio_rps.cc
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Description:
+ *      This file is part of the Reflective Persistent System.
+ *      It implements asynchronous whole file input and output, using
+ *      the Linux io_uring(7) when available.
+ *
+ * Author(s):
+ *      Basile Starynkevitch <basile@starynkevitch.net>
+ *      Abhishek Chakravarti <abhishek@taranjali.org>
+ *      Nimesh Neema <nimeshneema@gmail.com>
+ *
+ *      © Copyright (C) 2025 The Reflective Persistent System Team
+ *      team@refpersys.org & http://refpersys.org/
+ *
+ * License:
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "refpersys.hh"
+
+/// we don't depend upon liburing, just on the Linux kernel headers
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+
+extern "C" const char rps_asyncio_gitid[];
+const char rps_asyncio_gitid[]= RPS_GITID;
+
+extern "C" const char rps_asyncio_date[];
+const char rps_asyncio_date[]= __DATE__;
+
+extern "C" const char rps_asyncio_shortgitid[];
+const char rps_asyncio_shortgitid[]= RPS_SHORTGITID;
+
+/// number of submission queue entries of our io_uring
+#define RPS_ASYNCIO_NBENTRIES 64
+
+/// the largest chunk transferred by one io_uring operation
+#define RPS_ASYNCIO_MAXCHUNK (1<<30)
+
+/// a pending whole file request
+struct rps_asyncio_req_st
+{
+  Rps_AsyncFileIo::ticket_t aio_ticket;
+  bool aio_reading;
+  bool aio_done;
+  bool aio_inflight;    // submitted to the io_uring, not yet completed
+  int aio_fd;
+  int aio_errno;
+  size_t aio_off;       // number of bytes already transferred
+  std::string aio_path;
+  std::string aio_buf;  // the content read or to be written
+  Rps_ClosureValue aio_clos; // the continuation, if any
+};
+
+/// the io_uring rings, mmap-ed as in io_uring_setup(2)
+struct rps_asyncio_ring_st
+{
+  int ring_fd;
+  int ring_eventfd;
+  unsigned ring_nbentries;
+  unsigned ring_inflight;   // number of submitted operations
+  unsigned ring_tosubmit;   // number of queued, not yet submitted, entries
+  unsigned*ring_sqhead;
+  unsigned*ring_sqtail;
+  unsigned*ring_sqmask;
+  unsigned*ring_sqarray;
+  unsigned*ring_cqhead;
+  unsigned*ring_cqtail;
+  unsigned*ring_cqmask;
+  struct io_uring_sqe*ring_sqes;
+  struct io_uring_cqe*ring_cqes;
+  void*ring_sqptr;
+  size_t ring_sqsize;
+  void*ring_cqptr;
+  size_t ring_cqsize;
+  size_t ring_sqesize;
+};
+
+static std::recursive_mutex rps_asyncio_mtx;
+static struct rps_asyncio_ring_st rps_asyncio_ring;
+static std::map<Rps_AsyncFileIo::ticket_t, struct rps_asyncio_req_st*> rps_asyncio_reqmap;
+static Rps_AsyncFileIo::ticket_t rps_asyncio_lastticket;
+static bool rps_asyncio_in_event_loop;
+/// requests waiting for room in the full submission ring
+static std::deque<struct rps_asyncio_req_st*> rps_asyncio_backlog;
+/// true while some thread waits for completions in io_uring_enter,
+/// without rps_asyncio_mtx; only that thread reaps meanwhile, and the
+/// other waiters sleep on the condition variable
+static bool rps_asyncio_waiting;
+static std::condition_variable_any rps_asyncio_waitcond;
+
+static void rps_asyncio_queue_sqe(struct rps_asyncio_req_st*req);
+static void rps_asyncio_submit(void);
+static void rps_asyncio_reap(void);
+static void rps_asyncio_wait_completions(std::unique_lock<std::recursive_mutex>&lock);
+static void rps_asyncio_perform_blocking(struct rps_asyncio_req_st*req);
+static void rps_asyncio_run_continuations(Rps_CallFrame*cf);
+extern "C" void rps_asyncio_eventfd_handler(Rps_CallFrame*cf, int fd, void* data);
+
+void
+Rps_AsyncFileIo::initialize(void)
+{
+  std::lock_guard<std::recursive_mutex> gu(rps_asyncio_mtx);
+  static int count;
+  if (count++ > 0)
+    RPS_FATALOUT("Rps_AsyncFileIo::initialize called twice");
+  rps_asyncio_ring.ring_fd = -1;
+  rps_asyncio_ring.ring_eventfd = -1;
+  if (rps_without_io_uring)
+    {
+      RPS_INFORMOUT("io_uring is disabled, using blocking file input and output");
+      return;
+    };
+  struct io_uring_params params;
+  memset (&params, 0, sizeof(params));
+  int ringfd = (int) syscall(__NR_io_uring_setup, RPS_ASYNCIO_NBENTRIES, &params);
+  if (ringfd < 0)
+    {
+      RPS_INFORMOUT("io_uring unavailable (" << strerror(errno)
+                    << "), using blocking file input and output");
+      return;
+    };
+  auto& ring = rps_asyncio_ring;
+  ring.ring_nbentries = params.sq_entries;
+  ring.ring_sqsize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  ring.ring_cqsize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+      if (ring.ring_cqsize > ring.ring_sqsize)
+        ring.ring_sqsize = ring.ring_cqsize;
+      ring.ring_cqsize = ring.ring_sqsize;
+    };
+  ring.ring_sqptr = mmap(nullptr, ring.ring_sqsize, PROT_READ|PROT_WRITE,
+                         MAP_SHARED|MAP_POPULATE, ringfd, IORING_OFF_SQ_RING);
+  if (ring.ring_sqptr == MAP_FAILED)
+    RPS_FATALOUT("failed to mmap io_uring submission ring:" << strerror(errno));
+  if (params.features & IORING_FEAT_SINGLE_MMAP)
+    ring.ring_cqptr = ring.ring_sqptr;
+  else
+    {
+      ring.ring_cqptr = mmap(nullptr, ring.ring_cqsize, PROT_READ|PROT_WRITE,
+                             MAP_SHARED|MAP_POPULATE, ringfd, IORING_OFF_CQ_RING);
+      if (ring.ring_cqptr == MAP_FAILED)
+        RPS_FATALOUT("failed to mmap io_uring completion ring:" << strerror(errno));
+    };
+  ring.ring_sqesize = params.sq_entries * sizeof(struct io_uring_sqe);
+  void*sqesptr = mmap(nullptr, ring.ring_sqesize, PROT_READ|PROT_WRITE,
+                      MAP_SHARED|MAP_POPULATE, ringfd, IORING_OFF_SQES);
+  if (sqesptr == MAP_FAILED)
+    RPS_FATALOUT("failed to mmap io_uring submission entries:" << strerror(errno));
+  char*sqp = (char*)ring.ring_sqptr;
+  char*cqp = (char*)ring.ring_cqptr;
+  ring.ring_sqhead = (unsigned*)(sqp + params.sq_off.head);
+  ring.ring_sqtail = (unsigned*)(sqp + params.sq_off.tail);
+  ring.ring_sqmask = (unsigned*)(sqp + params.sq_off.ring_mask);
+  ring.ring_sqarray = (unsigned*)(sqp + params.sq_off.array);
+  ring.ring_sqes = (struct io_uring_sqe*)sqesptr;
+  ring.ring_cqhead = (unsigned*)(cqp + params.cq_off.head);
+  ring.ring_cqtail = (unsigned*)(cqp + params.cq_off.tail);
+  ring.ring_cqmask = (unsigned*)(cqp + params.cq_off.ring_mask);
+  ring.ring_cqes = (struct io_uring_cqe*)(cqp + params.cq_off.cqes);
+  ring.ring_inflight = 0;
+  ring.ring_tosubmit = 0;
+  ring.ring_fd = ringfd;
+  RPS_DEBUG_LOG(LOAD, "Rps_AsyncFileIo::initialize io_uring fd#" << ringfd
+                << " with " << params.sq_entries << " entries");
+} // end Rps_AsyncFileIo::initialize
+
+bool
+Rps_AsyncFileIo::has_io_uring(void)
+{
+  std::lock_guard<std::recursive_mutex> gu(rps_asyncio_mtx);
+  return rps_asyncio_ring.ring_fd > 0;
+} // end Rps_AsyncFileIo::has_io_uring
+
+void
+Rps_AsyncFileIo::initialize_in_event_loop(void)
+{
+  std::lock_guard<std::recursive_mutex> gu(rps_asyncio_mtx);
+  if (rps_asyncio_ring.ring_fd <= 0)
+    return;
+  int evfd = eventfd(0, EFD_CLOEXEC|EFD_NONBLOCK);
+  if (evfd < 0)
+    RPS_FATALOUT("Rps_AsyncFileIo::initialize_in_event_loop failed to eventfd:"
+                 << strerror(errno));
+  if (syscall(__NR_io_uring_register, rps_asyncio_ring.ring_fd,
+              IORING_REGISTER_EVENTFD, &evfd, 1) < 0)
+    {
+      RPS_WARNOUT("Rps_AsyncFileIo::initialize_in_event_loop failed to register eventfd:"
+                  << strerror(errno));
+      close(evfd);
+      return;
+    };
+  rps_asyncio_ring.ring_eventfd = evfd;
+  rps_asyncio_in_event_loop = true;
+  rps_event_loop_add_input_fd_handler(evfd, rps_asyncio_eventfd_handler,
+                                      "io_uring completions", nullptr);
+} // end Rps_AsyncFileIo::initialize_in_event_loop
+
+/// fill a submission queue entry for the rest of req, under
+/// rps_asyncio_mtx; the caller submits it with rps_asyncio_submit
+void
+rps_asyncio_queue_sqe(struct rps_asyncio_req_st*req)
+{
+  auto& ring = rps_asyncio_ring;
+  RPS_ASSERT(req != nullptr && !req->aio_done && !req->aio_inflight);
+  RPS_ASSERT(ring.ring_fd > 0);
+  /// keep at most ring_nbentries operations in flight, so the
+  /// completion ring never overflows; rps_asyncio_reap queues the
+  /// backlog as operations complete
+  if (ring.ring_inflight + ring.ring_tosubmit >= ring.ring_nbentries)
+    {
+      rps_asyncio_backlog.push_back(req);
+      return;
+    };
+  unsigned tail = *ring.ring_sqtail;
+  unsigned ix = tail & *ring.ring_sqmask;
+  struct io_uring_sqe*sqe = ring.ring_sqes + ix;
+  memset (sqe, 0, sizeof(*sqe));
+  size_t len = req->aio_buf.size() - req->aio_off;
+  if (len > RPS_ASYNCIO_MAXCHUNK)
+    len = RPS_ASYNCIO_MAXCHUNK;
+  sqe->opcode = req->aio_reading?IORING_OP_READ:IORING_OP_WRITE;
+  sqe->fd = req->aio_fd;
+  sqe->addr = (uint64_t)(uintptr_t)(req->aio_buf.data() + req->aio_off);
+  sqe->len = (uint32_t)len;
+  sqe->off = req->aio_off;
+  sqe->user_data = (uint64_t)req->aio_ticket;
+  ring.ring_sqarray[ix] = ix;
+  __atomic_store_n(ring.ring_sqtail, tail+1, __ATOMIC_RELEASE);
+  ring.ring_tosubmit++;
+  req->aio_inflight = true;
+} // end rps_asyncio_queue_sqe
+
+/// submit the queued entries in one system call, without waiting,
+/// under rps_asyncio_mtx
+void
+rps_asyncio_submit(void)
+{
+  auto& ring = rps_asyncio_ring;
+  RPS_ASSERT(ring.ring_fd > 0);
+  unsigned nbsub = ring.ring_tosubmit;
+  if (nbsub == 0)
+    return;
+  errno = 0;
+  int ret = (int) syscall(__NR_io_uring_enter, ring.ring_fd, nbsub, 0,
+                          0, nullptr, 0);
+  if (ret < 0)
+    {
+      if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+        return;
+      RPS_FATALOUT("io_uring_enter failed to submit " << nbsub
+                   << " entries:" << strerror(errno));
+    };
+  ring.ring_tosubmit -= ret;
+  ring.ring_inflight += ret;
+} // end rps_asyncio_submit
+
+/// handle the available completions, under rps_asyncio_mtx
+void
+rps_asyncio_reap(void)
+{
+  auto& ring = rps_asyncio_ring;
+  unsigned head = *ring.ring_cqhead;
+  bool requeued = false;
+  for (;;)
+    {
+      unsigned tail = __atomic_load_n(ring.ring_cqtail, __ATOMIC_ACQUIRE);
+      if (head == tail)
+        break;
+      struct io_uring_cqe*cqe = ring.ring_cqes + (head & *ring.ring_cqmask);
+      Rps_AsyncFileIo::ticket_t tick = (Rps_AsyncFileIo::ticket_t) cqe->user_data;
+      int res = cqe->res;
+      head++;
+      RPS_ASSERT(ring.ring_inflight > 0);
+      ring.ring_inflight--;
+      auto it = rps_asyncio_reqmap.find(tick);
+      if (it == rps_asyncio_reqmap.end())
+        continue;
+      struct rps_asyncio_req_st*req = it->second;
+      req->aio_inflight = false;
+      if (res == -EAGAIN || res == -EINTR)
+        {
+          rps_asyncio_queue_sqe(req);
+          requeued = true;
+        }
+      else if (res < 0)
+        {
+          req->aio_errno = -res;
+          req->aio_done = true;
+        }
+      else if (res == 0 && req->aio_reading)
+        {
+          /// the file shrinked since we did fstat it
+          req->aio_buf.resize(req->aio_off);
+          req->aio_done = true;
+        }
+      else
+        {
+          req->aio_off += res;
+          if (req->aio_off < req->aio_buf.size())
+            {
+              rps_asyncio_queue_sqe(req);
+              requeued = true;
+            }
+          else
+            req->aio_done = true;
+        }
+    };
+  __atomic_store_n(ring.ring_cqhead, head, __ATOMIC_RELEASE);
+  while (!rps_asyncio_backlog.empty()
+         && ring.ring_inflight + ring.ring_tosubmit < ring.ring_nbentries)
+    {
+      struct rps_asyncio_req_st*req = rps_asyncio_backlog.front();
+      rps_asyncio_backlog.pop_front();
+      rps_asyncio_queue_sqe(req);
+      requeued = true;
+    };
+  if (requeued)
+    rps_asyncio_submit();
+} // end rps_asyncio_reap
+
+/// wait for some completions and reap them; the lock on
+/// rps_asyncio_mtx is released while blocked, so other threads can
+/// submit requests meanwhile
+void
+rps_asyncio_wait_completions(std::unique_lock<std::recursive_mutex>&lock)
+{
+  auto& ring = rps_asyncio_ring;
+  RPS_ASSERT(ring.ring_fd > 0);
+  if (rps_asyncio_waiting)
+    {
+      rps_asyncio_waitcond.wait(lock);
+      return;
+    };
+  rps_asyncio_waiting = true;
+  rps_asyncio_submit();
+  lock.unlock();
+  errno = 0;
+  int ret = (int) syscall(__NR_io_uring_enter, ring.ring_fd, 0, 1,
+                          IORING_ENTER_GETEVENTS, nullptr, 0);
+  int err = errno;
+  lock.lock();
+  rps_asyncio_waiting = false;
+  if (ret < 0 && err != EINTR && err != EAGAIN && err != EBUSY)
+    RPS_FATALOUT("io_uring_enter failed to wait for completions:" << strerror(err));
+  rps_asyncio_reap();
+  rps_asyncio_waitcond.notify_all();
+  /// the event loop skipped the completions reaped here, so wake it
+  /// up for their continuations
+  if (ring.ring_eventfd >= 0)
+    {
+      uint64_t one = 1;
+      if (write(ring.ring_eventfd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+        RPS_WARNOUT("rps_asyncio_wait_completions failed to write eventfd#"
+                    << ring.ring_eventfd << ":" << strerror(errno));
+    };
+} // end rps_asyncio_wait_completions
+
+/// the fallback, used without io_uring, under rps_asyncio_mtx
+void
+rps_asyncio_perform_blocking(struct rps_asyncio_req_st*req)
+{
+  RPS_ASSERT(req != nullptr && !req->aio_inflight);
+  while (!req->aio_done)
+    {
+      size_t len = req->aio_buf.size() - req->aio_off;
+      if (len == 0)
+        {
+          req->aio_done = true;
+          break;
+        }
+      errno = 0;
+      ssize_t nb = req->aio_reading
+                   ? pread(req->aio_fd, (char*)req->aio_buf.data() + req->aio_off, len, req->aio_off)
+                   : pwrite(req->aio_fd, req->aio_buf.data() + req->aio_off, len, req->aio_off);
+      if (nb < 0 && errno == EINTR)
+        continue;
+      if (nb < 0)
+        {
+          req->aio_errno = errno;
+          req->aio_done = true;
+        }
+      else if (nb == 0 && req->aio_reading)
+        {
+          req->aio_buf.resize(req->aio_off);
+          req->aio_done = true;
+        }
+      else
+        req->aio_off += nb;
+    };
+} // end rps_asyncio_perform_blocking
+
+Rps_AsyncFileIo::ticket_t
+Rps_AsyncFileIo::submit_read_file(const std::string& path)
+{
+  std::lock_guard<std::recursive_mutex> gu(rps_asyncio_mtx);
+  struct rps_asyncio_req_st*req = new rps_asyncio_req_st;
+  req->aio_ticket = ++rps_asyncio_lastticket;
+  req->aio_reading = true;
+  req->aio_done = false;
+  req->aio_inflight = false;
+  req->aio_errno = 0;
+  req->aio_off = 0;
+  req->aio_path = path;
+  req->aio_fd = open(path.c_str(), O_RDONLY|O_CLOEXEC);
+  if (req->aio_fd < 0)
+    {
+      req->aio_errno = errno;
+      req->aio_done = true;
+    }
+  else
+    {
+      struct stat st;
+      memset (&st, 0, sizeof(st));
+      if (fstat(req->aio_fd, &st))
+        {
+          req->aio_errno = errno;
+          req->aio_done = true;
+        }
+      else
+        {
+          req->aio_buf.resize(st.st_size);
+          if (st.st_size == 0)
+            req->aio_done = true;
+        }
+    };
+  rps_asyncio_reqmap.insert({req->aio_ticket, req});
+  if (!req->aio_done && rps_asyncio_ring.ring_fd > 0)
+    {
+      rps_asyncio_queue_sqe(req);
+      rps_asyncio_submit();
+    };
+  return req->aio_ticket;
+} // end Rps_AsyncFileIo::submit_read_file
+
+Rps_AsyncFileIo::ticket_t
+Rps_AsyncFileIo::submit_write_file(const std::string& path, std::string&& content)
+{
+  std::lock_guard<std::recursive_mutex> gu(rps_asyncio_mtx);
+  struct rps_asyncio_req_st*req = new rps_asyncio_req_st;
+  req->aio_ticket = ++rps_asyncio_lastticket;
+  req->aio_reading = false;
+  req->aio_done = false;
+  req->aio_inflight = false;
+  req->aio_errno = 0;
+  req->aio_off = 0;
+  req->aio_path = path;
+  req->aio_buf = std::move(content);
+  req->aio_fd = open(path.c_str(), O_WRONLY|O_CREAT|O_TRUNC|O_CLOEXEC, 0644);
+  if (req->aio_fd < 0)
+    {
+      req->aio_errno = errno;
+      req->aio_done = true;
+    }
+  else if (req->aio_buf.empty())
+    req->aio_done = true;
+  rps_asyncio_reqmap.insert({req->aio_ticket, req});
+  if (!req->aio_done && rps_asyncio_ring.ring_fd > 0)
+    {
+      rps_asyncio_queue_sqe(req);
+      rps_asyncio_submit();
+    };
+  return req->aio_ticket;
+} // end Rps_AsyncFileIo::submit_write_file
+
+/// wait for the request of given ticket, and remove it; the caller
+/// should delete it
+static struct rps_asyncio_req_st*
+rps_asyncio_wait(Rps_AsyncFileIo::ticket_t tick)
+{
+  std::unique_lock<std::recursive_mutex> lock(rps_asyncio_mtx);
+  auto it = rps_asyncio_reqmap.find(tick);
+  if (it == rps_asyncio_reqmap.end())
+    throw std::runtime_error(std::string("invalid asynchronous file ticket ")
+                             + std::to_string(tick));
+  struct rps_asyncio_req_st*req = it->second;
+  while (!req->aio_done)
+    {
+      if (rps_asyncio_ring.ring_fd > 0)
+        rps_asyncio_wait_completions(lock);
+      else
+        rps_asyncio_perform_blocking(req);
+    };
+  rps_asyncio_reqmap.erase(tick);
+  if (req->aio_fd >= 0)
+    close(req->aio_fd);
+  req->aio_fd = -1;
+  return req;
+} // end rps_asyncio_wait
+
+std::string
+Rps_AsyncFileIo::wait_read(ticket_t tick)
+{
+  std::unique_ptr<struct rps_asyncio_req_st> req(rps_asyncio_wait(tick));
+  RPS_ASSERT(req->aio_reading);
+  if (req->aio_errno)
+    throw std::runtime_error(std::string("failed to read ") + req->aio_path
+                             + ":" + strerror(req->aio_errno));
+  return std::move(req->aio_buf);
+} // end Rps_AsyncFileIo::wait_read
+
+void
+Rps_AsyncFileIo::wait_write(ticket_t tick)
+{
+  std::unique_ptr<struct rps_asyncio_req_st> req(rps_asyncio_wait(tick));
+  RPS_ASSERT(!req->aio_reading);
+  if (req->aio_errno)
+    throw std::runtime_error(std::string("failed to write ") + req->aio_path
+                             + ":" + strerror(req->aio_errno));
+} // end Rps_AsyncFileIo::wait_write
+
+Rps_AsyncFileIo::ticket_t
+Rps_AsyncFileIo::async_read_file_then(Rps_CallFrame*callerframe, const std::string& path, Rps_ClosureValue clos)
+{
+  RPS_LOCALFRAME(RPS_CALL_FRAME_UNDESCRIBED,
+                 callerframe,
+                 Rps_ClosureValue clos;
+                 Rps_Value strv;
+                );
+  _f.clos = clos;
+  ticket_t tick = submit_read_file(path);
+  {
+    std::lock_guard<std::recursive_mutex> gu(rps_asyncio_mtx);
+    auto it = rps_asyncio_reqmap.find(tick);
+    RPS_ASSERT(it != rps_asyncio_reqmap.end());
+    /// a request which failed to open, or of an empty file, is
+    /// already done and would never be reaped, so is continued below
+    if (rps_asyncio_in_event_loop && rps_is_active_event_loop()
+        && !it->second->aio_done)
+      {
+        it->second->aio_clos = _f.clos;
+        return tick;
+      }
+  }
+  /// no event loop or an already completed request, so read and
+  /// continue now
+  int err = 0;
+  {
+    std::unique_ptr<struct rps_asyncio_req_st> req(rps_asyncio_wait(tick));
+    RPS_ASSERT(req->aio_reading);
+    err = req->aio_errno;
+    _f.strv = Rps_StringValue(err?std::string():req->aio_buf);
+  }
+  _f.clos.apply2(&_, _f.strv, Rps_Value((intptr_t)err));
+  return tick;
+} // end Rps_AsyncFileIo::async_read_file_then
+
+/// apply the continuations of completed requests, in the event loop
+void
+rps_asyncio_run_continuations(Rps_CallFrame*cf)
+{
+  RPS_ASSERT(rps_is_main_thread());
+  RPS_LOCALFRAME(RPS_CALL_FRAME_UNDESCRIBED,
+                 cf,
+                 Rps_ClosureValue clos;
+                 Rps_Value strv;
+                );
+  for (;;)
+    {
+      std::unique_ptr<struct rps_asyncio_req_st> req;
+      {
+        std::lock_guard<std::recursive_mutex> gu(rps_asyncio_mtx);
+        for (auto it: rps_asyncio_reqmap)
+          if (it.second->aio_done && it.second->aio_clos)
+            {
+              req.reset(rps_asyncio_wait(it.first));
+              break;
+            }
+      }
+      if (!req)
+        break;
+      _f.clos = req->aio_clos;
+      _f.strv = Rps_StringValue(req->aio_buf);
+      _f.clos.apply2(&_, _f.strv, Rps_Value((intptr_t)req->aio_errno));
+    };
+} // end rps_asyncio_run_continuations
+
+void
+rps_asyncio_eventfd_handler(Rps_CallFrame*cf, int fd, [[maybe_unused]] void* data)
+{
+  RPS_ASSERT(cf != nullptr && cf->is_good_call_frame());
+  RPS_ASSERT(fd == rps_asyncio_ring.ring_eventfd);
+  uint64_t cnt = 0;
+  /// edge-triggered, so read till EAGAIN
+  while (read(fd, &cnt, sizeof(cnt)) == sizeof(cnt))
+    continue;
+  {
+    std::lock_guard<std::recursive_mutex> gu(rps_asyncio_mtx);
+    /// a thread blocked in rps_asyncio_wait_completions reaps, and
+    /// writes the eventfd again once done
+    if (rps_asyncio_waiting)
+      return;
+    rps_asyncio_reap();
+  }
+  rps_asyncio_run_continuations(cf);
+} // end rps_asyncio_eventfd_handler
+
+void
+Rps_AsyncFileIo::gc_mark(Rps_GarbageCollector&gc)
+{
+  std::lock_guard<std::recursive_mutex> gu(rps_asyncio_mtx);
+  for (auto it: rps_asyncio_reqmap)
+    if (it.second->aio_clos)
+      gc.mark_value(it.second->aio_clos);
+} // end Rps_AsyncFileIo::gc_mark
+
+/// adding a pragma which works for both GCC and Clang
+#pragma message "compiled asyncio_rps.cc"
+
+//// end of file asyncio_rps.cc
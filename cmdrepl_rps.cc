@@ -55,12 +55,13 @@ rps_full_evaluate_repl_composite_object(Rps_CallFrame*callframe, unsigned long c
 //// RPS_REPLEVAL_LOCALFRAME macro which defines and initialize exprv and envob
 #warning we could need some RPS_REPLEVAL_LOCALFRAME macro local to this source file.
 
-/// Evaluate for the REPL machinery in given callframe the expression
-/// `expr` in the environment given by `envob`; should give two values
-/// which should not be both null.  This routine might be called in a
-/// non-REPL thread by agenda....
-Rps_TwoValues
-rps_full_evaluate_repl_expr(Rps_CallFrame*callframe, Rps_Value exprarg, Rps_ObjectRef envobarg)
+/// Walk and evaluate for the REPL machinery in given callframe the
+/// expression `expr` in the environment given by `envob`, dispatching
+/// again on its type and class.  This is the slow path, used by
+/// rps_full_evaluate_repl_expr when some compiled node cannot handle
+/// the expression, and it gives the detailed failures.
+static Rps_TwoValues
+rps_walk_evaluate_repl_expr(Rps_CallFrame*callframe, Rps_Value exprarg, Rps_ObjectRef envobarg)
 {
 #define TEMPORARY_CODE 1
   RPS_ASSERT_CALLFRAME (callframe);
@@ -238,7 +239,7 @@ rps_full_evaluate_repl_expr(Rps_CallFrame*callframe, Rps_Value exprarg, Rps_Obje
             {
               bool missing = false;
               RPS_POSSIBLE_BREAKPOINT();
-              _f.mainresv = paylenv->get_obmap(_f.evalob,/*defaultval:*/nullptr,&missing);
+              _f.mainresv = paylenv->get_binding(_f.evalob,&missing);
               if (!missing)
                 {
                   RPS_REPLEVAL_GIVES_PLAIN(_f.mainresv);
@@ -290,7 +291,7 @@ rps_full_evaluate_repl_expr(Rps_CallFrame*callframe, Rps_Value exprarg, Rps_Obje
           if (paylenv)
             {
               bool missing = false;
-              _f.mainresv = paylenv->get_obmap(_f.evalob,nullptr,&missing);
+              _f.mainresv = paylenv->get_binding(_f.evalob,&missing);
               if (!missing)
                 {
                   RPS_REPLEVAL_GIVES_PLAIN(_f.mainresv);
@@ -337,6 +338,249 @@ rps_full_evaluate_repl_expr(Rps_CallFrame*callframe, Rps_Value exprarg, Rps_Obje
       RPS_POSSIBLE_BREAKPOINT();
       RPS_REPLEVAL_GIVES_PLAIN(_f.exprv);
     }
+} // end rps_walk_evaluate_repl_expr
+
+
+
+////////////////////////////////////////////////////////////////
+//// Compiled REPL expressions.  An expression object is compiled
+//// once into an evaluator node, so its class is dispatched upon only
+//// at compile time.  The compiled node is cached in a weak side table
+//// keyed by the expression object, and is recompiled when that
+//// object is modified (its mtime or class changes).  Variables cache
+//// the environment binding them, validated by the generation counter
+//// of Rps_PayloadEnvironment.
+
+class Rps_ReplEvalNode
+{
+public:
+  virtual ~Rps_ReplEvalNode() {};
+  /// the expression object is passed, not kept, to keep the cache weak
+  virtual Rps_TwoValues eval(Rps_CallFrame*callframe, Rps_ObjectRef exprob, Rps_ObjectRef envob) =0;
+};                              // end Rps_ReplEvalNode
+
+/// self-evaluating objects
+class Rps_ReplSelfEvalNode : public Rps_ReplEvalNode
+{
+public:
+  virtual Rps_TwoValues eval(Rps_CallFrame*, Rps_ObjectRef exprob, Rps_ObjectRef)
+  {
+    return Rps_TwoValues(Rps_Value(exprob), nullptr);
+  };
+};                              // end Rps_ReplSelfEvalNode
+
+/// composite repl_expression-s, still evaluated by walking them
+class Rps_ReplCompositeNode : public Rps_ReplEvalNode
+{
+public:
+  virtual Rps_TwoValues eval(Rps_CallFrame*callframe, Rps_ObjectRef exprob, Rps_ObjectRef envob)
+  {
+    return rps_walk_evaluate_repl_expr(callframe, Rps_Value(exprob), envob);
+  };
+};                              // end Rps_ReplCompositeNode
+
+/// variables and symbolic variables, with an inline cache of the
+/// environment binding them, and of their slot there (or -1 when
+/// bound in its object map)
+class Rps_ReplVariableNode : public Rps_ReplEvalNode
+{
+  std::mutex vn_mtx;
+  Rps_ObjectZone* vn_startenv;
+  Rps_ObjectZone* vn_foundenv;
+  unsigned vn_depth;
+  int vn_slot;
+  uint64_t vn_generation;
+  bool resolve(Rps_ObjectRef varob, Rps_ObjectRef envob);
+public:
+  Rps_ReplVariableNode() :
+    vn_startenv(nullptr), vn_foundenv(nullptr), vn_depth(0), vn_slot(-1), vn_generation(0) {};
+  virtual Rps_TwoValues eval(Rps_CallFrame*callframe, Rps_ObjectRef exprob, Rps_ObjectRef envob);
+};                              // end Rps_ReplVariableNode
+
+/// find the environment binding varob, starting from envob, and
+/// remember it; the generation is read before walking, so a binding
+/// change while we walk invalidates what we remember
+bool
+Rps_ReplVariableNode::resolve(Rps_ObjectRef varob, Rps_ObjectRef envob)
+{
+  constexpr unsigned maxdepth = 256;
+  uint64_t gen = Rps_PayloadEnvironment::generation();
+  Rps_ObjectRef curenvob = envob;
+  unsigned depth = 0;
+  while (curenvob && depth < maxdepth)
+    {
+      Rps_ObjectRef parenvob;
+      {
+        std::lock_guard gu(*curenvob->objmtxptr());
+        auto paylenv = curenvob->get_dynamic_payload<Rps_PayloadEnvironment>();
+        if (!paylenv)
+          return false;
+        if (paylenv->has_binding(varob))
+          {
+            std::lock_guard vgu(vn_mtx);
+            vn_startenv = envob.optr();
+            vn_foundenv = curenvob.optr();
+            vn_depth = depth;
+            vn_slot = paylenv->slot_index(varob);
+            vn_generation = gen;
+            return true;
+          };
+        parenvob = paylenv->get_parent_environment();
+      }
+      curenvob = parenvob;
+      depth++;
+    };
+  return false;
+} // end Rps_ReplVariableNode::resolve
+
+Rps_TwoValues
+Rps_ReplVariableNode::eval(Rps_CallFrame*callframe, Rps_ObjectRef exprob, Rps_ObjectRef envob)
+{
+  Rps_ObjectZone* foundenv = nullptr;
+  int slotix = -1;
+  {
+    std::lock_guard vgu(vn_mtx);
+    if (vn_startenv == envob.optr()
+        && vn_generation == Rps_PayloadEnvironment::generation())
+      {
+        foundenv = vn_foundenv;
+        slotix = vn_slot;
+      }
+  }
+  if (!foundenv)
+    {
+      if (!resolve(exprob, envob))
+        return rps_walk_evaluate_repl_expr(callframe, Rps_Value(exprob), envob);
+      std::lock_guard vgu(vn_mtx);
+      foundenv = vn_foundenv;
+      slotix = vn_slot;
+      RPS_DEBUG_LOG(REPL, "Rps_ReplVariableNode resolved " << exprob
+                    << " in env:" << envob << " to env:" << Rps_ObjectRef(foundenv)
+                    << " at depth " << vn_depth << " slot " << vn_slot);
+    };
+  RPS_ASSERT(foundenv);
+  Rps_Value resv;
+  bool missing = true;
+  {
+    std::lock_guard gu(*foundenv->objmtxptr());
+    auto paylenv = foundenv->get_dynamic_payload<Rps_PayloadEnvironment>();
+    if (paylenv && slotix >= 0 && paylenv->slot_index(exprob) == slotix)
+      {
+        resv = paylenv->get_slot(slotix);
+        missing = !resv;
+      }
+    else if (paylenv)
+      resv = paylenv->get_binding(exprob, &missing);
+  }
+  if (missing)
+    return rps_walk_evaluate_repl_expr(callframe, Rps_Value(exprob), envob);
+  return Rps_TwoValues(resv, nullptr);
+} // end Rps_ReplVariableNode::eval
+
+struct rps_repl_compiled_st
+{
+  std::shared_ptr<Rps_ReplEvalNode> rc_node;
+  Rps_ObjectZone* rc_class;
+  double rc_mtime;
+};
+static std::mutex rps_repl_compiled_mtx;
+static std::unordered_map<Rps_ObjectZone*,rps_repl_compiled_st> rps_repl_compiled_map;
+
+static std::shared_ptr<Rps_ReplEvalNode>
+rps_repl_compiled_node(Rps_ObjectRef exprob)
+{
+  RPS_ASSERT(exprob);
+  Rps_ObjectRef classob;
+  double mtime = 0.0;
+  {
+    std::lock_guard gu(*exprob->objmtxptr());
+    classob = exprob->get_class();
+    mtime = exprob->get_mtime();
+  }
+  {
+    std::lock_guard mgu(rps_repl_compiled_mtx);
+    auto it = rps_repl_compiled_map.find(exprob.optr());
+    if (it != rps_repl_compiled_map.end()
+        && it->second.rc_class == classob.optr()
+        && it->second.rc_mtime == mtime)
+      return it->second.rc_node;
+  }
+  RPS_ASSERT(classob && classob->is_class());
+  std::shared_ptr<Rps_ReplEvalNode> node;
+  if (classob == RPS_ROOT_OB(_4HJvNCh35Lu00n5z3R) //variable∈class
+      || classob->is_subclass_of(RPS_ROOT_OB(_4HJvNCh35Lu00n5z3R)) //variable∈class
+      || classob == RPS_ROOT_OB(_4Si5RBkg1Qm0285SD0) //symbolic_variable∈class
+      || classob->is_subclass_of(RPS_ROOT_OB(_4Si5RBkg1Qm0285SD0))) //symbolic_variable∈class
+    node = std::make_shared<Rps_ReplVariableNode>();
+  else if (classob == RPS_ROOT_OB(_1jJaY1usnpR02WUvSX) //repl_expression∈class
+           || classob->is_subclass_of(RPS_ROOT_OB(_1jJaY1usnpR02WUvSX))) //repl_expression∈class
+    node = std::make_shared<Rps_ReplCompositeNode>();
+  else
+    node = std::make_shared<Rps_ReplSelfEvalNode>();
+  RPS_DEBUG_LOG(REPL, "rps_repl_compiled_node compiled " << exprob
+                << " of class " << classob);
+  std::lock_guard mgu(rps_repl_compiled_mtx);
+  rps_repl_compiled_map[exprob.optr()] = rps_repl_compiled_st{node, classob.optr(), mtime};
+  return node;
+} // end rps_repl_compiled_node
+
+/// called by the garbage collector after marking, before deletion
+void
+rps_repl_compiled_forget_dead(Rps_GarbageCollector&gc)
+{
+  std::lock_guard mgu(rps_repl_compiled_mtx);
+  for (auto it = rps_repl_compiled_map.begin(); it != rps_repl_compiled_map.end(); )
+    {
+      if (it->first->is_gcmarked(gc))
+        it++;
+      else
+        it = rps_repl_compiled_map.erase(it);
+    };
+} // end rps_repl_compiled_forget_dead
+
+/// check that envob is an environment; the last environment checked
+/// by the current thread is remembered until the next generation
+static bool
+rps_repl_is_environment(Rps_ObjectRef envob)
+{
+  thread_local Rps_ObjectZone* lastenv;
+  thread_local uint64_t lastgen;
+  uint64_t gen = Rps_PayloadEnvironment::generation();
+  if (envob.optr() == lastenv && gen == lastgen)
+    return true;
+  if (!envob || envob->stored_type() != Rps_Type::Object)
+    return false;
+  std::lock_guard gu(*envob->objmtxptr());
+  if (!envob->is_instance_of(RPS_ROOT_OB(_5LMLyzRp6kq04AMM8a)) //environment∈class
+      || !envob->get_dynamic_payload<Rps_PayloadEnvironment>())
+    return false;
+  lastenv = envob.optr();
+  lastgen = gen;
+  return true;
+} // end rps_repl_is_environment
+
+/// Evaluate for the REPL machinery in given callframe the expression
+/// `expr` in the environment given by `envob`; should give two values
+/// which should not be both null.  This routine might be called in a
+/// non-REPL thread by agenda....
+Rps_TwoValues
+rps_full_evaluate_repl_expr(Rps_CallFrame*callframe, Rps_Value exprarg, Rps_ObjectRef envobarg)
+{
+  RPS_ASSERT_CALLFRAME (callframe);
+  RPS_ASSERT(envobarg);
+  if (!rps_repl_is_environment(envobarg))
+    return rps_walk_evaluate_repl_expr(callframe, exprarg, envobarg);
+  if (exprarg.is_object())
+    {
+      std::shared_ptr<Rps_ReplEvalNode> node
+        = rps_repl_compiled_node(exprarg.as_object());
+      return node->eval(callframe, exprarg.as_object(), envobarg);
+    }
+  else if (exprarg.is_int() || exprarg.is_double() || exprarg.is_string()
+           || exprarg.is_tuple() || exprarg.is_set() || exprarg.is_closure()
+           || exprarg.is_json() || exprarg.is_lextoken())
+    return Rps_TwoValues(exprarg, nullptr);
+  return rps_walk_evaluate_repl_expr(callframe, exprarg, envobarg);
 } // end rps_full_evaluate_repl_expr
 
 
@@ -393,12 +637,162 @@ rps_simple_evaluate_repl_expr(Rps_CallFrame*callframe, Rps_Value expr, Rps_Objec
 
 ////////////////
 
+std::atomic<uint64_t> Rps_PayloadEnvironment::env_generation;
+std::mutex Rps_PayloadEnvironment::env_scope_mtx;
+std::map<Rps_ObjectZone*,std::shared_ptr<const Rps_EnvironmentLayout>> Rps_PayloadEnvironment::env_scope_layouts;
+
 Rps_PayloadEnvironment::Rps_PayloadEnvironment(Rps_ObjectZone*obown) :
   Rps_PayloadObjMap(obown),
   env_parent(nullptr)
 {
+  env_generation.fetch_add(1);
 } // end Rps_PayloadEnvironment::Rps_PayloadEnvironment
 
+void
+Rps_PayloadEnvironment::put_parent_environment(Rps_ObjectRef envob)
+{
+  if (envob == env_parent)
+    return;
+  env_parent = envob;
+  env_generation.fetch_add(1);
+} // end Rps_PayloadEnvironment::put_parent_environment
+
+Rps_EnvironmentLayout::Rps_EnvironmentLayout(const std::vector<Rps_ObjectRef>&vars)
+  : envl_vars(), envl_index()
+{
+  envl_vars.reserve(vars.size());
+  for (Rps_ObjectRef varob: vars)
+    {
+      if (!varob || envl_index.find(varob.optr()) != envl_index.end())
+        continue;
+      envl_index.insert({varob.optr(), (unsigned)envl_vars.size()});
+      envl_vars.push_back(varob);
+    };
+} // end Rps_EnvironmentLayout::Rps_EnvironmentLayout
+
+Rps_EnvironmentLayout::Rps_EnvironmentLayout(const Rps_EnvironmentLayout&oldlayout, Rps_ObjectRef varob)
+  : envl_vars(oldlayout.envl_vars), envl_index(oldlayout.envl_index)
+{
+  if (varob && envl_index.find(varob.optr()) == envl_index.end())
+    {
+      envl_index.insert({varob.optr(), (unsigned)envl_vars.size()});
+      envl_vars.push_back(varob);
+    };
+} // end Rps_EnvironmentLayout::Rps_EnvironmentLayout extending
+
+/// the layout of a scope, extended with varob if it is not yet in it
+std::shared_ptr<const Rps_EnvironmentLayout>
+Rps_PayloadEnvironment::scope_layout(Rps_ObjectRef scopeob, Rps_ObjectRef varob)
+{
+  RPS_ASSERT(scopeob);
+  std::lock_guard<std::mutex> gu(env_scope_mtx);
+  auto& scopelayout = env_scope_layouts[scopeob.optr()];
+  if (!scopelayout)
+    scopelayout = std::make_shared<const Rps_EnvironmentLayout>(std::vector<Rps_ObjectRef>{});
+  if (varob && scopelayout->slot_index(varob) < 0)
+    scopelayout = std::make_shared<const Rps_EnvironmentLayout>(*scopelayout, varob);
+  return scopelayout;
+} // end Rps_PayloadEnvironment::scope_layout
+
+/// since scope layouts only grow, the bound slots keep their index
+void
+Rps_PayloadEnvironment::adopt_scope_layout(Rps_ObjectRef scopeob, Rps_ObjectRef varob)
+{
+  RPS_ASSERT(!env_scope || env_scope == scopeob);
+  env_scope = scopeob;
+  env_layout = scope_layout(scopeob, varob);
+  RPS_ASSERT(env_layout->nb_slots() >= env_slots.size());
+  env_slots.resize(env_layout->nb_slots());
+} // end Rps_PayloadEnvironment::adopt_scope_layout
+
+void
+Rps_PayloadEnvironment::gc_mark_scope_layouts(Rps_GarbageCollector&gc)
+{
+  std::lock_guard<std::mutex> gu(env_scope_mtx);
+  for (auto& it: env_scope_layouts)
+    {
+      gc.mark_obj(it.first);
+      it.second->gc_mark(gc);
+    };
+} // end Rps_PayloadEnvironment::gc_mark_scope_layouts
+
+void
+Rps_EnvironmentLayout::gc_mark(Rps_GarbageCollector&gc) const
+{
+  for (Rps_ObjectRef varob: envl_vars)
+    gc.mark_obj(varob);
+} // end Rps_EnvironmentLayout::gc_mark
+
+/// a slot holding null leaves its variable unbound, like a missing
+/// key in the object map
+Rps_Value
+Rps_PayloadEnvironment::get_binding(Rps_ObjectRef varob, bool*pmissing) const
+{
+  int slotix = slot_index(varob);
+  if (slotix >= 0)
+    {
+      if (pmissing)
+        *pmissing = !env_slots[slotix];
+      return env_slots[slotix];
+    };
+  return get_obmap(varob, nullptr, pmissing);
+} // end Rps_PayloadEnvironment::get_binding
+
+bool
+Rps_PayloadEnvironment::has_binding(Rps_ObjectRef varob) const
+{
+  int slotix = slot_index(varob);
+  if (slotix >= 0)
+    return (bool)env_slots[slotix];
+  return has_key_obmap(varob);
+} // end Rps_PayloadEnvironment::has_binding
+
+void
+Rps_PayloadEnvironment::put_binding(Rps_ObjectRef varob, Rps_Value val)
+{
+  int slotix = slot_index(varob);
+  if (slotix < 0 && env_scope && val)
+    {
+      adopt_scope_layout(env_scope, varob);
+      slotix = slot_index(varob);
+    };
+  if (slotix >= 0)
+    put_slot(slotix, val);
+  else
+    put_obmap(varob, val);
+} // end Rps_PayloadEnvironment::put_binding
+
+void
+Rps_PayloadEnvironment::put_slot(unsigned ix, Rps_Value val)
+{
+  RPS_ASSERT(ix < env_slots.size());
+  /// binding or unbinding a variable may change how it resolves
+  if ((bool)env_slots[ix] != (bool)val)
+    env_generation.fetch_add(1);
+  env_slots[ix] = val;
+} // end Rps_PayloadEnvironment::put_slot
+
+unsigned
+Rps_PayloadEnvironment::nb_bindings(void) const
+{
+  unsigned nbslotbound = 0;
+  for (Rps_Value slotv: env_slots)
+    if (slotv)
+      nbslotbound++;
+  return nbslotbound + get_obmap_size();
+} // end Rps_PayloadEnvironment::nb_bindings
+
+void
+Rps_PayloadEnvironment::do_each_entry(Rps_CallFrame*cf,
+                                      std::function<bool(Rps_CallFrame*,Rps_ObjectRef,Rps_Value,void*)> f,
+                                      void* clientdata) const
+{
+  for (unsigned ix=0; ix<env_slots.size(); ix++)
+    if (env_slots[ix] && f(cf, env_layout->slot_variable(ix), env_slots[ix], clientdata))
+      return;
+  Rps_PayloadObjMap::do_each_entry(cf, f, clientdata);
+} // end Rps_PayloadEnvironment::do_each_entry
+
 Rps_ObjectZone*
 Rps_PayloadEnvironment::make(Rps_CallFrame*callframe, Rps_ObjectRef classob, Rps_ObjectRef spaceob)
 {
@@ -416,6 +810,7 @@ Rps_PayloadEnvironment::make(Rps_CallFrame*callframe, Rps_ObjectRef classob, Rps
   _f.obenv = Rps_ObjectRef::make_object(&_, _f.obclass, _f.obspace);
   auto paylenv = _f.obenv->put_new_plain_payload<Rps_PayloadEnvironment>();
   RPS_ASSERT(paylenv);
+  paylenv->adopt_scope_layout(_f.obclass);
   return _f.obenv;
 } // end Rps_PayloadEnvironment::make
 
@@ -439,6 +834,7 @@ Rps_PayloadEnvironment::make_with_parent_environment(Rps_CallFrame*callframe, Rp
   _f.obenv = Rps_ObjectRef::make_object(&_, _f.obclass, _f.obspace);
   auto paylenv = _f.obenv->put_new_plain_payload<Rps_PayloadEnvironment>();
   RPS_ASSERT(paylenv);
+  paylenv->adopt_scope_layout(_f.obclass);
   paylenv->env_parent = parentob;
   return _f.obenv;
 } // end Rps_PayloadEnvironment::make_with_parent_environment
@@ -472,7 +868,7 @@ rps_environment_get_shallow_bound_value(Rps_ObjectRef envob, Rps_ObjectRef varob
         *pmissing = true;
       return nullptr;
     };
-  return paylenv->get_obmap(varob, nullptr, pmissing);
+  return paylenv->get_binding(varob, pmissing);
 } // end rps_environment_get_shallow_bound_value
 
 constexpr int rps_environment_maxloop = 4096;
@@ -508,7 +904,7 @@ rps_environment_find_binding_depth(Rps_ObjectRef envob, Rps_ObjectRef varob)
       auto paylenv = envob->get_dynamic_payload<Rps_PayloadEnvironment>();
       if (!paylenv)
         return -1;
-      if (paylenv->has_key_obmap(varob))
+      if (paylenv->has_binding(varob))
         return depth;
       depth++;
       envob = paylenv->get_parent_environment();
@@ -571,7 +967,7 @@ rps_environment_find_bound_value(Rps_ObjectRef envob, Rps_ObjectRef varob,
             *penvob = nullptr;
           return nullptr;
         }
-      if (Rps_Value v = paylenv->get_obmap(varob))
+      if (Rps_Value v = paylenv->get_binding(varob))
         {
           if (pdepth)
             *pdepth = depth;
@@ -622,7 +1018,7 @@ rps_environment_add_shallow_binding(Rps_CallFrame*callframe,
   auto paylenv = envob->get_dynamic_payload<Rps_PayloadEnvironment>();
   if (!paylenv)
     return;
-  paylenv->put_obmap(_f.varob, _f.valv);
+  paylenv->put_binding(_f.varob, _f.valv);
 } // end rps_environment_add_shallow_binding
 
 /// overwrite a binding in the deep environment containing it, or when
@@ -683,11 +1079,11 @@ rps_environment_overwrite_binding(Rps_CallFrame*callframe,
             *penvob = nullptr;
           return -1;
         }
-      if (Rps_Value v = paylenv->get_obmap(_f.varob))
+      if (Rps_Value v = paylenv->get_binding(_f.varob))
         {
           if (penvob)
             *penvob = _f.envob;
-          paylenv->put_obmap(_f.varob, _f.valv);
+          paylenv->put_binding(_f.varob, _f.valv);
           return depth;
         }
       depth++;
@@ -714,7 +1110,7 @@ rps_environment_overwrite_binding(Rps_CallFrame*callframe,
         *penvob = nullptr;
       return -1;
     }
-  paylenv->put_obmap(_f.varob, _f.valv);
+  paylenv->put_binding(_f.varob, _f.valv);
   return 0;
 } // end rps_environment_overwrite_binding
 
@@ -725,6 +1121,10 @@ Rps_PayloadEnvironment::gc_mark(Rps_GarbageCollector&gc) const
   gc_mark_objmap(gc);
   if (env_parent)
     gc.mark_obj(env_parent);
+  if (env_layout)
+    env_layout->gc_mark(gc);
+  for (Rps_Value slotv: env_slots)
+    gc.mark_value(slotv);
 } // end Rps_PayloadEnvironment::gc_mark
 
 void
@@ -734,6 +1134,14 @@ Rps_PayloadEnvironment::dump_scan(Rps_Dumper*du) const
   dump_scan_objmap_internal(du);
   if (rps_is_dumpable_objref(du, env_parent))
     rps_dump_scan_object(du, env_parent);
+  for (unsigned ix=0; ix<env_slots.size(); ix++)
+    {
+      Rps_ObjectRef varob = env_layout->slot_variable(ix);
+      if (!env_slots[ix] || !rps_is_dumpable_objref(du, varob))
+        continue;
+      rps_dump_scan_object(du, varob);
+      rps_dump_scan_value(du, env_slots[ix], 0);
+    };
 } // end Rps_PayloadEnvironment::dump_scan
 
 void
@@ -742,6 +1150,15 @@ Rps_PayloadEnvironment::dump_json_content(Rps_Dumper*du, Json::Value&jv) const
   RPS_ASSERT(du);
   jv["payload"] = "environment";
   dump_json_objmap_internal_content(du, jv);
+  /// bound slots are dumped as ordinary bindings; the loader makes
+  /// them slots again
+  for (unsigned ix=0; ix<env_slots.size(); ix++)
+    {
+      Rps_ObjectRef varob = env_layout->slot_variable(ix);
+      if (!env_slots[ix] || !rps_is_dumpable_objref(du, varob))
+        continue;
+      jv["objmap"][varob.as_string()] = rps_dump_json_value(du, env_slots[ix]);
+    };
   if (rps_is_dumpable_objref(du, env_parent))
     jv["parent_env"] = rps_dump_json_objectref(du, env_parent);
   else
@@ -765,21 +1182,30 @@ Rps_PayloadEnvironment::output_payload(std::ostream&out, unsigned depth, unsigne
   const char* NORM_esc = (ontty?RPS_TERMINAL_NORMAL_ESCAPE:"");
   std::lock_guard<std::recursive_mutex> gudispob(*owner()->objmtxptr());
   int nbobjmap = (int) get_obmap_size();
-  if (nbobjmap==0)
+  int nbslots = (int) env_slots.size();
+  if (nbobjmap+nbslots==0)
     out << BOLD_esc << "-empty environment-" << NORM_esc;
   else
-    out << BOLD_esc << "-environment of " << nbobjmap
-        << ((nbobjmap>1)?" entries":" entry");
+    out << BOLD_esc << "-environment of " << (nbobjmap+nbslots)
+        << ((nbobjmap+nbslots>1)?" entries":" entry");
+  if (env_layout)
+    out << " flat with " << nbslots << " slots";
   Rps_Value dv = get_descr();
   if (dv)
     out << " described by " << NORM_esc << Rps_OutputValue(dv, depth, maxdepth) << std::endl;
   else
     out << " plain" << NORM_esc << std::endl;
-  std::vector<Rps_ObjectRef> attrvect(nbobjmap);
+  for (int ix=0; ix<nbslots; ix++)
+    out << BOLD_esc << "#" << ix
+        << NORM_esc << " " << env_layout->slot_variable(ix) << ": "
+        << Rps_OutputValue(env_slots[ix], depth, maxdepth)
+        << std::endl;
+  std::vector<Rps_ObjectRef> attrvect;
+  attrvect.reserve(nbobjmap);
   do_each_obmap_entry<std::vector<Rps_ObjectRef>&>(attrvect,
       [&](std::vector<Rps_ObjectRef>&atvec,
           Rps_ObjectRef atob,
-          [[unused]]Rps_Value, [[unused]]void*)
+          [[maybe_unused]] Rps_Value, [[maybe_unused]] void*)
   {
     atvec.push_back(atob);
     return false;
@@ -816,14 +1242,27 @@ rpsldpy_environment (Rps_ObjectZone*obz, Rps_Loader*ld, const Json::Value& jv, R
   const Json::Value& jobmap = jv["objmap"];
   const Json::Value&  jdescr = jv["descr"];
   const Json::Value& jparent = jv["parent_env"];
-  if (jobmap.type () == Json::objectValue)
+  /// a loaded environment is flat: its dumped variables get slots,
+  /// and variables bound later go to the object map
+  if (jobmap.type () == Json::objectValue && jobmap.size() > 0)
     {
       auto membvec = jobmap.getMemberNames(); // vector of strings
+      std::vector<Rps_ObjectRef> varvect;
+      std::vector<Rps_Value> valvect;
+      varvect.reserve(membvec.size());
+      valvect.reserve(membvec.size());
       for (const std::string& keystr : membvec)
         {
-          Rps_ObjectRef keyob(keystr, ld);
-          Rps_Value val = Rps_Value(jobmap[keystr], ld);
-          paylenv->put_obmap(keyob, val);
+          varvect.push_back(Rps_ObjectRef(keystr, ld));
+          valvect.push_back(Rps_Value(jobmap[keystr], ld));
+        }
+      paylenv->env_layout = std::make_shared<const Rps_EnvironmentLayout>(varvect);
+      paylenv->env_slots.resize(paylenv->env_layout->nb_slots());
+      for (unsigned ix=0; ix<varvect.size(); ix++)
+        {
+          int slotix = paylenv->env_layout->slot_index(varvect[ix]);
+          if (slotix >= 0)
+            paylenv->env_slots[slotix] = valvect[ix];
         }
     }
   paylenv->put_descr(Rps_Value(jdescr, ld));
@@ -1427,15 +1866,13 @@ void rps_show_instance_for_repl(Rps_CallFrame*callerframe,
                   << " µrk#" << metark << " µob:"
                   << _f.obmeta << std::endl;
         };
-      int rk=0;
       for (auto catob : * _f.attrset.as_set())
         {
           _f.curattrob = catob;
           (*pout) << "°" << _f.curattrob;
-          _f.curval = _f.inst->at(rk);
+          _f.curval = _f.inst.get_attr(&_, _f.curattrob);
           (*pout) << ":" << _f.curval;
           (*pout) << std::endl;
-          rk++;
         };
 
     }
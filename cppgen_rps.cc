@@ -173,7 +173,10 @@ public:
   void emit_initial_cplusplus_comment(Rps_CallFrame*callerframe, Rps_ObjectRef argmodule);
   void emit_cplusplus_includes(Rps_CallFrame*callerframe, Rps_ObjectRef argmodule);
   void emit_cplusplus_declarations(Rps_CallFrame*callerframe, Rps_ObjectRef argmodule);
-  void emit_cplusplus_definitions(Rps_CallFrame*callerframe, Rps_ObjectRef argmodule);
+  void emit_cplusplus_definitions(Rps_CallFrame*callerframe, Rps_ObjectRef argmodule,
+                                  Rps_Value arggenparam);
+  /// write the generated code, only if the file content changes
+  bool write_cplusplus_file(Rps_ObjectRef obmodule);
   virtual const std::string payload_type_name(void) const
   {
     return "cplusplusgen";
@@ -254,9 +257,9 @@ void
 Rps_PayloadCplusplusGen::output(std::function<void(std::ostringstream&out)> fun,
                                 bool raw)
 {
-  std::string buf;
-  std::ostringstream out(buf);
+  std::ostringstream out;
   fun(out);
+  std::string buf = out.str();
   if (raw)
     {
       cppgen_outcod << buf;
@@ -780,8 +783,80 @@ Rps_PayloadCplusplusGen::emit_cplusplus_declarations(Rps_CallFrame*callerframe,
 #warning incomplete PayloadCplusplusGen::emit_cplusplus_declarations
 } // end Rps_PayloadCplusplusGen::emit_cplusplus_declarations
 
+////////////////////////////////////////////////////////////////
+//// The C++ definition of a module component is the string given by
+//// sending generate_code to it, with the generator, the generation
+//// parameters, the module and the component index.  Components are
+//// independent, so they are emitted in parallel by up to rps_nbjobs
+//// threads, with the garbage collector forbidden; their emitting
+//// methods should give their code as result and not output into the
+//// generator.  The code of a component is cached, keyed by the
+//// module, the component and its index, and reused while the mtime
+//// of the component and the hash of the generation parameters are
+//// unchanged.  So the code emitted for a component should depend
+//// only on them: a component whose code uses other objects should
+//// be touched when they change.
+struct rps_cppgen_cached_st
+{
+  double cc_mtime;
+  Rps_HashInt cc_genparamhash;
+  std::string cc_code;
+};
+typedef std::tuple<Rps_Id,Rps_Id,int> rps_cppgen_cachekey_t;
+static std::mutex rps_cppgen_cache_mtx;
+static std::map<rps_cppgen_cachekey_t,rps_cppgen_cached_st> rps_cppgen_cache_map;
+
+struct rps_cppgen_component_st
+{
+  int cc_index;
+  Rps_ObjectRef cc_obcomp;
+  double cc_mtime;
+  bool cc_cached;
+  std::string cc_code;
+  std::string cc_error;
+};
+
+/// run in a worker thread, with the garbage collector forbidden
+static void
+rps_cppgen_emit_component(Rps_ObjectRef obgenerator, Rps_Value genparamv,
+                          Rps_ObjectRef obmodule, struct rps_cppgen_component_st&comp)
+{
+  RPS_LOCALFRAME(RPS_CALL_FRAME_UNDESCRIBED,
+                 RPS_NULL_CALL_FRAME,
+                 Rps_ObjectRef obgenerator;
+                 Rps_Value genparamv;
+                 Rps_ObjectRef obmodule;
+                 Rps_ObjectRef obcomp;
+                 Rps_Value mainv;
+                );
+  _f.obgenerator = obgenerator;
+  _f.genparamv = genparamv;
+  _f.obmodule = obmodule;
+  _f.obcomp = comp.cc_obcomp;
+  try
+    {
+      Rps_TwoValues two =
+        Rps_Value(_f.obcomp).send4(&_,
+                                   RPS_ROOT_OB(_5VC4IuJ0dyr01b8lA0), //generate_code∈named_selector
+                                   _f.obgenerator,
+                                   _f.genparamv,
+                                   _f.obmodule,
+                                   Rps_Value::make_tagged_int(comp.cc_index));
+      _f.mainv = two.main();
+      if (_f.mainv.is_string())
+        comp.cc_code = _f.mainv.as_cppstring();
+      else
+        comp.cc_error = "no C++ definition";
+    }
+  catch (std::exception&exc)
+    {
+      comp.cc_error = exc.what();
+    };
+} // end rps_cppgen_emit_component
+
 void
-Rps_PayloadCplusplusGen::emit_cplusplus_definitions(Rps_CallFrame*callerframe, Rps_ObjectRef argmodule)
+Rps_PayloadCplusplusGen::emit_cplusplus_definitions(Rps_CallFrame*callerframe, Rps_ObjectRef argmodule,
+    Rps_Value arggenparam)
 {
   RPS_LOCALFRAME(nullptr,
                  callerframe,
@@ -789,25 +864,26 @@ Rps_PayloadCplusplusGen::emit_cplusplus_definitions(Rps_CallFrame*callerframe, R
                  Rps_ObjectRef obmodule;
                  Rps_Value vcomp;
                  Rps_ObjectRef obcomp;
+                 Rps_Value genparamv;
                 );
   _f.obgenerator = owner();
   _f.obmodule = argmodule;
-  // TODO: we probably need a selector to send some message related to C++ definition emission
-  //
-  // It could happen that the number of components in the module is
-  // changing during the loop
+  _f.genparamv = arggenparam;
+  Rps_HashInt genparamhash = _f.genparamv?_f.genparamv.valhash():0;
+  std::vector<struct rps_cppgen_component_st> compvect;
+  _.set_additional_gc_marker([&](Rps_GarbageCollector*gc)
+  {
+    for (auto& comp: compvect)
+      gc->mark_obj(comp.cc_obcomp);
+  });
+  /// collect the components, and their cached code
   for (int cix=0; cix<(int)_f.obmodule->nb_components(&_); cix++)
     {
       _f.obcomp = nullptr;
       _f.vcomp = _f.obmodule->component_at(&_, cix, /*dontfail=*/true);
       if (!_f.vcomp)
         continue;
-      if (_f.vcomp.is_object())
-        {
-          _f.obcomp = _f.vcomp.as_object();
-          std::lock_guard<std::recursive_mutex> guobcomp(*_f.obcomp->objmtxptr());
-        }
-      else
+      if (!_f.vcomp.is_object())
         {
           RPS_WARNOUT("in module " << _f.obmodule
                       << " component#" << cix
@@ -818,11 +894,161 @@ Rps_PayloadCplusplusGen::emit_cplusplus_definitions(Rps_CallFrame*callerframe, R
                                       << " cannot be defined"
                                       << " in obmodule=" << _f.obmodule
                                       << " obgenerator=" << _f.obgenerator);
-        }
+        };
+      _f.obcomp = _f.vcomp.as_object();
+      struct rps_cppgen_component_st comp
+      {
+        .cc_index= cix,
+        .cc_obcomp= _f.obcomp,
+        .cc_mtime= _f.obcomp->get_mtime(),
+        .cc_cached= false,
+        .cc_code= "",
+        .cc_error= ""
+      };
+      {
+        std::lock_guard<std::mutex> gucache(rps_cppgen_cache_mtx);
+        auto it = rps_cppgen_cache_map.find({_f.obmodule->oid(), _f.obcomp->oid(), cix});
+        if (it != rps_cppgen_cache_map.end() && it->second.cc_mtime == comp.cc_mtime
+            && it->second.cc_genparamhash == genparamhash)
+          {
+            comp.cc_cached = true;
+            comp.cc_code = it->second.cc_code;
+          }
+      }
+      compvect.push_back(comp);
+    };
+  /// emit the uncached components in parallel; our caller does not
+  /// hold the locks of the module and the generator, which the
+  /// emitting methods may need
+  std::vector<int> todovect;
+  for (int ix=0; ix<(int)compvect.size(); ix++)
+    if (!compvect[ix].cc_cached)
+      todovect.push_back(ix);
+  if (!todovect.empty())
+    {
+      int nbthreads = std::min<int>(rps_nbjobs, (int)todovect.size());
+      std::atomic<int> nextodo(0);
+      auto worker = [&](void)
+      {
+        for (int tix = nextodo++; tix < (int)todovect.size(); tix = nextodo++)
+          rps_cppgen_emit_component(_f.obgenerator, _f.genparamv, _f.obmodule,
+                                    compvect[todovect[tix]]);
+      };
+      /// no garbage collection can start while the worker threads
+      /// exist, so their call frames need not be scanned
+      {
+        Rps_GarbageCollectionForbidder nogc;
+        std::vector<std::thread> threadvect;
+        try
+          {
+            for (int thix=1; thix<nbthreads; thix++)
+              threadvect.emplace_back([&,thix](void)
+              {
+                char thname[24];
+                memset (thname, 0, sizeof(thname));
+                snprintf(thname, sizeof(thname), "rps-cppgen%d", thix);
+                pthread_setname_np(pthread_self(), thname);
+                worker();
+              });
+          }
+        catch (...)
+          {
+            /// the already started threads still emit every component
+            for (std::thread& th: threadvect)
+              th.join();
+            throw;
+          };
+        worker();
+        for (std::thread& th: threadvect)
+          th.join();
+      }
+      RPS_DEBUG_LOG(CODEGEN, "emit_cplusplus_definitions emitted "
+                    << todovect.size() << " of " << compvect.size()
+                    << " components of module " << _f.obmodule
+                    << " in " << nbthreads << " threads");
+    };
+  /// output the definitions in the order of the components
+  for (auto& comp: compvect)
+    {
+      if (!comp.cc_error.empty())
+        throw RPS_RUNTIME_ERROR_OUT("rps_generate_cplusplus_code failed for component#"
+                                    << comp.cc_index << " = " << comp.cc_obcomp
+                                    << " in obmodule=" << _f.obmodule
+                                    << " obgenerator=" << _f.obgenerator
+                                    << " : " << comp.cc_error);
+      if (!comp.cc_cached)
+        {
+          std::lock_guard<std::mutex> gucache(rps_cppgen_cache_mtx);
+          rps_cppgen_cache_map[ {_f.obmodule->oid(), comp.cc_obcomp->oid(), comp.cc_index}]
+            = rps_cppgen_cached_st{comp.cc_mtime, genparamhash, comp.cc_code};
+        };
+      output([&](std::ostringstream&out)
+      {
+        out << std::endl << "//// component#" << comp.cc_index
+            << " " << comp.cc_obcomp << std::endl;
+      });
+      raw_output([&](std::ostringstream&out)
+      {
+        out << comp.cc_code << std::endl;
+      });
+      check_size(__LINE__);
     };
 #warning incomplete PayloadCplusplusGen::emit_cplusplus_definitions
 } // end Rps_PayloadCplusplusGen::emit_cplusplus_definitions
 
+/// write the generated C++ code, by default into the plugins_dir/
+/// directory, only if its content has changed, so that the plugin is
+/// not rebuilt needlessly; return true on success
+bool
+Rps_PayloadCplusplusGen::write_cplusplus_file(Rps_ObjectRef obmodule)
+{
+  RPS_ASSERT(obmodule);
+  std::lock_guard<std::recursive_mutex> guown(*(owner()->objmtxptr()));
+  if (cppgen_path.empty())
+    cppgen_path = std::string(rps_topdirectory) + "/plugins_dir/rpsgen"
+                  + obmodule->oid().to_string() + ".cc";
+  std::string newcode = cppgen_outcod.str();
+  size_t newhash = std::hash<std::string>()(newcode);
+  {
+    std::ifstream oldinp(cppgen_path);
+    if (oldinp)
+      {
+        std::ostringstream oldout;
+        oldout << oldinp.rdbuf();
+        std::string oldcode = oldout.str();
+        if (oldcode.size() == newcode.size()
+            && std::hash<std::string>()(oldcode) == newhash
+            && oldcode == newcode)
+          {
+            RPS_DEBUG_LOG(CODEGEN, "write_cplusplus_file unchanged " << cppgen_path
+                          << " for module " << obmodule);
+            return true;
+          }
+      }
+  }
+  std::string tmpath = cppgen_path + ".tmp~";
+  {
+    std::ofstream out(tmpath);
+    out << newcode;
+    out.close();
+    if (out.fail())
+      {
+        RPS_WARNOUT("write_cplusplus_file failed to write " << tmpath
+                    << " for module " << obmodule);
+        return false;
+      }
+  }
+  if (rename(tmpath.c_str(), cppgen_path.c_str()))
+    {
+      RPS_WARNOUT("write_cplusplus_file failed to rename " << tmpath
+                  << " to " << cppgen_path << " : " << strerror(errno));
+      return false;
+    };
+  RPS_INFORMOUT("generated C++ file " << cppgen_path << " for module " << obmodule
+                << " of " << newcode.size() << " bytes");
+  return true;
+} // end Rps_PayloadCplusplusGen::write_cplusplus_file
+
 //// return true on successful C++ code generation
 bool
 rps_generate_cplusplus_code(Rps_CallFrame*callerframe,
@@ -859,12 +1085,12 @@ rps_generate_cplusplus_code(Rps_CallFrame*callerframe,
   RPS_ASSERT(argobmodule);
   _f.obmodule = argobmodule;
   _f.vgenparam = arggenparam;
-  std::lock_guard<std::recursive_mutex> gumodule(*_f.obmodule->objmtxptr());
+  std::unique_lock<std::recursive_mutex> gumodule(*_f.obmodule->objmtxptr());
   _f.obgenerator =
     Rps_ObjectRef::make_object(&_,
                                RPS_ROOT_OB(_2yzD3HZ6VQc038ekBU)//midend_cplusplus_code_generator∈class
                               );
-  std::lock_guard<std::recursive_mutex> gugenerator(*_f.obgenerator->objmtxptr());
+  std::unique_lock<std::recursive_mutex> gugenerator(*_f.obgenerator->objmtxptr());
   _f.obgenerator->put_attr(RPS_ROOT_OB(_2Xfl3YNgZg900K6zdC), //"code_module"∈named_attribute
                            _f.obmodule);
   auto cppgenpayl = _f.obgenerator->put_new_plain_payload<Rps_PayloadCplusplusGen>();
@@ -934,7 +1160,23 @@ rps_generate_cplusplus_code(Rps_CallFrame*callerframe,
     out << std::endl << std::endl;
     out << "//// C++ definitions from " << _f.obmodule << std::endl;
   });
-  cppgenpayl->emit_cplusplus_definitions(&_,  _f.obmodule);
+  /// the definitions of components are emitted in parallel, by
+  /// methods which may lock the module or the generator
+  gugenerator.unlock();
+  gumodule.unlock();
+  try
+    {
+      cppgenpayl->emit_cplusplus_definitions(&_,  _f.obmodule, _f.vgenparam);
+      gumodule.lock();
+      gugenerator.lock();
+    }
+  catch  (std::exception&exc)
+    {
+      RPS_WARNOUT("rps_generate_cplusplus_code failed to emit definitions of "
+                  << _f.obmodule << " with " << _f.obgenerator
+                  << " : " << exc.what());
+      return false;
+    };
   cppgenpayl->clear_indentation();
   cppgenpayl->output([&](std::ostringstream&out)
   {
@@ -944,12 +1186,12 @@ rps_generate_cplusplus_code(Rps_CallFrame*callerframe,
         << " {<" __FILE__ ":" << __LINE__ << ">}" << std::endl;
     out << std::flush;
   });
-  sync();
-  RPS_WARNOUT("incomplete rps_generate_cplusplus_code obmodule="
-              << _f.obmodule << " generator=" << _f.obgenerator
-              << std::endl
-              << RPS_FULL_BACKTRACE_HERE(1, "rps_generate_cplusplus_code"));
-  return false;
+  bool written = cppgenpayl->write_cplusplus_file(_f.obmodule);
+  RPS_DEBUG_LOG(CODEGEN, "rps_generate_cplusplus_code obmodule="
+                << _f.obmodule << " generator=" << _f.obgenerator
+                << (written?" wrote ":" failed to write ")
+                << cppgenpayl->cplusplus_file_path());
+  return written;
 } // end rps_generate_cplusplus_code
 
 
@@ -24,7 +24,12 @@
 ///     ./do-build-refpersys-plugin --plugin-src=DIRNAME | -s DIRNAME #plugin source directory
 ///     ./do-build-refpersys-plugin --help | -h #this help
 ///     ./do-build-refpersys-plugin --ninja=NINJAFILE | -N NINJAFILE #add to generated ninja-build script
+///     ./do-build-refpersys-plugin --no-cache | -n #dont use the plugin cache
 ///
+///// Built plugins are cached in $RPSPLUGIN_CACHEDIR (by default the
+///// _plugin-cache/ subdirectory of the top directory), keyed by a hash
+///// of the git id, of the plugin build settings and of the contents of
+///// the plugin sources with the headers they include with quotes.
 ///// The C++ plugin sources may contain comments driving the compilation
 
 ///
@@ -57,6 +62,7 @@
 #include <getopt.h>
 #include <string.h>
 #include <libgen.h>
+#include <filesystem>
 
 
 //// www.gnu.org/software/guile/ version 3
@@ -95,6 +101,9 @@ extern "C" {
   // indexes in
   // bp_vect_cpp_sources
   bool bp_verbose;
+  bool bp_no_cache; // dont use the cache of built plugins
+  std::string bp_cache_key; // hash of everything the plugin depends upon
+  std::string bp_cached_plugin; // path of the cached plugin
   struct option* bp_options_ptr;
 };        // end extern "C"
 
@@ -142,6 +151,12 @@ struct option bp_options_arr[BP_MAX_OPTIONS] =
     .flag= nullptr,
     .val= 's',
   },
+  {
+    .name= "no-cache", // --no-cache | -n
+    .has_arg= no_argument,
+    .flag= nullptr,
+    .val= 'n',
+  },
   {
     .name= nullptr,
     .has_arg= no_argument,
@@ -191,11 +206,14 @@ bp_usage(void)
   std::cout << '\t' << bp_spaces << "otherwise GUILE_CODE is a file with GNU Guile Scheme code"
             << std::endl;
 
+  std::cout << '\t' << bp_progname << " --no-cache | -n #dont use the cache of built plugins" << std::endl;
   std::cout << '\t' << bp_progname << " --help | -h #this help" << std::endl;
   std::cout << "\t #from " << __FILE__ << ':' << __LINE__ << " git " << bp_git_id << std::endl;
   std::cout << "\t #see refpersys.org and github.com/RefPerSys/RefPerSys" << std::endl;
   std::cout << "\t #uses $RPSPLUGIN_CXXFLAGS and $RPSPLUGIN_LDFLAGS if provided"
             << std::endl;
+  std::cout << "\t #caches built plugins in $RPSPLUGIN_CACHEDIR, by default "
+            << rps_topdirectory << "/_plugin-cache" << std::endl;
   std::cout << "\t #the C++ plugin sources may contain comments to drive the compilation" << std::endl;
   std::cout << "\t\t\t //@PKGCONFIG <package-name>   #e.g.  ////@PKGCONFIG sfml-graphics" <<std::endl;
   std::cout << "\t\t\t //@NINJA.<tag> up to //@ENDNINJA.<tag> #e.g. //@NINJA.foo ... //@ENDNINJA.foo copy lines to ninja file" <<std::endl;
@@ -211,7 +229,7 @@ bp_prog_options(int argc, char**argv)
   int ix= 0;
   do
     {
-      opt = getopt_long(argc, argv, "Vhvs:o:N:S:d:G:", bp_options_ptr, &ix);
+      opt = getopt_long(argc, argv, "Vhvns:o:N:S:d:G:", bp_options_ptr, &ix);
       if (ix >= argc)
         break;
       switch (opt)
@@ -227,6 +245,9 @@ bp_prog_options(int argc, char**argv)
         case 'v':     // --verbose
           bp_verbose= true;
           break;
+        case 'n':     // --no-cache
+          bp_no_cache= true;
+          break;
         case 'd':
         {
           static char dirbuf[1024];
@@ -441,6 +462,168 @@ bp_prog_options(int argc, char**argv)
 } // end bp_prog_options
 
 
+
+////////////////////////////////////////////////////////////////
+//// The cache of built plugins.  A plugin depends upon its C++
+//// sources, the headers they include with double quotes, the
+//// RefPerSys build (its git id) and the compilation settings given
+//// by GNU make.  All of these are hashed (with two FNV-1a hashes
+//// of different seeds) into a key naming the cached shared object.
+
+struct bp_hash_st
+{
+  uint64_t h1= 0xcbf29ce484222325ULL; // FNV-1a offset basis
+  uint64_t h2= 0x84222325cbf29ce4ULL;
+  void add(const char*buf, size_t len)
+  {
+    for (size_t i=0; i<len; i++)
+      {
+        h1 = (h1 ^ (unsigned char)buf[i]) * 0x100000001b3ULL;
+        h2 = (h2 ^ (unsigned char)buf[i]) * 0x100000001b3ULL;
+        h2 ^= h2 >> 29;
+      };
+  };
+  void add(const std::string&str)
+  {
+    add(str.c_str(), str.size()+1);
+  };
+};        // end bp_hash_st
+
+/// hash a source file and, recursively, its quoted included files
+/// searched in its directory then in generated/ then in the top
+/// directory
+static void
+bp_hash_source_file(bp_hash_st&hash, const std::string&path,
+                    std::set<std::string>&visited)
+{
+  if (visited.find(path) != visited.end())
+    return;
+  visited.insert(path);
+  std::ifstream inp(path);
+  if (!inp)
+    {
+      hash.add("?"+path);
+      return;
+    };
+  hash.add(path);
+  std::string dir;
+  {
+    size_t lastslash = path.rfind('/');
+    if (lastslash != std::string::npos)
+      dir = path.substr(0, lastslash+1);
+  }
+  std::string line;
+  std::vector<std::string> included;
+  while (std::getline(inp, line))
+    {
+      hash.add(line);
+      char incbuf[256];
+      memset(incbuf, 0, sizeof(incbuf));
+      if (sscanf(line.c_str(), " # include \"%250[^\"]\"", incbuf) == 1)
+        included.push_back(incbuf);
+    };
+  inp.close();
+  for (const std::string& inc: included)
+    {
+      for (std::string incpath: {dir+inc,
+                                   std::string(rps_topdirectory)+"/generated/"+inc,
+                                   std::string(rps_topdirectory)+"/"+inc
+                                  })
+        {
+          if (!access(incpath.c_str(), R_OK))
+            {
+              bp_hash_source_file(hash, incpath, visited);
+              break;
+            };
+        };
+    };
+} // end bp_hash_source_file
+
+
+/// compute the cache key and the cached plugin path, or leave them
+/// empty when the cache is not used
+void
+bp_compute_cache_key(void)
+{
+  if (bp_no_cache || !bp_plugin_binary)
+    return;
+  bp_hash_st hash;
+  hash.add(bp_git_id);
+  {
+    char settingcmd[384];
+    memset (settingcmd, 0, sizeof(settingcmd));
+    snprintf (settingcmd, sizeof(settingcmd),
+              "%s -s -C %s print-plugin-settings",
+              rps_gnu_make, rps_topdirectory);
+    FILE*pset = popen(settingcmd, "r");
+    if (!pset)
+      {
+        fprintf(stderr, "%s failed to popen %s (%s) [%s:%d]\n",
+                bp_progname, settingcmd, strerror(errno),
+                __FILE__, __LINE__-2);
+        return;
+      };
+    char linbuf[512];
+    memset (linbuf, 0, sizeof(linbuf));
+    while (fgets(linbuf, sizeof(linbuf), pset))
+      hash.add(linbuf, strlen(linbuf));
+    if (pclose(pset))
+      return;
+  }
+  std::set<std::string> visited;
+  for (const std::string& cursrc: bp_vect_cpp_sources)
+    bp_hash_source_file(hash, cursrc, visited);
+  char keybuf[40];
+  memset (keybuf, 0, sizeof(keybuf));
+  snprintf(keybuf, sizeof(keybuf), "%016llx%016llx",
+           (unsigned long long)hash.h1, (unsigned long long)hash.h2);
+  bp_cache_key = keybuf;
+  const char*cachedir = getenv("RPSPLUGIN_CACHEDIR");
+  std::string cachedirstr = cachedir?std::string(cachedir)
+                            :(std::string(rps_topdirectory)+"/_plugin-cache");
+  std::error_code ec;
+  std::filesystem::create_directories(cachedirstr, ec);
+  if (ec)
+    {
+      fprintf(stderr, "%s cannot use plugin cache %s (%s) [%s:%d]\n",
+              bp_progname, cachedirstr.c_str(), ec.message().c_str(),
+              __FILE__, __LINE__-2);
+      bp_cache_key.clear();
+      return;
+    };
+  bp_cached_plugin = cachedirstr + "/" + bp_cache_key + ".so";
+  if (bp_verbose)
+    printf("%s plugin cache key %s for %d sources [%s:%d]\n",
+           bp_progname, keybuf, (int)bp_vect_cpp_sources.size(),
+           __FILE__, __LINE__-1);
+} // end bp_compute_cache_key
+
+
+/// copy a file, thru a temporary file renamed at end
+static bool
+bp_copy_file(const std::string&src, const std::string&dst)
+{
+  std::error_code ec;
+  char tmpsuffix[48];
+  memset (tmpsuffix, 0, sizeof(tmpsuffix));
+  snprintf(tmpsuffix, sizeof(tmpsuffix), ".%d-tmp~", (int)getpid());
+  std::string tmpdst = dst + tmpsuffix;
+  std::filesystem::copy_file(src, tmpdst,
+                             std::filesystem::copy_options::overwrite_existing, ec);
+  if (!ec)
+    std::filesystem::rename(tmpdst, dst, ec);
+  if (ec)
+    {
+      fprintf(stderr, "%s failed to copy %s to %s (%s) [%s:%d]\n",
+              bp_progname, src.c_str(), dst.c_str(), ec.message().c_str(),
+              __FILE__, __LINE__-2);
+      std::filesystem::remove(tmpdst, ec);
+      return false;
+    };
+  return true;
+} // end bp_copy_file
+
+
 /// by convention Scheme primitives for GNU guile are prefixed by bpscm
 static SCM
 bpscm_false0(void)
@@ -568,6 +751,19 @@ main(int argc, char**argv, const char**env)
         bp_first_base = bufstr;
       bp_base_src_set.insert({bufstr,cursrc});
     };
+  /// reuse a cached plugin if possible
+  bp_compute_cache_key();
+  if (!bp_cached_plugin.empty() && !access(bp_cached_plugin.c_str(), R_OK))
+    {
+      if (bp_copy_file(bp_cached_plugin, bp_plugin_binary))
+        {
+          printf("%s reused cached plugin %s for %s [%s:%d]\n",
+                 bp_progname, bp_cached_plugin.c_str(), bp_plugin_binary,
+                 __FILE__, __LINE__-2);
+          fflush(nullptr);
+          return 0;
+        };
+    };
   /// run the script to build the plugin
   {
     char buildcmd[384];
@@ -598,6 +794,12 @@ main(int argc, char**argv, const char**env)
     if (ex)
       return ex;
   }
+  /// remember the built plugin in the cache
+  if (!bp_cached_plugin.empty() && !access(bp_plugin_binary, R_OK)
+      && bp_copy_file(bp_plugin_binary, bp_cached_plugin) && bp_verbose)
+    printf("%s cached plugin %s as %s [%s:%d]\n",
+           bp_progname, bp_plugin_binary, bp_cached_plugin.c_str(),
+           __FILE__, __LINE__-2);
   /// temporary files should be removed using at(1) utility in ten minutes
   /// see https://linuxize.com/post/at-command-in-linux/
   if (!bp_temp_ninja.empty() || symlkbuf[0])
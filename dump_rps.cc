@@ -118,6 +118,9 @@ class Rps_Dumper
   // with the temporary suffix above, and renamed by
   // rename_opened_files below.
   std::set<std::string> du_openedpathset;
+  // tickets of asynchronous writes of space files, waited for by
+  // rename_opened_files
+  std::vector<Rps_AsyncFileIo::ticket_t> du_asyncwritevec;
   // a random temporary suffix for written files
   static std::string make_temporary_suffix(void)
   {
@@ -155,6 +158,7 @@ private:
   void write_space_file(Rps_ObjectRef spacobr);
   void scan_object_contents(Rps_ObjectRef obr);
   std::unique_ptr<std::ofstream> open_output_file(const std::string& relpath);
+  std::unique_ptr<std::ostringstream> open_output_buffer(const std::string& relpath);
   void rename_opened_files(void);
   void scan_code_addr(const void*);
 public:
@@ -208,7 +212,7 @@ Rps_Dumper::Rps_Dumper(const std::string&topdir, Rps_CallFrame*callframe) :
   du_startprocesstime(rps_process_cpu_time()),
   du_startwallclockrealtime(rps_wallclock_real_time()),
   du_startmonotonictime(rps_monotonic_real_time()),
-  du_callframe(callframe), du_openedpathset()
+  du_callframe(callframe), du_openedpathset(), du_asyncwritevec()
 {
   {
     char topdirpath[PATH_MAX];
@@ -444,6 +448,22 @@ Rps_Dumper::open_output_file(const std::string& relpath)
   return poutf;
 } // end Rps_Dumper::open_output_file
 
+/// the content of the returned buffer should be written
+/// asynchronously into the temporary_opened_path
+std::unique_ptr<std::ostringstream>
+Rps_Dumper::open_output_buffer(const std::string& relpath)
+{
+  RPS_ASSERT(relpath.size()>1 && relpath[0] != '/');
+  std::lock_guard<std::recursive_mutex> gu(du_mtx);
+  if (RPS_UNLIKELY(du_openedpathset.find(relpath) != du_openedpathset.end()))
+    {
+      RPS_WARNOUT("duplicate opened dump buffer " << relpath);
+      throw std::runtime_error(std::string{"duplicate opened dump buffer "} + relpath);
+    }
+  du_openedpathset.insert(relpath);
+  return std::make_unique<std::ostringstream>();
+} // end Rps_Dumper::open_output_buffer
+
 
 int
 Rps_Dumper::scan_source_file_for_constants(const std::string&relfilename)
@@ -459,8 +479,7 @@ Rps_Dumper::scan_source_file_for_constants(const std::string&relfilename)
   for (std::string linbuf; std::getline(ins, linbuf); )
     {
       lincnt++;
-      if (u8_check(reinterpret_cast<const uint8_t*> (linbuf.c_str()),
-                   linbuf.size()))
+      if (rps_utf8_check(linbuf.c_str(), linbuf.size()))
         {
           RPS_WARNOUT("file " << fullpath << ", line " << lincnt
                       << " non UTF8:" << linbuf);
@@ -594,6 +613,18 @@ void
 Rps_Dumper::rename_opened_files(void)
 {
   std::lock_guard<std::recursive_mutex> gu(du_mtx);
+  for (Rps_AsyncFileIo::ticket_t tick: du_asyncwritevec)
+    {
+      try
+        {
+          Rps_AsyncFileIo::wait_write(tick);
+        }
+      catch (std::exception& exc)
+        {
+          RPS_FATALOUT("dump failed to write space file:" << exc.what());
+        }
+    };
+  du_asyncwritevec.clear();
   for (std::string curelpath: du_openedpathset)
     {
       std::string curpath = du_topdir + "/" + curelpath;
@@ -1738,14 +1769,14 @@ Rps_Dumper::write_space_file(Rps_ObjectRef spacobr)
   std::string curelpath;
   std::set<Rps_ObjectRef> curspaset;
   Rps_Id spacid;
-  std::unique_ptr<std::ofstream> pouts;
+  std::unique_ptr<std::ostringstream> pouts;
   RPS_ASSERT(du_jsonwriterbuilder["indentation"] == std::string{" "});
   std::unique_ptr<Json::StreamWriter> jsonwriter(du_jsonwriterbuilder.newStreamWriter());
   {
     std::lock_guard<std::recursive_mutex> gu(du_mtx);
     spacid = curspa->sp_id;
     curelpath = std::string{"persistore/sp"} + spacid.to_string() + "-rps.json";
-    pouts = open_output_file(curelpath);
+    pouts = open_output_buffer(curelpath);
     curspaset = curspa->sp_setob;
   }
   RPS_ASSERT(pouts);
@@ -1884,6 +1915,12 @@ Rps_Dumper::write_space_file(Rps_ObjectRef spacobr)
   ////
   *pouts << std::endl << std::endl;
   *pouts << "//// end of RefPerSys generated space file " << curelpath << std::endl;
+  {
+    std::lock_guard<std::recursive_mutex> gu(du_mtx);
+    du_asyncwritevec.push_back
+    (Rps_AsyncFileIo::submit_write_file(temporary_opened_path(curelpath),
+                                        pouts->str()));
+  }
   RPS_DEBUG_LOG(DUMP, "dumper write_space_file end " << curelpath << " with " << count << " objects." << std::endl);
 } // end Rps_Dumper::write_space_file
 
@@ -34,6 +34,8 @@
 
 #include "refpersys.hh"
 
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 
 extern "C" const char rps_eventloop_gitid[];
 const char rps_eventloop_gitid[]= RPS_GITID;
@@ -47,20 +49,69 @@ const char rps_eventloop_shortgitid[]= RPS_SHORTGITID;
 // default or initial delay to poll(2) in milliseconds.
 #define RPS_EVENT_DEFAULT_POLL_DELAY_MILLISEC 1600
 
-enum self_pipe_code_en
+/// the kinds of messages sent to the main thread thru the main channel
+enum main_message_code_en
 {
-  SelfPipe__NONE=0,
-  SelfPipe_Dump = 'D',
-  SelfPipe_GarbColl = 'G',
-  SelfPipe_Process = 'P',
-  SelfPipe_Quit = 'Q',
-  SelfPipe_Exit = 'X',
+  MainMsg__NONE=0,
+  MainMsg_Closure = 'C',
+  MainMsg_Dump = 'D',
+  MainMsg_Function = 'F',
+  MainMsg_GarbColl = 'G',
+  MainMsg_Process = 'P',
+  MainMsg_Quit = 'Q',
+  MainMsg_Exit = 'X',
 };
 
+/// A message for the main thread, with its optional payload.
+struct rps_main_message_st
+{
+  enum main_message_code_en mm_code;
+  Rps_ClosureValue mm_clos;
+  Rps_Value mm_arg0;
+  Rps_Value mm_arg1;
+  std::function<void(Rps_CallFrame*)> mm_fun;
+};
+
+/// The main channel is a bounded lock-free multi-producer
+/// single-consumer ring of messages (each cell has a sequence
+/// number, as in Dmitry Vyukov's bounded queue), consumed by the
+/// main thread. Producers wake it up thru an eventfd(2), but only
+/// once for a batch of messages.
+#define RPS_MAINCHAN_RING_SIZE 1024
+struct rps_main_channel_cell_st
+{
+  std::atomic<uint64_t> mc_seq;
+  struct rps_main_message_st mc_msg;
+};
+struct rps_main_channel_st
+{
+  struct rps_main_channel_cell_st mch_ring[RPS_MAINCHAN_RING_SIZE];
+  std::atomic<uint64_t> mch_enqpos;
+  std::atomic<uint64_t> mch_deqpos;
+  /// true once the eventfd has been written and not yet read
+  std::atomic<bool> mch_wakeuppending;
+  /// messages posted by the main thread itself into a full ring
+  std::deque<struct rps_main_message_st> mch_mainoverflow;
+  /// serializes the garbage collector marking pending messages with
+  /// the main thread dequeuing them and using the overflow queue
+  std::mutex mch_gcmtx;
+  rps_main_channel_st() : mch_enqpos(0), mch_deqpos(0),
+    mch_wakeuppending(false), mch_mainoverflow(), mch_gcmtx()
+  {
+    for (uint64_t ix=0; ix<RPS_MAINCHAN_RING_SIZE; ix++)
+      mch_ring[ix].mc_seq.store(ix, std::memory_order_relaxed);
+  };
+};
+static struct rps_main_channel_st rps_main_channel;
+
 
 
+/// maximal number of file descriptors added by prepollers
 #define RPS_MAXPOLL_FD 128
 
+/// maximal number of ready events handled by one epoll_wait(2)
+#define RPS_EPOLL_MAX_EVENTS 64
+
 //extern "C" std::atomic<bool> rps_stop_event_loop_flag;
 
 std::atomic<bool> rps_stop_event_loop_flag;
@@ -68,24 +119,35 @@ std::atomic<bool> rps_stop_event_loop_flag;
 int rps_poll_delay_millisec;
 
 
+/// The handlers registered for a given file descriptor. They stay
+/// registered in the epoll(7) set till removed, with edge-triggered
+/// readiness, so each handler should read or write till EAGAIN.
+struct event_loop_fdhandler_st
+{
+  Rps_EventHandler_sigt* elh_infun;
+  const char* elh_inexpl;
+  void* elh_indata;
+  Rps_EventHandler_sigt* elh_outfun;
+  const char* elh_outexpl;
+  void* elh_outdata;
+  uint32_t elh_events; // the registered epoll events, or 0
+};
+
 #define RPS_EVENTLOOPDATA_MAGIC 814538509 /*0x308cdf0d*/
 struct event_loop_data_st
 {
   unsigned eld_magic;   // should be RPS_EVENTLOOPDATA_MAGIC
   int eld_polldelaymillisec;
-  unsigned eld_lastix;
   std::recursive_mutex eld_mtx;
   double eld_startelapsedtime; // start real time of event loop
   double eld_startcputime; // start CPU time of event loop
-  Rps_EventHandler_sigt* eld_handlarr[RPS_MAXPOLL_FD+1];
-  const char*eld_explarr[RPS_MAXPOLL_FD+1];
-  struct pollfd eld_pollarr[RPS_MAXPOLL_FD+1];
-  void* eld_datarr[RPS_MAXPOLL_FD+1];
+  int eld_epollfd; // file descriptor from epoll_create1(2)
+  unsigned eld_nbfdhandlers; // number of file descriptors with handlers
+  /// the handlers, indexed by their file descriptor
+  std::vector<struct event_loop_fdhandler_st> eld_fdhandlvec;
   int eld_sigfd;  // file descriptor from signalfd(2)
   int eld_timfd;        // file descriptor from timerfd_create(2)
-  int eld_selfpipereadfd; // self pipe, reading end
-  int eld_selfpipewritefd; // self pipe, writing end
-  std::deque<unsigned char> eld_selfpipefifo;
+  int eld_mainchanfd; // eventfd(2) waking up the main channel
   std::atomic<bool> eld_eventloopisactive;
   std::atomic<long> eld_nbloops;
   std::vector<std::function<void(struct pollfd*, int& npoll, Rps_CallFrame*)>> eld_prepollvect;
@@ -99,7 +161,10 @@ extern "C" std::string rps_eventloop_explstring(void);
 
 static std::mutex rps_jsonrpc_mtx; /// common mutex for below buffers
 #warning TODO: maybe command and response should use std::stringstream?
-static std::stringbuf rps_jsonrpc_cmdbuf; /// buffer for commands written to JSONRPC GUI process
+/// commands written to JSONRPC GUI process; the bytes before
+/// rps_jsonrpc_cmdoff have already been written
+static std::string rps_jsonrpc_cmdpending;
+static size_t rps_jsonrpc_cmdoff;
 static std::stringbuf rps_jsonrpc_rspbuf; /// buffer for responses read from JSONRPC GUI process
 static std::stringstream rps_jsonrpc_rspstream; // should be used
 #warning use rps_jsonrpc_rspstream below
@@ -108,10 +173,9 @@ extern "C" void rps_sigfd_read_handler(Rps_CallFrame*cf, int fd, void* data);
 extern "C" void rps_timerfd_read_handler(Rps_CallFrame*cf, int fd, void* data);
 extern "C" void rps_fifo_read_handler(Rps_CallFrame*cf, int fd, void* data);
 extern "C" void rps_fifo_write_handler(Rps_CallFrame*cf, int fd, void* data);
-extern "C" void rps_self_pipe_read_handler(Rps_CallFrame*cf, int fd, void* data);
-extern "C" void rps_self_pipe_write_handler(Rps_CallFrame*cf, int fd, void* data);
+extern "C" void rps_main_channel_read_handler(Rps_CallFrame*cf, int fd, void* data);
 /**
- * We probably want to use the pipe to self trick.
+ * We use an eventfd(2) instead of the pipe to self trick.
  * https://www.sitepoint.com/the-self-pipe-trick-explained/
  *
  * in cooperation with Rps_PayloadUnixProcess::start_process
@@ -121,9 +185,16 @@ static std::atomic<bool> event_loop_is_active;
 static std::atomic<long> event_nbloops;
 
 
-extern "C" void rps_self_pipe_write_byte(unsigned char b);
+static void rps_main_channel_post(struct rps_main_message_st&& msg);
+
+static void handle_main_message_rps(Rps_CallFrame*cf, struct rps_main_message_st& msg,
+                                    Rps_ClosureValue clos, Rps_Value arg0, Rps_Value arg1);
 
-static void handle_self_pipe_byte_rps(unsigned char b);
+static void rps_event_loop_update_epoll(int fd);
+
+static void rps_event_loop_rearm_epoll(int fd);
+
+static void rps_timerwheel_rearm(void);
 
 
 
@@ -144,14 +215,171 @@ rps_do_stop_event_loop(void)
 extern "C" void rps_jsonrpc_initialize(void);
 
 
+/// wake up the main thread, unless already done for the current batch
+static void
+rps_main_channel_wakeup(void)
+{
+  if (rps_main_channel.mch_wakeuppending.exchange(true))
+    return;
+  int fd = rps_eventloopdata.eld_mainchanfd;
+  if (fd <= 0)
+    {
+      /// rps_initialize_main_channel_in_event_loop will wake up later
+      rps_main_channel.mch_wakeuppending.store(false);
+      return;
+    }
+  uint64_t one = 1;
+  errno = 0;
+  if (write(fd, &one, sizeof(one)) != sizeof(one))
+    RPS_DEBUG_LOG(EVENT_LOOP, "rps_main_channel_wakeup failed to write eventfd#"
+                  << fd << ":" << strerror(errno));
+} // end rps_main_channel_wakeup
+
+/// enqueue into the ring, return false when it is full
+static bool
+rps_main_channel_try_push(struct rps_main_message_st& msg)
+{
+  auto& mch = rps_main_channel;
+  uint64_t pos = mch.mch_enqpos.load(std::memory_order_relaxed);
+  struct rps_main_channel_cell_st* cell = nullptr;
+  for (;;)
+    {
+      cell = &mch.mch_ring[pos % RPS_MAINCHAN_RING_SIZE];
+      uint64_t seq = cell->mc_seq.load(std::memory_order_acquire);
+      int64_t dif = (int64_t)seq - (int64_t)pos;
+      if (dif == 0)
+        {
+          if (mch.mch_enqpos.compare_exchange_weak(pos, pos+1,
+              std::memory_order_relaxed))
+            break;
+        }
+      else if (dif < 0)
+        return false;
+      else
+        pos = mch.mch_enqpos.load(std::memory_order_relaxed);
+    };
+  cell->mc_msg = std::move(msg);
+  cell->mc_seq.store(pos+1, std::memory_order_release);
+  return true;
+} // end rps_main_channel_try_push
+
+/// dequeue from the ring, or else from the overflow queue, only in
+/// the main thread. The values of the message are moved into the
+/// given references, which should be fields of a local frame, under
+/// mch_gcmtx so they are always reachable by the garbage collector.
+static bool
+rps_main_channel_pop(struct rps_main_message_st& msg, Rps_ClosureValue& clos,
+                     Rps_Value& arg0, Rps_Value& arg1)
+{
+  RPS_ASSERT(rps_is_main_thread());
+  auto& mch = rps_main_channel;
+  std::lock_guard<std::mutex> gu(mch.mch_gcmtx);
+  uint64_t pos = mch.mch_deqpos.load(std::memory_order_relaxed);
+  struct rps_main_channel_cell_st* cell = &mch.mch_ring[pos % RPS_MAINCHAN_RING_SIZE];
+  uint64_t seq = cell->mc_seq.load(std::memory_order_acquire);
+  if (seq == pos+1)
+    {
+      msg = std::move(cell->mc_msg);
+      cell->mc_msg = rps_main_message_st{};
+      mch.mch_deqpos.store(pos+1, std::memory_order_relaxed);
+      cell->mc_seq.store(pos+RPS_MAINCHAN_RING_SIZE, std::memory_order_release);
+    }
+  else if (!mch.mch_mainoverflow.empty())
+    {
+      msg = std::move(mch.mch_mainoverflow.front());
+      mch.mch_mainoverflow.pop_front();
+    }
+  else
+    return false;
+  clos = msg.mm_clos;
+  arg0 = msg.mm_arg0;
+  arg1 = msg.mm_arg1;
+  msg.mm_clos = nullptr;
+  msg.mm_arg0 = nullptr;
+  msg.mm_arg1 = nullptr;
+  return true;
+} // end rps_main_channel_pop
+
 void
-rps_self_pipe_write_byte(unsigned char b)
+rps_main_channel_post(struct rps_main_message_st&& msg)
 {
-  RPS_ASSERT(b != (char)0);
-  std::lock_guard<std::recursive_mutex> gu(rps_eventloopdata.eld_mtx);
-  RPS_ASSERT(rps_eventloopdata.eld_magic == RPS_EVENTLOOPDATA_MAGIC);
-  rps_eventloopdata.eld_selfpipefifo.push_back(b);
-} // end rps_self_pipe_write_byte
+  RPS_ASSERT(msg.mm_code != MainMsg__NONE);
+  while (!rps_main_channel_try_push(msg))
+    {
+      /// the ring is full, so the main thread should consume it
+      if (rps_is_main_thread())
+        {
+          std::lock_guard<std::mutex> gu(rps_main_channel.mch_gcmtx);
+          rps_main_channel.mch_mainoverflow.push_back(std::move(msg));
+          break;
+        }
+      rps_main_channel_wakeup();
+      sched_yield();
+    };
+  rps_main_channel_wakeup();
+} // end rps_main_channel_post
+
+static void
+rps_main_channel_post_code(enum main_message_code_en code)
+{
+  struct rps_main_message_st msg;
+  msg.mm_code = code;
+  rps_main_channel_post(std::move(msg));
+} // end rps_main_channel_post_code
+
+void
+rps_event_loop_post_closure(Rps_ClosureValue clos, Rps_Value arg0, Rps_Value arg1)
+{
+  RPS_ASSERT(clos);
+  struct rps_main_message_st msg;
+  msg.mm_code = MainMsg_Closure;
+  msg.mm_clos = clos;
+  msg.mm_arg0 = arg0;
+  msg.mm_arg1 = arg1;
+  rps_main_channel_post(std::move(msg));
+} // end rps_event_loop_post_closure
+
+void
+rps_event_loop_post_function(const std::function<void(Rps_CallFrame*)>& fun)
+{
+  RPS_ASSERT(fun);
+  struct rps_main_message_st msg;
+  msg.mm_code = MainMsg_Function;
+  msg.mm_fun = fun;
+  rps_main_channel_post(std::move(msg));
+} // end rps_event_loop_post_function
+
+/// the values inside pending messages are roots; producers could
+/// still be filling some cell, which is then skipped. The main thread
+/// cannot dequeue while we hold mch_gcmtx.
+void
+rps_event_loop_gc_mark_main_channel(Rps_GarbageCollector&gc)
+{
+  auto& mch = rps_main_channel;
+  std::lock_guard<std::mutex> gu(mch.mch_gcmtx);
+  uint64_t endpos = mch.mch_enqpos.load(std::memory_order_acquire);
+  for (uint64_t pos = mch.mch_deqpos.load(std::memory_order_acquire); pos < endpos; pos++)
+    {
+      struct rps_main_channel_cell_st* cell = &mch.mch_ring[pos % RPS_MAINCHAN_RING_SIZE];
+      if (cell->mc_seq.load(std::memory_order_acquire) != pos+1)
+        continue;
+      if (cell->mc_msg.mm_clos)
+        gc.mark_value(cell->mc_msg.mm_clos);
+      if (cell->mc_msg.mm_arg0)
+        gc.mark_value(cell->mc_msg.mm_arg0);
+      if (cell->mc_msg.mm_arg1)
+        gc.mark_value(cell->mc_msg.mm_arg1);
+    };
+  for (auto& msg: mch.mch_mainoverflow)
+    {
+      if (msg.mm_clos)
+        gc.mark_value(msg.mm_clos);
+      if (msg.mm_arg0)
+        gc.mark_value(msg.mm_arg0);
+      if (msg.mm_arg1)
+        gc.mark_value(msg.mm_arg1);
+    };
+} // end rps_event_loop_gc_mark_main_channel
 
 
 int
@@ -188,6 +416,8 @@ rps_unregister_event_loop_prepoller(int rank)
   rps_eventloopdata.eld_prepollvect[rank] = nullptr;
 } // end rps_unregister_event_loop_prepoller
 
+/// the index of entries is twice the file descriptor, plus one for
+/// an output handler
 bool rps_event_loop_get_entry(int ix,
                               Rps_EventHandler_sigt**pfun,
                               struct pollfd*po, const char**pexpl, void**pdata)
@@ -204,19 +434,89 @@ bool rps_event_loop_get_entry(int ix,
     *pexpl = nullptr;
   if (pdata)
     *pdata = nullptr;
-  if (ix<0 || ix>(int) rps_eventloopdata.eld_lastix)
+  int fd = ix/2;
+  bool isout = (ix%2) != 0;
+  if (ix<0 || fd >= (int) rps_eventloopdata.eld_fdhandlvec.size())
+    return false;
+  const struct event_loop_fdhandler_st& elh
+    = rps_eventloopdata.eld_fdhandlvec[fd];
+  Rps_EventHandler_sigt*fun = isout?elh.elh_outfun:elh.elh_infun;
+  if (!fun)
     return false;
   if (pfun)
-    *pfun = rps_eventloopdata.eld_handlarr[ix];
+    *pfun = fun;
   if (po)
-    *po = rps_eventloopdata.eld_pollarr[ix];
+    {
+      po->fd = fd;
+      po->events = isout?POLLOUT:POLLIN;
+    }
   if (pexpl)
-    *pexpl = rps_eventloopdata.eld_explarr[ix];
+    *pexpl = isout?elh.elh_outexpl:elh.elh_inexpl;
   if (pdata)
-    *pdata = rps_eventloopdata.eld_datarr[ix];
+    *pdata = isout?elh.elh_outdata:elh.elh_indata;
   return true;
 } // end rps_event_loop_get_entry
 
+/// synchronize the epoll(7) registration of fd with its handlers,
+/// under eld_mtx
+void
+rps_event_loop_update_epoll(int fd)
+{
+  std::lock_guard<std::recursive_mutex> gu(rps_eventloopdata.eld_mtx);
+  RPS_ASSERT(fd >= 0 && fd < (int) rps_eventloopdata.eld_fdhandlvec.size());
+  struct event_loop_fdhandler_st& elh = rps_eventloopdata.eld_fdhandlvec[fd];
+  uint32_t newevents = 0;
+  if (elh.elh_infun)
+    newevents |= EPOLLIN | EPOLLRDHUP;
+  if (elh.elh_outfun)
+    newevents |= EPOLLOUT;
+  if (newevents)
+    newevents |= EPOLLET;
+  if (newevents == elh.elh_events)
+    return;
+  /// when FLTK is enabled, it does its own polling
+  if (rps_eventloopdata.eld_epollfd > 0)
+    {
+      struct epoll_event ev = {};
+      ev.events = newevents;
+      ev.data.fd = fd;
+      int op = EPOLL_CTL_MOD;
+      if (!elh.elh_events)
+        op = EPOLL_CTL_ADD;
+      else if (!newevents)
+        op = EPOLL_CTL_DEL;
+      if (epoll_ctl(rps_eventloopdata.eld_epollfd, op, fd, &ev) < 0)
+        RPS_WARNOUT("rps_event_loop_update_epoll failed for fd#" << fd
+                    << " (" << (elh.elh_inexpl?:"")
+                    << "," << (elh.elh_outexpl?:"") << "):"
+                    << strerror(errno));
+    }
+  if (!elh.elh_events && newevents)
+    rps_eventloopdata.eld_nbfdhandlers++;
+  else if (elh.elh_events && !newevents)
+    rps_eventloopdata.eld_nbfdhandlers--;
+  elh.elh_events = newevents;
+} // end rps_event_loop_update_epoll
+
+/// with edge-triggered readiness, make epoll(7) report again the
+/// current readiness of fd, e.g. after a handler stopped before
+/// EAGAIN
+void
+rps_event_loop_rearm_epoll(int fd)
+{
+  std::lock_guard<std::recursive_mutex> gu(rps_eventloopdata.eld_mtx);
+  RPS_ASSERT(fd >= 0 && fd < (int) rps_eventloopdata.eld_fdhandlvec.size());
+  const struct event_loop_fdhandler_st& elh = rps_eventloopdata.eld_fdhandlvec[fd];
+  if (rps_eventloopdata.eld_epollfd <= 0 || !elh.elh_events)
+    return;
+  struct epoll_event ev = {};
+  ev.events = elh.elh_events;
+  ev.data.fd = fd;
+  if (epoll_ctl(rps_eventloopdata.eld_epollfd, EPOLL_CTL_MOD, fd, &ev) < 0)
+    RPS_WARNOUT("rps_event_loop_rearm_epoll failed for fd#" << fd
+                << ":" << strerror(errno));
+} // end rps_event_loop_rearm_epoll
+
 void
 rps_event_loop_add_input_fd_handler (int fd,
                                      Rps_EventHandler_sigt*f,
@@ -225,16 +525,18 @@ rps_event_loop_add_input_fd_handler (int fd,
 {
   std::lock_guard<std::recursive_mutex> gu(rps_eventloopdata.eld_mtx);
   RPS_ASSERT(rps_eventloopdata.eld_magic == RPS_EVENTLOOPDATA_MAGIC);
-  unsigned lastfd = rps_eventloopdata.eld_lastix;
-  RPS_ASSERT(lastfd < RPS_MAXPOLL_FD);
-  rps_eventloopdata.eld_pollarr[lastfd].fd = fd;
-  rps_eventloopdata.eld_pollarr[lastfd].events = POLLIN;
-  rps_eventloopdata.eld_explarr[lastfd] = explanation;
-  rps_eventloopdata.eld_datarr[lastfd] = data;
-  rps_eventloopdata.eld_lastix = lastfd+1;
+  RPS_ASSERT(fd >= 0);
+  RPS_ASSERT(f != nullptr);
+  if (fd >= (int) rps_eventloopdata.eld_fdhandlvec.size())
+    rps_eventloopdata.eld_fdhandlvec.resize(fd+fd/4+16);
+  struct event_loop_fdhandler_st& elh = rps_eventloopdata.eld_fdhandlvec[fd];
+  elh.elh_infun = f;
+  elh.elh_inexpl = explanation;
+  elh.elh_indata = data;
+  rps_event_loop_update_epoll(fd);
   if (rps_fltk_enabled())
     {
-      rps_fltk_add_input_fd(fd, f, explanation, (int)lastfd);
+      rps_fltk_add_input_fd(fd, f, explanation, 2*fd);
     };
   RPS_DEBUG_LOG(REPL, "rps_event_loop_add_input_fd_handler fd#" << fd
                 << " f@" << (void*)f
@@ -250,16 +552,18 @@ rps_event_loop_add_output_fd_handler (int fd,
 {
   std::lock_guard<std::recursive_mutex> gu(rps_eventloopdata.eld_mtx);
   RPS_ASSERT(rps_eventloopdata.eld_magic == RPS_EVENTLOOPDATA_MAGIC);
-  unsigned lastfd = rps_eventloopdata.eld_lastix;
-  RPS_ASSERT(lastfd < RPS_MAXPOLL_FD);
-  rps_eventloopdata.eld_pollarr[lastfd].fd = fd;
-  rps_eventloopdata.eld_pollarr[lastfd].events = POLLOUT;
-  rps_eventloopdata.eld_explarr[lastfd] = explanation;
-  rps_eventloopdata.eld_datarr[lastfd] = data;
-  rps_eventloopdata.eld_lastix = lastfd+1;
+  RPS_ASSERT(fd >= 0);
+  RPS_ASSERT(f != nullptr);
+  if (fd >= (int) rps_eventloopdata.eld_fdhandlvec.size())
+    rps_eventloopdata.eld_fdhandlvec.resize(fd+fd/4+16);
+  struct event_loop_fdhandler_st& elh = rps_eventloopdata.eld_fdhandlvec[fd];
+  elh.elh_outfun = f;
+  elh.elh_outexpl = explanation;
+  elh.elh_outdata = data;
+  rps_event_loop_update_epoll(fd);
   if (rps_fltk_enabled())
     {
-      rps_fltk_add_output_fd(fd, f, explanation, (int)lastfd);
+      rps_fltk_add_output_fd(fd, f, explanation, 2*fd+1);
     }
   RPS_DEBUG_LOG(REPL, "rps_event_loop_add_output_fd_handler fd#" << fd
                 << " f@" << (void*)f
@@ -270,187 +574,66 @@ rps_event_loop_add_output_fd_handler (int fd,
 void
 rps_event_loop_remove_input_fd_handler(int fd)
 {
-  Rps_EventHandler_sigt* new_handlarr[RPS_MAXPOLL_FD+1];
-  const char*new_explarr[RPS_MAXPOLL_FD+1];
-  struct pollfd new_pollarr[RPS_MAXPOLL_FD+1];
-  void* new_datarr[RPS_MAXPOLL_FD+1];
-  memset (new_handlarr, 0, sizeof(new_handlarr));
-  memset (new_explarr, 0, sizeof(new_explarr));
-  memset (new_pollarr, 0, sizeof(new_pollarr));
-  memset (new_datarr, 0, sizeof(new_datarr));
   std::lock_guard<std::recursive_mutex> gu(rps_eventloopdata.eld_mtx);
   RPS_ASSERT(rps_eventloopdata.eld_magic == RPS_EVENTLOOPDATA_MAGIC);
-  unsigned lastix = rps_eventloopdata.eld_lastix;
-  unsigned newlastix = 0;
-  for (int ix=0; ix<(int)lastix; ix++)
-    {
-      Rps_EventHandler_sigt* curphdlr=nullptr;
-      struct pollfd curpfd= {};
-      const char*curexpl=nullptr;
-      void*curdata = nullptr;
-      if (rps_event_loop_get_entry(ix, &curphdlr, &curpfd, &curexpl, &curdata))
-        {
-          if (curpfd.fd == fd && curpfd.events == POLLIN)
-            continue;
-          new_handlarr[newlastix] = curphdlr;
-          new_pollarr[newlastix] = curpfd;
-          new_explarr[newlastix] = curexpl;
-          new_datarr[newlastix] = curdata;
-          newlastix++;
-        }
-      else
-        continue;
-    };
-  // the erasing below is in theory useless...
-  memset (rps_eventloopdata.eld_handlarr, 0, sizeof(rps_eventloopdata.eld_handlarr));
-  memset (rps_eventloopdata.eld_explarr, 0, sizeof(rps_eventloopdata.eld_explarr));
-  memset (rps_eventloopdata.eld_pollarr, 0, sizeof(rps_eventloopdata.eld_pollarr));
-  memset (rps_eventloopdata.eld_datarr, 0, sizeof(rps_eventloopdata.eld_datarr));
-  // copy the new things
-  memcpy (rps_eventloopdata.eld_handlarr, new_handlarr, newlastix*sizeof(new_handlarr[0]));
-  memcpy (rps_eventloopdata.eld_explarr, new_explarr, newlastix*sizeof(new_explarr[0]));
-  memcpy (rps_eventloopdata.eld_pollarr, new_pollarr, newlastix*sizeof(new_pollarr[0]));
-  memcpy (rps_eventloopdata.eld_datarr, new_datarr, newlastix*sizeof(new_datarr[0]));
-  rps_eventloopdata.eld_lastix = newlastix;
+  if (fd < 0 || fd >= (int) rps_eventloopdata.eld_fdhandlvec.size())
+    return;
+  struct event_loop_fdhandler_st& elh = rps_eventloopdata.eld_fdhandlvec[fd];
+  elh.elh_infun = nullptr;
+  elh.elh_inexpl = nullptr;
+  elh.elh_indata = nullptr;
+  rps_event_loop_update_epoll(fd);
   RPS_DEBUG_LOG(REPL, "rps_event_loop_remove_input_fd_handler fd#" << fd);
   if (rps_fltk_enabled())
     rps_fltk_remove_input_fd(fd);
 } // end rps_event_loop_remove_input_fd_handler
 
 void
-rps_self_pipe_read_handler(Rps_CallFrame*cf, int fd, void* data)
+rps_main_channel_read_handler(Rps_CallFrame*cf, int fd, [[maybe_unused]] void* data)
 {
   RPS_ASSERT(rps_is_main_thread());
-  unsigned char buf[128];
-  RPS_ASSERT(fd == rps_eventloopdata.eld_selfpipereadfd);
+  RPS_ASSERT(fd == rps_eventloopdata.eld_mainchanfd);
   RPS_ASSERT(cf != nullptr && cf->is_good_call_frame());
-  memset(buf, 0, sizeof(buf));
-  int nbr = read(fd, buf, sizeof(buf));
-  RPS_DEBUG_LOG(REPL, "rps_self_pipe_read_handler fd#" << fd << " nbr=" << nbr
-                << " buf=" << buf << "." << std::endl
-                << RPS_FULL_BACKTRACE_HERE(1, "rps_self_pipe_read_handler"));
-  if (nbr > 0)
-    {
-      std::function<void(Rps_GarbageCollector*)> gcmarker
-        = [&] (Rps_GarbageCollector*gc)
-      {
-        RPS_ASSERT(gc->is_valid_garbcoll());
-        gc->mark_call_stack(cf);
-      };
-      for (int i = 0; i<nbr; i++)
-        {
-          unsigned char b=buf[i];
-          switch (b)
-            {
-            case SelfPipe_Dump:
-              rps_dump_into (rps_get_loaddir());
-              break;
-            case SelfPipe_GarbColl:
-              rps_garbage_collect(&gcmarker);
-              break;
-            case SelfPipe_Quit:
-              rps_stop_event_loop_flag.store(true);
-              break;
-            case SelfPipe_Exit:
-              rps_dump_into (rps_get_loaddir());
-              rps_stop_event_loop_flag.store(true);
-              break;
-            case SelfPipe_Process:
-#warning should call something from transientobj_rps.cc to perhaps fork a process related to some Rps_PayloadUnixProcess
-            /* TODO: see Rps_PayloadUnixProcess::queue_of_runnable_processes
-            in transientobj_rps.cc; the dormant processes should somehow
-            be started by fork/exec */
-            default:
-              RPS_FATALOUT("unexpected byte " << (char)b << "#" << (unsigned)b << " on self pipe");
-            };
-        };
-    }
-} // end rps_self_pipe_read_handler
-
-void
-rps_self_pipe_write_handler(Rps_CallFrame*cf, int fd, void* data)
-{
-  RPS_ASSERT(rps_is_main_thread());
-  RPS_DEBUG_LOG(REPL, "rps_self_pipe_write_handler fd#" << fd
-                << RPS_FULL_BACKTRACE_HERE(1, "rps_self_pipe_write_handler"));
-  std::lock_guard<std::recursive_mutex> gu(rps_eventloopdata.eld_mtx);
-  RPS_ASSERT(rps_eventloopdata.eld_magic == RPS_EVENTLOOPDATA_MAGIC);
-  RPS_ASSERT(fd == rps_eventloopdata.eld_selfpipewritefd);
-  while (!rps_eventloopdata.eld_selfpipefifo.empty())
+  RPS_LOCALFRAME(RPS_CALL_FRAME_UNDESCRIBED,
+                 cf,
+                 Rps_ClosureValue clos;
+                 Rps_Value arg0;
+                 Rps_Value arg1;
+                );
+  uint64_t cnt = 0;
+  errno = 0;
+  int nbr = read(fd, &cnt, sizeof(cnt));
+  RPS_DEBUG_LOG(REPL, "rps_main_channel_read_handler fd#" << fd << " nbr=" << nbr
+                << " cnt=" << cnt);
+  /// clear before draining, so a message posted while draining
+  /// either is drained now or wakes us up again
+  rps_main_channel.mch_wakeuppending.store(false);
+  struct rps_main_message_st msg;
+  long nbmsg = 0;
+  while (rps_main_channel_pop(msg, _f.clos, _f.arg0, _f.arg1))
     {
-      char buf[4] = {0,0,0,0};
-      char c = rps_eventloopdata.eld_selfpipefifo.back();
-      buf[0] = c;
-      errno = 0;
-      ssize_t nw = write(fd, buf, 1);
-      if (nw>0)
-        {
-          RPS_DEBUG_LOG(REPL, "rps_self_pipe_write_handler wrote " << buf << " to fd#" << fd);
-          rps_eventloopdata.eld_selfpipefifo.pop_back();
-        }
-      else
-        {
-          RPS_DEBUG_LOG(REPL, "rps_self_pipe_write_handler write-fail fd#" << fd << ":" << strerror(errno));
-          break;
-        }
-    }
-} // end rps_self_pipe_write_handler
+      nbmsg++;
+      handle_main_message_rps(&_, msg, _f.clos, _f.arg0, _f.arg1);
+      msg = rps_main_message_st{};
+      _f.clos = nullptr;
+      _f.arg0 = nullptr;
+      _f.arg1 = nullptr;
+    };
+  RPS_DEBUG_LOG(EVENT_LOOP, "rps_main_channel_read_handler handled " << nbmsg << " messages");
+} // end rps_main_channel_read_handler
 
 void
 rps_event_loop_remove_output_fd_handler(int fd)
 {
   std::lock_guard<std::recursive_mutex> gu(rps_eventloopdata.eld_mtx);
   RPS_ASSERT(rps_eventloopdata.eld_magic == RPS_EVENTLOOPDATA_MAGIC);
-  unsigned lastfd = rps_eventloopdata.eld_lastix;
-  Rps_EventHandler_sigt* new_handlarr[RPS_MAXPOLL_FD+1];
-  const char*new_explarr[RPS_MAXPOLL_FD+1];
-  struct pollfd new_pollarr[RPS_MAXPOLL_FD+1];
-  void* new_datarr[RPS_MAXPOLL_FD+1];
-  memset (new_handlarr, 0, sizeof(new_handlarr));
-  memset (new_explarr, 0, sizeof(new_explarr));
-  memset (new_pollarr, 0, sizeof(new_pollarr));
-  memset (new_datarr, 0, sizeof(new_datarr));
-  unsigned new_lastfd=0;
-  unsigned lastix = rps_eventloopdata.eld_lastix;
-  unsigned newlastix = 0;
-  for (int ix=0; ix<(int)lastix; ix++)
-    {
-      Rps_EventHandler_sigt* curphdlr=nullptr;
-      struct pollfd curpfd= {0};
-      const char*curexpl=nullptr;
-      void*curdata = nullptr;
-      if (rps_event_loop_get_entry(ix, &curphdlr, &curpfd, &curexpl, &curdata))
-        {
-          if (curpfd.fd == fd && curpfd.events == POLLOUT)
-            continue;
-          new_handlarr[newlastix] = curphdlr;
-          new_pollarr[newlastix] = curpfd;
-          new_explarr[newlastix] = curexpl;
-          new_datarr[newlastix] = curdata;
-          newlastix++;
-        }
-      else
-        continue;
-    };
-  // the erasing below is in theory useless...
-  memset (rps_eventloopdata.eld_handlarr, 0,
-          sizeof(rps_eventloopdata.eld_handlarr));
-  memset (rps_eventloopdata.eld_explarr, 0,
-          sizeof(rps_eventloopdata.eld_explarr));
-  memset (rps_eventloopdata.eld_pollarr, 0,
-          sizeof(rps_eventloopdata.eld_pollarr));
-  memset (rps_eventloopdata.eld_datarr, 0,
-          sizeof(rps_eventloopdata.eld_datarr));
-  // copy the new things
-  memcpy (rps_eventloopdata.eld_handlarr, new_handlarr,
-          newlastix*sizeof(new_handlarr[0]));
-  memcpy (rps_eventloopdata.eld_explarr, new_explarr,
-          newlastix*sizeof(new_explarr[0]));
-  memcpy (rps_eventloopdata.eld_pollarr, new_pollarr,
-          newlastix*sizeof(new_pollarr[0]));
-  memcpy (rps_eventloopdata.eld_datarr, new_datarr,
-          newlastix*sizeof(new_datarr[0]));
-  rps_eventloopdata.eld_lastix = newlastix;
+  if (fd < 0 || fd >= (int) rps_eventloopdata.eld_fdhandlvec.size())
+    return;
+  struct event_loop_fdhandler_st& elh = rps_eventloopdata.eld_fdhandlvec[fd];
+  elh.elh_outfun = nullptr;
+  elh.elh_outexpl = nullptr;
+  elh.elh_outdata = nullptr;
+  rps_event_loop_update_epoll(fd);
   RPS_DEBUG_LOG(REPL, "rps_event_loop_remove_output_fd_handler fd#" << fd);
   if (rps_fltk_enabled())
     rps_fltk_remove_output_fd(fd);
@@ -466,40 +649,31 @@ rps_is_fifo(std::string path)
 } // end rps_is_fifo
 
 void
-rps_initialize_pipe_to_self_in_event_loop(void)
+rps_initialize_main_channel_in_event_loop(void)
 {
   std::lock_guard<std::recursive_mutex> gu(rps_eventloopdata.eld_mtx);
   RPS_ASSERT(rps_eventloopdata.eld_magic == RPS_EVENTLOOPDATA_MAGIC);
   /**
-   * create the pipe to self and install handlers for it
+   * create the eventfd of the main channel and install its handler
    **/
-  {
-    int pipefdarr[2] = {-1, -1};
-    if (pipe2(pipefdarr, O_CLOEXEC) <0)
-      RPS_FATALOUT("rps_initialize_event_loop failed to create pipe to self:"
-                   << strerror(errno));
-    rps_eventloopdata.eld_selfpipereadfd = pipefdarr[0];
-    RPS_ASSERT(rps_eventloopdata.eld_selfpipereadfd > 0);
-    rps_eventloopdata.eld_selfpipewritefd = pipefdarr[1];
-    RPS_ASSERT(rps_eventloopdata.eld_selfpipewritefd > 0);
-    rps_event_loop_add_input_fd_handler(rps_eventloopdata.eld_selfpipereadfd,
-                                        rps_self_pipe_read_handler,
-                                        "selfpiperead",
-                                        nullptr);;
-    rps_event_loop_add_input_fd_handler(rps_eventloopdata.eld_selfpipewritefd,
-                                        rps_self_pipe_write_handler,
-                                        "selfpipewrite",
-                                        nullptr);
-    RPS_DEBUG_LOG(REPL, "rps_initialize_pipe_to_self_in_event_loop eld_selfpipereadfd#"
-                  << (rps_eventloopdata.eld_selfpipereadfd)
-                  << " eld_selfpipewritefd#"
-                  << (rps_eventloopdata.eld_selfpipewritefd)
-                  << " rps_poll_delay_millisec=" << rps_poll_delay_millisec
-                  << " in thread " << rps_current_pthread_name()
-                  << std::endl
-                  << RPS_FULL_BACKTRACE_HERE(1, "rps_initialize_pipe_to_self_event_loop"));
-  }
-} // end rps_initialize_pipe_to_self_in_event_loop
+  rps_eventloopdata.eld_mainchanfd = eventfd(0, EFD_CLOEXEC|EFD_NONBLOCK);
+  if (rps_eventloopdata.eld_mainchanfd <= 0)
+    RPS_FATALOUT("rps_initialize_event_loop failed to create main channel eventfd:"
+                 << strerror(errno));
+  rps_event_loop_add_input_fd_handler(rps_eventloopdata.eld_mainchanfd,
+                                      rps_main_channel_read_handler,
+                                      "mainchannel",
+                                      nullptr);
+  RPS_DEBUG_LOG(REPL, "rps_initialize_main_channel_in_event_loop eld_mainchanfd#"
+                << (rps_eventloopdata.eld_mainchanfd)
+                << " rps_poll_delay_millisec=" << rps_poll_delay_millisec
+                << " in thread " << rps_current_pthread_name()
+                << std::endl
+                << RPS_FULL_BACKTRACE_HERE(1, "rps_initialize_main_channel_in_event_loop"));
+  /// messages could have been posted before
+  if (rps_main_channel.mch_enqpos.load() != rps_main_channel.mch_deqpos.load())
+    rps_main_channel_wakeup();
+} // end rps_initialize_main_channel_in_event_loop
 
 void
 rps_initialize_signalfd_in_event_loop(void)
@@ -514,7 +688,7 @@ rps_initialize_signalfd_in_event_loop(void)
   sigaddset(&msk, SIGXCPU);
   sigaddset(&msk, SIGALRM);
   sigaddset(&msk, SIGVTALRM);
-  rps_eventloopdata.eld_sigfd = signalfd(-1, &msk, SFD_CLOEXEC);
+  rps_eventloopdata.eld_sigfd = signalfd(-1, &msk, SFD_CLOEXEC|SFD_NONBLOCK);
   if (rps_eventloopdata.eld_sigfd<=0)
     RPS_FATALOUT("failed to call signalfd:" << strerror(errno));
   RPS_DEBUG_LOG(REPL, "rps_initialize_signalfd_in_event_loop thread "
@@ -532,7 +706,8 @@ rps_initialize_timerfd_in_event_loop(void)
 {
   std::lock_guard<std::recursive_mutex> gu(rps_eventloopdata.eld_mtx);
   RPS_ASSERT(rps_eventloopdata.eld_magic == RPS_EVENTLOOPDATA_MAGIC);
-  rps_eventloopdata.eld_timfd = timerfd_create(CLOCK_REALTIME, TFD_CLOEXEC);
+  /// the timer wheel uses rps_monotonic_real_time
+  rps_eventloopdata.eld_timfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC|TFD_NONBLOCK);
   if (rps_eventloopdata.eld_timfd<=0)
     RPS_FATALOUT("failed to call timerfd:" << strerror(errno));
   RPS_DEBUG_LOG(REPL, "rps_initialize_timerfd_in_event_loop thread "
@@ -541,8 +716,10 @@ rps_initialize_timerfd_in_event_loop(void)
                 << std::endl
                 << RPS_FULL_BACKTRACE_HERE(1, "rps_initialize_timerfd_in_event_loop")
                );
-  rps_event_loop_add_input_fd_handler(rps_eventloopdata.eld_sigfd, rps_timerfd_read_handler,
+  rps_event_loop_add_input_fd_handler(rps_eventloopdata.eld_timfd, rps_timerfd_read_handler,
                                       "timerfd", nullptr);
+  /// timers could have been scheduled before
+  rps_timerwheel_rearm();
 } // end rps_initialize_timerfd_in_event_loop
 
 void
@@ -555,6 +732,12 @@ rps_initialize_jsonfifo_in_event_loop(void)
   if (fdp.fifo_ui_rout <= 0)
     RPS_FATALOUT("invalid output FIFO fd " << fdp.fifo_ui_rout
                  << " with FIFO prefix " << rps_get_fifo_prefix());
+  /// JSONRPC commands written from RefPerSys to the GUI process...
+  rps_event_loop_add_output_fd_handler(fdp.fifo_ui_wcmd, rps_fifo_write_handler,
+                                       "JsonRpc commands to GUI", nullptr);
+  /// JSONRPC responses/events sent by the GUI process to RefPerSys
+  rps_event_loop_add_input_fd_handler(fdp.fifo_ui_rout, rps_fifo_read_handler,
+                                      "JsonRpc responses from GUI", nullptr);
 } // end rps_initialize_jsonfifo_in_event_loop
 
 /////////// the toplevel event loop initialization
@@ -571,22 +754,23 @@ rps_initialize_event_loop(void)
     RPS_FATALOUT("rps_initialize_event_loop should be called once");
   rps_eventloopdata.eld_magic = RPS_EVENTLOOPDATA_MAGIC;
   rps_eventloopdata.eld_polldelaymillisec = (rps_debug_flags != 0)?666:111;
-  rps_eventloopdata.eld_lastix = 0;
   rps_eventloopdata.eld_startelapsedtime = -1.0/1024;
   rps_eventloopdata.eld_startcputime =  -1.0/1024;
-  memset (rps_eventloopdata.eld_handlarr, 0,
-          sizeof(rps_eventloopdata.eld_handlarr));
-  memset (rps_eventloopdata.eld_explarr, 0,
-          sizeof(rps_eventloopdata.eld_explarr));
-  memset (rps_eventloopdata.eld_pollarr, 0,
-          sizeof(rps_eventloopdata.eld_pollarr));
-  memset (rps_eventloopdata.eld_datarr, 0,
-          sizeof(rps_eventloopdata.eld_datarr));
+  rps_eventloopdata.eld_nbfdhandlers = 0;
+  rps_eventloopdata.eld_fdhandlvec.clear();
+  rps_eventloopdata.eld_fdhandlvec.resize(64);
+  /// with FLTK, file descriptors are polled by FLTK itself
+  rps_eventloopdata.eld_epollfd = -1;
+  if (!rps_fltk_enabled())
+    {
+      rps_eventloopdata.eld_epollfd = epoll_create1(EPOLL_CLOEXEC);
+      if (rps_eventloopdata.eld_epollfd < 0)
+        RPS_FATALOUT("rps_initialize_event_loop failed to epoll_create1:"
+                     << strerror(errno));
+    }
   rps_eventloopdata.eld_sigfd = -1;
   rps_eventloopdata.eld_timfd = -1;
-  rps_eventloopdata.eld_selfpipereadfd = -1;
-  rps_eventloopdata.eld_selfpipewritefd = -1;
-  rps_eventloopdata.eld_selfpipefifo.clear();
+  rps_eventloopdata.eld_mainchanfd = -1;
   rps_eventloopdata.eld_eventloopisactive = false;
   rps_eventloopdata.eld_nbloops = 0;
   rps_eventloopdata.eld_prepollvect.clear();
@@ -595,11 +779,12 @@ rps_initialize_event_loop(void)
                 << (rps_fltk_enabled()?"with FLTK":"without-fltk")
                 << std::endl
                 << RPS_FULL_BACKTRACE_HERE(1, "rps_initialize_event_loop*start"));
-  rps_initialize_pipe_to_self_in_event_loop();
+  rps_initialize_main_channel_in_event_loop();
   rps_initialize_signalfd_in_event_loop();
   rps_initialize_timerfd_in_event_loop();
   if (!rps_get_fifo_prefix().empty())
     rps_initialize_jsonfifo_in_event_loop();
+  Rps_AsyncFileIo::initialize_in_event_loop();
   if (rps_poll_delay_millisec==0)
     rps_poll_delay_millisec = RPS_EVENT_DEFAULT_POLL_DELAY_MILLISEC;
   RPS_DEBUG_LOG(REPL, "rps_initialize_event_loop ended "
@@ -671,14 +856,17 @@ rps_eventloop_explstring(void)
 
 
 ////////////////////////////////////////////////////////////////
-/* TODO: an event loop using poll(2) and also handling SIGCHLD using
+/* The event loop uses epoll(7) with persistent and edge-triggered
+   registrations made by rps_event_loop_add_input_fd_handler and
+   rps_event_loop_add_output_fd_handler, so each iteration costs
+   proportionally to the ready file descriptors. SIGCHLD and other
+   signals are handled using
    https://man7.org/linux/man-pages/man2/signalfd.2.html
  */
 void
 rps_event_loop(void)
 {
-  /// see https://man7.org/linux/man-pages/man2/poll.2.html
-  int nbfdpoll = 0; /// number of polled file descriptors, second argument to poll(2)
+  /// see https://man7.org/linux/man-pages/man7/epoll.7.html
   long pollcount = 0;
   double startelapsedtime = rps_elapsed_real_time();
   double startcputime = rps_process_cpu_time();
@@ -686,7 +874,6 @@ rps_event_loop(void)
                 << " cputime=" << startcputime
                 << " thread:" << rps_current_pthread_name() << std::endl
                 << RPS_FULL_BACKTRACE_HERE(1, "rps_event_loop/start"));
-  std::array<std::function<void(Rps_CallFrame*, int/*fd*/, short /*revents*/)>,RPS_MAXPOLL_FD+1> handlarr;
   ///
   /// check that rps_event_loop is called exactly once from main
   /// thread, and after rps_initialize_event_loop...
@@ -703,16 +890,13 @@ rps_event_loop(void)
   };
   if (rps_fltk_enabled ())
     RPS_FATALOUT("rps_event_loop incompatible with FLTK");
+  RPS_ASSERT(rps_eventloopdata.eld_epollfd > 0);
   RPS_LOCALFRAME(RPS_CALL_FRAME_UNDESCRIBED,
                  /*callerframe:*/rps_curthread_callframe, //
                  /** locals **/
-                 Rps_Value valarr[RPS_MAXPOLL_FD+1];
-                 Rps_ClosureValue closarr[RPS_MAXPOLL_FD+1];
+                 Rps_Value val;
                 );
 #warning incomplete rps_event_loop
-  const char*explarr[RPS_MAXPOLL_FD+1];
-  memset (explarr, 0, sizeof(explarr));
-#warning TODO: consider using rps_timer ...?
   /*** give output
    ***/
   RPS_INFORMOUT("starting rps_event_loop in pid " << (long)getpid() << std::endl
@@ -720,247 +904,34 @@ rps_event_loop(void)
                 << " git " << rps_shortgitid << std::endl
                 << RPS_FULL_BACKTRACE_HERE(1, "rps_event_loop")
                );
+  {
+    std::lock_guard<std::recursive_mutex> gu(rps_eventloopdata.eld_mtx);
+    rps_eventloopdata.eld_startelapsedtime = startelapsedtime;
+    rps_eventloopdata.eld_startcputime = startcputime;
+  }
+  event_loop_is_active.store(true);
+  struct epoll_event evarr[RPS_EPOLL_MAX_EVENTS];
   while (!rps_stop_event_loop_flag.load())
     {
       char elapsbuf[32];
       memset(elapsbuf, 0, sizeof(elapsbuf));
-      struct pollfd pollarr[RPS_MAXPOLL_FD+1];
-      memset ((void*)&pollarr, 0, sizeof(pollarr));
-#define EXPLAIN_EVFD_AT(Fil,Lin,Ix,Expl) do { explarr[Ix] = Fil ":" #Lin " " Expl; } while(0)
-#define EXPLAIN_EVFD_ATBIS(Fil,Lin,Ix,Expl)  EXPLAIN_EVFD_AT(Fil,Lin,Ix,Expl)
-#define EXPLAIN_EVFD_RPS(Ix,Expl) EXPLAIN_EVFD_ATBIS(__FILE__,__LINE__,(Ix),Expl)
       int loopcnt=1+ event_nbloops.fetch_add(1);
       if ((loopcnt-1) % 16 == 0)
         {
           RPS_DEBUG_LOG(REPL, "looping rps_event_loop #" << loopcnt
                         << " elapsed:" << rps_elapsed_real_time()
                         << " thread:" << rps_current_pthread_name()
-                        << ((rps_fltk_enabled())?" with FLTK": " without-fltk")
+                        << " with " << rps_eventloopdata.eld_nbfdhandlers
+                        << " file descriptors"
                         << std::endl
                         << RPS_FULL_BACKTRACE_HERE(1, "rps_event_loop/looping"));
         }
       else
         RPS_DEBUG_LOG(REPL, "looping rps_event_loop #" << loopcnt
                       << " elapsed:" << rps_elapsed_real_time());
-      memset ((void*)&pollarr, 0, sizeof(pollarr));
-      nbfdpoll=0;
-      struct rps_fifo_fdpair_st fdp = rps_get_gui_fifo_fds();
-      if (fdp.fifo_ui_wcmd >0)
-        {
-          /// JSONRPC commands written from RefPerSys to the GUI process...
-          RPS_ASSERT(nbfdpoll<RPS_MAXPOLL_FD);
-          int pix = nbfdpoll++;
-          pollarr[pix].fd = fdp.fifo_ui_wcmd;
-          pollarr[pix].events = POLLOUT;
-          EXPLAIN_EVFD_RPS(pix, "JsonRpc commands to GUI");
-          handlarr[pix] = [&](Rps_CallFrame* cf, int fd, short rev)
-          {
-            RPS_ASSERT(fd ==  pollarr[pix].fd);
-            RPS_ASSERT(rev == POLLOUT);
-            RPS_ASSERT(cf != nullptr && cf->is_good_call_frame());
-            RPS_DEBUG_LOG(REPL, "should write JSONRPC to GUI on cmdfd#" << fd);
-            RPS_FATALOUT("missing code to handle JSONRPC output commands to fd#"
-                         << fd << " pix#" << pix);
-            /* TODO: write the bytes that are in rps_jsonrpc_cmdbuf */
-#warning missing code to handle JsonRpc output to the GUI process
-          };
-        };
-      if (fdp.fifo_ui_rout>0)
-        {
-          /// JSONRPC responses/events sent by the GUI process to RefPerSys
-          RPS_ASSERT(nbfdpoll<RPS_MAXPOLL_FD);
-          int pix = nbfdpoll++;
-          pollarr[pix].fd = fdp.fifo_ui_rout;
-          pollarr[pix].events = POLLIN;
-          EXPLAIN_EVFD_RPS(pix, "JsonRpc responses from GUI");
-          handlarr[pix] = [&](Rps_CallFrame* cf, int fd, short rev)
-          {
-            constexpr unsigned bufusefulen = 1024;
-            char buf[bufusefulen+8];
-            RPS_ASSERT(fd ==  pollarr[pix].fd);
-            RPS_ASSERT(rev == POLLIN);
-            RPS_ASSERT(cf != nullptr && cf->is_good_call_frame());
-            /* TODO: should read(2) */
-            memset(buf, 0, sizeof(buf));
-            RPS_DEBUG_LOG(REPL, "reading JSONRPC from GUI on outfd#" << fd);
-            errno = 0;
-            int nbr = read(fd, buf, bufusefulen);
-            if (nbr < 0)
-              return;
-            if (nbr == 0)
-              {
-                RPS_FATALOUT("missing code to handle JSONRPC input EOF from fd#"
-                             << fd << " pix#" << pix);
-#warning missing code to handle JsonRpc EOF from GUI process
-              };
-            buf[nbr] = (char)0;
-            RPS_DEBUG_LOG(REPL, "got " << nbr << " bytes from JSONRPC fd#" << fd << std::endl
-                          << buf << std::endl);
-            /* TODO: append the bytes we did read to
-               rps_jsonrpc_rspbuf; by convention a double newline or a
-               formfeed is ending the JSON message. */
-            {
-              std::lock_guard<std::mutex> gu(rps_jsonrpc_mtx);
-#warning oldbufsiz need a code review
-              std::size_t oldbufsiz= rps_jsonrpc_rspbuf.in_avail();
-              std::size_t oldprevix = (oldbufsiz>0)?(oldbufsiz-1):0;
-              auto newsiz = rps_jsonrpc_rspbuf.sputn(buf, nbr);
-              bool again = false;
-              char* curp = buf;
-              do
-                {
-                  again = false;
-                  /// Find a double newline or formfeed at index. If there
-                  /// is one (or more) it is terminating a message...
-                  /* Invariant: there cannot be any double newline of
-                  formfeed before, since it would have been already
-                  processed. */
-                  {
-                    char*ffbuf = strchr(curp, '\f');
-                    char*nl2buf = strstr(curp, "\n\n");
-                    char*eombuf = nullptr;
-                    if (ffbuf && nl2buf)
-                      eombuf = (ffbuf>nl2buf)?ffbuf:nl2buf;
-                    else if (ffbuf) eombuf = ffbuf;
-                    else if (nl2buf) eombuf = nl2buf+1;
-                    if (eombuf)
-                      {
-                        int eombufoff = eombuf - buf;
-                        again = true;
-                        RPS_FATALOUT("missing code JSONRPC input eombufoff:" << eombufoff);
-#warning should build a string with the JSON message, then decode and process that JSON
-                      }
-                  }
-                }
-              while (again);
-              /// oldprevix
-#warning missing code to handle JsonRpc input from the GUI process
-            }
-            RPS_FATALOUT("missing code to handle JSONRPC input responses from fd#"
-                         << fd << " pix#" << pix
-                         << " did read " << nbr << " bytes");
-          };
-        };
-
-      if (rps_eventloopdata.eld_timfd>0)
-        {
-          /// timers transformed to data with timerfd_create(2)
-          RPS_ASSERT(nbfdpoll<RPS_MAXPOLL_FD);
-          int pix = nbfdpoll++;
-          pollarr[pix].fd = rps_eventloopdata.eld_timfd;
-          pollarr[pix].events = POLLIN;
-          EXPLAIN_EVFD_RPS(pix, "timerfd");
-          handlarr[pix] = [&](Rps_CallFrame*cf, int fd, short rev)
-          {
-            RPS_ASSERT(fd ==  pollarr[pix].fd);
-            RPS_ASSERT(cf != nullptr && cf->is_good_call_frame());
-            RPS_ASSERT(rev == POLLIN);
-            uint64_t timbuf[16];
-            memset (&timbuf, 0, sizeof(timbuf));
-            int nbr = read(fd, (void*)&timbuf, sizeof(timbuf));
-            if (nbr>0)
-              {
-                RPS_DEBUG_LOG(REPL, "eventloop read " << nbr << " bytes on timerfd, so " << (nbr/sizeof(std::uint64_t)) << " int64s: "
-                              << Rps_Do_Output([=](std::ostream& out)
-                {
-                  for (int ix=0; ix< (int) (nbr/sizeof(std::uint64_t)); ix++)
-                    out << ' ' << timbuf[ix];
-                }
-                                              )
-                    << std::flush);
-              }
-#warning some missing code to handle timerfd...
-          };
-        };
-      if (rps_eventloopdata.eld_selfpipereadfd>0)
-        {
-          RPS_ASSERT(nbfdpoll<RPS_MAXPOLL_FD);
-          int pix = nbfdpoll++;
-          pollarr[pix].fd = rps_eventloopdata.eld_selfpipereadfd;
-          pollarr[pix].events = POLLIN;
-          EXPLAIN_EVFD_RPS(pix, "self_pipe_read_fd");
-          handlarr[pix] = [&](Rps_CallFrame* cf, int fd, short rev)
-          {
-            unsigned char buf[128];
-            RPS_ASSERT(fd == rps_eventloopdata.eld_selfpipereadfd);
-            RPS_ASSERT(cf != nullptr && cf->is_good_call_frame());
-            RPS_ASSERT(rev == POLLIN);
-            /* TODO: should read(2) */
-            memset(buf, 0, sizeof(buf));
-            int nbr = read(fd, buf, sizeof(buf));
-            if (nbr > 0)
-              for (int i = 0; i<nbr; i++)
-                handle_self_pipe_byte_rps(buf[i]);
-          };
-        };
-      bool wantselfwrite = false;
-      {
-        std::lock_guard<std::recursive_mutex> gu(rps_eventloopdata.eld_mtx);
-        wantselfwrite = !rps_eventloopdata.eld_selfpipefifo.empty();
-      }
-      if (rps_eventloopdata.eld_selfpipewritefd>0 && wantselfwrite)
-        {
-          RPS_ASSERT(nbfdpoll<RPS_MAXPOLL_FD);
-          int pix = nbfdpoll++;
-          pollarr[pix].fd = rps_eventloopdata.eld_selfpipewritefd;
-          pollarr[pix].events = POLLOUT;
-          EXPLAIN_EVFD_RPS(pix, "self_pipe_write_fd");
-          handlarr[pix] = [&](Rps_CallFrame* cf, int fd, short rev)
-          {
-            RPS_ASSERT(fd == rps_eventloopdata.eld_selfpipewritefd);
-            RPS_ASSERT(rev == POLLOUT);
-            RPS_ASSERT(cf != nullptr && cf->is_good_call_frame());
-            std::lock_guard<std::recursive_mutex> gu(rps_eventloopdata.eld_mtx);
-            while (!rps_eventloopdata.eld_selfpipefifo.empty())
-              {
-                unsigned char b = rps_eventloopdata.eld_selfpipefifo.back();
-                if (write(fd, &b, 1) > 0)
-                  {
-                    RPS_DEBUG_LOG(REPL, "eventloop wrote self pipe " << b
-                                  << " to fd#" << fd);
-                    rps_eventloopdata.eld_selfpipefifo.pop_back();
-                  }
-                else
-                  {
-                    RPS_DEBUG_LOG(REPL, "eventloop failed to write self pipe " << b
-                                  << " to fd#" << fd << ":" << strerror(errno));
-                    break;
-                  }
-              };
-          };
-        };
       bool debugpoll = RPS_DEBUG_ENABLED(REPL) //
                        || RPS_DEBUG_ENABLED(EVENT_LOOP) //
                        || RPS_DEBUG_ENABLED(GUI);
-      if (debugpoll)
-        {
-          char pidbuf[16];
-          memset(pidbuf, 0, sizeof(pidbuf));
-          if (event_nbloops.load() % 10)
-            snprintf(pidbuf, sizeof(pidbuf)-1, " pid %d", (int)getpid());
-          for (int pix=0; pix<nbfdpoll; pix++)
-            {
-              std::string evstr;
-              if (pollarr[pix].events & POLLIN)
-                evstr += " POLLIN";
-              if (pollarr[pix].events & POLLOUT)
-                evstr += " POLLOUT";
-              if (pollarr[pix].events & POLLPRI)
-                evstr += " POLLPRI";
-              if (pollarr[pix].events & POLLRDHUP)
-                evstr += " POLLRDHUP";
-              if (pollarr[pix].events & POLLERR)
-                evstr += " POLLERR";
-              if (pollarr[pix].events & POLLHUP)
-                evstr += " POLLHUP";
-              if (pollarr[pix].events & POLLNVAL)
-                evstr += " POLLNVAL";
-              rps_debug_printf_at(__FILE__,__LINE__,__FUNCTION__,RPS_DEBUG__EVERYTHING,
-                                  "poll[%d] loop%ld:fd#%d:%s,%s%s\n",
-                                  pix, event_nbloops.load(), pollarr[pix].fd,
-                                  explarr[pix], evstr.c_str(), pidbuf);
-            }
-        };
       errno = 0;
       if (Rps_Agenda::agenda_timeout > 0
           && rps_elapsed_real_time() >= Rps_Agenda::agenda_timeout)
@@ -972,72 +943,89 @@ rps_event_loop(void)
           break;
         };
       fflush(nullptr);
-      // call the registered event prepoller
+      int polldelay = 20 + (rps_poll_delay_millisec*(debugpoll?4:1));
+      // call the registered event prepollers, if any; then the epoll
+      // file descriptor is poll(2)-ed with the ones they added.
+      bool hasprepoller = false;
       {
         std::lock_guard<std::recursive_mutex> gu(rps_eventloopdata.eld_mtx);
-        for (auto fun : rps_eventloopdata.eld_prepollvect)
+        for (auto& fun : rps_eventloopdata.eld_prepollvect)
+          if (fun)
+            hasprepoller = true;
+        if (hasprepoller)
           {
-            if (fun)
-              fun(pollarr, nbfdpoll, &_);
+            struct pollfd pollarr[RPS_MAXPOLL_FD+1];
+            memset ((void*)&pollarr, 0, sizeof(pollarr));
+            int nbfdpoll = 1;
+            pollarr[0].fd = rps_eventloopdata.eld_epollfd;
+            pollarr[0].events = POLLIN;
+            for (auto& fun : rps_eventloopdata.eld_prepollvect)
+              if (fun)
+                fun(pollarr, nbfdpoll, &_);
+            RPS_ASSERT(nbfdpoll <= RPS_MAXPOLL_FD);
+            if (poll(pollarr, nbfdpoll, polldelay) >= 0)
+              polldelay = 0;
           }
       }
       errno = 0;
-      int respoll = poll(pollarr, nbfdpoll, 20 + (rps_poll_delay_millisec*(debugpoll?4:1)));
+      int nbev = epoll_wait(rps_eventloopdata.eld_epollfd, evarr,
+                            RPS_EPOLL_MAX_EVENTS, polldelay);
       pollcount++;
       if (pollcount %2 && debugpoll)
         snprintf(elapsbuf, sizeof(elapsbuf), " elti: %.3fs", rps_elapsed_real_time());
       RPS_DEBUG_LOG(REPL, "rps_event_loop pollcount#"  << pollcount ///
-                    << " respoll=" << respoll
-                    << " nbfdpoll=" << nbfdpoll
+                    << " nbev=" << nbev
                     << " elapsed time:" << rps_elapsed_real_time());
-      if (respoll>0)
+      if (nbev>0)
         {
           if (debugpoll)
             rps_debug_printf_at(__FILE__,__LINE__,__FUNCTION__,RPS_DEBUG__EVERYTHING,
-                                "respoll=%d loop%ld%s\n", respoll, event_nbloops.load(), elapsbuf);
-          int nbrev=0;
-          for (int pix=0; pix<nbfdpoll; pix++)
+                                "nbev=%d loop%ld%s\n", nbev, event_nbloops.load(), elapsbuf);
+          for (int eix=0; eix<nbev; eix++)
             {
-              if (pollarr[pix].revents != 0)
+              int fd = evarr[eix].data.fd;
+              uint32_t rev = evarr[eix].events;
+              Rps_EventHandler_sigt*fun = nullptr;
+              const char*expl = nullptr;
+              void*data = nullptr;
+              if (debugpoll)
+                {
+                  std::string evstr;
+                  if (rev & EPOLLIN)
+                    evstr += " EPOLLIN";
+                  if (rev & EPOLLOUT)
+                    evstr += " EPOLLOUT";
+                  if (rev & EPOLLPRI)
+                    evstr += " EPOLLPRI";
+                  if (rev & EPOLLRDHUP)
+                    evstr += " EPOLLRDHUP";
+                  if (rev & EPOLLERR)
+                    evstr += " EPOLLERR";
+                  if (rev & EPOLLHUP)
+                    evstr += " EPOLLHUP";
+                  rps_debug_printf_at(__FILE__,__LINE__,__FUNCTION__,RPS_DEBUG__EVERYTHING,
+                                      "epolled[%d]:fd#%d:%s\n",
+                                      eix, fd, evstr.c_str());
+                }
+              /// a handler may remove itself or another one, so fetch
+              /// it just before calling it
+              if (rev & (EPOLLIN|EPOLLRDHUP|EPOLLHUP|EPOLLERR))
                 {
-                  nbrev++;
-                  if (debugpoll)
-                    {
-                      std::string evstr;
-                      if (pollarr[pix].revents & POLLIN)
-                        evstr += " POLLIN";
-                      if (pollarr[pix].revents & POLLOUT)
-                        evstr += " POLLOUT";
-                      if (pollarr[pix].revents & POLLPRI)
-                        evstr += " POLLPRI";
-                      if (pollarr[pix].revents & POLLRDHUP)
-                        evstr += " POLLRDHUP";
-                      if (pollarr[pix].revents & POLLERR)
-                        evstr += " POLLERR";
-                      if (pollarr[pix].revents & POLLHUP)
-                        evstr += " POLLHUP";
-                      if (pollarr[pix].revents & POLLNVAL)
-                        evstr += " POLLNVAL";
-                      rps_debug_printf_at(__FILE__,__LINE__,__FUNCTION__,RPS_DEBUG__EVERYTHING,
-                                          "polled[%d]:fd#%d:%s>%s\n",
-                                          pix, pollarr[pix].fd, explarr[pix], evstr.c_str());
-                    }
-                  if (handlarr[pix])
-                    handlarr[pix](&_, pollarr[pix].fd, pollarr[pix].revents);
-                  else
-                    usleep((5+(pix & 0xf))*1024);
-                };
+                  if (rps_event_loop_get_entry(2*fd, &fun, nullptr, &expl, &data))
+                    (*fun)(&_, fd, data);
+                }
+              if (rev & (EPOLLOUT|EPOLLERR))
+                {
+                  if (rps_event_loop_get_entry(2*fd+1, &fun, nullptr, &expl, &data))
+                    (*fun)(&_, fd, data);
+                }
             };
-          if (debugpoll)
-            rps_debug_printf_at(__FILE__,__LINE__,__FUNCTION__,RPS_DEBUG__EVERYTHING,
-                                "respoll=%d nbrev=%d event_nbloops=%ld\n",
-                                respoll, nbrev, event_nbloops.load());
         }
-      else if (respoll==0)   // timed out poll
+      else if (nbev==0)   // timed out epoll
         {
           if (debugpoll)
             rps_debug_printf_at(__FILE__,__LINE__,__FUNCTION__,RPS_DEBUG__EVERYTHING,
-                                "poll timeout loop%ld\n", event_nbloops.load());
+                                "epoll timeout loop%ld\n", event_nbloops.load());
         }
       else if (errno != EINTR)
         RPS_FATALOUT("rps_event_loop failure : " << strerror(errno));
@@ -1046,7 +1034,7 @@ rps_event_loop(void)
           if (debugpoll)
             rps_debug_printf_at(__FILE__,__LINE__,__FUNCTION__,
                                 RPS_DEBUG__EVERYTHING,
-                                "poll interrupt loop%ld\n", event_nbloops.load());
+                                "epoll interrupt loop%ld\n", event_nbloops.load());
         };
       if (Rps_Agenda::agenda_timeout > 0
           && rps_elapsed_real_time() >= Rps_Agenda::agenda_timeout + 2.0)
@@ -1058,6 +1046,7 @@ rps_event_loop(void)
         };
       fflush(nullptr);
     };       // end while not rps_stop_event_loop_flag
+  event_loop_is_active.store(false);
   {
     std::lock_guard<std::recursive_mutex> gu(rps_eventloopdata.eld_mtx);
     rps_eventloopdata.eld_eventloopisactive.store(true);
@@ -1078,12 +1067,119 @@ rps_event_loop(void)
                 << " cputime=" << startcputime
                 << " thread:" << rps_current_pthread_name() << std::endl
                 << RPS_FULL_BACKTRACE_HERE(1, "rps_event_loop/ended"));
-#undef EXPLAIN_EVFD_AT
-#undef EXPLAIN_EVFD_ATBIS
-#undef EXPLAIN_EVFD_RPS
 } // end rps_event_loop
 
 
+/// called when the JSONRPC command FIFO to the GUI process is
+/// writable; writes the pending bytes of rps_jsonrpc_cmdpending till
+/// EAGAIN
+void
+rps_fifo_write_handler(Rps_CallFrame*cf, int fd, [[maybe_unused]] void* data)
+{
+  RPS_ASSERT(cf != nullptr && cf->is_good_call_frame());
+  std::lock_guard<std::mutex> gu(rps_jsonrpc_mtx);
+  size_t startoff = rps_jsonrpc_cmdoff;
+  bool again = false;
+  while (rps_jsonrpc_cmdoff < rps_jsonrpc_cmdpending.size())
+    {
+      errno = 0;
+      ssize_t nw = write(fd, rps_jsonrpc_cmdpending.c_str()+rps_jsonrpc_cmdoff,
+                         rps_jsonrpc_cmdpending.size()-rps_jsonrpc_cmdoff);
+      if (nw > 0)
+        rps_jsonrpc_cmdoff += nw;
+      else if (nw < 0 && errno == EINTR)
+        continue;
+      else
+        {
+          /// on EAGAIN the next edge comes when the FIFO is drained,
+          /// otherwise epoll should report the descriptor again
+          again = (nw == 0 || (errno != EAGAIN && errno != EWOULDBLOCK));
+          break;
+        }
+    };
+  RPS_DEBUG_LOG(REPL, "rps_fifo_write_handler wrote " << (rps_jsonrpc_cmdoff-startoff)
+                << " bytes of JSONRPC to GUI on cmdfd#" << fd);
+  if (rps_jsonrpc_cmdoff >= rps_jsonrpc_cmdpending.size())
+    {
+      rps_jsonrpc_cmdpending.clear();
+      rps_jsonrpc_cmdoff = 0;
+    }
+  else if (again)
+    rps_event_loop_rearm_epoll(fd);
+} // end rps_fifo_write_handler
+
+/// called when the JSONRPC output FIFO from the GUI process is
+/// readable; edge-triggered, so reads till EAGAIN
+void
+rps_fifo_read_handler(Rps_CallFrame*cf, int fd, [[maybe_unused]] void* data)
+{
+  constexpr unsigned bufusefulen = 1024;
+  char buf[bufusefulen+8];
+  RPS_ASSERT(cf != nullptr && cf->is_good_call_frame());
+  RPS_DEBUG_LOG(REPL, "reading JSONRPC from GUI on outfd#" << fd);
+  long nbtotal = 0;
+  for (;;)
+    {
+      memset(buf, 0, sizeof(buf));
+      errno = 0;
+      int nbr = read(fd, buf, bufusefulen);
+      if (nbr < 0 && errno == EINTR)
+        continue;
+      if (nbr < 0)
+        break;
+      if (nbr == 0)
+        {
+          RPS_FATALOUT("missing code to handle JSONRPC input EOF from fd#"
+                       << fd);
+#warning missing code to handle JsonRpc EOF from GUI process
+        };
+      nbtotal += nbr;
+      buf[nbr] = (char)0;
+      RPS_DEBUG_LOG(REPL, "got " << nbr << " bytes from JSONRPC fd#" << fd << std::endl
+                    << buf << std::endl);
+      /* TODO: append the bytes we did read to
+         rps_jsonrpc_rspbuf; by convention a double newline or a
+         formfeed is ending the JSON message. */
+      {
+        std::lock_guard<std::mutex> gu(rps_jsonrpc_mtx);
+        rps_jsonrpc_rspbuf.sputn(buf, nbr);
+        bool again = false;
+        char* curp = buf;
+        do
+          {
+            again = false;
+            /// Find a double newline or formfeed at index. If there
+            /// is one (or more) it is terminating a message...
+            /* Invariant: there cannot be any double newline of
+            formfeed before, since it would have been already
+            processed. */
+            {
+              char*ffbuf = strchr(curp, '\f');
+              char*nl2buf = strstr(curp, "\n\n");
+              char*eombuf = nullptr;
+              if (ffbuf && nl2buf)
+                eombuf = (ffbuf>nl2buf)?ffbuf:nl2buf;
+              else if (ffbuf) eombuf = ffbuf;
+              else if (nl2buf) eombuf = nl2buf+1;
+              if (eombuf)
+                {
+                  int eombufoff = eombuf - buf;
+                  again = true;
+                  RPS_FATALOUT("missing code JSONRPC input eombufoff:" << eombufoff);
+#warning should build a string with the JSON message, then decode and process that JSON
+                }
+            }
+          }
+        while (again);
+#warning missing code to handle JsonRpc input from the GUI process
+      }
+    };
+  if (nbtotal > 0)
+    RPS_FATALOUT("missing code to handle JSONRPC input responses from fd#"
+                 << fd << " did read " << nbtotal << " bytes");
+} // end rps_fifo_read_handler
+
+
 bool
 rps_is_active_event_loop(void)
 {
@@ -1100,57 +1196,64 @@ rps_sigfd_read_handler(Rps_CallFrame*cf, int fd, void* data)
                  << RPS_FULL_BACKTRACE_HERE(1, "rps_sigfd_read_handler"));
   RPS_ASSERT (rps_eventloopdata.eld_sigfd>0);
   RPS_ASSERT(rps_eventloopdata.eld_magic == RPS_EVENTLOOPDATA_MAGIC);
-  struct signalfd_siginfo infsig;
-  memset(&infsig, 0, sizeof(infsig));
   RPS_ASSERT(fd == rps_eventloopdata.eld_sigfd);
   RPS_ASSERT(cf != nullptr && cf->is_good_call_frame());
-  int nbr = read(fd, (void*)&infsig, sizeof(infsig));
-  if (nbr != sizeof(infsig))
-    RPS_FATALOUT("rps_sigfd_read_handler read failure on fd#" << fd
-                 << " got " << nbr << " bytes, expecting " << sizeof(infsig)
-                 << ":" << strerror(errno));
-  std::int32_t scod= infsig.ssi_code;
-  pid_t origpid= infsig.ssi_pid;
-  std::int32_t status= infsig.ssi_status;
-  int signum= infsig.ssi_signo;
-  RPS_DEBUG_LOG(REPL, "rps_sigfd_read_handler signal#" << signum << ":" << strsignal(signum)
-                << " scod:" << scod << " origpid:"<< origpid << " status:" << status);
-  switch (infsig.ssi_signo)
+  /// edge-triggered, so read till EAGAIN
+  for (;;)
     {
-    case SIGTERM:
-    {
-      RPS_INFORMOUT("rps_sigfd_read_handler got SIGTERM from pid " << origpid);
+      struct signalfd_siginfo infsig;
+      memset(&infsig, 0, sizeof(infsig));
+      errno = 0;
+      int nbr = read(fd, (void*)&infsig, sizeof(infsig));
+      if (nbr < 0 && (errno == EAGAIN || errno == EINTR))
+        break;
+      if (nbr != sizeof(infsig))
+        RPS_FATALOUT("rps_sigfd_read_handler read failure on fd#" << fd
+                     << " got " << nbr << " bytes, expecting " << sizeof(infsig)
+                     << ":" << strerror(errno));
+      std::int32_t scod= infsig.ssi_code;
+      pid_t origpid= infsig.ssi_pid;
+      std::int32_t status= infsig.ssi_status;
+      int signum= infsig.ssi_signo;
+      RPS_DEBUG_LOG(REPL, "rps_sigfd_read_handler signal#" << signum << ":" << strsignal(signum)
+                    << " scod:" << scod << " origpid:"<< origpid << " status:" << status);
+      switch (infsig.ssi_signo)
+        {
+        case SIGTERM:
+        {
+          RPS_INFORMOUT("rps_sigfd_read_handler got SIGTERM from pid " << origpid);
 #warning on SIGTERM should schedule a final dump
-      rps_do_stop_event_loop();
-      /* TODO: perhaps use rps_register_after_event_loop for the final dump? */
-    };
-    break;
-    case SIGINT:
-    {
-      RPS_INFORMOUT("rps_sigfd_read_handler got SIGINT from pid " << origpid);
-      rps_do_stop_event_loop();
-    };
-    break;
-    case SIGQUIT:
-    {
-      RPS_INFORMOUT("rps_sigfd_read_handler got SIGQUIT from pid " << origpid);
-      rps_do_stop_event_loop();
-    };
-    break;
-    case SIGCHLD:
-    {
-      RPS_INFORMOUT("rps_sigfd_read_handler got SIGCHLD from pid " << origpid
-                    << " status:" << status);
-    };
-    break;
-    case SIGUSR1:
-    {
-      RPS_INFORMOUT("rps_sigfd_read_handler got SIGUSR1 from pid " << origpid);
+          rps_do_stop_event_loop();
+          /* TODO: perhaps use rps_register_after_event_loop for the final dump? */
+        };
+        break;
+        case SIGINT:
+        {
+          RPS_INFORMOUT("rps_sigfd_read_handler got SIGINT from pid " << origpid);
+          rps_do_stop_event_loop();
+        };
+        break;
+        case SIGQUIT:
+        {
+          RPS_INFORMOUT("rps_sigfd_read_handler got SIGQUIT from pid " << origpid);
+          rps_do_stop_event_loop();
+        };
+        break;
+        case SIGCHLD:
+        {
+          RPS_INFORMOUT("rps_sigfd_read_handler got SIGCHLD from pid " << origpid
+                        << " status:" << status);
+        };
+        break;
+        case SIGUSR1:
+        {
+          RPS_INFORMOUT("rps_sigfd_read_handler got SIGUSR1 from pid " << origpid);
 #warning on SIGUSR1 should schedule a temporary dump
-    };
-    break;
-    default:
-      RPS_FATALOUT("rps_sigfd_read_handler got unexpected signal#" << signum << ":" << strsignal(signum));
+        };
+        break;
+        default:
+          RPS_FATALOUT("rps_sigfd_read_handler got unexpected signal#" << signum << ":" << strsignal(signum));
+        };
     };
 } // end rps_sigfd_read_handler
 
@@ -1164,43 +1267,418 @@ rps_timerfd_read_handler(Rps_CallFrame*cf, int fd, void* data)
                  << " thread:" << rps_current_pthread_name() << std::endl
                  << RPS_FULL_BACKTRACE_HERE(1, "rps_timerfd_read_handler"));
   RPS_ASSERT(rps_eventloopdata.eld_magic == RPS_EVENTLOOPDATA_MAGIC);
-#warning unimplemented rps_timerfd_read_handler
-  RPS_FATALOUT("unimplemented rps_timerfd_read_handler fd#" << fd);
+  RPS_ASSERT(fd == rps_eventloopdata.eld_timfd);
+  RPS_ASSERT(cf != nullptr && cf->is_good_call_frame());
+  uint64_t nbexpir = 0;
+  /// edge-triggered, so read till EAGAIN
+  for (;;)
+    {
+      errno = 0;
+      int nbr = read(fd, (void*)&nbexpir, sizeof(nbexpir));
+      if (nbr != sizeof(nbexpir))
+        break;
+      RPS_DEBUG_LOG(REPL, "rps_timerfd_read_handler got " << nbexpir
+                    << " expirations on timerfd#" << fd);
+    };
+  Rps_TimerWheel::fire_expired_timers(cf);
 } // end rps_timerfd_read_handler
 
 
 
+////////////////////////////////////////////////////////////////
+/// The hierarchical timer wheel, with a millisecond tick of
+/// rps_monotonic_real_time. A timer expiring at tick T is in the
+/// level L slot (T >> 8L) & 255, for the smallest L such that T and
+/// the current tick agree above their 8(L+1) lowest bits. The
+/// current tick jumps from one pending deadline to the next, and when
+/// it leaves its 256 ticks block the higher levels are cascaded. Timers
+/// beyond the last level (about 49 days) sit in a far list.
+#define RPS_TIMERWHEEL_LEVELS 4
+#define RPS_TIMERWHEEL_SLOTBITS 8
+#define RPS_TIMERWHEEL_NBSLOTS (1<<RPS_TIMERWHEEL_SLOTBITS)
+#define RPS_TIMERWHEEL_SLOTMASK (RPS_TIMERWHEEL_NBSLOTS-1)
+
+struct rps_timer_node_st
+{
+  Rps_TimerWheel::timer_id_t tn_id;
+  uint64_t tn_tick;             // expiration, in milliseconds
+  Rps_ClosureValue tn_clos;     // applied in the event loop, or
+  Rps_ObjectRef tn_obtasklet;   // added to the agenda
+  Rps_Agenda::agenda_prio_en tn_prio;
+  struct rps_timer_node_st* tn_prev;
+  struct rps_timer_node_st* tn_next;
+  struct rps_timer_node_st** tn_head; // the list containing this node
+};
+
+struct rps_timerwheel_st
+{
+  std::mutex tw_mtx;
+  uint64_t tw_curtick;   // the next tick to process
+  uint64_t tw_armedtick; // when the timerfd is armed, or 0
+  Rps_TimerWheel::timer_id_t tw_lastid;
+  struct rps_timer_node_st* tw_slots[RPS_TIMERWHEEL_LEVELS][RPS_TIMERWHEEL_NBSLOTS];
+  struct rps_timer_node_st* tw_far;
+  std::unordered_map<Rps_TimerWheel::timer_id_t, struct rps_timer_node_st*> tw_nodemap;
+};
+
+static struct rps_timerwheel_st rps_timerwheel;
+
+static inline uint64_t
+rps_timerwheel_tick_of_time(double t)
+{
+  if (t < 0.0 || std::isnan(t))
+    return 0;
+  return (uint64_t)(t*1000.0);
+} // end rps_timerwheel_tick_of_time
+
+/// link the node in the right slot, under tw_mtx
+static void
+rps_timerwheel_place(struct rps_timer_node_st*nd)
+{
+  auto& tw = rps_timerwheel;
+  uint64_t tick = nd->tn_tick;
+  if (tick < tw.tw_curtick)
+    tick = tw.tw_curtick;
+  struct rps_timer_node_st** phead = &tw.tw_far;
+  for (int lev=0; lev<RPS_TIMERWHEEL_LEVELS; lev++)
+    {
+      unsigned hishift = RPS_TIMERWHEEL_SLOTBITS*(lev+1);
+      if ((tick >> hishift) == (tw.tw_curtick >> hishift))
+        {
+          phead = &tw.tw_slots[lev][(tick >> (RPS_TIMERWHEEL_SLOTBITS*lev))
+                                    & RPS_TIMERWHEEL_SLOTMASK];
+          break;
+        }
+    };
+  nd->tn_head = phead;
+  nd->tn_prev = nullptr;
+  nd->tn_next = *phead;
+  if (*phead)
+    (*phead)->tn_prev = nd;
+  *phead = nd;
+} // end rps_timerwheel_place
+
+/// unlink the node from its slot, under tw_mtx
+static void
+rps_timerwheel_unlink(struct rps_timer_node_st*nd)
+{
+  RPS_ASSERT(nd && nd->tn_head);
+  if (nd->tn_prev)
+    nd->tn_prev->tn_next = nd->tn_next;
+  else
+    *nd->tn_head = nd->tn_next;
+  if (nd->tn_next)
+    nd->tn_next->tn_prev = nd->tn_prev;
+  nd->tn_prev = nd->tn_next = nullptr;
+  nd->tn_head = nullptr;
+} // end rps_timerwheel_unlink
+
+/// re-place every node of some list, under tw_mtx
+static void
+rps_timerwheel_cascade(struct rps_timer_node_st** phead)
+{
+  struct rps_timer_node_st* nd = *phead;
+  *phead = nullptr;
+  while (nd)
+    {
+      struct rps_timer_node_st* nextnd = nd->tn_next;
+      rps_timerwheel_place(nd);
+      nd = nextnd;
+    };
+} // end rps_timerwheel_cascade
+
+/// the earliest pending deadline tick, or 0 when no timer is
+/// pending, under tw_mtx
+static uint64_t
+rps_timerwheel_next_tick(void)
+{
+  auto& tw = rps_timerwheel;
+  if (tw.tw_nodemap.empty())
+    return 0;
+  uint64_t t = tw.tw_curtick;
+  for (unsigned ix = t & RPS_TIMERWHEEL_SLOTMASK; ix < RPS_TIMERWHEEL_NBSLOTS; ix++, t++)
+    if (tw.tw_slots[0][ix])
+      return t;
+  /// the level 0 block is empty, so the earliest timer is in a
+  /// higher level or in the far list
+  uint64_t mintick = UINT64_MAX;
+  auto minlist = [&](struct rps_timer_node_st*nd)
+  {
+    for (; nd; nd = nd->tn_next)
+      if (nd->tn_tick < mintick)
+        mintick = nd->tn_tick;
+  };
+  for (int lev=1; lev<RPS_TIMERWHEEL_LEVELS; lev++)
+    for (unsigned ix=0; ix<RPS_TIMERWHEEL_NBSLOTS; ix++)
+      minlist(tw.tw_slots[lev][ix]);
+  minlist(tw.tw_far);
+  RPS_ASSERT(mintick != UINT64_MAX);
+  return (mintick < tw.tw_curtick)?tw.tw_curtick:mintick;
+} // end rps_timerwheel_next_tick
+
+/// move the current tick forward to newtick, under tw_mtx; no timer
+/// may expire before newtick, so the skipped level 0 slots are empty
+static void
+rps_timerwheel_advance(uint64_t newtick)
+{
+  auto& tw = rps_timerwheel;
+  RPS_ASSERT(newtick >= tw.tw_curtick);
+  bool sameblock = (newtick >> RPS_TIMERWHEEL_SLOTBITS)
+                   == (tw.tw_curtick >> RPS_TIMERWHEEL_SLOTBITS);
+  tw.tw_curtick = newtick;
+  if (sameblock)
+    return;
+  for (int lev=1; lev<RPS_TIMERWHEEL_LEVELS; lev++)
+    for (unsigned ix=0; ix<RPS_TIMERWHEEL_NBSLOTS; ix++)
+      if (tw.tw_slots[lev][ix])
+        rps_timerwheel_cascade(&tw.tw_slots[lev][ix]);
+  rps_timerwheel_cascade(&tw.tw_far);
+} // end rps_timerwheel_advance
+
+/// arm the timerfd for the next wheel step, under tw_mtx
+static void
+rps_timerwheel_rearm_locked(void)
+{
+  auto& tw = rps_timerwheel;
+  int timfd = rps_eventloopdata.eld_timfd;
+  if (timfd < 0)
+    return;
+  uint64_t nextick = rps_timerwheel_next_tick();
+  if (nextick == tw.tw_armedtick)
+    return;
+  struct itimerspec its;
+  memset (&its, 0, sizeof(its));
+  if (nextick > 0)
+    {
+      its.it_value.tv_sec = nextick / 1000;
+      its.it_value.tv_nsec = (nextick % 1000) * 1000000;
+    }
+  if (timerfd_settime(timfd, TFD_TIMER_ABSTIME, &its, nullptr))
+    RPS_FATALOUT("rps_timerwheel_rearm_locked failed to timerfd_settime timerfd#"
+                 << timfd << ":" << strerror(errno));
+  tw.tw_armedtick = nextick;
+} // end rps_timerwheel_rearm_locked
+
+static void
+rps_timerwheel_rearm(void)
+{
+  std::lock_guard<std::mutex> gu(rps_timerwheel.tw_mtx);
+  rps_timerwheel.tw_armedtick = 0;
+  rps_timerwheel_rearm_locked();
+} // end rps_timerwheel_rearm
+
+static Rps_TimerWheel::timer_id_t
+rps_timerwheel_schedule(double deadline, Rps_ClosureValue clos,
+                        Rps_Agenda::agenda_prio_en prio, Rps_ObjectRef obtasklet)
+{
+  auto& tw = rps_timerwheel;
+  std::lock_guard<std::mutex> gu(tw.tw_mtx);
+  /// an empty wheel restarts from now, whatever its stale tick
+  if (tw.tw_nodemap.empty())
+    tw.tw_curtick = rps_timerwheel_tick_of_time(rps_monotonic_real_time());
+  struct rps_timer_node_st*nd = new rps_timer_node_st;
+  nd->tn_id = ++tw.tw_lastid;
+  nd->tn_tick = rps_timerwheel_tick_of_time(deadline);
+  nd->tn_clos = clos;
+  nd->tn_obtasklet = obtasklet;
+  nd->tn_prio = prio;
+  rps_timerwheel_place(nd);
+  tw.tw_nodemap.insert({nd->tn_id, nd});
+  if (tw.tw_armedtick == 0 || nd->tn_tick < tw.tw_armedtick)
+    rps_timerwheel_rearm_locked();
+  return nd->tn_id;
+} // end rps_timerwheel_schedule
+
+Rps_TimerWheel::timer_id_t
+Rps_TimerWheel::schedule_closure_at(double deadline, Rps_ClosureValue clos)
+{
+  RPS_ASSERT(clos);
+  return rps_timerwheel_schedule(deadline, clos,
+                                 Rps_Agenda::AgPrio__None, Rps_ObjectRef(nullptr));
+} // end Rps_TimerWheel::schedule_closure_at
+
+Rps_TimerWheel::timer_id_t
+Rps_TimerWheel::schedule_closure_after(double delay, Rps_ClosureValue clos)
+{
+  return schedule_closure_at(rps_monotonic_real_time() + delay, clos);
+} // end Rps_TimerWheel::schedule_closure_after
+
+Rps_TimerWheel::timer_id_t
+Rps_TimerWheel::schedule_tasklet_at(double deadline, Rps_Agenda::agenda_prio_en prio,
+                                    Rps_ObjectRef obtasklet)
+{
+  RPS_ASSERT(obtasklet);
+  RPS_ASSERT(prio > Rps_Agenda::AgPrio__None && prio < Rps_Agenda::AgPrio__Last);
+  return rps_timerwheel_schedule(deadline, Rps_ClosureValue(nullptr), prio, obtasklet);
+} // end Rps_TimerWheel::schedule_tasklet_at
+
+Rps_TimerWheel::timer_id_t
+Rps_TimerWheel::schedule_tasklet_after(double delay, Rps_Agenda::agenda_prio_en prio,
+                                       Rps_ObjectRef obtasklet)
+{
+  return schedule_tasklet_at(rps_monotonic_real_time() + delay, prio, obtasklet);
+} // end Rps_TimerWheel::schedule_tasklet_after
+
+bool
+Rps_TimerWheel::cancel(timer_id_t tid)
+{
+  auto& tw = rps_timerwheel;
+  std::lock_guard<std::mutex> gu(tw.tw_mtx);
+  auto it = tw.tw_nodemap.find(tid);
+  if (it == tw.tw_nodemap.end())
+    return false;
+  struct rps_timer_node_st*nd = it->second;
+  tw.tw_nodemap.erase(it);
+  rps_timerwheel_unlink(nd);
+  delete nd;
+  /// the timerfd may stay armed, an early wakeup is harmless
+  return true;
+} // end Rps_TimerWheel::cancel
+
+unsigned
+Rps_TimerWheel::nb_pending_timers(void)
+{
+  std::lock_guard<std::mutex> gu(rps_timerwheel.tw_mtx);
+  return rps_timerwheel.tw_nodemap.size();
+} // end Rps_TimerWheel::nb_pending_timers
+
 void
-handle_self_pipe_byte_rps(unsigned char b)
+Rps_TimerWheel::gc_mark(Rps_GarbageCollector&gc)
+{
+  std::lock_guard<std::mutex> gu(rps_timerwheel.tw_mtx);
+  for (auto it: rps_timerwheel.tw_nodemap)
+    {
+      struct rps_timer_node_st*nd = it.second;
+      if (nd->tn_clos)
+        gc.mark_value(nd->tn_clos);
+      if (nd->tn_obtasklet)
+        gc.mark_obj(nd->tn_obtasklet);
+    }
+} // end Rps_TimerWheel::gc_mark
+
+void
+Rps_TimerWheel::fire_expired_timers(Rps_CallFrame*callframe)
+{
+  auto& tw = rps_timerwheel;
+  RPS_LOCALFRAME(RPS_CALL_FRAME_UNDESCRIBED,
+                 callframe,
+                 Rps_ClosureValue clos;
+                 Rps_ObjectRef obtasklet;
+                );
+  struct fired_timer_st
+  {
+    Rps_TimerWheel::timer_id_t ft_id;
+    Rps_ClosureValue ft_clos;
+    Rps_ObjectRef ft_obtasklet;
+    Rps_Agenda::agenda_prio_en ft_prio;
+  };
+  /// the fired timers are no longer in the wheel, so those not yet run
+  /// are marked here while earlier callbacks run
+  std::vector<fired_timer_st> firedvec;
+  unsigned firedix = 0;
+  _.set_additional_gc_marker([&](Rps_GarbageCollector*gc)
+  {
+    for (unsigned ix=firedix; ix<firedvec.size(); ix++)
+      {
+        if (firedvec[ix].ft_clos)
+          gc->mark_value(firedvec[ix].ft_clos);
+        if (firedvec[ix].ft_obtasklet)
+          gc->mark_obj(firedvec[ix].ft_obtasklet);
+      }
+  });
+  {
+    std::lock_guard<std::mutex> gu(tw.tw_mtx);
+    uint64_t nowtick = rps_timerwheel_tick_of_time(rps_monotonic_real_time());
+    /// jump from one expired deadline to the next, not tick by tick
+    for (;;)
+      {
+        uint64_t t = rps_timerwheel_next_tick();
+        if (t == 0 || t > nowtick)
+          break;
+        rps_timerwheel_advance(t);
+        struct rps_timer_node_st** phead = &tw.tw_slots[0][t & RPS_TIMERWHEEL_SLOTMASK];
+        while (*phead)
+          {
+            struct rps_timer_node_st*nd = *phead;
+            rps_timerwheel_unlink(nd);
+            tw.tw_nodemap.erase(nd->tn_id);
+            firedvec.push_back(fired_timer_st{nd->tn_id, nd->tn_clos,
+                                              nd->tn_obtasklet, nd->tn_prio});
+            delete nd;
+          };
+      };
+    if (tw.tw_curtick <= nowtick)
+      rps_timerwheel_advance(nowtick+1);
+    tw.tw_armedtick = 0;
+    rps_timerwheel_rearm_locked();
+  }
+  while (firedix < firedvec.size())
+    {
+      const fired_timer_st& ft = firedvec[firedix];
+      RPS_DEBUG_LOG(EVENT_LOOP, "Rps_TimerWheel::fire_expired_timers timer#" << ft.ft_id);
+      _f.clos = ft.ft_clos;
+      _f.obtasklet = ft.ft_obtasklet;
+      Rps_Agenda::agenda_prio_en prio = ft.ft_prio;
+      Rps_TimerWheel::timer_id_t tid = ft.ft_id;
+      firedix++;
+      if (_f.clos)
+        _f.clos.apply1(&_, Rps_Value((intptr_t)tid));
+      else if (_f.obtasklet)
+        Rps_Agenda::add_tasklet(prio, _f.obtasklet);
+    };
+  _.clear_additional_gc_marker();
+} // end Rps_TimerWheel::fire_expired_timers
+
+
+
+void
+handle_main_message_rps(Rps_CallFrame*cf, struct rps_main_message_st& msg,
+                        Rps_ClosureValue clos, Rps_Value arg0, Rps_Value arg1)
 {
   RPS_ASSERT(rps_is_main_thread());
-  RPS_DEBUG_LOG(REPL, "handle_self_pipe_byte_rps b=" << (char)b
-                << "#" << (unsigned)b
+  RPS_LOCALFRAME(RPS_CALL_FRAME_UNDESCRIBED,
+                 cf,
+                 Rps_ClosureValue clos;
+                 Rps_Value arg0;
+                 Rps_Value arg1;
+                );
+  RPS_DEBUG_LOG(REPL, "handle_main_message_rps code=" << (char)msg.mm_code
+                << "#" << (unsigned)msg.mm_code
                 << " thread:" << rps_current_pthread_name());
-  switch (b)
+  switch (msg.mm_code)
     {
-    case SelfPipe_Dump:
+    case MainMsg_Closure:
+      _f.clos = clos;
+      _f.arg0 = arg0;
+      _f.arg1 = arg1;
+      _f.clos.apply2(&_, _f.arg0, _f.arg1);
+      break;
+    case MainMsg_Function:
+      msg.mm_fun(&_);
+      break;
+    case MainMsg_Dump:
       rps_dump_into (rps_get_loaddir());
       break;
-    case SelfPipe_GarbColl:
+    case MainMsg_GarbColl:
       rps_garbage_collect();
       break;
-    case SelfPipe_Quit:
+    case MainMsg_Quit:
       rps_do_stop_event_loop();
       break;
-    case SelfPipe_Exit:
+    case MainMsg_Exit:
       rps_dump_into (rps_get_loaddir());
       rps_do_stop_event_loop();
       break;
-    case SelfPipe_Process:
+    case MainMsg_Process:
 #warning should call something from transientobj_rps.cc to perhaps fork a process related to some Rps_PayloadUnixProcess
     /* TODO: see Rps_PayloadUnixProcess::queue_of_runnable_processes
     in transientobj_rps.cc; the dormant processes should somehow
     be started by fork/exec */
     default:
-      RPS_FATALOUT("unexpected byte " << (char)b << "#" << (unsigned)b << " on self pipe");
+      RPS_FATALOUT("unexpected main message " << (char)msg.mm_code
+                   << "#" << (unsigned)msg.mm_code);
     };
-} // end handle_self_pipe_byte_rps
+} // end handle_main_message_rps
 
 bool
 rps_event_loop_is_running(void)
@@ -1227,7 +1705,7 @@ rps_postpone_dump(void)
 {
   RPS_DEBUG_LOG(REPL, "rps_postpone_dump thread:"
                 << rps_current_pthread_name());
-  rps_self_pipe_write_byte(SelfPipe_Dump);
+  rps_main_channel_post_code(MainMsg_Dump);
 } // end rps_postpone_dump
 
 void
@@ -1235,7 +1713,7 @@ rps_postpone_garbage_collection(void)
 {
   RPS_DEBUG_LOG(REPL, "rps_postpone_garbage_collection thread:"
                 << rps_current_pthread_name());
-  rps_self_pipe_write_byte(SelfPipe_GarbColl);
+  rps_main_channel_post_code(MainMsg_GarbColl);
 } // end rps_postpone_garbage_collection
 
 void
@@ -1243,7 +1721,7 @@ rps_postpone_quit(void)
 {
   RPS_DEBUG_LOG(REPL, "rps_postpone_quit thread:"
                 << rps_current_pthread_name());
-  rps_self_pipe_write_byte(SelfPipe_Quit);
+  rps_main_channel_post_code(MainMsg_Quit);
 } // end rps_postpone_quit
 
 void
@@ -1251,7 +1729,7 @@ rps_postpone_exit_with_dump(void)
 {
   RPS_DEBUG_LOG(REPL, "rps_postpone_exit_with_dump thread:"
                 << rps_current_pthread_name());
-  rps_self_pipe_write_byte(SelfPipe_Exit);
+  rps_main_channel_post_code(MainMsg_Exit);
 } // end rps_postpone_exit_with_dump
 
 
@@ -1260,7 +1738,7 @@ rps_postpone_child_process(void)
 {
   RPS_DEBUG_LOG(REPL, "rps_postpone_child_process thread:"
                 << rps_current_pthread_name());
-  rps_self_pipe_write_byte(SelfPipe_Process);
+  rps_main_channel_post_code(MainMsg_Process);
 } // end rps_postpone_child_process
 
 /// end of file eventloop_rps.cc
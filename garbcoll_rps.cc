@@ -50,7 +50,7 @@ Rps_GarbageCollector::Rps_GarbageCollector(const std::function<void(Rps_GarbageC
   gc_mtx(), gc_running(false), gc_magic(_gc_magicnum_),
   gc_rootmarkers(rootmarkers),
   gc_obscanque(),
-  gc_nbscan(0), gc_nbmark(0), gc_nbdelete(0), gc_nbroots(0),
+  gc_nbscan(0), gc_nbmark(0), gc_nbdelete(0), gc_nbroots(0), gc_nblivewords(0),
   gc_startrealtime(rps_wallclock_real_time()),
   gc_startelapsedtime(rps_elapsed_real_time()),
   gc_startprocesstime(rps_process_cpu_time())
@@ -82,11 +82,14 @@ Rps_CallFrame::gc_mark_frame(Rps_GarbageCollector* gc)
     cfram_state.as_ptr()->gc_mark(*gc,0);
   if (cfram_clos)
     cfram_clos.as_ptr()->gc_mark(*gc,0);
-  if (cfram_marker)
-    cfram_marker(gc);
+  if (cfram_markfun)
+    (*cfram_markfun)(gc, cfram_markdata);
   unsigned siz=cfram_size;
-  if (cfram_xtradata)
+  if (cfram_xtradata && cfram_fieldsmarker)
+    (*cfram_fieldsmarker)(gc, cfram_xtradata);
+  else if (cfram_xtradata)
     {
+      /// conservative scan, e.g. for Rps_SizedCallFrame
       void**frdata = reinterpret_cast<void**>(cfram_xtradata);
       for (unsigned ix=0; ix<siz; ix++)
         {
@@ -121,18 +124,75 @@ Rps_CallFrame::output(std::ostream&out, unsigned depth, unsigned maxdepth) const
 } // end of Rps_CallFrame::output i.e. Rps_ProtoCallFrame::output
 
 
-static std::atomic<bool> rps_gc_forbidden;
+/// helpers of rps_callframe_benchmark, not inlined so that each call
+/// really pushes and pops its frame
+static __attribute__((noinline)) intptr_t
+rps_callframe_bench_regular(Rps_CallFrame*callerframe, intptr_t n)
+{
+  RPS_LOCALFRAME(RPS_CALL_FRAME_UNDESCRIBED,
+                 callerframe,
+                 Rps_Value val;
+                 Rps_ObjectRef ob;
+                );
+  _f.val = Rps_Value(n, Rps_Value::Rps_IntTag{});
+  return _f.val.as_int() + 1;
+} // end rps_callframe_bench_regular
+
+static __attribute__((noinline)) intptr_t
+rps_callframe_bench_lean(Rps_CallFrame*callerframe, intptr_t n)
+{
+  RPS_LEANLOCALFRAME(RPS_CALL_FRAME_UNDESCRIBED,
+                     callerframe,
+                     Rps_Value val;
+                     Rps_ObjectRef ob;
+                    );
+  _f.val = Rps_Value(n, Rps_Value::Rps_IntTag{});
+  return _f.val.as_int() + 1;
+} // end rps_callframe_bench_lean
+
+void
+rps_callframe_benchmark(Rps_CallFrame*callerframe, unsigned nbloops)
+{
+  RPS_ASSERT_CALLFRAME (callerframe);
+  if (nbloops == 0)
+    nbloops = 1;
+  intptr_t regsum = 0, leansum = 0;
+  double regstart = rps_monotonic_real_time();
+  for (unsigned n=0; n<nbloops; n++)
+    regsum += rps_callframe_bench_regular(callerframe, n);
+  double regend = rps_monotonic_real_time();
+  for (unsigned n=0; n<nbloops; n++)
+    leansum += rps_callframe_bench_lean(callerframe, n);
+  double leanend = rps_monotonic_real_time();
+  RPS_ASSERT(regsum == leansum);
+  RPS_DEBUG_LOG(LOWREP, "rps_callframe_benchmark " << nbloops
+                << " frames pushed and popped: regular "
+                << (1.0e9*(regend - regstart)/nbloops) << " ns, lean "
+                << (1.0e9*(leanend - regend)/nbloops) << " ns each");
+} // end rps_callframe_benchmark
+
+
+/// the garbage collection is forbidden while rps_gc_forbid_count is
+/// positive; forbidding it waits for a running collection to end
+static std::mutex rps_gc_forbid_mtx;
+static std::condition_variable rps_gc_forbid_condvar;
+static int rps_gc_forbid_count;
+static bool rps_gc_in_progress;
 
 void
 rps_forbid_garbage_collection(void)
 {
-  rps_gc_forbidden.store(true);
+  std::unique_lock<std::mutex> gu(rps_gc_forbid_mtx);
+  rps_gc_forbid_condvar.wait(gu, [] { return !rps_gc_in_progress; });
+  rps_gc_forbid_count++;
 } // end rps_forbid_garbage_collection
 
 void
 rps_allow_garbage_collection(void)
 {
-  rps_gc_forbidden.store(false);
+  std::lock_guard<std::mutex> gu(rps_gc_forbid_mtx);
+  RPS_ASSERT(rps_gc_forbid_count > 0);
+  rps_gc_forbid_count--;
 } // end rps_allow_garbage_collection
 
 /* The top level function to call the garbage collector; the optional
@@ -142,13 +202,17 @@ rps_allow_garbage_collection(void)
 void
 rps_garbage_collect (std::function<void(Rps_GarbageCollector*)>* pfun)
 {
-  if (rps_gc_forbidden.load())
-    {
-      RPS_WARNOUT("garbage collection is forbidden from "
-                  <<  rps_current_pthread_name() << std::endl
-                  << RPS_FULL_BACKTRACE_HERE(1, "rps_garbage_collect"));
-      return;
-    };
+  {
+    std::lock_guard<std::mutex> gu(rps_gc_forbid_mtx);
+    if (rps_gc_forbid_count > 0)
+      {
+        RPS_WARNOUT("garbage collection is forbidden from "
+                    <<  rps_current_pthread_name() << std::endl
+                    << RPS_FULL_BACKTRACE_HERE(1, "rps_garbage_collect"));
+        return;
+      };
+    rps_gc_in_progress = true;
+  }
 #warning TODO: we might want to wait half a second in rps_garbage_collect
   // e.g. in generated or hand-written plugins) since in some C++ code
   // (e.g. called by graphical toolkits or numerical routines),
@@ -167,10 +231,21 @@ rps_garbage_collect (std::function<void(Rps_GarbageCollector*)>* pfun)
              gcnt);
   the_gc.run_gc();
   auto nbroots = the_gc.nb_roots();
+  {
+    std::lock_guard<std::mutex> gu(rps_gc_forbid_mtx);
+    rps_gc_in_progress = false;
+  }
+  rps_gc_forbid_condvar.notify_all();
   RPS_INFORM("rps_garbage_collect completed; count#%ld, %ld roots, %ld scans,"
              " %ld marks, %ld deletions, real %.3f, cpu %.3f sec",
              gcnt, (long) nbroots, (long)(the_gc.nb_scans()),  (long)(the_gc.nb_marks()),  (long)(the_gc.nb_deletions()),
              the_gc.elapsed_time(), the_gc.process_time());
+  /// the heap census, with the containers counted by Rps_CountingAllocator
+  RPS_INFORM("rps_garbage_collect census; count#%ld, %ld live zone words,"
+             " %ld external container words, %ld interned strings",
+             gcnt, (long)(the_gc.nb_live_words()),
+             (long)Rps_QuasiZone::external_live_wordcount(),
+             (long)Rps_String::nb_interned());
 } // end of rps_garbage_collect
 
 void
@@ -193,6 +268,7 @@ Rps_GarbageCollector::mark_gcroots(void)
     this->mark_root_objectref(obr);
   });
   rps_garbcoll_application(*this);
+  rps_jit_gc_mark(*this);
   ///
   /// mark the hardcoded global roots
 #define RPS_INSTALL_ROOT_OB(Oid)    {     \
@@ -216,6 +292,9 @@ Rps_GarbageCollector::mark_gcroots(void)
     this->mark_root_objectref(rpskob##Oid); \
 };
   Rps_PayloadUnixProcess::gc_mark_active_processes(*this);
+  Rps_AsyncFileIo::gc_mark(*this);
+  Rps_TimerWheel::gc_mark(*this);
+  rps_event_loop_gc_mark_main_channel(*this);
 #include "generated/rps-constants.hh"
   ///
   if (gc_rootmarkers)
@@ -235,6 +314,7 @@ Rps_GarbageCollector::run_gc(void)
     Rps_QuasiZone::clear_all_gcmarks(gc);
     gc.mark_gcroots();
     Rps_PayloadSymbol::gc_mark_strong_symbols(&gc);
+    Rps_PayloadEnvironment::gc_mark_scope_layouts(gc);
     while (!gc.gc_obscanque.empty())
       {
         auto obfront = gc.gc_obscanque.front();
@@ -243,6 +323,9 @@ Rps_GarbageCollector::run_gc(void)
         obfront->mark_gc_inside(gc);
         gc.gc_nbscan++;
       };
+    Rps_String::gc_clear_dead_interned(gc);
+    rps_repl_compiled_forget_dead(gc);
+    rps_jit_forget_dead(gc);
   });
   Rps_QuasiZone::every_zone
   (*this,
@@ -250,7 +333,10 @@ Rps_GarbageCollector::run_gc(void)
   {
     gc.gc_nbmark++;
     if (qz->is_gcmarked(gc))
-      return;
+      {
+        gc.gc_nblivewords += qz->wordsize();
+        return;
+      }
     RPS_ASSERT(Rps_QuasiZone::raw_nth_zone(qz->qz_rank,gc) == qz);
     delete qz;
     gc.gc_nbdelete++;
@@ -83,6 +83,13 @@ class Rps_PayloadGccjit : public Rps_Payload
   /// code and the gccjit::object-s for them.
   /// TODO: document the representation of GCCJIT code.
   std::map<Rps_ObjectRef, struct gcc_jit_object*> _gji_rpsobj2jit;
+  /// The routines emitted for connectives, and the values used as
+  /// constants in their code.
+  std::map<Rps_ObjectRef, struct gcc_jit_function*> _gji_routines;
+  std::vector<Rps_Value> _gji_constants;
+  /// the number of frame slots of each routine
+  std::map<struct gcc_jit_function*, unsigned> _gji_nbslots;
+  bool _gji_compiled;
   friend Rps_PayloadGccjit*
   Rps_QuasiZone::rps_allocate1<Rps_PayloadGccjit,Rps_ObjectZone*>(Rps_ObjectZone*);
 public:
@@ -129,6 +136,61 @@ public:
   struct gcc_jit_location* make_rpsobj_location(Rps_ObjectRef ob, int line, int col=0);
   void locked_register_object_jit(Rps_ObjectRef ob,  struct gcc_jit_object* jit);
   void locked_unregister_object_jit(Rps_ObjectRef ob);
+  ///
+  //////////////// GCCJIT ROUTINES
+  /// A routine is the machine code of the applying function of some
+  /// connective; it has the signature of rps_jitroutine_t and its
+  /// parameters are ranked as below.
+  enum routine_param_en
+  {
+    routparam_callframe,
+    routparam_closure,
+    routparam_arg0,
+    routparam_arg1,
+    routparam_arg2,
+    routparam_arg3,
+    routparam_restargs,
+    routparam_slots,
+    routparam_results,
+    routparam__last
+  };
+  /// the type of raw value words
+  struct gcc_jit_type* value_word_type(void)
+  {
+    return raw_get_gccjit_builtin_type(GCC_JIT_TYPE_VOID_PTR);
+  };
+  struct gcc_jit_function* locked_new_routine(Rps_ObjectRef obconn, struct gcc_jit_location* loc=nullptr);
+  struct gcc_jit_rvalue* routine_param(struct gcc_jit_function* fun, enum routine_param_en rank);
+  /// The slots of the routine frame, see rps_jitroutine_t; slot 0
+  /// has the closure and slots 1 to 4 the arguments.  Every value
+  /// live across a call to the runtime should be kept in a slot.
+  unsigned locked_new_slot(struct gcc_jit_function* fun);
+  struct gcc_jit_lvalue* routine_slot(struct gcc_jit_function* fun, unsigned slotix,
+                                      struct gcc_jit_location* loc=nullptr);
+  /// a value constant, kept alive as long as the code using it
+  struct gcc_jit_rvalue* locked_value_constant(Rps_Value val);
+  /// add to a block a call to the runtime applying a closure or
+  /// sending a message with up to four arguments; the main result is
+  /// stored in a new slot, whose rvalue is given
+  struct gcc_jit_rvalue* locked_add_apply_call(struct gcc_jit_function* fun,
+      struct gcc_jit_block* block,
+      struct gcc_jit_rvalue* closure,
+      const std::vector<struct gcc_jit_rvalue*>& args,
+      struct gcc_jit_location* loc=nullptr);
+  struct gcc_jit_rvalue* locked_add_send_call(struct gcc_jit_function* fun,
+      struct gcc_jit_block* block,
+      struct gcc_jit_rvalue* receiver, Rps_ObjectRef obselector,
+      const std::vector<struct gcc_jit_rvalue*>& args,
+      struct gcc_jit_location* loc=nullptr);
+  /// end a block of a routine by returning two values (the xtra one
+  /// might be null)
+  void locked_end_routine_block(struct gcc_jit_function* fun, struct gcc_jit_block* block,
+                                struct gcc_jit_rvalue* mainres, struct gcc_jit_rvalue* xtrares,
+                                struct gcc_jit_location* loc=nullptr);
+  /// compile in memory all the routines, and install them in their
+  /// connectives; gives the number of installed routines, or -1 on
+  /// failure
+  int locked_compile_and_install(void);
 protected:
   void load_jit_json(Rps_Loader*ld, Rps_Id spacid, unsigned lineno, Json::Value&jseq);
   void raw_register_object_jit(Rps_ObjectRef ob, struct gcc_jit_object* jit);
@@ -174,9 +236,17 @@ protected:
 
 Rps_PayloadGccjit::Rps_PayloadGccjit(Rps_ObjectZone*owner)
   : Rps_Payload(Rps_Type::PaylGccjit,owner), // is that thread-safe?
-    _gji_ctxt(rps_gccjit_top_ctxt),
-    _gji_rpsobj2jit()
+    _gji_ctxt(gcc_jit_context_new_child_context(rps_gccjit_top_ctxt)),
+    _gji_rpsobj2jit(),
+    _gji_routines(),
+    _gji_constants(),
+    _gji_nbslots(),
+    _gji_compiled(false)
 {
+  gcc_jit_context_set_int_option(_gji_ctxt,
+                                 GCC_JIT_INT_OPTION_OPTIMIZATION_LEVEL, 2);
+  /// so C++ exceptions thrown by the runtime can go thru routines
+  gcc_jit_context_add_command_line_option(_gji_ctxt, "-fexceptions");
 #warning incomplete Rps_PayloadGccjit::Rps_PayloadGccjit
 } // end of Rps_PayloadGccjit::Rps_PayloadGccjit
 
@@ -467,6 +537,481 @@ Rps_PayloadGccjit::load_jit_json(Rps_Loader*ld, Rps_Id spacid, unsigned lineno,
 } // end Rps_PayloadGccjit::load_jit_json
 
 
+////////////////////////////////////////////////////////////////
+////// emitting routines
+
+struct gcc_jit_function*
+Rps_PayloadGccjit::locked_new_routine(Rps_ObjectRef obconn, struct gcc_jit_location* loc)
+{
+  RPS_ASSERT(owner());
+  RPS_ASSERT(obconn);
+  std::lock_guard<std::recursive_mutex> guown(*owner()->objmtxptr());
+  if (_gji_compiled)
+    throw RPS_RUNTIME_ERROR_OUT("Rps_PayloadGccjit::locked_new_routine in already compiled "
+                                << owner() << " for connective " << obconn);
+  if (_gji_routines.find(obconn) != _gji_routines.end())
+    throw RPS_RUNTIME_ERROR_OUT("Rps_PayloadGccjit::locked_new_routine in "
+                                << owner() << " for connective " << obconn
+                                << " already having a routine");
+  struct gcc_jit_type* wordty = value_word_type();
+  struct gcc_jit_type* paramtypes[routparam__last];
+  for (int ix=0; ix<(int)routparam__last; ix++)
+    paramtypes[ix] = wordty;
+  paramtypes[routparam_slots] = raw_get_gccjit_pointer_type(wordty);
+  paramtypes[routparam_results] = raw_get_gccjit_pointer_type(wordty);
+  static const char*const paramnames[routparam__last] =
+  {
+    "rpsj_callframe", "rpsj_closure",
+    "rpsj_arg0", "rpsj_arg1", "rpsj_arg2", "rpsj_arg3",
+    "rpsj_restargs", "rpsj_slots", "rpsj_results"
+  };
+  struct gcc_jit_param* params[routparam__last];
+  for (int ix=0; ix<(int)routparam__last; ix++)
+    params[ix] = gcc_jit_context_new_param(_gji_ctxt, loc, paramtypes[ix], paramnames[ix]);
+  std::string funame = std::string("rpsjit") + obconn->oid().to_string();
+  struct gcc_jit_function* fun
+    = gcc_jit_context_new_function(_gji_ctxt, loc, GCC_JIT_FUNCTION_EXPORTED,
+                                   raw_get_gccjit_builtin_type(GCC_JIT_TYPE_VOID),
+                                   funame.c_str(), (int)routparam__last, params,
+                                   /*is_variadic:*/0);
+  _gji_routines.insert({obconn, fun});
+  _gji_nbslots.insert({fun, rps_jit_arg_slots});
+  raw_register_object_jit(obconn, gcc_jit_function_as_object(fun));
+  RPS_DEBUG_LOG(CODEGEN, "Rps_PayloadGccjit::locked_new_routine " << funame
+                << " in " << owner());
+  return fun;
+} // end Rps_PayloadGccjit::locked_new_routine
+
+struct gcc_jit_rvalue*
+Rps_PayloadGccjit::routine_param(struct gcc_jit_function* fun, enum routine_param_en rank)
+{
+  RPS_ASSERT(fun);
+  RPS_ASSERT(rank >= 0 && rank < routparam__last);
+  return gcc_jit_param_as_rvalue(gcc_jit_function_get_param(fun, (int)rank));
+} // end Rps_PayloadGccjit::routine_param
+
+unsigned
+Rps_PayloadGccjit::locked_new_slot(struct gcc_jit_function* fun)
+{
+  RPS_ASSERT(owner());
+  RPS_ASSERT(fun);
+  std::lock_guard<std::recursive_mutex> guown(*owner()->objmtxptr());
+  auto it = _gji_nbslots.find(fun);
+  RPS_ASSERT(it != _gji_nbslots.end());
+  if (it->second >= rps_jit_max_slots)
+    throw RPS_RUNTIME_ERROR_OUT("Rps_PayloadGccjit::locked_new_slot in "
+                                << owner() << " too many slots");
+  return it->second++;
+} // end Rps_PayloadGccjit::locked_new_slot
+
+struct gcc_jit_lvalue*
+Rps_PayloadGccjit::routine_slot(struct gcc_jit_function* fun, unsigned slotix,
+                                struct gcc_jit_location* loc)
+{
+  RPS_ASSERT(fun);
+  RPS_ASSERT(slotix < rps_jit_max_slots);
+  return gcc_jit_context_new_array_access
+         (_gji_ctxt, loc, routine_param(fun, routparam_slots),
+          gcc_jit_context_new_rvalue_from_int(_gji_ctxt,
+              raw_get_gccjit_builtin_type(GCC_JIT_TYPE_INT),
+              (int)slotix));
+} // end Rps_PayloadGccjit::routine_slot
+
+struct gcc_jit_rvalue*
+Rps_PayloadGccjit::locked_value_constant(Rps_Value val)
+{
+  RPS_ASSERT(owner());
+  std::lock_guard<std::recursive_mutex> guown(*owner()->objmtxptr());
+  if (val.is_empty())
+    return gcc_jit_context_null(_gji_ctxt, value_word_type());
+  _gji_constants.push_back(val);
+  return gcc_jit_context_new_rvalue_from_ptr(_gji_ctxt, value_word_type(),
+         const_cast<void*>(val.unsafe_wptr()));
+} // end Rps_PayloadGccjit::locked_value_constant
+
+struct gcc_jit_rvalue*
+Rps_PayloadGccjit::locked_add_apply_call(struct gcc_jit_function* fun,
+    struct gcc_jit_block* block,
+    struct gcc_jit_rvalue* closure,
+    const std::vector<struct gcc_jit_rvalue*>& args,
+    struct gcc_jit_location* loc)
+{
+  RPS_ASSERT(owner());
+  RPS_ASSERT(fun);
+  RPS_ASSERT(block);
+  RPS_ASSERT(closure);
+  if (args.size() > 4)
+    throw RPS_RUNTIME_ERROR_OUT("Rps_PayloadGccjit::locked_add_apply_call in "
+                                << owner() << " with too many arguments: " << args.size());
+  std::lock_guard<std::recursive_mutex> guown(*owner()->objmtxptr());
+  struct gcc_jit_type* wordty = value_word_type();
+  struct gcc_jit_type* argtypes[6] = {wordty, wordty, wordty, wordty, wordty, wordty};
+  struct gcc_jit_type* funty =
+    gcc_jit_context_new_function_ptr_type(_gji_ctxt, loc, wordty, 6, argtypes, 0);
+  struct gcc_jit_rvalue* callargs[6] =
+  {
+    routine_param(fun, routparam_callframe), closure,
+    nullptr, nullptr, nullptr, nullptr
+  };
+  for (int ix=0; ix<4; ix++)
+    callargs[2+ix] = (ix < (int)args.size() && args[ix])
+                     ? args[ix] : gcc_jit_context_null(_gji_ctxt, wordty);
+  struct gcc_jit_lvalue* reslv = routine_slot(fun, locked_new_slot(fun), loc);
+  gcc_jit_block_add_assignment
+  (block, loc, reslv,
+   gcc_jit_context_new_call_through_ptr
+   (_gji_ctxt, loc,
+    gcc_jit_context_new_rvalue_from_ptr(_gji_ctxt, funty,
+                                        (void*)rps_jit_runtime_apply),
+    6, callargs));
+  return gcc_jit_lvalue_as_rvalue(reslv);
+} // end Rps_PayloadGccjit::locked_add_apply_call
+
+struct gcc_jit_rvalue*
+Rps_PayloadGccjit::locked_add_send_call(struct gcc_jit_function* fun,
+                                        struct gcc_jit_block* block,
+                                        struct gcc_jit_rvalue* receiver, Rps_ObjectRef obselector,
+                                        const std::vector<struct gcc_jit_rvalue*>& args,
+                                        struct gcc_jit_location* loc)
+{
+  RPS_ASSERT(owner());
+  RPS_ASSERT(fun);
+  RPS_ASSERT(block);
+  RPS_ASSERT(receiver);
+  RPS_ASSERT(obselector);
+  if (args.size() > 4)
+    throw RPS_RUNTIME_ERROR_OUT("Rps_PayloadGccjit::locked_add_send_call in "
+                                << owner() << " with too many arguments: " << args.size());
+  std::lock_guard<std::recursive_mutex> guown(*owner()->objmtxptr());
+  struct gcc_jit_type* wordty = value_word_type();
+  struct gcc_jit_type* argtypes[7] = {wordty, wordty, wordty, wordty, wordty, wordty, wordty};
+  struct gcc_jit_type* funty =
+    gcc_jit_context_new_function_ptr_type(_gji_ctxt, loc, wordty, 7, argtypes, 0);
+  struct gcc_jit_rvalue* callargs[7] =
+  {
+    routine_param(fun, routparam_callframe), receiver,
+    locked_value_constant(Rps_Value(obselector)),
+    nullptr, nullptr, nullptr, nullptr
+  };
+  for (int ix=0; ix<4; ix++)
+    callargs[3+ix] = (ix < (int)args.size() && args[ix])
+                     ? args[ix] : gcc_jit_context_null(_gji_ctxt, wordty);
+  struct gcc_jit_lvalue* reslv = routine_slot(fun, locked_new_slot(fun), loc);
+  gcc_jit_block_add_assignment
+  (block, loc, reslv,
+   gcc_jit_context_new_call_through_ptr
+   (_gji_ctxt, loc,
+    gcc_jit_context_new_rvalue_from_ptr(_gji_ctxt, funty,
+                                        (void*)rps_jit_runtime_send),
+    7, callargs));
+  return gcc_jit_lvalue_as_rvalue(reslv);
+} // end Rps_PayloadGccjit::locked_add_send_call
+
+void
+Rps_PayloadGccjit::locked_end_routine_block(struct gcc_jit_function* fun, struct gcc_jit_block* block,
+    struct gcc_jit_rvalue* mainres, struct gcc_jit_rvalue* xtrares,
+    struct gcc_jit_location* loc)
+{
+  RPS_ASSERT(owner());
+  RPS_ASSERT(fun);
+  RPS_ASSERT(block);
+  std::lock_guard<std::recursive_mutex> guown(*owner()->objmtxptr());
+  struct gcc_jit_type* wordty = value_word_type();
+  struct gcc_jit_type* intty = raw_get_gccjit_builtin_type(GCC_JIT_TYPE_INT);
+  struct gcc_jit_rvalue* resptr = routine_param(fun, routparam_results);
+  gcc_jit_block_add_assignment
+  (block, loc,
+   gcc_jit_context_new_array_access(_gji_ctxt, loc, resptr,
+                                    gcc_jit_context_new_rvalue_from_long(_gji_ctxt, intty, 0)),
+   mainres?mainres:gcc_jit_context_null(_gji_ctxt, wordty));
+  gcc_jit_block_add_assignment
+  (block, loc,
+   gcc_jit_context_new_array_access(_gji_ctxt, loc, resptr,
+                                    gcc_jit_context_new_rvalue_from_long(_gji_ctxt, intty, 1)),
+   xtrares?xtrares:gcc_jit_context_null(_gji_ctxt, wordty));
+  gcc_jit_block_end_with_void_return(block, loc);
+} // end Rps_PayloadGccjit::locked_end_routine_block
+
+
+
+////////////////////////////////////////////////////////////////
+////// routines (from libgccjit or GNU lightning), installed in their
+////// connectives
+
+struct rps_jit_native_st
+{
+  rps_jitroutine_t* gn_routine;
+  unsigned gn_nbslots;
+  enum rps_jit_tier_en gn_tier;
+  /// the constants used by the code of the routine
+  std::shared_ptr<const std::vector<Rps_Value>> gn_constants;
+  /// the native applying function replaced by the trampoline, if any
+  rps_applyingfun_t* gn_origfun;
+};
+static std::mutex rps_jit_native_mtx;
+static std::unordered_map<const Rps_ObjectZone*,rps_jit_native_st> rps_jit_native_map;
+/// the compilation results are never released while running, since
+/// their code could be running
+static std::vector<struct gcc_jit_result*> rps_gccjit_results_vect;
+
+static Rps_TwoValues
+rps_jit_applying_trampoline(Rps_CallFrame*callerframe,
+                            const Rps_Value arg0, const Rps_Value arg1,
+                            const Rps_Value arg2, const Rps_Value arg3,
+                            const std::vector<Rps_Value>* restargs);
+
+bool
+rps_install_jit_routine(Rps_ObjectZone*obconn, rps_jitroutine_t*routine,
+                        const std::vector<Rps_Value>& constants,
+                        unsigned nbslots,
+                        enum rps_jit_tier_en tier)
+{
+  RPS_ASSERT(obconn);
+  RPS_ASSERT(routine);
+  RPS_ASSERT(nbslots >= rps_jit_arg_slots && nbslots <= rps_jit_max_slots);
+  RPS_ASSERT(tier > RPS_JIT_TIER_NONE);
+  {
+    std::lock_guard<std::mutex> gunat(rps_jit_native_mtx);
+    auto it = rps_jit_native_map.find(obconn);
+    if (it != rps_jit_native_map.end() && it->second.gn_tier > tier)
+      return false;
+    rps_applyingfun_t* origfun = nullptr;
+    if (it != rps_jit_native_map.end())
+      origfun = it->second.gn_origfun;
+    else if (obconn->applying_function() != rps_jit_applying_trampoline)
+      origfun = obconn->applying_function();
+    rps_jit_native_map[obconn]
+      = rps_jit_native_st{routine, nbslots, tier,
+                          std::make_shared<const std::vector<Rps_Value>>(constants),
+                          origfun};
+  }
+  /// a recompiled connective keeps its trampoline, and uses the new
+  /// routine at its next application
+  if (obconn->applying_function() != rps_jit_applying_trampoline)
+    obconn->put_applying_function(rps_jit_applying_trampoline);
+  return true;
+} // end rps_install_jit_routine
+
+enum rps_jit_tier_en
+rps_jit_routine_tier(const Rps_ObjectZone*obconn)
+{
+  std::lock_guard<std::mutex> gunat(rps_jit_native_mtx);
+  auto it = rps_jit_native_map.find(obconn);
+  if (it == rps_jit_native_map.end())
+    return RPS_JIT_TIER_NONE;
+  return it->second.gn_tier;
+} // end rps_jit_routine_tier
+
+rps_applyingfun_t*
+rps_jit_native_applying_function(const Rps_ObjectZone*obconn)
+{
+  RPS_ASSERT(obconn);
+  rps_applyingfun_t* apfun = obconn->applying_function();
+  if (apfun != rps_jit_applying_trampoline)
+    return apfun;
+  std::lock_guard<std::mutex> gunat(rps_jit_native_mtx);
+  auto it = rps_jit_native_map.find(obconn);
+  return (it != rps_jit_native_map.end())?it->second.gn_origfun:nullptr;
+} // end rps_jit_native_applying_function
+
+unsigned
+rps_jit_rebind_original_functions(const std::function<void*(const Rps_ObjectZone*,void*)>&rebindfun)
+{
+  unsigned count = 0;
+  std::lock_guard<std::mutex> gunat(rps_jit_native_mtx);
+  for (auto& it: rps_jit_native_map)
+    {
+      rps_applyingfun_t* oldfun = it.second.gn_origfun;
+      if (!oldfun)
+        continue;
+      rps_applyingfun_t* newfun =
+        reinterpret_cast<rps_applyingfun_t*>(rebindfun(it.first, reinterpret_cast<void*>(oldfun)));
+      if (newfun != oldfun)
+        {
+          it.second.gn_origfun = newfun;
+          count++;
+        };
+    };
+  return count;
+} // end rps_jit_rebind_original_functions
+
+int
+Rps_PayloadGccjit::locked_compile_and_install(void)
+{
+  RPS_ASSERT(owner());
+  std::lock_guard<std::recursive_mutex> guown(*owner()->objmtxptr());
+  if (_gji_compiled)
+    throw RPS_RUNTIME_ERROR_OUT("Rps_PayloadGccjit::locked_compile_and_install already compiled "
+                                << owner());
+  _gji_compiled = true;
+  if (_gji_routines.empty())
+    return 0;
+  double startrealt = rps_wallclock_real_time();
+  struct gcc_jit_result* res = gcc_jit_context_compile(_gji_ctxt);
+  if (!res)
+    {
+      const char*err = gcc_jit_context_get_first_error(_gji_ctxt);
+      RPS_WARNOUT("Rps_PayloadGccjit::locked_compile_and_install failed to compile "
+                  << _gji_routines.size() << " routines in " << owner()
+                  << " : " << (err?err:"?"));
+      return -1;
+    };
+  {
+    std::lock_guard<std::mutex> gunat(rps_jit_native_mtx);
+    rps_gccjit_results_vect.push_back(res);
+  }
+  std::vector<Rps_ObjectRef> installedvect;
+  for (auto it: _gji_routines)
+    {
+      Rps_ObjectRef obconn = it.first;
+      std::string funame = std::string("rpsjit") + obconn->oid().to_string();
+      void* code = gcc_jit_result_get_code(res, funame.c_str());
+      if (!code)
+        {
+          RPS_WARNOUT("Rps_PayloadGccjit::locked_compile_and_install no code for "
+                      << funame << " in " << owner());
+          continue;
+        };
+      if (rps_install_jit_routine(obconn.optr(), (rps_jitroutine_t*)code,
+                                  _gji_constants, _gji_nbslots[it.second],
+                                  RPS_JIT_TIER_OPTIMIZED))
+        installedvect.push_back(obconn);
+    };
+  RPS_DEBUG_LOG(CODEGEN, "Rps_PayloadGccjit::locked_compile_and_install installed "
+                << installedvect.size() << " routines from " << owner()
+                << " in " << (rps_wallclock_real_time() - startrealt) << " s");
+  return (int)installedvect.size();
+} // end Rps_PayloadGccjit::locked_compile_and_install
+
+static inline Rps_Value
+rps_gccjit_value_of_word(const void*w)
+{
+  if (((intptr_t)w) & 1)
+    return Rps_Value(((intptr_t)w) >> 1, Rps_Value::Rps_IntTag{});
+  return Rps_Value((const Rps_ZoneValue*)w, Rps_Value::Rps_ValPtrTag{});
+} // end rps_gccjit_value_of_word
+
+static Rps_TwoValues
+rps_jit_applying_trampoline(Rps_CallFrame*callerframe,
+                               const Rps_Value arg0, const Rps_Value arg1,
+                               const Rps_Value arg2, const Rps_Value arg3,
+                               const std::vector<Rps_Value>* restargs)
+{
+  RPS_ASSERT_CALLFRAME (callerframe);
+  Rps_ClosureValue clos = callerframe->call_frame_closure();
+  RPS_ASSERT(!clos.is_empty() && clos.is_closure());
+  Rps_ObjectRef obconn = clos.connob();
+  rps_jitroutine_t* routine = nullptr;
+  unsigned nbslots = 0;
+  {
+    std::lock_guard<std::mutex> gunat(rps_jit_native_mtx);
+    auto it = rps_jit_native_map.find(obconn.optr());
+    if (it != rps_jit_native_map.end())
+      {
+        routine = it->second.gn_routine;
+        nbslots = it->second.gn_nbslots;
+      }
+  }
+  if (!routine)
+    RPS_FATALOUT("rps_jit_applying_trampoline without routine for connective "
+                 << obconn << " of closure " << clos);
+  RPS_LOCALFRAME(obconn,
+                 callerframe,
+                 Rps_Value closv;
+                 Rps_Value mainv;
+                 Rps_Value xtrav;
+                );
+  _f.closv = clos;
+  RPS_ASSERT(nbslots >= rps_jit_arg_slots && nbslots <= rps_jit_max_slots);
+  /// the slots are the words of the routine frame, so are scanned by
+  /// the garbage collector
+  const void* slots[rps_jit_max_slots];
+  memset ((void*)slots, 0, nbslots*sizeof(void*));
+  slots[0] = _f.closv.unsafe_wptr();
+  slots[1] = arg0.unsafe_wptr();
+  slots[2] = arg1.unsafe_wptr();
+  slots[3] = arg2.unsafe_wptr();
+  slots[4] = arg3.unsafe_wptr();
+  const void* results[2] = {nullptr, nullptr};
+  {
+    Rps_ProtoCallFrame jitframe(nbslots, (void*)slots, obconn, &_);
+    jitframe.set_closure(clos);
+    (*routine)(&jitframe, slots[0], slots[1], slots[2], slots[3], slots[4],
+               restargs, slots, results);
+    _f.mainv = rps_gccjit_value_of_word(results[0]);
+    _f.xtrav = rps_gccjit_value_of_word(results[1]);
+  }
+  RPS_LOCALRETURNTWO(_f.mainv, _f.xtrav);
+} // end rps_jit_applying_trampoline
+
+const void*
+rps_jit_runtime_apply(Rps_CallFrame*callframe, const void*closure,
+                         const void*arg0, const void*arg1,
+                         const void*arg2, const void*arg3)
+{
+  RPS_ASSERT_CALLFRAME (callframe);
+  Rps_ClosureValue clos(rps_gccjit_value_of_word(closure));
+  if (clos.is_empty() || !clos.is_closure())
+    return nullptr;
+  Rps_TwoValues res = clos.apply4(callframe,
+                                  rps_gccjit_value_of_word(arg0),
+                                  rps_gccjit_value_of_word(arg1),
+                                  rps_gccjit_value_of_word(arg2),
+                                  rps_gccjit_value_of_word(arg3));
+  return res.main().unsafe_wptr();
+} // end rps_jit_runtime_apply
+
+const void*
+rps_jit_runtime_send(Rps_CallFrame*callframe, const void*receiver,
+                        const void*selector, const void*arg0, const void*arg1,
+                        const void*arg2, const void*arg3)
+{
+  RPS_ASSERT_CALLFRAME (callframe);
+  Rps_Value selv = rps_gccjit_value_of_word(selector);
+  RPS_ASSERT(selv.is_object());
+  Rps_TwoValues res = rps_gccjit_value_of_word(receiver)
+                      .send4(callframe, selv.as_object(),
+                             rps_gccjit_value_of_word(arg0),
+                             rps_gccjit_value_of_word(arg1),
+                             rps_gccjit_value_of_word(arg2),
+                             rps_gccjit_value_of_word(arg3));
+  return res.main().unsafe_wptr();
+} // end rps_jit_runtime_send
+
+/// called by the garbage collector when marking its roots: the
+/// connectives with compiled routines, and the constants of these
+/// routines, stay alive
+void
+rps_jit_gc_mark(Rps_GarbageCollector&gc)
+{
+  /// the connectives themselves are not roots: a compiled routine is
+  /// forgotten with its connective by rps_jit_forget_dead
+  {
+    std::lock_guard<std::mutex> gunat(rps_jit_native_mtx);
+    for (auto& it: rps_jit_native_map)
+      for (const Rps_Value& cstv: *it.second.gn_constants)
+        if (cstv)
+          cstv.gc_mark(gc);
+  }
+  rps_lightning_gc_mark_hot_queue(gc);
+} // end rps_jit_gc_mark
+
+/// called by the garbage collector after marking, before deletion
+void
+rps_jit_forget_dead(Rps_GarbageCollector&gc)
+{
+  std::lock_guard<std::mutex> gunat(rps_jit_native_mtx);
+  for (auto it = rps_jit_native_map.begin(); it != rps_jit_native_map.end(); )
+    {
+      if (it->first->is_gcmarked(gc))
+        it++;
+      else
+        it = rps_jit_native_map.erase(it);
+    };
+} // end rps_jit_forget_dead
+
+
+
 void
 Rps_PayloadGccjit::gc_mark(Rps_GarbageCollector&gc) const
 {
@@ -476,6 +1021,9 @@ Rps_PayloadGccjit::gc_mark(Rps_GarbageCollector&gc) const
       RPS_ASSERT(obr);
       obr->gc_mark(gc);
     }
+  for (const Rps_Value& cstv: _gji_constants)
+    if (cstv)
+      cstv.gc_mark(gc);
 #warning incomplete Rps_PayloadGccjit::gc_mark
 } // end Rps_PayloadGccjit::gc_mark
 
@@ -514,6 +1062,12 @@ Rps_PayloadGccjit::dump_json_content(Rps_Dumper*du, Json::Value&jv) const
 Rps_PayloadGccjit::~Rps_PayloadGccjit()
 {
   _gji_rpsobj2jit.clear();
+  _gji_routines.clear();
+  _gji_constants.clear();
+  _gji_nbslots.clear();
+  if (_gji_ctxt && _gji_ctxt != rps_gccjit_top_ctxt)
+    gcc_jit_context_release(_gji_ctxt);
+  _gji_ctxt = nullptr;
 } // end of Rps_PayloadGccjit::~Rps_PayloadGccjit
 
 /// loading of Gccjit payload; see above
@@ -554,6 +1108,161 @@ void rpsldpy_gccjit(Rps_ObjectZone*obz, Rps_Loader*ld, const Json::Value& jv, Rp
 } // end of rpsldpy_gccjit
 
 
+////////////////////////////////////////////////////////////////
+//// Returns true on successful in-memory code generation.  Every
+//// component of the module is either a closure, applied to the
+//// generator, or gets the generate_code message; they emit routines
+//// with the public member functions of Rps_PayloadGccjit.  The
+//// routines are then compiled and installed in their connectives.
+bool
+rps_generate_gccjit_code(Rps_CallFrame*callerframe,
+                         Rps_ObjectRef argobmodule,
+                         Rps_Value arggenparam)
+{
+  RPS_ASSERT(callerframe && callerframe->is_good_call_frame());
+  RPS_ASSERT(argobmodule);
+  RPS_LOCALFRAME(nullptr,
+                 callerframe,
+                 Rps_ObjectRef obmodule;
+                 Rps_ObjectRef obgenerator;
+                 Rps_Value genparamv;
+                 Rps_Value elemv;
+                 Rps_Value mainv;
+                 Rps_Value xtrav;
+                );
+  _f.obmodule = argobmodule;
+  _f.genparamv = arggenparam;
+  std::lock_guard<std::recursive_mutex> gumodule(*_f.obmodule->objmtxptr());
+  _f.obgenerator =
+    Rps_ObjectRef::make_object(&_,
+                               RPS_ROOT_OB(_5apchd96kkK00iu9Tk) //midend_generator∈class
+                              );
+  std::lock_guard<std::recursive_mutex> gugenerator(*_f.obgenerator->objmtxptr());
+  Rps_PayloadGccjit*paylgen =
+    _f.obgenerator->put_new_plain_payload<Rps_PayloadGccjit>();
+  RPS_ASSERT(paylgen != nullptr);
+  _f.obgenerator->put_attr(RPS_ROOT_OB(_2Xfl3YNgZg900K6zdC), //"code_module"∈named_attribute
+                           _f.obmodule);
+  RPS_DEBUG_LOG (CODEGEN, "libgccjit generator " << _f.obgenerator
+                 << " for module " << RPS_OBJECT_DISPLAY(_f.obmodule)
+                 << std::endl
+                 << " generation params " << _f.genparamv
+                 << " thread=" << rps_current_pthread_name());
+  for (int mix = 0; (unsigned)mix < _f.obmodule->nb_components(&_); mix++)
+    {
+      _f.mainv = nullptr;
+      _f.xtrav = nullptr;
+      _f.elemv = _f.obmodule->component_at(&_, mix);
+      if (!_f.elemv)
+        continue;
+      try
+        {
+          Rps_TwoValues res =
+            _f.elemv.is_closure()
+            ? Rps_ClosureValue(_f.elemv).apply4(&_,
+                                                _f.obgenerator,
+                                                _f.genparamv,
+                                                _f.obmodule,
+                                                Rps_Value::make_tagged_int(mix))
+            : _f.elemv.send4(&_,
+                             RPS_ROOT_OB(_5VC4IuJ0dyr01b8lA0), //generate_code∈named_selector
+                             _f.obgenerator,
+                             _f.genparamv,
+                             _f.obmodule,
+                             Rps_Value::make_tagged_int(mix));
+          _f.mainv = res.main();
+          _f.xtrav = res.xtra();
+        }
+      catch (std::exception&exc)
+        {
+          RPS_WARNOUT("rps_generate_gccjit_code failed for element#" << mix
+                      << "=" << _f.elemv << " of module " << _f.obmodule
+                      << " with generator " << _f.obgenerator
+                      << " : " << exc.what());
+          return false;
+        };
+      if (!_f.mainv && !_f.xtrav)
+        {
+          RPS_WARNOUT("rps_generate_gccjit_code got no code for element#" << mix
+                      << "=" << _f.elemv << " of module " << _f.obmodule
+                      << " with generator " << _f.obgenerator);
+          return false;
+        };
+    };
+  int nbinstalled = paylgen->locked_compile_and_install();
+  RPS_DEBUG_LOG (CODEGEN, "rps_generate_gccjit_code module " << _f.obmodule
+                 << " installed " << nbinstalled << " routines");
+  return nbinstalled >= 0;
+} // end rps_generate_gccjit_code
+
+/// applying functions of the !test_jit_routine command: the connective
+/// of the compiled routine has the first one, which its routine
+/// replaces, and the routine applies twice a closure with the second
+static Rps_TwoValues
+rps_gccjit_test_native(Rps_CallFrame*, const Rps_Value arg0,
+                       const Rps_Value, const Rps_Value, const Rps_Value,
+                       const std::vector<Rps_Value>*)
+{
+  return Rps_TwoValues(Rps_Value::make_tagged_int(arg0.as_int()+100));
+} // end rps_gccjit_test_native
+
+static Rps_TwoValues
+rps_gccjit_test_succ(Rps_CallFrame*, const Rps_Value arg0,
+                     const Rps_Value, const Rps_Value, const Rps_Value,
+                     const std::vector<Rps_Value>*)
+{
+  return Rps_TwoValues(Rps_Value::make_tagged_int(arg0.as_int()+1));
+} // end rps_gccjit_test_succ
+
+void
+rps_gccjit_test_routine(Rps_CallFrame*callerframe)
+{
+  RPS_LOCALFRAME(RPS_CALL_FRAME_UNDESCRIBED,
+                 callerframe,
+                 Rps_ObjectRef obgenerator;
+                 Rps_ObjectRef obconn;
+                 Rps_ObjectRef obsucc;
+                 Rps_Value succlosv;
+                 Rps_Value resv;
+                );
+  _f.obsucc = Rps_ObjectRef::make_object(&_, Rps_ObjectRef::the_object_class());
+  _f.obsucc->put_applying_function(rps_gccjit_test_succ);
+  _f.succlosv = Rps_ClosureValue(_f.obsucc, {});
+  _f.obconn = Rps_ObjectRef::make_object(&_, Rps_ObjectRef::the_object_class());
+  _f.obconn->put_applying_function(rps_gccjit_test_native);
+  _f.obgenerator =
+    Rps_ObjectRef::make_object(&_,
+                               RPS_ROOT_OB(_5apchd96kkK00iu9Tk) //midend_generator∈class
+                              );
+  Rps_PayloadGccjit*paylgen =
+    _f.obgenerator->put_new_plain_payload<Rps_PayloadGccjit>();
+  RPS_ASSERT(paylgen != nullptr);
+  struct gcc_jit_function* fun = paylgen->locked_new_routine(_f.obconn);
+  struct gcc_jit_block* block = gcc_jit_function_new_block(fun, "rpsj_entry");
+  struct gcc_jit_rvalue* succlos = paylgen->locked_value_constant(_f.succlosv);
+  struct gcc_jit_rvalue* onev =
+    paylgen->locked_add_apply_call(fun, block, succlos,
+                                   {paylgen->routine_param(fun, Rps_PayloadGccjit::routparam_arg0)});
+  struct gcc_jit_rvalue* twov = paylgen->locked_add_apply_call(fun, block, succlos, {onev});
+  paylgen->locked_end_routine_block(fun, block, twov, nullptr);
+  int nbinstalled = paylgen->locked_compile_and_install();
+  if (nbinstalled != 1)
+    RPS_FATALOUT("rps_gccjit_test_routine installed " << nbinstalled
+                 << " routines for " << _f.obconn << " with " << _f.obgenerator);
+  _f.resv = Rps_ClosureValue(_f.obconn, {}).apply1(&_, Rps_Value::make_tagged_int(40)).main();
+  if (!_f.resv.is_int() || _f.resv.as_int() != 42)
+    RPS_FATALOUT("rps_gccjit_test_routine got " << _f.resv
+                 << " instead of 42 from the routine of " << _f.obconn);
+  if (rps_jit_routine_tier(_f.obconn.optr()) != RPS_JIT_TIER_OPTIMIZED
+      || _f.obconn->applying_function() == rps_gccjit_test_native)
+    RPS_FATALOUT("rps_gccjit_test_routine: no routine installed in " << _f.obconn);
+  /// what the dumper writes for the connective
+  if (rps_jit_native_applying_function(_f.obconn.optr()) != rps_gccjit_test_native)
+    RPS_FATALOUT("rps_gccjit_test_routine: the native applying function of "
+                 << _f.obconn << " is lost");
+} // end rps_gccjit_test_routine
+
+
 void
 rps_gccjit_initialize(void)
 {
@@ -568,6 +1277,13 @@ void rps_gccjit_finalize(void)
 {
   if (std::atomic_flag_test_and_set(&rps_gccjit_finalized))
     return;
+  {
+    std::lock_guard<std::mutex> gunat(rps_jit_native_mtx);
+    for (struct gcc_jit_result* res: rps_gccjit_results_vect)
+      gcc_jit_result_release(res);
+    rps_gccjit_results_vect.clear();
+    rps_jit_native_map.clear();
+  }
   gcc_jit_context_release(rps_gccjit_top_ctxt);
 #warning rps_gccjit_finalize incomplete
 } // end rps_gccjit_finalize
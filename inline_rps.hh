@@ -1141,7 +1141,9 @@ inline void*
 Rps_QuasiZone::operator new (std::size_t siz, std::nullptr_t)
 {
   RPS_ASSERT(siz % sizeof(void*) == 0);
-  qz_alloc_cumulw.fetch_add(siz / sizeof(void*));
+  uint64_t nbw = siz / sizeof(void*);
+  Rps_Agenda::note_allocation(qz_alloc_cumulw.fetch_add(nbw) + nbw);
+  Rps_Agenda::allocation_safepoint();
   return ::operator new (siz);
 } // end plain Rps_QuasiZone::operator new
 
@@ -1151,10 +1153,27 @@ Rps_QuasiZone::operator new (std::size_t siz, unsigned wordgap)
 {
   RPS_ASSERT(siz % sizeof(void*) == 0);
   auto realsize = siz + wordgap * sizeof(void*);
-  qz_alloc_cumulw.fetch_add(realsize / sizeof(void*));
+  uint64_t nbw = realsize / sizeof(void*);
+  Rps_Agenda::note_allocation(qz_alloc_cumulw.fetch_add(nbw) + nbw);
+  Rps_Agenda::allocation_safepoint();
   return ::operator new (realsize);
 } // end wordgapped Rps_QuasiZone::operator new
 
+inline void
+Rps_QuasiZone::note_external_allocation(std::size_t nbytes)
+{
+  uint64_t nbw = (nbytes + sizeof(void*) - 1) / sizeof(void*);
+  qz_external_livew.fetch_add(nbw);
+  Rps_Agenda::note_allocation(qz_alloc_cumulw.fetch_add(nbw) + nbw);
+} // end Rps_QuasiZone::note_external_allocation
+
+inline void
+Rps_QuasiZone::note_external_deallocation(std::size_t nbytes)
+{
+  uint64_t nbw = (nbytes + sizeof(void*) - 1) / sizeof(void*);
+  qz_external_livew.fetch_sub(nbw);
+} // end Rps_QuasiZone::note_external_deallocation
+
 
 //////////////////////////////////////////////////////////// zone values
 
@@ -1337,7 +1356,7 @@ rps_hash_cstr(const char*cstr, int len)
 {
   Rps_HashInt h = 0;
   int64_t ht[2] = {0,0};
-  int utf8len = rps_compute_cstr_two_64bits_hash(ht, cstr, len);
+  int utf8len = rps_fast_compute_cstr_two_64bits_hash(ht, cstr, len);
   if (utf8len>=0)
     {
       h = Rps_HashInt (ht[0] ^  ht[1]);
@@ -1385,9 +1404,9 @@ Rps_String::safe_utf8len(const char*cstr, int len)
       || !*cstr) return 0;
   if (len<0)
     len = strlen(cstr);
-  if (RPS_UNLIKELY(u8_check((const uint8_t*)cstr, (size_t)len) != nullptr))
+  if (RPS_UNLIKELY(rps_utf8_check(cstr, (size_t)len) != nullptr))
     RPS_FATAL("corrupted UTF8 string %.*s", len, cstr);
-  return u8_mblen((const uint8_t*)cstr, (size_t)len);
+  return rps_utf8_count(cstr, (size_t)len);
 }; // end of Rps_String::safe_utf8len
 
 Rps_String::Rps_String (const char*cstr, int len)
@@ -2020,7 +2039,7 @@ Rps_ClosureValue::apply0(Rps_CallFrame*callerframe) const
   Rps_ObjectRef obconn = connob();
   if (!obconn)
     return Rps_TwoValues(nullptr);
-  rps_applyingfun_t*appfun = obconn->get_applyingfun(*this);
+  rps_applyingfun_t*appfun = obconn->get_applyingfun(callerframe, *this);
   if (!appfun)
     return Rps_TwoValues(nullptr);
   callerframe->set_closure(*this);
@@ -2042,7 +2061,7 @@ Rps_ClosureValue::apply1(Rps_CallFrame*callerframe, const Rps_Value arg0) const
   Rps_ObjectRef obconn = connob();
   if (!obconn)
     return Rps_TwoValues(nullptr);
-  rps_applyingfun_t*appfun = obconn->get_applyingfun(*this);
+  rps_applyingfun_t*appfun = obconn->get_applyingfun(callerframe, *this);
   if (!appfun)
     return  Rps_TwoValues(nullptr);
   callerframe->set_closure(*this);
@@ -2066,7 +2085,7 @@ Rps_ClosureValue::apply2(Rps_CallFrame*callerframe, const Rps_Value arg0,
   Rps_ObjectRef obconn = connob();
   if (!obconn)
     return  Rps_TwoValues(nullptr);
-  rps_applyingfun_t*appfun = obconn->get_applyingfun(*this);
+  rps_applyingfun_t*appfun = obconn->get_applyingfun(callerframe, *this);
   if (!appfun)
     {
       RPS_DEBUG_LOG(MSGSEND, "apply2 " << *this << " no appfun");
@@ -2092,7 +2111,7 @@ Rps_ClosureValue::apply3(Rps_CallFrame*callerframe, const Rps_Value arg0,
   Rps_ObjectRef obconn = connob();
   if (!obconn)
     return  Rps_TwoValues(nullptr);
-  rps_applyingfun_t*appfun = obconn->get_applyingfun(*this);
+  rps_applyingfun_t*appfun = obconn->get_applyingfun(callerframe, *this);
   if (!appfun)
     return  Rps_TwoValues(nullptr);
   callerframe->set_closure(*this);
@@ -2116,7 +2135,7 @@ Rps_ClosureValue::apply4(Rps_CallFrame*callerframe, const Rps_Value arg0,
   Rps_ObjectRef obconn = connob();
   if (!obconn)
     return  Rps_TwoValues(nullptr);
-  rps_applyingfun_t*appfun = obconn->get_applyingfun(*this);
+  rps_applyingfun_t*appfun = obconn->get_applyingfun(callerframe, *this);
   if (!appfun)
     return nullptr;
   callerframe->set_closure(*this);
@@ -2141,7 +2160,7 @@ Rps_ClosureValue::apply5(Rps_CallFrame*callerframe, const Rps_Value arg0,
   Rps_ObjectRef obconn = connob();
   if (!obconn)
     return  Rps_TwoValues(nullptr);
-  rps_applyingfun_t*appfun = obconn->get_applyingfun(*this);
+  rps_applyingfun_t*appfun = obconn->get_applyingfun(callerframe, *this);
   if (!appfun)
     return  Rps_TwoValues(nullptr);
   callerframe->set_closure(*this);
@@ -2168,7 +2187,7 @@ Rps_ClosureValue::apply6(Rps_CallFrame*callerframe, const Rps_Value arg0,
   Rps_ObjectRef obconn = connob();
   if (!obconn)
     return  Rps_TwoValues(nullptr);
-  rps_applyingfun_t*appfun = obconn->get_applyingfun(*this);
+  rps_applyingfun_t*appfun = obconn->get_applyingfun(callerframe, *this);
   if (!appfun)
     return nullptr;
   callerframe->set_closure(*this);
@@ -2197,7 +2216,7 @@ Rps_ClosureValue::apply7(Rps_CallFrame*callerframe, const Rps_Value arg0,
   Rps_ObjectRef obconn = connob();
   if (!obconn)
     return  Rps_TwoValues(nullptr);
-  rps_applyingfun_t*appfun = obconn->get_applyingfun(*this);
+  rps_applyingfun_t*appfun = obconn->get_applyingfun(callerframe, *this);
   if (!appfun)
     return  Rps_TwoValues(nullptr);
   callerframe->set_closure(*this);
@@ -2228,7 +2247,7 @@ Rps_ClosureValue::apply8(Rps_CallFrame*callerframe, const Rps_Value arg0,
   Rps_ObjectRef obconn = connob();
   if (!obconn)
     return  Rps_TwoValues(nullptr);
-  rps_applyingfun_t*appfun = obconn->get_applyingfun(*this);
+  rps_applyingfun_t*appfun = obconn->get_applyingfun(callerframe, *this);
   if (!appfun)
     return nullptr;
   callerframe->set_closure(*this);
@@ -2259,7 +2278,7 @@ Rps_ClosureValue::apply9(Rps_CallFrame*callerframe, const Rps_Value arg0,
   Rps_ObjectRef obconn = connob();
   if (!obconn)
     return  Rps_TwoValues(nullptr);
-  rps_applyingfun_t*appfun = obconn->get_applyingfun(*this);
+  rps_applyingfun_t*appfun = obconn->get_applyingfun(callerframe, *this);
   if (!appfun)
     return  Rps_TwoValues(nullptr);
   callerframe->set_closure(*this);
@@ -2291,7 +2310,7 @@ Rps_ClosureValue::apply10(Rps_CallFrame*callerframe, const Rps_Value arg0,
   Rps_ObjectRef obconn = connob();
   if (!obconn)
     return  Rps_TwoValues(nullptr);
-  rps_applyingfun_t*appfun = obconn->get_applyingfun(*this);
+  rps_applyingfun_t*appfun = obconn->get_applyingfun(callerframe, *this);
   if (!appfun)
     return  Rps_TwoValues(nullptr);
   callerframe->set_closure(*this);
@@ -2310,6 +2329,87 @@ Rps_ClosureValue::apply10(Rps_CallFrame*callerframe, const Rps_Value arg0,
 } // end Rps_ClosureValue::apply10
 
 
+//////////////// bound closures
+template <unsigned Arity>
+Rps_BoundClosure<Arity>::Rps_BoundClosure(Rps_CallFrame*callerframe, const Rps_ClosureValue clos)
+  : bc_clos(), bc_connob(nullptr), bc_appfun(nullptr), bc_nbrebind(0)
+{
+  RPS_ASSERT_CALLFRAME (callerframe);
+  if (clos.is_empty() || !clos.is_closure())
+    return;
+  Rps_ObjectRef obconn = clos.connob();
+  if (!obconn)
+    return;
+  bc_clos = clos;
+  bc_connob = obconn.optr();
+  bc_appfun = bc_connob->applying_function();
+} // end Rps_BoundClosure::Rps_BoundClosure
+
+template <unsigned Arity>
+rps_applyingfun_t*
+Rps_BoundClosure<Arity>::validated_applying_function([[maybe_unused]] Rps_CallFrame*callerframe)
+{
+  if (RPS_UNLIKELY(!bc_connob))
+    return nullptr;
+  /// every application counts, as in Rps_ObjectZone::get_applyingfun
+  bc_connob->count_application();
+  rps_applyingfun_t* appfun = bc_connob->applying_function();
+  if (RPS_UNLIKELY(appfun != bc_appfun))
+    {
+      /// rebind after a plugin reload or a JIT compilation
+      bc_appfun = appfun;
+      bc_nbrebind++;
+    }
+  return appfun;
+} // end Rps_BoundClosure::validated_applying_function
+
+template <unsigned Arity> template <typename... Args>
+Rps_TwoValues
+Rps_BoundClosure<Arity>::apply(Rps_CallFrame*callerframe, const Args&... args)
+{
+  static_assert(sizeof...(Args) == Arity,
+                "Rps_BoundClosure::apply needs exactly Arity arguments");
+  RPS_ASSERT_CALLFRAME (callerframe);
+  rps_applyingfun_t* appfun = validated_applying_function(callerframe);
+  if (!appfun)
+    return Rps_TwoValues(nullptr);
+  /// missing arguments are null
+  const Rps_Value argtab[(Arity>4)?Arity:4] = { Rps_Value(args)... };
+  callerframe->set_closure(bc_clos);
+  if constexpr (Arity <= 4)
+    {
+      Rps_TwoValues res = appfun(callerframe, argtab[0], argtab[1],
+                                 argtab[2], argtab[3], nullptr);
+      callerframe->clear_closure();
+      return res;
+    }
+  else
+    {
+      struct depth_guard_st
+      {
+        depth_guard_st()
+        {
+          if (rps_bound_restargs_pool.size() <= rps_bound_restargs_depth)
+            rps_bound_restargs_pool.emplace_back();
+          rps_bound_restargs_depth++;
+        };
+        ~depth_guard_st()
+        {
+          rps_bound_restargs_depth--;
+        };
+      } depthguard;
+      std::vector<Rps_Value>& restvec =
+        rps_bound_restargs_pool[rps_bound_restargs_depth-1];
+      restvec.assign(argtab+4, argtab+Arity);
+      Rps_TwoValues res = appfun(callerframe, argtab[0], argtab[1],
+                                 argtab[2], argtab[3], &restvec);
+      restvec.clear();
+      callerframe->clear_closure();
+      return res;
+    }
+} // end Rps_BoundClosure::apply
+
+
 
 ////////////////////////////////////////////////////// immutable instances
 
@@ -2356,14 +2456,14 @@ Rps_Payload::Rps_Payload(Rps_Type ptyp, Rps_ObjectRef obr)
 ////// class information payload - for PaylClassInfo
 Rps_PayloadClassInfo::Rps_PayloadClassInfo(Rps_ObjectZone*owner)
   : Rps_Payload(Rps_Type::PaylClassInfo, owner),
-    pclass_super(nullptr), pclass_methdict(), pclass_symbname(nullptr), pclass_attrset(nullptr)
+    pclass_super(nullptr), pclass_methdict(), pclass_symbname(nullptr), pclass_attrset(nullptr), pclass_shape(nullptr)
 {
   RPS_ASSERT(owner && owner->stored_type() == Rps_Type::Object);
 }      // end Rps_PayloadClassInfo::Rps_PayloadClassInfo
 
 Rps_PayloadClassInfo::Rps_PayloadClassInfo(Rps_ObjectZone*owner, Rps_Loader*ld)
   : Rps_Payload(Rps_Type::PaylClassInfo, owner, ld),
-    pclass_super(nullptr), pclass_methdict(), pclass_symbname(nullptr), pclass_attrset(nullptr)
+    pclass_super(nullptr), pclass_methdict(), pclass_symbname(nullptr), pclass_attrset(nullptr), pclass_shape(nullptr)
 {
   RPS_ASSERT(owner && owner->stored_type() == Rps_Type::Object);
 }      // end Rps_PayloadClassInfo::Rps_PayloadClassInfo ..loading
@@ -2518,6 +2618,44 @@ Rps_Agenda::tasklet_class()
   return RPS_ROOT_OB(_8fYqEw8vTED03wsznt);
 }      // end Rps_Agenda::tasklet_class
 
+void
+Rps_Agenda::gc_safepoint(Rps_CallFrame*callframe)
+{
+  if (RPS_LIKELY(!agenda_needs_garbcoll_.load(std::memory_order_acquire)))
+    return;
+  // only agenda worker threads are parked; the main thread or the
+  // event loop thread don't run tasklets.
+  if (rps_curthread_ix <= 0 || rps_curthread_ix > RPS_NBJOBS_MAX)
+    return;
+  do_garbage_collect(rps_curthread_ix, callframe);
+}      // end Rps_Agenda::gc_safepoint
+
+void
+Rps_Agenda::note_allocation(uint64_t cumulw)
+{
+  if (RPS_LIKELY(cumulw < agenda_cumulw_gc_.load(std::memory_order_relaxed)
+                 + agenda_gc_threshold))
+    return;
+  if (!agenda_is_running_.load(std::memory_order_relaxed))
+    return;
+  if (agenda_needs_garbcoll_.exchange(true))
+    return;
+  /// idle worker threads are already at their safepoint, so nobody
+  /// needs to be woken up
+  agenda_gc_request_elapsed_.store(rps_elapsed_real_time());
+}      // end Rps_Agenda::note_allocation
+
+void
+Rps_Agenda::allocation_safepoint(void)
+{
+  if (RPS_LIKELY(!agenda_needs_garbcoll_.load(std::memory_order_acquire)))
+    return;
+  // the collecting worker thread may allocate
+  if (collecting_garbage() || !rps_curthread_callframe)
+    return;
+  gc_safepoint(rps_curthread_callframe);
+}      // end Rps_Agenda::allocation_safepoint
+
 
 /////////////////////////////////////////////////////////////////
 //////////////// Tasklets
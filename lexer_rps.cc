@@ -54,6 +54,84 @@ const char rps_lexer_shortgitid[]= RPS_SHORTGITID;
 extern "C" Rps_StringValue rps_lexer_token_name_str_val;
 Rps_StringValue rps_lexer_token_name_str_val(nullptr);
 
+/// The lexer is driven by a table giving the class of every byte; the
+/// first bytes of a token select its kind in lexical_kind_at, like in
+/// a small deterministic automaton, instead of a chain of tests.
+enum rps_lexbyte_en : uint8_t
+{
+  RpsLexB_Other=0,              // control characters
+  RpsLexB_Space,
+  RpsLexB_Digit,
+  RpsLexB_Sign,                 // + or -
+  RpsLexB_Letter,
+  RpsLexB_UpperR,               // could start a raw literal string
+  RpsLexB_Underscore,
+  RpsLexB_Quote,
+  RpsLexB_Hash,                 // could start a code chunk
+  RpsLexB_Punct,
+  RpsLexB_High                  // in some UTF-8 sequence
+};
+
+static const std::array<uint8_t,256> rps_lexbyte_table = []()
+{
+  std::array<uint8_t,256> tab{};
+  for (int c=0; c<256; c++)
+    {
+      uint8_t k = RpsLexB_Other;
+      if (c >= 0x80)
+        k = RpsLexB_High;
+      else if (c==' ' || c=='\t' || c=='\n' || c=='\v' || c=='\f' || c=='\r')
+        k = RpsLexB_Space;
+      else if (c>='0' && c<='9')
+        k = RpsLexB_Digit;
+      else if (c=='+' || c=='-')
+        k = RpsLexB_Sign;
+      else if (c=='R')
+        k = RpsLexB_UpperR;
+      else if ((c>='a' && c<='z') || (c>='A' && c<='Z'))
+        k = RpsLexB_Letter;
+      else if (c=='_')
+        k = RpsLexB_Underscore;
+      else if (c=='"')
+        k = RpsLexB_Quote;
+      else if (c=='#')
+        k = RpsLexB_Hash;
+      else if (c>' ' && c<0x7f)
+        k = RpsLexB_Punct;
+      tab[c] = k;
+    };
+  return tab;
+}();
+
+static inline uint8_t
+rps_lexbyte(char c)
+{
+  return rps_lexbyte_table[(uint8_t)c];
+} // end rps_lexbyte
+
+/// bytes inside names or object ids, like _0S6DQvp3Gop015zXhL
+static inline bool
+rps_lexer_is_name_byte(char c)
+{
+  switch (rps_lexbyte(c))
+    {
+    case RpsLexB_Letter:
+    case RpsLexB_UpperR:
+    case RpsLexB_Digit:
+    case RpsLexB_Underscore:
+      return true;
+    default:
+      return false;
+    }
+} // end rps_lexer_is_name_byte
+
+static inline bool
+rps_lexer_is_letter_byte(char c)
+{
+  auto k = rps_lexbyte(c);
+  return k == RpsLexB_Letter || k == RpsLexB_UpperR;
+} // end rps_lexer_is_letter_byte
+
 std::atomic<unsigned> Rps_TokenSource::toksrc_instance_count_;
 
 Rps_TokenSource::Rps_TokenSource(std::string name)
@@ -61,7 +139,9 @@ Rps_TokenSource::Rps_TokenSource(std::string name)
     toksrc_number(1+toksrc_instance_count_.fetch_add(1)),
     toksrc_linebuf{},
     toksrc_token_deq(),
-    toksrc_ptrnameval(nullptr)
+    toksrc_tokpos(0),
+    toksrc_ptrnameval(nullptr),
+    toksrc_parse_memo()
 {
   RPS_DEBUG_LOG(REPL, "Rps_TokenSource @" << this << " named " << name
                 << std::endl << RPS_FULL_BACKTRACE_HERE(1, "Rps_TokenSource constr"));
@@ -85,6 +165,8 @@ Rps_TokenSource::really_gc_mark(Rps_GarbageCollector&gc, unsigned depth)
   if (toksrc_ptrnameval)
     toksrc_ptrnameval->gc_mark(gc, depth+1);
   toksrc_token_deq.gc_mark(gc, depth+1);
+  for (auto& it : toksrc_parse_memo)
+    gc.mark_value(it.second.pmemo_result, depth+1);
 } // end Rps_TokenSource::really_gc_mark
 
 
@@ -177,6 +259,7 @@ Rps_TokenSource::~Rps_TokenSource()
   toksrc_col= -1;
   toksrc_linebuf.clear();
   toksrc_token_deq.clear();
+  toksrc_parse_memo.clear();
 } // end Rps_TokenSource::~Rps_TokenSource
 
 Rps_StreamTokenSource::Rps_StreamTokenSource(std::string path)
@@ -506,9 +589,8 @@ Rps_TokenSource::get__number__token(Rps_CallFrame*callframe, const char*curp)
   char*endfloat=nullptr;
   const char*startnum = curp;
   bool isfloat = false;
-  std::string startpos = position_str();
   RPS_DEBUG_LOG(REPL, "Rps_TokenSource::get__number__token#" << (toksrc_counter+1) << "?  startnum=" << Rps_QuotedC_String(startnum)
-                << " at " << position_str() << " startpos:" << startpos);
+                << " at " << position_str());
   long long l = strtoll(startnum, &endint, 0);
   double d = strtod(startnum, &endfloat);
   RPS_ASSERT(endint != nullptr && endfloat != nullptr);
@@ -621,7 +703,7 @@ Rps_TokenSource::get__namoid__token(Rps_CallFrame*callframe, const char*curp)
   int curcol = toksrc_col;
   int startcol = curcol;
   size_t linelen = toksrc_linebuf.size();
-  while ((isalpha(*curp) || *curp == '_') && toksrc_col<(int)linelen)
+  while (toksrc_col<(int)linelen && rps_lexer_is_name_byte(*curp))
     curp++, toksrc_col++;
   std::string namestr(startname, toksrc_col-startcol);
   RPS_DEBUG_LOG(REPL, "get__namoid__token#" << (toksrc_counter+1) << "? namestr: '"
@@ -829,8 +911,7 @@ Rps_TokenSource::get__delim__token(Rps_CallFrame*callframe, const char*curp)
                            Rps_ObjectRef lexkindob;
                            Rps_Value lextokv;
                 );
-  std::string delimpos = position_str();
-  //int startcol = toksrc_col;
+  int delimcol = toksrc_col;
   _f.delimv = get_delimiter(&_);
   std::string delimstartstr {curp};
   RPS_DEBUG_LOG(REPL, "Rps_TokenSource::get_token#" << (toksrc_counter+1) << "? after "
@@ -840,6 +921,7 @@ Rps_TokenSource::get__delim__token(Rps_CallFrame*callframe, const char*curp)
                 << Rps_QuotedC_String(curcptr()));
   if (!_f.delimv)
     {
+      std::string delimpos = position_str(delimcol);
       RPS_WARNOUT("invalid delimiter " << Rps_QuotedC_String(delimstartstr) << " at " << delimpos
                   << " curp:" << Rps_QuotedC_String(curp)  << " curcptr:"
                   <<  Rps_QuotedC_String(curcptr())
@@ -870,24 +952,196 @@ Rps_TokenSource::get__delim__token(Rps_CallFrame*callframe, const char*curp)
 
 
 ////////////////////////////////
+Rps_TokenSource::lexkind_en
+Rps_TokenSource::lexical_kind_at(const char*curp)
+{
+  if (!curp || !*curp)
+    return LexKind_None;
+  switch (rps_lexbyte(curp[0]))
+    {
+    case RpsLexB_Digit:
+      return LexKind_Number;
+    case RpsLexB_Sign:
+      if (rps_lexbyte(curp[1]) == RpsLexB_Digit)
+        return LexKind_Number;
+      /// infinities (double) - but not NAN
+      if (curp[1]=='I' && curp[2]=='N' && curp[3]=='F'
+          && !rps_lexer_is_name_byte(curp[4]))
+        return LexKind_Infinity;
+      return LexKind_Delimiter;
+    case RpsLexB_UpperR:
+      /// raw literal strings may span across several lines, like in C++
+      /// see https://en.cppreference.com/w/cpp/language/string_literal
+      if (curp[1] == '"' && rps_lexer_is_letter_byte(curp[2]))
+        return LexKind_RawString;
+      return LexKind_Namoid;
+    case RpsLexB_Letter:
+    case RpsLexB_Underscore:
+      return LexKind_Namoid;
+    case RpsLexB_Quote:
+      return LexKind_ShortString;
+    case RpsLexB_Hash:
+    {
+      /* a code chunk or macro string starts with "#{" ending with
+         "}#", or with "#a{" ending with "}a#", etc... with up to 6
+         latin letters, as accepted by lex_code_chunk */
+      int ix = 1;
+      while (ix <= 6 && rps_lexer_is_letter_byte(curp[ix]))
+        ix++;
+      if (curp[ix] == '{')
+        return LexKind_CodeChunk;
+      return LexKind_Delimiter;
+    }
+    case RpsLexB_Punct:
+      return LexKind_Delimiter;
+    case RpsLexB_High:
+    {
+      ucs4_t uc = 0;
+      int ulen = u8_strmbtouc(&uc, (const uint8_t*)curp);
+      if (ulen > 0 && uc_is_punct(uc))
+        return LexKind_Delimiter;
+      return LexKind_Bad;
+    }
+    case RpsLexB_Space:
+      return LexKind_None;
+    default:
+      return LexKind_Bad;
+    }
+} // end Rps_TokenSource::lexical_kind_at
+
+
+bool
+Rps_TokenSource::scan_raw_token(raw_token_st&rawtok) const
+{
+  rawtok = raw_token_st{LexKind_None, toksrc_line, toksrc_col, 0, nullptr};
+  if (toksrc_linebuf.empty() || toksrc_col < 0)
+    return false;
+  const char*linestart = toksrc_linebuf.c_str();
+  const char*eol = linestart + toksrc_linebuf.size();
+  const char*curp = linestart + toksrc_col;
+  while (curp < eol && rps_lexbyte(*curp) == RpsLexB_Space)
+    curp++;
+  rawtok.rawtok_col = (int) (curp - linestart);
+  if (curp >= eol)
+    return false;
+  lexkind_en kind = lexical_kind_at(curp);
+  int len = 0;
+  switch (kind)
+    {
+    case LexKind_Number:
+    {
+      char*endint = nullptr;
+      char*endfloat = nullptr;
+      (void) strtoll(curp, &endint, 0);
+      (void) strtod(curp, &endfloat);
+      len = (int) (std::max(endint, endfloat) - curp);
+    }
+    break;
+    case LexKind_Infinity:
+      len = 4;
+      break;
+    case LexKind_Namoid:
+      len = 1;
+      while (curp+len < eol && rps_lexer_is_name_byte(curp[len]))
+        len++;
+      break;
+    case LexKind_ShortString:
+    {
+      const char*pc = curp+1;
+      while (pc < eol && *pc != '"')
+        pc += (*pc == '\\' && pc+1 < eol) ? 2 : 1;
+      len = (int) ((pc < eol) ? (pc+1 - curp) : (eol - curp));
+    }
+    break;
+    case LexKind_Delimiter:
+    {
+      Rps_Value delimv;
+      len = delimiter_length_at(curp, &delimv);
+      if (len > 0)
+        rawtok.rawtok_delim = delimv.as_object();
+    }
+    break;
+    case LexKind_None:
+      return false;
+    default:
+      /// multi-line or bad tokens
+      len = (int) (eol - curp);
+      break;
+    };
+  rawtok.rawtok_kind = kind;
+  rawtok.rawtok_len = len;
+  return true;
+} // end Rps_TokenSource::scan_raw_token
+
+
+void
+Rps_TokenSource::skip_raw_token(const raw_token_st&rawtok)
+{
+  RPS_ASSERT(rawtok.rawtok_line == toksrc_line);
+  RPS_ASSERT(rawtok.rawtok_col >= toksrc_col);
+  RPS_ASSERT(rawtok.rawtok_kind != LexKind_RawString
+             && rawtok.rawtok_kind != LexKind_CodeChunk
+             && rawtok.rawtok_kind != LexKind_Bad);
+  toksrc_col = rawtok.rawtok_col;
+  advance_cursor_bytes(rawtok.rawtok_len);
+  toksrc_counter++;
+} // end Rps_TokenSource::skip_raw_token
+
+
+Rps_ObjectRef
+Rps_TokenSource::lookahead_delimiter(void) const
+{
+  if (!toksrc_token_deq.empty())
+    {
+      Rps_Value fronttokv = toksrc_token_deq[0];
+      if (fronttokv.is_lextoken()
+          && fronttokv.to_lextoken()->lxkind() == RPS_ROOT_OB(_2wdmxJecnFZ02VGGFK) //repl_delimiter∈class
+          && fronttokv.to_lextoken()->lxval().is_object())
+        return fronttokv.to_lextoken()->lxval().to_object();
+      return nullptr;
+    };
+  raw_token_st rawtok;
+  if (!scan_raw_token(rawtok) || rawtok.rawtok_kind != LexKind_Delimiter)
+    return nullptr;
+  return rawtok.rawtok_delim;
+} // end Rps_TokenSource::lookahead_delimiter
+
+
+bool
+Rps_TokenSource::skip_delimiter(Rps_CallFrame*callframe, Rps_ObjectRef delimob)
+{
+  RPS_ASSERT(callframe && callframe->is_good_call_frame());
+  RPS_ASSERT(delimob);
+  if (!toksrc_token_deq.empty())
+    {
+      if (lookahead_delimiter() != delimob)
+        return false;
+      consume_front_token(callframe);
+      return true;
+    };
+  raw_token_st rawtok;
+  if (!scan_raw_token(rawtok) || rawtok.rawtok_kind != LexKind_Delimiter
+      || rawtok.rawtok_delim != delimob)
+    return false;
+  skip_raw_token(rawtok);
+  note_consumed_token();
+  RPS_DEBUG_LOG(REPL, "Rps_TokenSource::skip_delimiter skipped raw " << delimob
+                << " now at " << position_str());
+  return true;
+} // end Rps_TokenSource::skip_delimiter
+
+
 Rps_LexTokenValue
 Rps_TokenSource::get_token(Rps_CallFrame*callframe)
 {
   RPS_ASSERT(callframe==nullptr || callframe->is_good_call_frame());
-  RPS_LOCALFRAME(/*descr:*/RPS_ROOT_OB(_0S6DQvp3Gop015zXhL), //lexical_token∈class
-                           /*callerframe:*/callframe,
-                           Rps_Value res;
-                           Rps_ObjectRef lexkindob;
-                           Rps_Value lextokv;
-                           Rps_ObjectRef oblex;
-                           Rps_Value namev;
-                           Rps_Value delimv;
-                           Rps_ObjectRef obdelim;
-                );
-  const char* curp = curcptr();
-  std::string startpos = position_str();
+  RPS_LEANLOCALFRAME(/*descr:*/RPS_ROOT_OB(_0S6DQvp3Gop015zXhL), //lexical_token∈class
+                               /*callerframe:*/callframe,
+                               Rps_Value res;
+                    );
+  int startcol = toksrc_col;
   RPS_DEBUG_LOG(REPL, "+Rps_TokenSource::get_token#" << (toksrc_counter+1) << "? start curp="
-                << Rps_QuotedC_String(curp) << " at " << startpos << std::endl
+                << Rps_QuotedC_String(curcptr()) << " at " << position_str() << std::endl
                 << "… token_deq:" << toksrc_token_deq << " source:" << *this
                 << std::endl
                 << Rps_Do_Output([&](std::ostream& out)
@@ -895,28 +1149,14 @@ Rps_TokenSource::get_token(Rps_CallFrame*callframe)
     this->display_current_line_with_cursor(out);
   })
       << std::endl << RPS_FULL_BACKTRACE_HERE(1, "Rps_TokenSource::get_token/start"));
-  ucs4_t curuc=0;
-  int ulen= -1;
-  size_t linelen = toksrc_linebuf.size();
-  // check that we have a proper UTF-8 character
-  ulen=curp?u8_strmbtouc(&curuc, (const uint8_t*)curp):0; // length in bytes
-  if (ulen<0)
-    {
-      std::ostringstream errout;
-      errout << "bad UTF-8 encoding in " << toksrc_name << ":L" << toksrc_line << ",C" << toksrc_col << std::flush;
-      RPS_WARNOUT("Rps_TokenSource::get_token#" << (toksrc_counter+1) << "?  fails: " << errout.str() << " in " << (*this));
-      throw std::runtime_error(errout.str());
-    }
-  RPS_DEBUG_LOG(REPL, "Rps_TokenSource::get_token#" << (toksrc_counter+1) << "?  beforespace curp=" << Rps_QuotedC_String(curp)
-                << " startpos:" << startpos << " at:" << position_str());
-  while (curp && isspace(*curp) && toksrc_col<(int)linelen)
-    curp++, toksrc_col++;
-  RPS_DEBUG_LOG(REPL, "Rps_TokenSource::get_token#" << (toksrc_counter+1) << "? afterspace curp=" << Rps_QuotedC_String(curp)
-                << " startpos:" << startpos << " at:" << position_str());
-  if (toksrc_col>=(int)linelen)
+  raw_token_st rawtok;
+  bool gotraw = scan_raw_token(rawtok);
+  /// skip the spaces
+  toksrc_col = rawtok.rawtok_col;
+  if (!gotraw)
     {
       RPS_DEBUG_LOG(REPL, "-Rps_TokenSource::get_token#" << (toksrc_counter+1) << "? EOL  :-◑> ∅null at " << position_str()
-                    << " startpos:" << startpos << std::endl
+                    << " startpos:" << position_str(startcol) << std::endl
                     << Rps_Do_Output([&](std::ostream& out)
       {
         this->display_current_line_with_cursor(out);
@@ -924,158 +1164,126 @@ Rps_TokenSource::get_token(Rps_CallFrame*callframe)
                    );
       return nullptr;
     }
-  ulen=curp?u8_strmbtouc(&curuc, (const uint8_t*)curp):0; // length in bytes
-  /// lex numbers?
-  if (isdigit(*curp) ||
-      ((curp[0] == '+' || curp[0] == '-') && isdigit(curp[1])))
+  _f.res = token_of_raw(&_, rawtok);
+  RPS_DEBUG_LOG(REPL, "-Rps_TokenSource::get_token#" << toksrc_counter
+                << " kind#" << (int)rawtok.rawtok_kind << " from¤ " << *this
+                << " gives " << _f.res << " at " << position_str());
+  return _f.res;
+} // end Rps_TokenSource::get_token
+
+
+Rps_LexTokenValue
+Rps_TokenSource::token_of_raw(Rps_CallFrame*callframe, const raw_token_st&rawtok)
+{
+  RPS_LEANLOCALFRAME(/*descr:*/RPS_ROOT_OB(_0S6DQvp3Gop015zXhL), //lexical_token∈class
+                               /*callerframe:*/callframe,
+                               Rps_Value res;
+                    );
+  RPS_ASSERT(rawtok.rawtok_line == toksrc_line && rawtok.rawtok_col == toksrc_col);
+  const char* curp = curcptr();
+  RPS_ASSERT(curp != nullptr);
+  lexkind_en kind = rawtok.rawtok_kind;
+  RPS_DEBUG_LOG(REPL, "Rps_TokenSource::token_of_raw#" << (toksrc_counter+1) << "? kind#" << (int)kind
+                << " curp=" << Rps_QuotedC_String(curp)
+                << " len=" << rawtok.rawtok_len << " at:" << position_str());
+  switch (kind)
     {
-      // get__number__token
-      RPS_DEBUG_LOG(REPL, "-Rps_TokenSource::get_token number "
-                    << Rps_QuotedC_String(curp)
-                    << " toksrc=" << *this);
+    case LexKind_Number:
       _f.res = get__number__token(&_, curp);
-      RPS_DEBUG_LOG(REPL, "-Rps_TokenSource::get_token number "
-                    << Rps_QuotedC_String(curp)
-                    << " toksrc=" << *this << " gives " << _f.res);
-      return _f.res;
-    } //- end get__number__token lexing numbers
-  ///
-  /// lex infinities (double) - but not NAN
-  else if ((!strncmp(curp, "+INF", 4)
-            || !strncmp(curp, "-INF", 4))
-           && !isalnum(curp[4]))
-    {
-      RPS_DEBUG_LOG(REPL, "-Rps_TokenSource::get_token number "
-                    << Rps_QuotedC_String(curp)
-                    << " toksrc=" << *this);
+      break;
+    case LexKind_Infinity:
       _f.res = get__infinity__token(&_, curp);
-      RPS_DEBUG_LOG(REPL, "-Rps_TokenSource::get_token number "
-                    << Rps_QuotedC_String(curp)
-                    << " toksrc=" << *this << " gives " << _f.res);
-      return _f.res;
-    } //- end get__infinity__token lexing infinities
-
-  /// lex names or objectids
-  else if (isalpha(*curp) || *curp == '_')
-    {
-      // get__namoid__token
-      RPS_DEBUG_LOG(REPL, "-Rps_TokenSource::get_token namoid "
-                    << Rps_QuotedC_String(curp)
-                    << " toksrc=" << *this);
+      break;
+    case LexKind_Namoid:
       _f.res = get__namoid__token(&_, curp);
-      RPS_DEBUG_LOG(REPL, "-Rps_TokenSource::get_token namoid "
-                    << Rps_QuotedC_String(curp)
-                    << " toksrc=" << *this << " gives " << _f.res);
-      return _f.res;
-    } // end get__namoid__token
-  //// literal single line strings are like in C++
-  else if (*curp == '"')   /// plain literal string, on a single line
-    {
-      // get__shortstr__token
-      RPS_DEBUG_LOG(REPL, "-Rps_TokenSource::get_token shortstr "
-                    << Rps_QuotedC_String(curp)
-                    << " toksrc=" << *this);
+      break;
+    case LexKind_ShortString:
       _f.res = get__shortstr__token(&_, curp);
-      RPS_DEBUG_LOG(REPL, "-Rps_TokenSource::get_token shortstr "
-                    << Rps_QuotedC_String(curp)
-                    << " toksrc=" << *this << " gives " << _f.res);
-      return _f.res;
-    } // end  get__shortstr__token single-line literal string token
-
-  //// raw literal strings may span across several lines, like in C++
-  //// see https://en.cppreference.com/w/cpp/language/string_literal
-  else if (curp[0] == 'R' && curp[1] == '"' && isalpha(curp[2]))
-    {
-      RPS_DEBUG_LOG(REPL, "-Rps_TokenSource::get_token longlitstr "
-                    << Rps_QuotedC_String(curp)
-                    << " toksrc=" << *this);
+      break;
+    case LexKind_RawString:
       _f.res = get__longlitstr__token(&_, curp);
-      RPS_DEBUG_LOG(REPL, "-Rps_TokenSource::get_token longlitstr "
-                    << Rps_QuotedC_String(curp)
-                    << " toksrc=" << *this << " gives " << _f.res);
-      return _f.res;
-    } // end  get__longlitstr__token possibly multi-line raw literal strings
-
-  //// a code chunk or macro string is mixing strings and
-  //// objects.... Inspired by GCC MELT see
-  //// starynkevitch.net/Basile/gcc-melt/MELT-Starynkevitch-DSL2011.pdf
-  /* Improvement over GCC MELT: a macro string can start with "#{"
-     ending with "}#" or "#a{" ending with "}a#" or "#ab{" ending with
-     "}ab#" or "#abc{" ending with "}abc#" or "#abcd{" ending with
-     "}abcd#" or "#abcde{" ending with "}abcde#" or "#abcdef{" ending
-     with "}abcdef#" with the letters being arbitrary latin letters,
-     upper or lowercase. but no more than 7 letters. */
-  else if (curp[0] == '#'
-           && (
-             curp[1] == '{'
-             || (isalpha(curp[1])
-                 && (curp[2] == '{'
-                     || (isalpha(curp[2])
-                         && (curp[3] == '{'
-                             || (isalpha(curp[3])
-                                 && (curp[4] == '{'
-                                     || (isalpha(curp[4])
-                                         && (curp[5] == '{'
-                                             || (isalpha(curp[6])
-                                                 && (curp[6] == '{'
-                                                     || (isalpha(curp[7])
-                                                         && (curp[7] == '{'
-                                                             || (isalpha(curp[7])
-                                                                 && (curp[8] == '{'
-                                                                     || (isalpha(curp[8])
-                                                                         && curp[9] == '{')
-                                                                    )
-                                                                )
-                                                            )
-                                                        )
-                                                    )
-                                                )
-                                            )
-                                        )
-                                    )
-                                )
-                            )
-                        )
-                    )
-                )
-           )
-          )
-    {
-      //// get__codechunk__token
-      int linestart = toksrc_line;
-      int colstart = toksrc_col;
-      RPS_DEBUG_LOG(REPL, "Rps_TokenSource::get_token#" << (toksrc_counter+1)
-                    << "?  code_chunk starting at " << position_str() << curp);
+      break;
+    case LexKind_CodeChunk:
       _f.res = get__codechunk__token(&_, curp);
-      RPS_DEBUG_LOG(REPL, "Rps_TokenSource::get_token#" << (toksrc_counter+1)
-                    << "?  code_chunk ending at " << position_str() << curp << " = " << _f.res);
-      return _f.res;
-    } // end get__codechunk__token lexing code chunk
-
-  //// sequence of at most four ASCII or UTF-8 punctuation
-  else if (ispunct(*curp) || uc_is_punct(curuc))
-    {
-      //// get__delim__token
-      RPS_DEBUG_LOG(REPL, "Rps_TokenSource::get_token#" << (toksrc_counter+1)
-                    <<"? start delimiter curp='" << Rps_QuotedC_String(curp) << "' at " << position_str());
+      break;
+    case LexKind_Delimiter:
       _f.res = get__delim__token(&_, curp);
-      RPS_DEBUG_LOG(REPL, "Rps_TokenSource::get_token#" << (toksrc_counter+1)
-                    << " delimiter=" << _f.res);
-      return _f.res;
-    } ///// end  get__delim__token
+      break;
+    case LexKind_None:
+      return nullptr;
+    case LexKind_Bad:
+    {
+      ucs4_t curuc=0;
+      if (u8_strmbtouc(&curuc, (const uint8_t*)curp) < 0)
+        {
+          std::ostringstream errout;
+          errout << "bad UTF-8 encoding in " << toksrc_name << ":L" << toksrc_line << ",C" << toksrc_col << std::flush;
+          RPS_WARNOUT("Rps_TokenSource::get_token#" << (toksrc_counter+1) << "?  fails: " << errout.str() << " in " << (*this));
+          throw std::runtime_error(errout.str());
+        };
 #warning Rps_TokenSource::get_token incomplete
-  RPS_FATALOUT("incomplete Rps_TokenSource::get_token#" << (toksrc_counter+1) << "? @ " << name()
-               << std::endl << "… from " << *this << std::endl
-               << "… pos: " << position_str() << " start:" << startpos
-               << " curp:" << Rps_QuotedC_String(curp) << std::endl
-               << "… curcptr:" <<  Rps_QuotedC_String(curcptr())
-               << " token_deq:" << toksrc_token_deq << std::endl
-               << Rps_Do_Output([&](std::ostream& out)
-  {
-    this->display_current_line_with_cursor(out);
-  }));
+      RPS_FATALOUT("incomplete Rps_TokenSource::get_token#" << (toksrc_counter+1) << "? @ " << name()
+                   << std::endl << "… from " << *this << std::endl
+                   << "… pos: " << position_str()
+                   << " curp:" << Rps_QuotedC_String(curp) << std::endl
+                   << "… curcptr:" <<  Rps_QuotedC_String(curcptr())
+                   << " token_deq:" << toksrc_token_deq << std::endl
+                   << Rps_Do_Output([&](std::ostream& out)
+      {
+        this->display_current_line_with_cursor(out);
+      }));
+    }
+    };
+  return _f.res;
   // we should refactor properly the rps_repl_lexer & Rps_LexTokenZone constructor here
-} // end Rps_TokenSource::get_token
+} // end Rps_TokenSource::token_of_raw
+
+
+int
+Rps_TokenSource::delimiter_length_at(const char*curp, Rps_Value*pdelimv) const
+{
+  if (!curp)
+    return 0;
+  auto paylstrdict = RPS_ROOT_OB(_627ngdqrVfF020ugC5) //"repl_delim"∈string_dictionary
+                     ->get_dynamic_payload<Rps_PayloadStringDict>();
+  RPS_ASSERT (paylstrdict != nullptr);
+  /// byte offsets of the ends of the successive punctuation
+  /// characters (ASCII or UTF-8 like °) starting at curp
+  static constexpr int maxdelimch = 8;
+  int delimends[maxdelimch];
+  int nbdelimch = 0;
+  const char*pc = curp;
+  while (nbdelimch < maxdelimch && *pc)
+    {
+      auto k = rps_lexbyte(*pc);
+      if (k == RpsLexB_Punct || k == RpsLexB_Hash || k == RpsLexB_Quote || k == RpsLexB_Sign)
+        pc++;
+      else if (k == RpsLexB_High)
+        {
+          ucs4_t uc = 0;
+          int ulen = u8_strmbtouc(&uc, (const uint8_t*)pc);
+          if (ulen <= 0 || !uc_is_punct(uc))
+            break;
+          pc += ulen;
+        }
+      else
+        break;
+      delimends[nbdelimch++] = (int)(pc - curp);
+    };
+  /// the longest known delimiter wins
+  for (int ix = nbdelimch-1; ix >= 0; ix--)
+    {
+      std::string delimstr(curp, delimends[ix]);
+      Rps_Value delimv = paylstrdict->find(delimstr);
+      if (delimv)
+        {
+          if (pdelimv)
+            *pdelimv = delimv;
+          return delimends[ix];
+        }
+    };
+  return 0;
+} // end Rps_TokenSource::delimiter_length_at
 
 
 Rps_Value
@@ -1084,143 +1292,52 @@ Rps_TokenSource::get_delimiter(Rps_CallFrame*callframe)
   RPS_LOCALFRAME(RPS_CALL_FRAME_UNDESCRIBED,
                  /*callerframe:*/callframe,
                  Rps_Value res;
-                 Rps_ObjectRef obdictdelim;
                  Rps_Value delimv;
                  Rps_Value namev;
                  Rps_ObjectRef lexkindob;
                  Rps_ObjectRef delimob;
                  Rps_Value lextokv;
                 );
-  const char*curp=nullptr;
   RPS_ASSERT(callframe && callframe->is_good_call_frame());
-  std::string startpos = position_str();
-  _f.obdictdelim = RPS_ROOT_OB(_627ngdqrVfF020ugC5); //"repl_delim"∈string_dictionary
-  auto paylstrdict = _f.obdictdelim->get_dynamic_payload<Rps_PayloadStringDict>();
-  RPS_ASSERT (paylstrdict != nullptr);
-  std::string delimstr;
-  int nbdelimch=0; // number of delimiter UTF8 characters
-  bool again=false;
   const char* startp = curcptr();
   unsigned startcol = toksrc_col;
-  ucs4_t curuc=0;
   RPS_ASSERT(startp);
-  RPS_DEBUG_LOG(REPL, "Rps_TokenSource::get_delimiter start " << *this << Rps_QuotedC_String(startp) << " at startpos:" << startpos);
-  curp = startp;
-  do
+  RPS_DEBUG_LOG(REPL, "Rps_TokenSource::get_delimiter start " << *this << Rps_QuotedC_String(startp)
+                << " at startpos:" << position_str(startcol));
+  int delimlen = delimiter_length_at(startp, &_f.delimv);
+  if (delimlen > 0 && _f.delimv)
     {
-      curuc = 0;
-      int ulen= -1;
-      again=false;
-      if (!curp)
-        break;
-      if (isspace(*curp))
-        break;
-      // FIXME: maybe we should remember the byte position of every
-      // delimiter character (it can be UTF-8 like °)
-      if (*curp < 127 && ispunct(*curp))
-        {
-          delimstr.push_back(*curp);
-          curp ++;
-          nbdelimch ++;
-          again = true;
-        }
-      else if (*(const uint8_t*)curp > 128
-               && (ulen=u8_strmbtouc(&curuc, (const uint8_t*)curp) // length in bytes
-                        > 0)
-               &&  uc_is_punct(curuc))
-        {
-          delimstr.append(curp, ulen);
-          curp += ulen;
-          nbdelimch ++;
-          again = true;
-        }
-      else
-        again = false;
-    }
-  while (again);
-  RPS_DEBUG_LOG(REPL, "Rps_TokenSource::get_delimiter delimstr='" << Rps_Cjson_String(delimstr) << "' nbdelimch="
-                << nbdelimch << " startpos:" << startpos);
-  /***
-   * TODO: we need to find the longest substring in delimstr which is a known delimiter
-   ***/
-  int loopcnt = 0;
-  static constexpr int maxloopdelim = 16;
-  while (!delimstr.empty() && loopcnt < maxloopdelim)
-    {
-      loopcnt ++;
-      _f.delimob = nullptr;
-      _f.delimv = nullptr;
-      RPS_POSSIBLE_BREAKPOINT();
-      _f.delimv = paylstrdict->find(delimstr);
-      RPS_DEBUG_LOG(REPL, "Rps_TokenSource::get_delimiter punctuation delimv=" << _f.delimv << " for delimstr='"
-                    << Rps_Cjson_String(delimstr)
-                    << "' loopcnt#" << loopcnt
-                    << " dict@*" << *(paylstrdict->owner()));
-      if (_f.delimv)
-        {
-          _f.lexkindob = RPS_ROOT_OB(_2wdmxJecnFZ02VGGFK); //repl_delimiter∈class
-          _f.delimob = _f.delimv.as_object();
-          if (_f.delimob)
-            {
-              RPS_DEBUG_LOG(REPL, "Rps_TokenSource::get_delimiter delimob="
-                            << RPS_OBJECT_DISPLAY(_f.delimob)
-                            << std::endl
-                            << "… loopcnt#" << loopcnt << std::endl
-                            << RPS_FULL_BACKTRACE_HERE(1, "Rps_TokenSource::get_delimiter/ob"));
-            };
-          _f.lextokv = _f.delimv;
-          toksrc_col += delimstr.size();
-          const Rps_String* strv = _f.namev.to_string();
-          Rps_LexTokenZone* lextok =
-            Rps_QuasiZone::rps_allocate6<Rps_LexTokenZone,Rps_TokenSource*,Rps_ObjectRef,Rps_Value,const Rps_String*,int,int>
-            (this,_f.lexkindob, _f.lextokv,
-             strv,
-             toksrc_line, startcol);
-          lextok->set_serial(++toksrc_counter);
-          _f.res = Rps_LexTokenValue(lextok);
-          RPS_DEBUG_LOG(REPL, "Rps_TokenSource::get_delimiter delimiter :-◑> " << _f.res << std::endl
-                        << "… at " << position_str() << std::endl
-                        << "… from¤ " << *this
-                        << Rps_Do_Output([&](std::ostream& out)
-          {
-            this->display_current_line_with_cursor(out);
-          })
-              << " startpos " << startpos << std::endl
-              << RPS_FULL_BACKTRACE_HERE(1, "Rps_TokenSource::get_delimiter"));
-          return _f.res;
-        };
-      /// truncate the delimstr by one ending UTF-8
-      const uint8_t* prevu8 = u8_prev(&curuc,
-                                      reinterpret_cast<const uint8_t*>
-                                      (delimstr.c_str()+delimstr.size()),
-                                      reinterpret_cast<const uint8_t*>(delimstr.c_str()));
-      RPS_DEBUG_LOG(REPL, "Rps_TokenSource::get_delimiter prevu8='" << (const char*)prevu8
-                    << "' for delimstr='" << delimstr << "' with curuc#" << (int)curuc
-                    << " at " << startpos << " loopcnt#" << loopcnt);
-      if (!prevu8)
-        break;
-      unsigned curlen = delimstr.size();
-      unsigned prevlen = (delimstr.c_str()+delimstr.size() - (const char*)prevu8) +1;
-      RPS_DEBUG_LOG(REPL, "Rps_TokenSource::get_delimiter for delimstr='"
-                    << delimstr <<"' curlen=" << curlen
-                    << " prevlen=" << prevlen
-                    << " prevu8='" << Rps_Cjson_String((const char*)prevu8)
-                    << "'");
-      if (prevlen==0 || prevlen > curlen)
-        break;
-      delimstr[prevlen] = (char)0; /// facilitates debugging, in principle useless
-      delimstr.resize(prevlen);
-      RPS_DEBUG_LOG(REPL, "get_delimiter now delimstr='" << delimstr << "' at " << startpos
-                    << " prevlen=" << prevlen << " curlen=" << curlen
-                    << " loopcnt#" << loopcnt << std::endl);
-      usleep (250000);
-    } // end while loop
+      _f.lexkindob = RPS_ROOT_OB(_2wdmxJecnFZ02VGGFK); //repl_delimiter∈class
+      _f.delimob = _f.delimv.as_object();
+      RPS_DEBUG_LOG(REPL, "Rps_TokenSource::get_delimiter delimob="
+                    << RPS_OBJECT_DISPLAY(_f.delimob)
+                    << " delimlen=" << delimlen);
+      _f.lextokv = _f.delimv;
+      toksrc_col += delimlen;
+      const Rps_String* strv = _f.namev.to_string();
+      Rps_LexTokenZone* lextok =
+        Rps_QuasiZone::rps_allocate6<Rps_LexTokenZone,Rps_TokenSource*,Rps_ObjectRef,Rps_Value,const Rps_String*,int,int>
+        (this,_f.lexkindob, _f.lextokv,
+         strv,
+         toksrc_line, startcol);
+      lextok->set_serial(++toksrc_counter);
+      _f.res = Rps_LexTokenValue(lextok);
+      RPS_DEBUG_LOG(REPL, "Rps_TokenSource::get_delimiter delimiter :-◑> " << _f.res << std::endl
+                    << "… at " << position_str() << std::endl
+                    << "… from¤ " << *this
+                    << Rps_Do_Output([&](std::ostream& out)
+      {
+        this->display_current_line_with_cursor(out);
+      })
+          << " startpos " << position_str(startcol) << std::endl
+          << RPS_FULL_BACKTRACE_HERE(1, "Rps_TokenSource::get_delimiter"));
+      return _f.res;
+    };
   RPS_POSSIBLE_BREAKPOINT();
+  std::string startpos = position_str(startcol);
   RPS_WARNOUT("Rps_TokenSource::get_delimiter failing at " << startpos
               << " for " << startp << " in " << *this << std::endl
               << " git " << rps_gitid << " timestamp " << rps_timestamp
-              << " delimstr='"  << Rps_Cjson_String(delimstr)
-              << "'" << " loopcnt=" << loopcnt
               << std::endl << " host:" << rps_hostname()
               << std::endl << " procversion:" << rps_get_proc_version()
               << std::endl
@@ -1843,6 +1960,7 @@ Rps_TokenSource::consume_front_token(Rps_CallFrame*callframe, bool*psuccess)
   ////
   RPS_ASSERT(!toksrc_token_deq.empty());
   toksrc_token_deq.pop_front();
+  note_consumed_token();
   RPS_DEBUG_LOG(REPL, "Rps_TokenSource::consume_front_token#" << callcnt
                 << " done€, now token_deq:" << toksrc_token_deq
                 << std::endl << RPS_FULL_BACKTRACE_HERE(1, "Rps_TokenSource::consume_front_token/done€")
@@ -1874,6 +1992,7 @@ Rps_TokenSource::append_back_new_token(Rps_CallFrame*callframe, Rps_Value tokenv
                 << " tokenv:" << _f.lextokv);
   RPS_ASSERT (_f.lextokv && _f.lextokv.is_lextoken());
   toksrc_token_deq.push_back(tokenv);
+  toksrc_parse_memo.clear();
   RPS_DEBUG_LOG(REPL, "Rps_TokenSource::append_back_new_token done€ token_deq=" << toksrc_token_deq
                 << std::endl << RPS_FULL_BACKTRACE_HERE(1, "Rps_TokenSource::append_back_new_token/done€"));
 } // end Rps_TokenSource::append_back_new_token
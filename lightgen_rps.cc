@@ -83,6 +83,12 @@ public:
   jit_state_t* lightg_jist;
   std::map<jit_node*,lightnodenum_t> lightg_nod2num_map;
   std::map<lightnodenum_t,jit_node*> lightg_num2nod_map;
+  /// the arguments of the routine being emitted, see rps_jitroutine_t
+  std::vector<jit_node_t*> lightg_routine_args;
+  /// the number of frame slots of the routine being emitted
+  unsigned lightg_nbslots;
+  /// the values used as constants in the routine
+  std::vector<Rps_Value> lightg_constants;
 #define _jit this->lightg_jist
 #define RPSJITLIGHTPAYLOAD_LOCKGUARD_AT(Lin) \
   std::lock_guard<std::recursive_mutex> gu##Lin(*(this->owner()->objmtxptr()));
@@ -177,6 +183,44 @@ public:
   };
   Rps_ObjectRef make_lightgen_code_object(Rps_CallFrame*callframe, Rps_ObjectRef classarg, Rps_ObjectRef spacearg);
   virtual void output_payload(std::ostream&out, unsigned depth, unsigned maxdepth) const;
+  ///
+  /// Emitting a routine of signature rps_jitroutine_t, for the
+  /// baseline JIT.  The prolog keeps the call frame in JIT_V0 and the
+  /// slots of that frame in JIT_V1, which emitted code should not
+  /// clobber.  Its arguments are ranked as in rps_jitroutine_t:
+  /// callframe, closure, arg0 ... arg3, restargs, slots, results.
+  /// Slot 0 has the closure and slots 1 to 4 the arguments; values
+  /// in registers are not seen by the garbage collector, so every
+  /// value live across a runtime call should be kept in a slot.
+  void rpsjit_begin_routine(void);
+  bool rpsjit_in_routine(void) const
+  {
+    RPSJITLIGHTPAYLOAD_LOCKGUARD();
+    return !lightg_routine_args.empty();
+  };
+  void rpsjit_get_routine_arg(jit_gpr_t reg, unsigned rank);
+  void rpsjit_load_constant(jit_gpr_t reg, Rps_Value val);
+  unsigned rpsjit_new_slot(void);
+  void rpsjit_load_slot(jit_gpr_t reg, unsigned slotix);
+  void rpsjit_store_slot(unsigned slotix, jit_gpr_t reg);
+  /// call the runtime to apply a closure, or send a message, with
+  /// up to four arguments in registers; the main result is stored in
+  /// a new slot, whose index is given, and goes into resreg
+  unsigned rpsjit_call_apply(jit_gpr_t resreg, jit_gpr_t closreg,
+                             const std::vector<jit_gpr_t>& argregs);
+  unsigned rpsjit_call_send(jit_gpr_t resreg, jit_gpr_t recvreg, Rps_ObjectRef obselector,
+                            const std::vector<jit_gpr_t>& argregs);
+  void rpsjit_end_routine(jit_gpr_t mainreg, jit_gpr_t xtrareg);
+  /// emit the machine code of the routine, freezing this generator
+  rps_jitroutine_t* rpsjit_emit_routine(void);
+  const std::vector<Rps_Value>& rpsjit_constants(void) const
+  {
+    return lightg_constants;
+  };
+  unsigned rpsjit_nb_slots(void) const
+  {
+    return lightg_nbslots;
+  };
 };        // end class Rps_PayloadLightningCodeGen
 
 
@@ -186,7 +230,8 @@ public:
 ////////////////////////////////////////////////////////////////
 Rps_PayloadLightningCodeGen::Rps_PayloadLightningCodeGen(Rps_ObjectZone*owner)
   : Rps_Payload(Rps_Type::PaylLightCodeGen,owner), lightg_jist(nullptr),
-    lightg_nod2num_map(), lightg_num2nod_map()
+    lightg_nod2num_map(), lightg_num2nod_map(),
+    lightg_routine_args(), lightg_nbslots(0), lightg_constants()
 {
   lightg_jist = jit_new_state();
   RPSJITLIGHTPAYLOAD_LOCKGUARD();
@@ -205,13 +250,19 @@ Rps_PayloadLightningCodeGen::~Rps_PayloadLightningCodeGen()
     };
   lightg_nod2num_map.clear();
   lightg_num2nod_map.clear();
-  _jit_destroy_state(lightg_jist); /// all nodes get destroyed!
+  lightg_routine_args.clear();
+  lightg_constants.clear();
+  if (lightg_jist) // a frozen generator keeps its code
+    _jit_destroy_state(lightg_jist); /// all nodes get destroyed!
   lightg_jist = nullptr;
 } // end destructor Rps_PayloadLightningCodeGen::~Rps_PayloadLightningCodeGen
 
 void
 Rps_PayloadLightningCodeGen::gc_mark(Rps_GarbageCollector&gc) const
 {
+  for (const Rps_Value& cstv: lightg_constants)
+    if (cstv)
+      cstv.gc_mark(gc);
 } // end of Rps_PayloadLightningCodeGen::gc_mark
 
 void
@@ -415,4 +466,380 @@ Rps_PayloadLightningCodeGen::make_lightgen_code_object(Rps_CallFrame*callframe,
 } // end Rps_PayloadLightningCodeGen::make_lightgen_code_object
 
 
+
+////////////////////////////////////////////////////////////////
+//// Emitting routines for the baseline JIT
+
+void
+Rps_PayloadLightningCodeGen::rpsjit_begin_routine(void)
+{
+  RPSJITLIGHTPAYLOAD_LOCKGUARD();
+  RPS_ASSERT(lightg_jist != nullptr);
+  RPS_ASSERT(lightg_routine_args.empty());
+  RPS_ASSERT(JIT_V_NUM >= 3);
+  jit_prolog();
+  for (int ix=0; ix<9; ix++)
+    lightg_routine_args.push_back(jit_arg());
+  jit_getarg(JIT_V0, lightg_routine_args[0]);
+  jit_getarg(JIT_V1, lightg_routine_args[7]);
+  lightg_nbslots = rps_jit_arg_slots;
+} // end Rps_PayloadLightningCodeGen::rpsjit_begin_routine
+
+void
+Rps_PayloadLightningCodeGen::rpsjit_get_routine_arg(jit_gpr_t reg, unsigned rank)
+{
+  RPSJITLIGHTPAYLOAD_LOCKGUARD();
+  RPS_ASSERT(rank < lightg_routine_args.size());
+  jit_getarg(reg, lightg_routine_args[rank]);
+} // end Rps_PayloadLightningCodeGen::rpsjit_get_routine_arg
+
+void
+Rps_PayloadLightningCodeGen::rpsjit_load_constant(jit_gpr_t reg, Rps_Value val)
+{
+  RPSJITLIGHTPAYLOAD_LOCKGUARD();
+  if (val && !val.is_empty())
+    lightg_constants.push_back(val);
+  jit_movi(reg, (jit_word_t)val.unsafe_wptr());
+} // end Rps_PayloadLightningCodeGen::rpsjit_load_constant
+
+unsigned
+Rps_PayloadLightningCodeGen::rpsjit_new_slot(void)
+{
+  RPSJITLIGHTPAYLOAD_LOCKGUARD();
+  RPS_ASSERT(!lightg_routine_args.empty());
+  if (lightg_nbslots >= rps_jit_max_slots)
+    throw RPS_RUNTIME_ERROR_OUT("Rps_PayloadLightningCodeGen::rpsjit_new_slot in "
+                                << owner() << " too many slots");
+  return lightg_nbslots++;
+} // end Rps_PayloadLightningCodeGen::rpsjit_new_slot
+
+void
+Rps_PayloadLightningCodeGen::rpsjit_load_slot(jit_gpr_t reg, unsigned slotix)
+{
+  RPSJITLIGHTPAYLOAD_LOCKGUARD();
+  RPS_ASSERT(slotix < lightg_nbslots);
+  jit_ldxi(reg, JIT_V1, slotix*sizeof(void*));
+} // end Rps_PayloadLightningCodeGen::rpsjit_load_slot
+
+void
+Rps_PayloadLightningCodeGen::rpsjit_store_slot(unsigned slotix, jit_gpr_t reg)
+{
+  RPSJITLIGHTPAYLOAD_LOCKGUARD();
+  RPS_ASSERT(slotix < lightg_nbslots);
+  jit_stxi(slotix*sizeof(void*), JIT_V1, reg);
+} // end Rps_PayloadLightningCodeGen::rpsjit_store_slot
+
+unsigned
+Rps_PayloadLightningCodeGen::rpsjit_call_apply(jit_gpr_t resreg, jit_gpr_t closreg,
+    const std::vector<jit_gpr_t>& argregs)
+{
+  RPSJITLIGHTPAYLOAD_LOCKGUARD();
+  RPS_ASSERT(argregs.size() <= 4);
+  RPS_ASSERT(!lightg_routine_args.empty());
+  jit_prepare();
+  jit_pushargr(JIT_V0);
+  jit_pushargr(closreg);
+  for (unsigned ix=0; ix<4; ix++)
+    {
+      if (ix < argregs.size())
+        jit_pushargr(argregs[ix]);
+      else
+        jit_pushargi(0);
+    };
+  jit_finishi((jit_pointer_t)rps_jit_runtime_apply);
+  jit_retval(resreg);
+  unsigned resslot = rpsjit_new_slot();
+  jit_stxi(resslot*sizeof(void*), JIT_V1, resreg);
+  return resslot;
+} // end Rps_PayloadLightningCodeGen::rpsjit_call_apply
+
+unsigned
+Rps_PayloadLightningCodeGen::rpsjit_call_send(jit_gpr_t resreg, jit_gpr_t recvreg, Rps_ObjectRef obselector,
+    const std::vector<jit_gpr_t>& argregs)
+{
+  RPSJITLIGHTPAYLOAD_LOCKGUARD();
+  RPS_ASSERT(obselector);
+  RPS_ASSERT(argregs.size() <= 4);
+  RPS_ASSERT(!lightg_routine_args.empty());
+  lightg_constants.push_back(Rps_Value(obselector));
+  jit_prepare();
+  jit_pushargr(JIT_V0);
+  jit_pushargr(recvreg);
+  jit_pushargi((jit_word_t)obselector.optr());
+  for (unsigned ix=0; ix<4; ix++)
+    {
+      if (ix < argregs.size())
+        jit_pushargr(argregs[ix]);
+      else
+        jit_pushargi(0);
+    };
+  jit_finishi((jit_pointer_t)rps_jit_runtime_send);
+  jit_retval(resreg);
+  unsigned resslot = rpsjit_new_slot();
+  jit_stxi(resslot*sizeof(void*), JIT_V1, resreg);
+  return resslot;
+} // end Rps_PayloadLightningCodeGen::rpsjit_call_send
+
+void
+Rps_PayloadLightningCodeGen::rpsjit_end_routine(jit_gpr_t mainreg, jit_gpr_t xtrareg)
+{
+  RPSJITLIGHTPAYLOAD_LOCKGUARD();
+  RPS_ASSERT(!lightg_routine_args.empty());
+  RPS_ASSERT(mainreg != JIT_V2 && xtrareg != JIT_V2);
+  jit_getarg(JIT_V2, lightg_routine_args[8]);
+  jit_stxi(0, JIT_V2, mainreg);
+  jit_stxi(sizeof(void*), JIT_V2, xtrareg);
+  jit_ret();
+  jit_epilog();
+} // end Rps_PayloadLightningCodeGen::rpsjit_end_routine
+
+/// the states of emitted code are kept, since the code is in them
+static std::mutex rps_lightgen_code_mtx;
+static std::vector<jit_state_t*> rps_lightgen_code_states;
+
+rps_jitroutine_t*
+Rps_PayloadLightningCodeGen::rpsjit_emit_routine(void)
+{
+  RPSJITLIGHTPAYLOAD_LOCKGUARD();
+  RPS_ASSERT(lightg_jist != nullptr);
+  RPS_ASSERT(!lightg_routine_args.empty());
+  jit_pointer_t code = jit_emit();
+  if (!code)
+    return nullptr;
+  jit_clear_state();
+  {
+    std::lock_guard<std::mutex> gucode(rps_lightgen_code_mtx);
+    rps_lightgen_code_states.push_back(lightg_jist);
+  }
+  /// the nodes are gone
+  lightg_nod2num_map.clear();
+  lightg_num2nod_map.clear();
+  lightg_jist = nullptr;
+  return (rps_jitroutine_t*)code;
+} // end Rps_PayloadLightningCodeGen::rpsjit_emit_routine
+
+
+////////////////////////////////////////////////////////////////
+//// The baseline JIT.  When a connective gets hot,
+//// Rps_ObjectZone::count_application queues it; that can happen in
+//// any thread and with locks held, so nothing more is done there.
+//// Agenda worker threads then compile the queued connectives at
+//// tasklet boundaries: the class of a connective may have a
+//// lightning_generate_code method emitting a routine with the member
+//// functions above, which is then installed.  A connective is tried
+//// only once, and routines from libgccjit are never replaced.
+
+static std::mutex rps_lightning_hot_mtx;
+static std::deque<Rps_ObjectZone*> rps_lightning_hot_queue;
+static std::set<Rps_Id> rps_lightning_hot_tried;
+
+void
+rps_lightning_queue_hot_connective(Rps_ObjectZone*obzconn)
+{
+  RPS_ASSERT(obzconn);
+  std::lock_guard<std::mutex> guhot(rps_lightning_hot_mtx);
+  if (rps_lightning_hot_tried.insert(obzconn->oid()).second)
+    rps_lightning_hot_queue.push_back(obzconn);
+} // end rps_lightning_queue_hot_connective
+
+/// the queued connectives are kept alive till they are compiled
+void
+rps_lightning_gc_mark_hot_queue(Rps_GarbageCollector&gc)
+{
+  std::lock_guard<std::mutex> guhot(rps_lightning_hot_mtx);
+  for (Rps_ObjectZone* obz: rps_lightning_hot_queue)
+    gc.mark_obj(Rps_ObjectRef(obz));
+} // end rps_lightning_gc_mark_hot_queue
+
+static void
+rps_lightning_compile_hot_connective(Rps_CallFrame*callerframe, Rps_ObjectRef obconnarg)
+{
+  static std::once_flag initonce;
+  RPS_ASSERT(obconnarg);
+  if (rps_jit_routine_tier(obconnarg.optr()) != RPS_JIT_TIER_NONE)
+    return;
+  std::call_once(initonce, [](void)
+  {
+    init_jit(rps_progname);
+  });
+  RPS_LOCALFRAME(RPS_ROOT_OB(_6SM7PykipQW01HVClH), //midend_lightning_code_generator∈class
+                 callerframe,
+                 Rps_ObjectRef obconn;
+                 Rps_ObjectRef obgenerator;
+                 Rps_Value mainv;
+                );
+  _f.obconn = obconnarg;
+  _f.obgenerator =
+    Rps_ObjectRef::make_object(&_,
+                               RPS_ROOT_OB(_6SM7PykipQW01HVClH) //midend_lightning_code_generator∈class
+                              );
+  Rps_PayloadLightningCodeGen*paylgen =
+    _f.obgenerator->put_new_plain_payload<Rps_PayloadLightningCodeGen>();
+  RPS_ASSERT(paylgen != nullptr);
+  double startrealt = rps_wallclock_real_time();
+  try
+    {
+      Rps_TwoValues res =
+        Rps_Value(_f.obconn).send2(&_,
+                                   //lightning_generate_code∈named_selector:
+                                   RPS_ROOT_OB(_6GiKCsHJDCi04m74XV),
+                                   _f.obgenerator,
+                                   Rps_Value::make_tagged_int(_f.obconn->application_count()));
+      _f.mainv = res.main();
+    }
+  catch (std::exception&exc)
+    {
+      RPS_WARNOUT("rps_lightning_compile_hot_connective failed for " << _f.obconn
+                  << " : " << exc.what());
+      _f.mainv = nullptr;
+    };
+  if (!_f.mainv || !paylgen->rpsjit_in_routine())
+    {
+      RPS_DEBUG_LOG(CODEGEN, "rps_lightning_compile_hot_connective no routine for "
+                    << _f.obconn << " applied "
+                    << _f.obconn->application_count() << " times");
+      return;
+    };
+  rps_jitroutine_t* routine = paylgen->rpsjit_emit_routine();
+  if (!routine)
+    {
+      RPS_WARNOUT("rps_lightning_compile_hot_connective failed to emit code for "
+                  << _f.obconn);
+      return;
+    };
+  bool installed = rps_install_jit_routine(_f.obconn.optr(), routine,
+                   paylgen->rpsjit_constants(),
+                   paylgen->rpsjit_nb_slots(),
+                   RPS_JIT_TIER_BASELINE);
+  RPS_DEBUG_LOG(CODEGEN, "rps_lightning_compile_hot_connective "
+                << (installed?"installed":"did not install")
+                << " routine for " << _f.obconn
+                << " in " << (rps_wallclock_real_time() - startrealt) << " s");
+} // end rps_lightning_compile_hot_connective
+
+void
+rps_lightning_compile_hot_connectives(Rps_CallFrame*callerframe)
+{
+  RPS_LOCALFRAME(RPS_CALL_FRAME_UNDESCRIBED,
+                 callerframe,
+                 Rps_ObjectRef obconn;
+                );
+  for (;;)
+    {
+      {
+        std::lock_guard<std::mutex> guhot(rps_lightning_hot_mtx);
+        if (rps_lightning_hot_queue.empty())
+          return;
+        _f.obconn = Rps_ObjectRef(rps_lightning_hot_queue.front());
+        rps_lightning_hot_queue.pop_front();
+      }
+      rps_lightning_compile_hot_connective(&_, _f.obconn);
+    };
+} // end rps_lightning_compile_hot_connectives
+
+/// applying functions of the !test_hot_connective command: the hot
+/// connective has the first one, which its routine replaces; the
+/// routine applies twice a closure with the second one, and is
+/// emitted by the third, the lightning_generate_code method of the
+/// class of the hot connective
+static Rps_Value rps_lightning_test_succlos;
+
+static Rps_TwoValues
+rps_lightning_test_native(Rps_CallFrame*, const Rps_Value arg0,
+                          const Rps_Value, const Rps_Value, const Rps_Value,
+                          const std::vector<Rps_Value>*)
+{
+  return Rps_TwoValues(Rps_Value::make_tagged_int(arg0.as_int()+100));
+} // end rps_lightning_test_native
+
+static Rps_TwoValues
+rps_lightning_test_succ(Rps_CallFrame*, const Rps_Value arg0,
+                        const Rps_Value, const Rps_Value, const Rps_Value,
+                        const std::vector<Rps_Value>*)
+{
+  return Rps_TwoValues(Rps_Value::make_tagged_int(arg0.as_int()+1));
+} // end rps_lightning_test_succ
+
+static Rps_TwoValues
+rps_lightning_test_generate(Rps_CallFrame*, const Rps_Value, const Rps_Value genv,
+                            const Rps_Value, const Rps_Value,
+                            const std::vector<Rps_Value>*)
+{
+  RPS_ASSERT(genv.is_object());
+  auto paylgen = genv.as_object()->get_dynamic_payload<Rps_PayloadLightningCodeGen>();
+  RPS_ASSERT(paylgen != nullptr);
+  paylgen->rpsjit_begin_routine();
+  paylgen->rpsjit_get_routine_arg(JIT_R1, 2);
+  paylgen->rpsjit_load_constant(JIT_R0, rps_lightning_test_succlos);
+  paylgen->rpsjit_call_apply(JIT_R2, JIT_R0, {JIT_R1});
+  /// the call clobbered JIT_R0
+  paylgen->rpsjit_load_constant(JIT_R0, rps_lightning_test_succlos);
+  paylgen->rpsjit_call_apply(JIT_R2, JIT_R0, {JIT_R2});
+  paylgen->rpsjit_load_constant(JIT_R1, nullptr);
+  paylgen->rpsjit_end_routine(JIT_R2, JIT_R1);
+  return Rps_TwoValues(genv);
+} // end rps_lightning_test_generate
+
+void
+rps_lightning_test_hot_connective(Rps_CallFrame*callerframe)
+{
+  RPS_LOCALFRAME(RPS_CALL_FRAME_UNDESCRIBED,
+                 callerframe,
+                 Rps_ObjectRef obclass;
+                 Rps_ObjectRef obgenconn;
+                 Rps_ObjectRef obsucc;
+                 Rps_ObjectRef obconn;
+                 Rps_Value succlosv;
+                 Rps_Value closv;
+                 Rps_Value resv;
+                );
+  unsigned threshold = rps_jit_hot_threshold;
+  if (threshold == 0)
+    RPS_FATALOUT("rps_lightning_test_hot_connective with the baseline JIT disabled by --jit-threshold=0");
+  _f.obsucc = Rps_ObjectRef::make_object(&_, Rps_ObjectRef::the_object_class());
+  _f.obsucc->put_applying_function(rps_lightning_test_succ);
+  _f.succlosv = Rps_ClosureValue(_f.obsucc, {});
+  rps_lightning_test_succlos = _f.succlosv;
+  _f.obgenconn = Rps_ObjectRef::make_object(&_, Rps_ObjectRef::the_object_class());
+  _f.obgenconn->put_applying_function(rps_lightning_test_generate);
+  _f.obclass = Rps_ObjectRef::make_object(&_, Rps_ObjectRef::the_class_class());
+  {
+    std::lock_guard<std::recursive_mutex> gucla(*(_f.obclass->objmtxptr()));
+    auto paylcl = _f.obclass->put_new_plain_payload<Rps_PayloadClassInfo>();
+    paylcl->put_superclass(Rps_ObjectRef::the_object_class());
+    paylcl->put_own_method(RPS_ROOT_OB(_6GiKCsHJDCi04m74XV), //lightning_generate_code∈named_selector
+                           Rps_ClosureValue(_f.obgenconn, {}));
+  }
+  _f.obconn = Rps_ObjectRef::make_object(&_, _f.obclass);
+  _f.obconn->put_applying_function(rps_lightning_test_native);
+  _f.closv = Rps_ClosureValue(_f.obconn, {});
+  for (unsigned ix=0; ix<threshold; ix++)
+    {
+      _f.resv = Rps_ClosureValue(_f.closv).apply1(&_, Rps_Value::make_tagged_int(ix)).main();
+      if (_f.resv.as_int() != (intptr_t)ix+100)
+        RPS_FATALOUT("rps_lightning_test_hot_connective got " << _f.resv
+                     << " from " << _f.obconn << " before it got hot");
+    };
+  if (_f.obconn->application_count() != threshold)
+    RPS_FATALOUT("rps_lightning_test_hot_connective counted "
+                 << _f.obconn->application_count() << " applications of "
+                 << _f.obconn << " instead of " << threshold);
+  /// agenda worker threads may be compiling it already
+  rps_lightning_compile_hot_connectives(&_);
+  for (int loop=0; loop<500 && rps_jit_routine_tier(_f.obconn.optr()) == RPS_JIT_TIER_NONE; loop++)
+    usleep(10000);
+  rps_lightning_test_succlos = nullptr;
+  if (rps_jit_routine_tier(_f.obconn.optr()) != RPS_JIT_TIER_BASELINE)
+    RPS_FATALOUT("rps_lightning_test_hot_connective: no baseline routine for " << _f.obconn
+                 << " after " << threshold << " applications");
+  _f.resv = Rps_ClosureValue(_f.closv).apply1(&_, Rps_Value::make_tagged_int(40)).main();
+  if (!_f.resv.is_int() || _f.resv.as_int() != 42)
+    RPS_FATALOUT("rps_lightning_test_hot_connective got " << _f.resv
+                 << " instead of 42 from the routine of " << _f.obconn);
+  /// what the dumper writes for the connective
+  if (rps_jit_native_applying_function(_f.obconn.optr()) != rps_lightning_test_native)
+    RPS_FATALOUT("rps_lightning_test_hot_connective: the native applying function of "
+                 << _f.obconn << " is lost");
+} // end rps_lightning_test_hot_connective
+
 #warning incomplete lightgen_rps.cc file
@@ -78,8 +78,9 @@ class Rps_Loader
 {
   std::string ld_topdir;
   double ld_startclock;
-  /// dlsym and dlopen are not reentrant, so we need a mutex; is is
-  /// recursive since we might lock it in a nested way
+  /// dlopen is not reentrant, so we need a mutex; is is recursive
+  /// since we might lock it in a nested way; symbols are resolved by
+  /// rps_plugin_dlsym without it
   std::recursive_mutex ld_mtx;
   /// set of space ids
   std::set<Rps_Id> ld_spaceset;
@@ -103,6 +104,10 @@ class Rps_Loader
   static constexpr unsigned ld_maxtodo = 1<<20;
   /// dictionary of payload loaders - used as a cache to avoid most dlsym-s
   std::map<std::string,rpsldpysig_t*> ld_payloadercache;
+  /// asynchronous reads of space files, all submitted at start of
+  /// load_all_state_files, and their contents, kept till the second pass
+  std::map<Rps_Id,Rps_AsyncFileIo::ticket_t> ld_spacereadmap;
+  std::map<Rps_Id,std::string> ld_spacecontentmap;
   bool is_object_starting_line(Rps_Id spacid, unsigned lineno, const std::string&linbuf, Rps_Id*pobid);
   Rps_ObjectRef fetch_one_constant_at(const char*oid,int lin);
   void parse_json_buffer_second_pass (Rps_Id spacid, unsigned lineno,
@@ -118,6 +123,7 @@ public:
   void second_pass_space(Rps_Id spacid);
   std::string string_of_loaded_file(const std::string& relpath);
   std::string space_file_path(Rps_Id spacid);
+  const std::string& space_file_content(Rps_Id spacid);
   std::string load_real_path(const std::string& path);
   Rps_ObjectRef find_object_by_oid(Rps_Id oid)
   {
@@ -151,7 +157,9 @@ Rps_Loader::Rps_Loader(const std::string&topdir) :
   ld_mapobjects(),
   ld_todoque(),
   ld_todocount(0),
-  ld_payloadercache()
+  ld_payloadercache(),
+  ld_spacereadmap(),
+  ld_spacecontentmap()
 {
   RPS_DEBUG_LOG(LOAD, "Rps_Loader constr topdir=" << topdir
                 << " this@" << (void*)this
@@ -213,6 +221,25 @@ Rps_Loader::space_file_path(Rps_Id spacid)
   return std::string{"persistore/sp"} + spacid.to_string() + "-rps.json";
 } // end Rps_Loader::space_file_path
 
+const std::string&
+Rps_Loader::space_file_content(Rps_Id spacid)
+{
+  auto itcont = ld_spacecontentmap.find(spacid);
+  if (itcont != ld_spacecontentmap.end())
+    return itcont->second;
+  Rps_AsyncFileIo::ticket_t tick = 0;
+  auto itread = ld_spacereadmap.find(spacid);
+  if (itread != ld_spacereadmap.end())
+    {
+      tick = itread->second;
+      ld_spacereadmap.erase(itread);
+    }
+  else
+    tick = Rps_AsyncFileIo::submit_read_file(load_real_path(space_file_path(spacid)));
+  ld_spacecontentmap[spacid] = Rps_AsyncFileIo::wait_read(tick);
+  return ld_spacecontentmap[spacid];
+} // end Rps_Loader::space_file_content
+
 
 
 bool
@@ -309,7 +336,7 @@ void
 Rps_Loader::first_pass_space(Rps_Id spacid)
 {
   auto spacepath = load_real_path(space_file_path(spacid));
-  std::ifstream ins(spacepath);
+  std::istringstream ins(space_file_content(spacid));
   std::string prologstr;
   int obcnt = 0;
   int expectedcnt = 0;
@@ -318,8 +345,7 @@ Rps_Loader::first_pass_space(Rps_Id spacid)
   for (std::string linbuf; std::getline(ins, linbuf); )
     {
       lincnt++;
-      if (u8_check(reinterpret_cast<const uint8_t*> (linbuf.c_str()),
-                   linbuf.size()))
+      if (rps_utf8_check(linbuf.c_str(), linbuf.size()))
         {
           RPS_WARN("non UTF8 line#%d in %s:\n%s",
                    lincnt, spacepath.c_str(), linbuf.c_str());
@@ -634,7 +660,6 @@ Rps_Loader::parse_json_buffer_second_pass (Rps_Id spacid, unsigned lineno,
   if (objjson.isMember("magicattr"))
     {
       RPS_DEBUG_LOG(LOAD, "parse_json_buffer_second_pass magicattr objid=" << objid);
-      std::lock_guard<std::recursive_mutex> gu(ld_mtx);
       char getfunambuf[sizeof(RPS_GETTERFUN_PREFIX)+8+Rps_Id::nbchars];
       memset(getfunambuf, 0, sizeof(getfunambuf));
       char obidbuf[32];
@@ -643,17 +668,15 @@ Rps_Loader::parse_json_buffer_second_pass (Rps_Id spacid, unsigned lineno,
       strcpy(getfunambuf, RPS_GETTERFUN_PREFIX);
       strcat(getfunambuf+strlen(RPS_GETTERFUN_PREFIX), obidbuf);
       RPS_ASSERT(strlen(getfunambuf)<sizeof(getfunambuf)-4);
-      void*funad = dlsym(rps_proghdl, getfunambuf);
+      void*funad = rps_plugin_dlsym(getfunambuf);
       if (!funad)
         RPS_FATALOUT("cannot dlsym " << getfunambuf << " for magic attribute getter of objid:" <<  objid
-                     << " lineno:" << lineno << ", spacid:" << spacid
-                     << ":: " << dlerror());
+                     << " lineno:" << lineno << ", spacid:" << spacid);
       obz->loader_put_magicattrgetter(this, reinterpret_cast<rps_magicgetterfun_t*>(funad));
     };        // end with "magicattr" JSON member
   if (objjson.isMember("applying"))
     {
       RPS_DEBUG_LOG(LOAD, "parse_json_buffer_second_pass applying objid=" << objid);
-      std::lock_guard<std::recursive_mutex> gu(ld_mtx);
       char appfunambuf[sizeof(RPS_APPLYINGFUN_PREFIX)+8+Rps_Id::nbchars];
       memset(appfunambuf, 0, sizeof(appfunambuf));
       char obidbuf[32];
@@ -662,11 +685,10 @@ Rps_Loader::parse_json_buffer_second_pass (Rps_Id spacid, unsigned lineno,
       strcpy(appfunambuf, RPS_APPLYINGFUN_PREFIX);
       strcat(appfunambuf+strlen(RPS_APPLYINGFUN_PREFIX), obidbuf);
       RPS_ASSERT(strlen(appfunambuf)<sizeof(appfunambuf)-4);
-      void*funad = dlsym(rps_proghdl, appfunambuf);
+      void*funad = rps_plugin_dlsym(appfunambuf);
       if (!funad)
         RPS_FATALOUT("cannot dlsym " << appfunambuf << " for applying function of objid:" <<  objid
-                     << " lineno:" << lineno << ", spacid:" << spacid
-                     << ":: " << dlerror());
+                     << " lineno:" << lineno << ", spacid:" << spacid);
       obz->loader_put_applyingfunction(this, reinterpret_cast<rps_applyingfun_t*>(funad));
     };        // end with "applying" JSON member
   if (objjson.isMember("payload"))
@@ -682,11 +704,10 @@ Rps_Loader::parse_json_buffer_second_pass (Rps_Id spacid, unsigned lineno,
             if (isalpha(firstc))
               {
                 std::string symstr = std::string(RPS_PAYLOADING_PREFIX) + paylstr;
-                void* symad = dlsym(rps_proghdl, symstr.c_str());
+                void* symad = rps_plugin_dlsym(symstr.c_str());
                 if (!symad)
                   RPS_FATALOUT("cannot dlsym " << symstr << " for payload of objid:" <<  objid
-                               << " lineno:" << lineno << ", spacid:" << spacid
-                               << ":: " << dlerror());
+                               << " lineno:" << lineno << ", spacid:" << spacid);
                 pldfun = (rpsldpysig_t*)symad;
                 ld_payloadercache.insert({paylstr, pldfun});
               }
@@ -725,7 +746,6 @@ Rps_Loader::parse_json_buffer_second_pass (Rps_Id spacid, unsigned lineno,
   if (obz->is_instance_of(RPS_ROOT_OB(_3O1QUNKZ4bU02amQus) //∈rps_routine
                          ))
     {
-      std::lock_guard<std::recursive_mutex> gu(ld_mtx);
       char appfunambuf[sizeof(RPS_APPLYINGFUN_PREFIX)+8+Rps_Id::nbchars];
       memset(appfunambuf, 0, sizeof(appfunambuf));
       char obidbuf[32];
@@ -734,12 +754,11 @@ Rps_Loader::parse_json_buffer_second_pass (Rps_Id spacid, unsigned lineno,
       strcpy(appfunambuf, RPS_APPLYINGFUN_PREFIX);
       strcat(appfunambuf+strlen(RPS_APPLYINGFUN_PREFIX), obidbuf);
       RPS_ASSERT(strlen(appfunambuf)<sizeof(appfunambuf)-4);
-      void*funad = dlsym(rps_proghdl, appfunambuf);
+      void*funad = rps_plugin_dlsym(appfunambuf);
       if (!funad)
         RPS_WARNOUT("cannot dlsym " << appfunambuf << " for applying function of objid:" <<  objid
                     << Rps_ObjectRef(obz)
-                    << " lineno:" << lineno << ", spacid:" << spacid
-                    << ":: " << dlerror());
+                    << " lineno:" << lineno << ", spacid:" << spacid);
       else
         obz->loader_put_applyingfunction(this, reinterpret_cast<rps_applyingfun_t*>(funad));
     };
@@ -747,7 +766,6 @@ Rps_Loader::parse_json_buffer_second_pass (Rps_Id spacid, unsigned lineno,
   if (objjson.isMember("loadrout"))
     {
       auto loadroutstr = objjson["loadrout"].asString();
-      std::lock_guard<std::recursive_mutex> gu(ld_mtx);
       if (loadroutstr.empty())
         RPS_WARNOUT("invalid loadrout for loading routine function of objid:" <<  objid
                     << Rps_ObjectRef(obz)
@@ -755,13 +773,12 @@ Rps_Loader::parse_json_buffer_second_pass (Rps_Id spacid, unsigned lineno,
                     << std::endl << objjson);
       else
         {
-          void*ldroutad = dlsym(rps_proghdl, loadroutstr.c_str());
+          void*ldroutad = rps_plugin_dlsym(loadroutstr.c_str());
           if (!ldroutad)
             RPS_WARNOUT("cannot dlsym " << loadroutstr
                         << " for loading routine function of objid:" <<  objid
                         << Rps_ObjectRef(obz)
-                        << " lineno:" << lineno << ", spacid:" << spacid
-                        << ":: " << dlerror());
+                        << " lineno:" << lineno << ", spacid:" << spacid);
           rpsldpysig_t*ldrout = (rpsldpysig_t*)ldroutad;
           (*ldrout)(obz, this, objjson, spacid, lineno);
         };
@@ -779,7 +796,7 @@ Rps_Loader::second_pass_space(Rps_Id spacid)
   RPS_DEBUG_LOG(LOAD, "Rps_Loader::second_pass_space start spacid:" << spacid
                 << std::endl << RPS_FULL_BACKTRACE_HERE(0, "RpsLoader::second_pass_space"));
   auto spacepath = load_real_path(space_file_path(spacid));
-  std::ifstream ins(spacepath);
+  std::istringstream ins(space_file_content(spacid));
   unsigned lincnt = 0;
   unsigned obcnt = 0;
   Rps_Id prevoid;
@@ -860,6 +877,14 @@ Rps_Loader::load_all_state_files(void)
                 << std::endl << RPS_FULL_BACKTRACE_HERE(0, "RpsLoader::load_all_state_files"));
   int spacecnt1 = 0, spacecnt2 = 0;
   Rps_Id initialspaceid("_8J6vNYtP5E800eCr5q"); //"initial_space"∈space
+  /// submit all the space file reads at once, they are waited for
+  /// by space_file_content
+  ld_spacereadmap[initialspaceid]
+    = Rps_AsyncFileIo::submit_read_file(load_real_path(space_file_path(initialspaceid)));
+  for (Rps_Id spacid: ld_spaceset)
+    if (ld_spacereadmap.find(spacid) == ld_spacereadmap.end())
+      ld_spacereadmap[spacid]
+        = Rps_AsyncFileIo::submit_read_file(load_real_path(space_file_path(spacid)));
   first_pass_space(initialspaceid);
   spacecnt1++;
   initialize_root_objects();
@@ -878,6 +903,13 @@ Rps_Loader::load_all_state_files(void)
   RPS_INFORM("%s loaded %d space files in first pass",
 	     thisprog, spacecnt1);
   initialize_constant_objects();
+  /// resolving native functions in the second pass is then a lookup
+  /// in a hash table, which does not need our ld_mtx
+  {
+    unsigned nbsyms = rps_plugin_scan_symbols();
+    RPS_DEBUG_LOG(LOAD, "Rps_Loader::load_all_state_files scanned " << nbsyms
+                  << " native symbols");
+  }
   /// conceptually, the second pass might be done in parallel
   /// (multi-threaded, with different threads working on different
   /// spaces), but this require more clever locking and
@@ -886,6 +918,7 @@ Rps_Loader::load_all_state_files(void)
     {
       run_some_todo_functions();
       second_pass_space(spacid);
+      ld_spacecontentmap.erase(spacid);
       spacecnt2++;
       usleep(30);
     }
@@ -928,8 +961,7 @@ Rps_Loader::string_of_loaded_file(const std::string&relpath)
   for (std::string linbuf; std::getline(inp, linbuf); )
     {
       lincnt++;
-      if (u8_check(reinterpret_cast<const uint8_t*> (linbuf.c_str()),
-                   linbuf.size()))
+      if (rps_utf8_check(linbuf.c_str(), linbuf.size()))
         {
           RPS_WARN("non UTF8 line#%d in %s:\n%s",
                    lincnt, fullpath.c_str(), linbuf.c_str());
@@ -1212,12 +1244,19 @@ Rps_InstanceZone::fill_loaded_instance_from_json(Rps_Loader*ld,Rps_ObjectRef obc
               throw RPS_RUNTIME_ERROR_OUT("Rps_InstanceZone::make_from_attributes_components class " << obclass
                                           << " unexpected attribute " << curat);
           };
+        const Rps_InstanceShape*shape = clpayl->instance_shape();
+        unsigned nbslots = shape?shape->nb_attributes():0;
+        if (2*nbslots+nbcomps > cnt())
+          throw RPS_RUNTIME_ERROR_OUT("Rps_InstanceZone::fill_loaded_instance_from_json class " << obclass
+                                      << " with " << nbslots << " attributes and " << nbcomps
+                                      << " components does not fit size " << cnt());
+        _treenbattrs = nbslots;
         Rps_Value*sonarr = raw_data_sons();
         for (auto it : attrmap)
           {
             Rps_ObjectRef curat = it.first;
             Rps_Value curval = it.second;
-            int ix=attrset->element_index(curat);
+            int ix=shape->slot(curat.optr());
             RPS_ASSERT(ix>=0);
             sonarr[2*ix] = curat;
             sonarr[2*ix+1] = curval;
@@ -1225,7 +1264,7 @@ Rps_InstanceZone::fill_loaded_instance_from_json(Rps_Loader*ld,Rps_ObjectRef obc
         for (int cix=0; cix<(int)nbcomps; cix++)
           {
             Rps_Value curcomp = compvec[cix];
-            sonarr[2*nbattrs+cix] = curcomp;
+            sonarr[2*nbslots+cix] = curcomp;
           }
       }
     else
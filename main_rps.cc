@@ -75,6 +75,7 @@ std::string rps_cpluspluseditor_str;
 std::string rps_cplusplusflags_str;
 std::string rps_dumpdir_str;
 std::vector<std::string> rps_command_vec;
+std::string rps_repl_script_path;
 std::string rps_test_repl_string;
 char*rps_pidfile_path;
 /// the … is unicode U+2026 HORIZONTAL ELLIPSIS in UTF8 \xe2\x80\xA6
@@ -127,6 +128,17 @@ struct argp_option rps_progoptions[] =
     "Try the help command for details.\n", //
     /*group:*/0 ///
   },
+  /* ======= run a REPL script file after load ======= */
+  {/*name:*/ "repl-script", ///
+    /*key:*/ RPSPROGOPT_REPL_SCRIPT, ///
+    /*arg:*/ "SCRIPT_FILE", ///
+    /*flags:*/ 0, ///
+    /*doc:*/ "Run the REPL commands of SCRIPT_FILE, one per line,"
+    " after the --command ones;\n"
+    "a line ending with a backslash continues on the next one,"
+    " lines starting with # are comments.\n", //
+    /*group:*/0 ///
+  },
   /* ======= edit the C++ code of  a temporary plugin after load ======= */
   {/*name:*/ "cplusplus-editor-after-load", ///
     /*key:*/ RPSPROGOPT_CPLUSPLUSEDITOR_AFTER_LOAD, ///
@@ -224,6 +236,16 @@ struct argp_option rps_progoptions[] =
     // see RPS_NBJOBS_MIN and RPS_NBJOBS_MAX in refpersys.hh and initial value below.
     /*group:*/0 ///
   },
+  /* ======= threshold of the GNU lightning baseline JIT ======= */
+  {/*name:*/ "jit-threshold", ///
+    /*key:*/ RPSPROGOPT_JIT_THRESHOLD, ///
+    /*arg:*/ "COUNT", ///
+    /*flags:*/ 0, ///
+    /*doc:*/ "Compile with GNU lightning, in agenda worker threads,"
+    " the connectives of closures applied <COUNT> times"
+    " - default is 1000, and 0 disables that.\n", //
+    /*group:*/0 ///
+  },
   /* ======= the load directory ======= */
   {/*name:*/ "load", ///
     /*key:*/ RPSPROGOPT_LOADDIR, ///
@@ -266,6 +288,23 @@ struct argp_option rps_progoptions[] =
     /*doc:*/ "Disable quick tests after load by rps_small_quick_tests_after_load.\n", //
     /*group:*/0 ///
   },
+  /* ======= without io_uring ======= */
+  {/*name:*/ "no-io-uring", ///
+    /*key:*/ RPSPROGOPT_NO_IO_URING, ///
+    /*arg:*/ nullptr, ///
+    /*flags:*/ 0, ///
+    /*doc:*/ "Disable the Linux io_uring asynchronous file input and output,"
+    " using blocking system calls instead.\n", //
+    /*group:*/0 ///
+  },
+  /* ======= interned strings ======= */
+  {/*name:*/ "intern-strings", ///
+    /*key:*/ RPSPROGOPT_INTERN_STRINGS, ///
+    /*arg:*/ nullptr, ///
+    /*flags:*/ 0, ///
+    /*doc:*/ "Share every string value of equal content thru a weak intern table.\n", //
+    /*group:*/0 ///
+  },
   /* ======= without terminal ======= */
   {/*name:*/ "no-terminal", ///
     /*key:*/ RPSPROGOPT_NO_TERMINAL, ///
@@ -489,6 +528,9 @@ bool rps_disable_aslr = false;
 bool rps_without_terminal_escape = false;
 bool rps_daemonized = false;
 bool rps_without_quick_tests = false;
+
+bool rps_without_io_uring = false;
+bool rps_intern_strings = false;
 bool rps_test_repl_lexer = false;
 bool rps_syslog_enabled = false;
 bool rps_stdout_istty = false;
@@ -525,6 +567,7 @@ rps_set_exit_code(std::uint8_t ex)
 
 
 int rps_nbjobs = RPS_NBJOBS_MIN + 2;
+unsigned rps_jit_hot_threshold = rps_jit_default_hot_threshold;
 
 
 /// the rps_run_loaded_application is called after loading...
@@ -755,6 +798,12 @@ rps_run_loaded_application(int &argc, char **argv)
               << RPS_FULL_BACKTRACE_HERE(1, "rps_run_loaded_application/exc"));
         };
     }
+  ////  REPL script file
+  if (!rps_repl_script_path.empty())
+    {
+      RPS_INFORMOUT("before running REPL script " << rps_repl_script_path);
+      rps_do_repl_script_file(rps_repl_script_path);
+    }
   if (access(rps_gui_script_executable, X_OK))
     RPS_WARNOUT("default GUI script " << rps_gui_script_executable << " is not executable");
   ////
@@ -1193,6 +1242,10 @@ rps_small_quick_tests_after_load(void)
   _f.obfoundnew = Rps_ObjectRef::find_object_or_fail_by_oid(&_, _f.obnew->oid());
   RPS_DEBUG_LOG(CMD, "rps_small_quick_tests_after_load obfoundnew=" << _f.obfoundnew << " obnew=" << _f.obnew);
   RPS_ASSERT(_f.obnew == _f.obfoundnew);
+  rps_utf8_benchmark(16);
+  /// its timings only go to the LOWREP debug log
+  if (RPS_DEBUG_ENABLED(LOWREP))
+    rps_callframe_benchmark(&_, 100000);
 #warning should add some clever tests on  Rps_Value::is_instance_of and Rps_Value::is_subclass_of
   RPS_DEBUG_LOG(CMD, "end rps_small_quick_tests_after_load");
 } // end rps_small_quick_tests_after_load
@@ -1611,6 +1664,7 @@ main (int argc, char** argv)
   RPS_POSSIBLE_BREAKPOINT();
   ////
   Rps_QuasiZone::initialize();
+  Rps_AsyncFileIo::initialize();
   rps_check_mtime_files();
 #if RPS_USE_CURL
   rps_initialize_curl();
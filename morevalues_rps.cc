@@ -88,6 +88,62 @@ Rps_InstanceZone::class_attrset(Rps_ObjectRef obclass)
   return paylcl->class_attrset();
 } // end Rps_InstanceZone::class_attrset
 
+
+std::atomic<unsigned> Rps_InstanceShape::ishape_counter;
+
+Rps_InstanceShape::Rps_InstanceShape(const Rps_SetOb*attrset)
+  : ishape_serial(1+ishape_counter.fetch_add(1)),
+    ishape_nbattrs(attrset?attrset->cardinal():0),
+    ishape_slots()
+{
+  ishape_slots.reserve(ishape_nbattrs);
+  if (attrset)
+    for (Rps_ObjectRef obattr: *attrset)
+      {
+        RPS_ASSERT(obattr);
+        ishape_slots.insert({obattr.optr(), (unsigned)ishape_slots.size()});
+      };
+} // end Rps_InstanceShape::Rps_InstanceShape
+
+const Rps_InstanceShape*
+Rps_InstanceShape::make(const Rps_SetOb*attrset)
+{
+  return new Rps_InstanceShape(attrset);
+} // end Rps_InstanceShape::make
+
+
+/// no lock is needed: the payload and the shape are atomic, and class
+/// payloads are never erased
+const Rps_InstanceShape*
+Rps_InstanceZone::class_shape(Rps_ObjectRef obclass)
+{
+  if (!obclass || obclass.is_empty())
+    return nullptr;
+  auto paylcl = obclass->get_classinfo_payload();
+  if (!paylcl)
+    return nullptr;
+  return paylcl->instance_shape();
+} // end Rps_InstanceZone::class_shape
+
+
+Rps_Value
+Rps_InstanceZone::get_attr(const Rps_ObjectRef obattr, int*pslot) const
+{
+  if (pslot)
+    *pslot = -1;
+  if (!obattr || _treenbattrs == 0)
+    return nullptr;
+  const Rps_InstanceShape*shape = class_shape(get_class());
+  if (!shape)
+    return nullptr;
+  int slot = shape->slot(obattr.optr());
+  if (slot < 0)
+    return nullptr;
+  if (pslot)
+    *pslot = slot;
+  return attribute_at_slot((unsigned)slot, obattr);
+} // end Rps_InstanceZone::get_attr
+
 void
 Rps_InstanceZone::val_output(std::ostream& outs, unsigned depth, unsigned maxdepth) const
 {
@@ -173,7 +229,9 @@ Rps_InstanceZone::make_from_attributes_components(Rps_ObjectRef classob,
   if (!attrset)
     throw RPS_RUNTIME_ERROR_OUT("Rps_InstanceZone::make_from_attributes_components with class without attributes set:"
                                 << classob);
-  auto nbattrs = attrset->cardinal();
+  const Rps_InstanceShape*shape = clpayl->instance_shape();
+  RPS_ASSERT(shape);
+  auto nbattrs = shape->nb_attributes();
   auto nbcomps = valvec.size();
   auto physiz = 2*nbattrs+nbcomps; // physical allocated size
   if (RPS_UNLIKELY(physiz > maxsize)) // never happens in practice
@@ -192,12 +250,13 @@ Rps_InstanceZone::make_from_attributes_components(Rps_ObjectRef classob,
   res = rps_allocate_with_wordgap<Rps_InstanceZone,unsigned,Rps_ObjectRef,Rps_InstanceTag>
         ((physiz*sizeof(Rps_Value))/sizeof(void*),
          physiz, classob, Rps_InstanceTag{});
+  res->_treenbattrs = nbattrs;
   Rps_Value*sonarr = res->raw_data_sons();
   for (auto it : attrmap)
     {
       Rps_ObjectRef curat = it.first;
       Rps_Value curval = it.second;
-      int ix=attrset->element_index(curat);
+      int ix=shape->slot(curat.optr());
       RPS_ASSERT(ix>=0);
       sonarr[2*ix] = curat;
       sonarr[2*ix+1] = curval;
@@ -590,11 +649,11 @@ Rps_PayloadObjMap::Rps_PayloadObjMap(Rps_ObjectZone*obz) :
 void
 Rps_PayloadObjMap::gc_mark_objmap(Rps_GarbageCollector&gc) const
 {
-  for (auto it: obm_map)
-    {
-      gc.mark_obj(it.first);
-      gc.mark_value(it.second);
-    };
+  obm_map.each([&](Rps_ObjectRef obr, const Rps_Value&val)
+  {
+    gc.mark_obj(obr);
+    gc.mark_value(val);
+  });
   gc.mark_value (obm_descr);
 } // end Rps_PayloadObjMap::gc_mark_objmap
 
@@ -615,11 +674,11 @@ void
 Rps_PayloadObjMap::dump_scan_objmap_internal(Rps_Dumper*du) const
 {
   RPS_ASSERT (du != nullptr);
-  for (auto it: obm_map)
-    {
-      rps_dump_scan_object(du, it.first);
-      rps_dump_scan_value(du, it.second, 0);
-    };
+  obm_map.each([&](Rps_ObjectRef obr, const Rps_Value&val)
+  {
+    rps_dump_scan_object(du, obr);
+    rps_dump_scan_value(du, val, 0);
+  });
   rps_dump_scan_value(du, obm_descr, 0);
 } // end Rps_PayloadObjMap::dump_scan_internal
 
@@ -636,10 +695,10 @@ Rps_PayloadObjMap::dump_json_objmap_internal_content(Rps_Dumper*du, Json::Value&
 {
   RPS_ASSERT (du != nullptr);
   Json::Value jmap(Json::objectValue);
-  for (auto it: obm_map)
-    {
-      jmap[it.first.as_string()] = rps_dump_json_value(du, it.second);
-    };
+  obm_map.each_ordered([&](Rps_ObjectRef obr, const Rps_Value&val)
+  {
+    jmap[obr.as_string()] = rps_dump_json_value(du, val);
+  });
   jv["objmap"] = jmap;
   jv["descr"] = rps_dump_json_value(du, obm_descr);
 } // end Rps_PayloadObjMap::dump_json_internal_content
@@ -648,12 +707,12 @@ Rps_Value
 Rps_PayloadObjMap::get_obmap(Rps_ObjectRef obkey, Rps_Value defaultval,
                              bool*pmissing) const
 {
-  auto it = obm_map.find(obkey);
-  if (it != obm_map.end())
+  const Rps_Value*pval = obm_map.find(obkey);
+  if (pval)
     {
       if (pmissing)
         *pmissing = false;
-      return it->second;
+      return *pval;
     }
   if (pmissing)
     *pmissing = true;
@@ -663,7 +722,7 @@ Rps_PayloadObjMap::get_obmap(Rps_ObjectRef obkey, Rps_Value defaultval,
 bool
 Rps_PayloadObjMap::has_key_obmap(Rps_ObjectRef obkey) const
 {
-  return obm_map.find(obkey) != obm_map.end();
+  return obm_map.contains(obkey);
 } // end Rps_PayloadObjMap::has_key_obmap
 
 Rps_ObjectZone*
@@ -709,9 +768,19 @@ void
 Rps_PayloadObjMap::put_obmap(Rps_ObjectRef obkey, Rps_Value val)
 {
   RPS_ASSERT(obkey);
-  obm_map.insert({obkey,val});
+  if (obm_map.put(obkey,val))
+    obmap_keys_changed();
 } // end Rps_PayloadObjMap::put_obmap
 
+bool
+Rps_PayloadObjMap::remove_obmap(Rps_ObjectRef obkey)
+{
+  bool removed = obm_map.remove(obkey);
+  if (removed)
+    obmap_keys_changed();
+  return removed;
+} // end Rps_PayloadObjMap::remove_obmap
+
 void
 Rps_PayloadObjMap::output_payload(std::ostream&out, unsigned depth, unsigned maxdepth) const
 {
@@ -738,14 +807,18 @@ Rps_PayloadObjMap::output_payload(std::ostream&out, unsigned depth, unsigned max
     out << " described by " << NORM_esc << Rps_OutputValue(dv, depth, maxdepth) << std::endl;
   else
     out << " plain" << NORM_esc << std::endl;
-  std::vector<Rps_ObjectRef> attrvect(nbobjmap);
-  for (auto it : obm_map)
-    attrvect.push_back(it.first);
+  /// sorted once, for display
+  std::vector<Rps_ObjectRef> attrvect;
+  attrvect.reserve(nbobjmap);
+  obm_map.each([&](Rps_ObjectRef obr, const Rps_Value&)
+  {
+    attrvect.push_back(obr);
+  });
   rps_sort_object_vector_for_display(attrvect);
   for (int ix=0; ix<(int)nbobjmap; ix++)
     {
       const Rps_ObjectRef curattr = attrvect[ix];
-      const Rps_Value curval = (obm_map.at(curattr));
+      const Rps_Value curval = *obm_map.find(curattr);
       out << BOLD_esc << "*"
           << NORM_esc << curattr << ": "
           << Rps_OutputValue(curval, depth, maxdepth)
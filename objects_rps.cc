@@ -325,7 +325,8 @@ Rps_ObjectZone::Rps_ObjectZone(Rps_Id oid, registermode_en regmod)
     ob_space(nullptr), ob_mtime(0.0),
     ob_attrs(), ob_comps(), ob_payload(nullptr),
     ob_magicgetterfun(nullptr),
-    ob_applyingfun(nullptr)
+    ob_applyingfun(nullptr),
+    ob_applycount(0)
 {
   RPS_DEBUG_LOG(LOWREP, "Rps_ObjectZone oid=" << oid << ' '
                 << (regmod==OBZ_DONT_REGISTER?"non-":"") << "registering"
@@ -452,7 +453,17 @@ Rps_ObjectZone::gc_mark(Rps_GarbageCollector&gc, unsigned) const
 void
 Rps_ObjectZone::mark_gc_inside(Rps_GarbageCollector&gc)
 {
-  std::lock_guard<std::recursive_mutex> gu(ob_mtx);
+  std::unique_lock<std::recursive_mutex> gu(ob_mtx, std::defer_lock);
+  if (!Rps_Agenda::collecting_garbage())
+    gu.lock();
+  else
+    {
+      /// an agenda worker thread parked at an allocation safepoint may
+      /// own that lock, but cannot change this object before the end
+      /// of the collection; the event loop thread soon releases it.
+      for (int cnt=0; cnt<64 && !gu.try_lock(); cnt++)
+        std::this_thread::yield();
+    }
 #warning perhaps the _gcinfo should be used here
   Rps_ObjectZone* obcla = ob_class.load();
   RPS_ASSERT(obcla != nullptr);
@@ -1056,7 +1067,7 @@ const std::vector<Rps_Value>
 Rps_ObjectZone::vector_physical_components(void) const
 {
   std::lock_guard<std::recursive_mutex> gu(ob_mtx);
-  return ob_comps;
+  return std::vector<Rps_Value>(ob_comps.begin(), ob_comps.end());
 } // end Rps_ObjectZone::vector_physical_components
 
 unsigned
@@ -1334,55 +1345,33 @@ Rps_ObjectZone::dump_json_content(Rps_Dumper*du, Json::Value&json) const
       RPS_NOPRINTOUT("Rps_ObjectZone::dump_json_content thisob=" << thisob
                      << " has no magicgetter");
   }
-  /// applying function
+  /// applying function; it is dumped only when the loader would find
+  /// it by name, and a compiled routine is not persistent, so the
+  /// native function replaced by its trampoline is dumped instead
   {
-    rps_applyingfun_t*apfun = ob_applyingfun.load();
+    rps_applyingfun_t*apfun = rps_jit_native_applying_function(this);
     if (apfun)
       {
-        Dl_info di = {};
-        if (dladdr((void*)apfun, &di))
+        char appfunambuf[sizeof(RPS_APPLYINGFUN_PREFIX)+8+Rps_Id::nbchars];
+        memset(appfunambuf, 0, sizeof(appfunambuf));
+        char obidbuf[32];
+        memset (obidbuf, 0, sizeof(obidbuf));
+        oid().to_cbuf24(obidbuf);
+        strcpy(appfunambuf, RPS_APPLYINGFUN_PREFIX);
+        strcat(appfunambuf+strlen(RPS_APPLYINGFUN_PREFIX), obidbuf);
+        RPS_ASSERT(strlen(appfunambuf)<sizeof(appfunambuf)-4);
+        if (rps_plugin_dlsym(appfunambuf) == reinterpret_cast<void*>(apfun))
+          json["applying"] = Json::Value(true);
+        else
           {
-            RPS_DEBUG_LOG(DUMP, "Rps_ObjectZone::dump_json_content thisob=" << thisob
-                          << " has applyingfun " << (void*)apfun
-                          << " dli_fname=" << (di.dli_fname?:"???")
-                          << " dli_sname=" << (di.dli_sname?:"???"));
-
             Dl_info di = {};
-            if (dladdr((void*)apfun, &di))
-              {
-                RPS_NOPRINTOUT("Rps_ObjectZone::dump_json_content thisob=" << thisob
-                               << " has applyingfun " << (void*)apfun
-                               << " dli_fname=" << (di.dli_fname?:"???")
-                               << " dli_sname=" << (di.dli_sname?:"???"));
-                if (di.dli_sname && !strncmp(di.dli_sname, RPS_APPLYINGFUN_PREFIX, sizeof(RPS_APPLYINGFUN_PREFIX)-1)
-                    && di.dli_sname[sizeof(RPS_APPLYINGFUN_PREFIX)] == '_'
-                    && isdigit(di.dli_sname[sizeof(RPS_APPLYINGFUN_PREFIX)+1]))
-                  {
-                    const char* pend=nullptr;
-                    bool ok = false;
-                    Rps_Id apoidfun(di.dli_sname+sizeof(RPS_APPLYINGFUN_PREFIX), &pend, &ok);
-                    if (ok && apoidfun)
-                      {
-                        /* TODO: add more code */
-#warning Rps_ObjectZone::dump_json_content should deal with rpsapply_* function name (applying function)
-                        RPS_WARNOUT("Rps_ObjectZone::dump_json_content thisob=" << thisob <<
-                                    " applyingfun dli_sname:" << di.dli_sname
-                                    << " @@apoidfun:" << apoidfun << std::endl
-                                    << RPS_FULL_BACKTRACE_HERE(1, "Rps_ObjectZone::dump_json_content@@apoidfun"));
-                        json["applyfun"] = apoidfun.to_string();
-                      }
-                  };
-              }
-            else // dladdr apfun failed
-              {
-                RPS_WARNOUT("Rps_ObjectZone::dump_json_content thisob=" << thisob
-                            << " has strange applyingfun " << (void*)apfun);
-              };
-            json["applying"] = Json::Value(true);
+            if (!dladdr((void*)apfun, &di))
+              di.dli_sname = nullptr;
+            RPS_WARNOUT("Rps_ObjectZone::dump_json_content thisob=" << thisob
+                        << " has applying function " << (void*)apfun
+                        << " named " << (di.dli_sname?:"???")
+                        << " which is not " << appfunambuf << ", so is not dumped");
           }
-        else
-          RPS_NOPRINTOUT("Rps_ObjectZone::dump_json_content thisob=" << thisob
-                         << " has applying function");
       }
   }
   /// attributes
@@ -1526,6 +1515,37 @@ Rps_ObjectZone::autocomplete_oid(const char*prefix,
   return count;
 } // end Rps_ObjectZone::autocomplete_oid
 
+unsigned
+Rps_ObjectZone::rebind_native_functions(const std::function<void*(const Rps_ObjectZone*,void*)>&rebindfun)
+{
+  unsigned count = 0;
+  std::lock_guard<std::recursive_mutex> gu(ob_idmtx_);
+  for (auto& it: ob_idmap_)
+    {
+      Rps_ObjectZone* obz = it.second;
+      RPS_ASSERT(obz != nullptr);
+      rps_applyingfun_t* oldappfun = obz->ob_applyingfun.load();
+      if (oldappfun)
+        {
+          rps_applyingfun_t* newappfun =
+            reinterpret_cast<rps_applyingfun_t*>(rebindfun(obz, reinterpret_cast<void*>(oldappfun)));
+          if (newappfun != oldappfun
+              && obz->ob_applyingfun.compare_exchange_strong(oldappfun, newappfun))
+            count++;
+        };
+      rps_magicgetterfun_t* oldgetfun = obz->ob_magicgetterfun.load();
+      if (oldgetfun)
+        {
+          rps_magicgetterfun_t* newgetfun =
+            reinterpret_cast<rps_magicgetterfun_t*>(rebindfun(obz, reinterpret_cast<void*>(oldgetfun)));
+          if (newgetfun != oldgetfun
+              && obz->ob_magicgetterfun.compare_exchange_strong(oldgetfun, newgetfun))
+            count++;
+        };
+    };
+  return count;
+} // end Rps_ObjectZone::rebind_native_functions
+
 
 
 ////////////////////////////////////////////////////////////////
@@ -1608,8 +1628,35 @@ Rps_PayloadClassInfo::loader_put_attrset(const Rps_SetOb*setob, Rps_Loader*ld)
   RPS_ASSERT(ld != nullptr);
   RPS_ASSERT(!setob || setob->stored_type() == Rps_Type::Set);
   pclass_attrset.store(setob);
+  pclass_shape.store(nullptr);
 } // end Rps_PayloadClassInfo::loader_put_attrset
 
+void
+Rps_PayloadClassInfo::put_attributes_set(const Rps_SetOb*setob)
+{
+  RPS_ASSERT(!setob || setob->stored_type() == Rps_Type::Set);
+  pclass_attrset.store(setob);
+  pclass_shape.store(nullptr);
+} // end Rps_PayloadClassInfo::put_attributes_set
+
+/// the shape is computed once from the attribute set; if two threads
+/// race, the loser's shape is simply dropped
+const Rps_InstanceShape*
+Rps_PayloadClassInfo::instance_shape(void) const
+{
+  const Rps_InstanceShape*shape = pclass_shape.load();
+  if (shape)
+    return shape;
+  const Rps_SetOb*attrset = pclass_attrset.load();
+  if (!attrset)
+    return nullptr;
+  const Rps_InstanceShape*newshape = Rps_InstanceShape::make(attrset);
+  if (pclass_shape.compare_exchange_strong(shape, newshape))
+    return newshape;
+  delete newshape;
+  return shape;
+} // end Rps_PayloadClassInfo::instance_shape
+
 void
 Rps_PayloadClassInfo::put_symbname(Rps_ObjectRef obr)
 {
@@ -1788,16 +1835,20 @@ Rps_PayloadClassInfo::output_payload(std::ostream&out, unsigned depth, unsigned
 void
 Rps_PayloadSetOb::gc_mark(Rps_GarbageCollector&gc) const
 {
-  for (auto obr: psetob)
+  psetob.each([&](Rps_ObjectRef obr, const Rps_NoValueTag&)
+  {
     gc.mark_obj(obr);
+  });
 } // end Rps_PayloadSetOb::gc_mark
 
 void
 Rps_PayloadSetOb::dump_scan(Rps_Dumper*du) const
 {
   RPS_ASSERT(du != nullptr);
-  for (auto obr: psetob)
+  psetob.each([&](Rps_ObjectRef obr, const Rps_NoValueTag&)
+  {
     rps_dump_scan_object(du, obr);
+  });
 } // end Rps_PayloadSetOb::dump_scan
 
 
@@ -1808,9 +1859,11 @@ Rps_PayloadSetOb::dump_json_content(Rps_Dumper*du, Json::Value&jv) const
   RPS_ASSERT(du != nullptr);
   RPS_ASSERT(jv.type() == Json::objectValue);
   Json::Value jarr(Json::arrayValue);
-  for (auto obr: psetob)
+  psetob.each_ordered([&](Rps_ObjectRef obr, const Rps_NoValueTag&)
+  {
     if (rps_is_dumpable_objref(du,obr))
       jarr.append(rps_dump_json_objectref(du,obr));
+  });
   jv["setob"] = jarr;
 } // end Rps_PayloadSetOb::dump_json_content
 
@@ -1877,13 +1930,7 @@ Rps_PayloadSetOb::output_payload(std::ostream&out, unsigned depth, unsigned maxd
           << std::endl;
       return;
     }
-  std::vector<Rps_ObjectRef> vectelem(setcard);
-  for (auto setit: psetob)
-    {
-      Rps_ObjectRef curob = *setit;
-      RPS_ASSERT(curob);
-      vectelem.push_back(curob);
-    };
+  std::vector<Rps_ObjectRef> vectelem = psetob.sorted_keys();
   if (setcard==1)
     out << BOLD_esc << "¤¤ singleton set object payload ¤¤" << NORM_esc
         << std::endl;
@@ -2032,7 +2079,7 @@ Rps_PayloadVectVal::make_closure_zone_from_vector(Rps_ObjectRef connob)
   if (!connob)
     return nullptr;
   std::lock_guard<std::recursive_mutex> gu(*(connob->objmtxptr()));
-  return Rps_ClosureZone::make(connob, pvectval);
+  return Rps_ClosureZone::make(connob, std::vector<Rps_Value>(pvectval.begin(), pvectval.end()));
 } // end Rps_PayloadVectVal::make_closure_zone_from_vector
 
 
@@ -2044,7 +2091,7 @@ Rps_PayloadVectVal::make_instance_zone_from_vector(Rps_ObjectRef classob)
   std::lock_guard<std::recursive_mutex> gu(*(classob->objmtxptr()));
   if (!classob->is_class())
     return nullptr;
-  return Rps_InstanceZone::make_from_components(classob, pvectval);
+  return Rps_InstanceZone::make_from_components(classob, std::vector<Rps_Value>(pvectval.begin(), pvectval.end()));
 } // end Rps_PayloadVectVal::make_instance_zone_from_vector
 
 void
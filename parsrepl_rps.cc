@@ -59,11 +59,119 @@ rps_parsrepl_termvect_stammering(std::vector<Rps_Value>& termvect, int line)
     return false;
 } // end rps_parsrepl_termvect_stammering
 
+////////////////////////////////////////////////////////////////
+/// Packrat parsing: every rule below is memoized on its rule and
+/// starting token position. The memo is cleared whenever a token is
+/// consumed, so it only remembers the parses which consumed nothing,
+/// mostly failures, and avoids redoing them at the same position.
+Rps_Value
+Rps_TokenSource::parse_memoized(Rps_CallFrame*callframe, parse_rule_en rule, bool*pokparse,
+                                Rps_Value (Rps_TokenSource::*rawparser)(Rps_CallFrame*,bool*))
+{
+  RPS_ASSERT(rps_is_main_thread());
+  RPS_ASSERT(callframe && callframe->is_good_call_frame());
+  RPS_ASSERT(rule > ParseRule_None && rule < ParseRule__Last);
+  RPS_LOCALFRAME(RPS_CALL_FRAME_UNDESCRIBED,
+                 /*callerframe:*/callframe,
+                 Rps_Value resv;
+                );
+  long startpos = token_position();
+  uint64_t key = parse_memo_key(rule, startpos);
+  auto it = toksrc_parse_memo.find(key);
+  if (it != toksrc_parse_memo.end() && it->second.pmemo_line == toksrc_line)
+    {
+      RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_memoized rule#" << (int)rule
+                    << " memo hit at token position " << startpos
+                    << (it->second.pmemo_ok?" ok ":" failed ") << it->second.pmemo_result);
+      if (pokparse)
+        *pokparse = it->second.pmemo_ok;
+      return it->second.pmemo_result;
+    };
+  bool ok = false;
+  _f.resv = (this->*rawparser)(&_, &ok);
+  if (token_position() == startpos)
+    toksrc_parse_memo[key] = parse_memo_st{_f.resv, toksrc_line, ok};
+  if (pokparse)
+    *pokparse = ok;
+  return _f.resv;
+} // end Rps_TokenSource::parse_memoized
+
+Rps_Value
+Rps_TokenSource::parse_expression(Rps_CallFrame*callframe, bool*pokparse)
+{
+  return parse_memoized(callframe, ParseRule_Expression, pokparse,
+                        &Rps_TokenSource::raw_parse_expression);
+} // end Rps_TokenSource::parse_expression
+
+Rps_Value
+Rps_TokenSource::parse_disjunction(Rps_CallFrame*callframe, bool*pokparse)
+{
+  return parse_memoized(callframe, ParseRule_Disjunction, pokparse,
+                        &Rps_TokenSource::raw_parse_disjunction);
+} // end Rps_TokenSource::parse_disjunction
+
+Rps_Value
+Rps_TokenSource::parse_conjunction(Rps_CallFrame*callframe, bool*pokparse)
+{
+  return parse_memoized(callframe, ParseRule_Conjunction, pokparse,
+                        &Rps_TokenSource::raw_parse_conjunction);
+} // end Rps_TokenSource::parse_conjunction
+
+Rps_Value
+Rps_TokenSource::parse_comparison(Rps_CallFrame*callframe, bool*pokparse)
+{
+  return parse_memoized(callframe, ParseRule_Comparison, pokparse,
+                        &Rps_TokenSource::raw_parse_comparison);
+} // end Rps_TokenSource::parse_comparison
+
+Rps_Value
+Rps_TokenSource::parse_sum(Rps_CallFrame*callframe, bool*pokparse)
+{
+  return parse_memoized(callframe, ParseRule_Sum, pokparse,
+                        &Rps_TokenSource::raw_parse_sum);
+} // end Rps_TokenSource::parse_sum
+
+Rps_Value
+Rps_TokenSource::parse_comparand(Rps_CallFrame*callframe, bool*pokparse)
+{
+  return parse_memoized(callframe, ParseRule_Comparand, pokparse,
+                        &Rps_TokenSource::raw_parse_comparand);
+} // end Rps_TokenSource::parse_comparand
+
+Rps_Value
+Rps_TokenSource::parse_factor(Rps_CallFrame*callframe, bool*pokparse)
+{
+  return parse_memoized(callframe, ParseRule_Factor, pokparse,
+                        &Rps_TokenSource::raw_parse_factor);
+} // end Rps_TokenSource::parse_factor
+
+Rps_Value
+Rps_TokenSource::parse_term(Rps_CallFrame*callframe, bool*pokparse)
+{
+  return parse_memoized(callframe, ParseRule_Term, pokparse,
+                        &Rps_TokenSource::raw_parse_term);
+} // end Rps_TokenSource::parse_term
+
+Rps_Value
+Rps_TokenSource::parse_product(Rps_CallFrame*callframe, bool*pokparse)
+{
+  return parse_memoized(callframe, ParseRule_Product, pokparse,
+                        &Rps_TokenSource::raw_parse_product);
+} // end Rps_TokenSource::parse_product
+
+Rps_Value
+Rps_TokenSource::parse_primary(Rps_CallFrame*callframe, bool*pokparse)
+{
+  return parse_memoized(callframe, ParseRule_Primary, pokparse,
+                        &Rps_TokenSource::raw_parse_primary);
+} // end Rps_TokenSource::parse_primary
+
+
 /// This member function returns some expression which could later be
 /// evaluated to a value; the *pokparse flag, when given, is set to
 /// true if and only if parsing was successful.
 Rps_Value
-Rps_TokenSource::parse_expression(Rps_CallFrame*callframe, bool*pokparse)
+Rps_TokenSource::raw_parse_expression(Rps_CallFrame*callframe, bool*pokparse)
 {
   // a REPL expression is a sequence of disjuncts separated by ||
   RPS_ASSERT(rps_is_main_thread());
@@ -195,37 +303,17 @@ Rps_TokenSource::parse_expression(Rps_CallFrame*callframe, bool*pokparse)
   static Rps_Id idoroper;
   if (!idoroper)
     idoroper = Rps_Id("_1ghZV0g1dtR02xPgqk"); // id of "or!binop"∈repl_binary_operator
+  _f.ordelimob = Rps_ObjectRef::find_object_or_fail_by_oid(&_,idordelim);
   do
     {
       again = false;
-      _f.lextokv =  lookahead_token(&_,  0);
-      if (!_f.lextokv)
-        {
-          RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_expression¤" << callnum << "#"  << exprnum
-                        << " position:" << position_str()<< " startpos:" << startpos << std::endl
-                        << " failed lookahea.tokzero"
-                        << " curcptr:" << Rps_QuotedC_String(curcptr())
-                        << std::endl
-                        << "… token_deq:" << toksrc_token_deq
-                        << std::endl
-                        << Rps_Do_Output([&](std::ostream& out)
-          {
-            this->display_current_line_with_cursor(out);
-          }));
-          again = false;
-          break;
-        };
-      RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_expression¤" << callnum << "#"  << exprnum << " testing or lextokv=" << _f.lextokv
+      RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_expression¤" << callnum << "#"  << exprnum << " testing or"
                     << " position:" << position_str()<< " startpos:" << startpos << " disjvect:" << disjvect
                     << std::endl << " … in:" << (*this));
-      if (_f.lextokv.is_lextoken()
-          && _f.lextokv.to_lextoken()->lxkind() == RPS_ROOT_OB(_2wdmxJecnFZ02VGGFK) //repl_delimiter∈class
-          &&  _f.lextokv.to_lextoken()->lxval().is_object()
-          &&  _f.lextokv.to_lextoken()->lxval().to_object()->oid() == idordelim)
+      /// the or operator is skipped without making its lexical token
+      if (skip_delimiter(&_, _f.ordelimob))
         {
-          (void) get_token(&_); // consume the or operator
-#warning please code review Rps_TokenSource::parse_expression on consuming or
-          RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_expression¤" << callnum << "#"  << exprnum << " consumed or lextokv=" << _f.lextokv
+          RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_expression¤" << callnum << "#"  << exprnum << " consumed or"
                         << " position:" << position_str()<< " startpos:" << startpos << " disjvect:" << disjvect
                         << std::endl << " … in:" << (*this));
           again = true;
@@ -350,7 +438,7 @@ Rps_TokenSource::parse_expression(Rps_CallFrame*callframe, bool*pokparse)
   if (pokparse)
     *pokparse = true;
   return _f.resexprv;
-} // end Rps_TokenSource::parse_expression
+} // end Rps_TokenSource::raw_parse_expression
 
 
 
@@ -362,7 +450,7 @@ Rps_TokenSource::parse_expression(Rps_CallFrame*callframe, bool*pokparse)
 /// evaluated to a value; the *pokparse flag, when given, is set to
 /// true if and only if parsing was successful.
 Rps_Value
-Rps_TokenSource::parse_disjunction(Rps_CallFrame*callframe, bool*pokparse)
+Rps_TokenSource::raw_parse_disjunction(Rps_CallFrame*callframe, bool*pokparse)
 {
   /// a disjunction is a sequence of one or more conjunct separated by
   /// && - the and operator
@@ -488,6 +576,7 @@ Rps_TokenSource::parse_disjunction(Rps_CallFrame*callframe, bool*pokparse)
   static Rps_Id idoroper;
   if (!idoroper)
     idoroper = Rps_Id("_1ghZV0g1dtR02xPgqk"); // id of "or!binop"∈repl_binary_operator
+  _f.ordelimob = Rps_ObjectRef::find_object_or_fail_by_oid(&_,idordelim);
   do
     {
       again = false;
@@ -499,26 +588,13 @@ Rps_TokenSource::parse_disjunction(Rps_CallFrame*callframe, bool*pokparse)
       {
         this->display_current_line_with_cursor(out);
       }));
-      _f.lextokv =  lookahead_token(&_,  0);
-      RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_disjunction¤" << callnum << " in loop position:" << position_str() << " startpos:" << startpos
-                    << " curcptr:" << Rps_QuotedC_String(curcptr())
-                    << " token_deq:" << toksrc_token_deq << " lextok:" << _f.lextokv);
-      if (!_f.lextokv)
-        {
-          again = false;
-          break;
-        };
-      RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_disjunction¤" << callnum << "  testing and lextokv="
-                    << _f.lextokv << " position:" << position_str() << " startpos:" << startpos
+      RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_disjunction¤" << callnum << "  testing or"
+                    << " position:" << position_str() << " startpos:" << startpos
                     << " curcptr:" << Rps_QuotedC_String(curcptr())
                     << " token_deq:" << toksrc_token_deq);
-      if (_f.lextokv.is_lextoken()
-          && _f.lextokv.to_lextoken()->lxkind()
-          == RPS_ROOT_OB(_2wdmxJecnFZ02VGGFK) //repl_delimiter∈class
-          &&  _f.lextokv.to_lextoken()->lxval().is_object()
-          &&  _f.lextokv.to_lextoken()->lxval().to_object()->oid() == idordelim)
+      /// the or operator is skipped without making its lexical token
+      if (skip_delimiter(&_, _f.ordelimob))
         {
-          (void) get_token(&_); // consume the or operator
           again = true;
           if (!_f.oroperob)
             _f.oroperob = Rps_ObjectRef::find_object_or_fail_by_oid(&_,idoroper);
@@ -601,7 +677,7 @@ Rps_TokenSource::parse_disjunction(Rps_CallFrame*callframe, bool*pokparse)
   if (pokparse)
     *pokparse = true;
   return _f.resdisjv;
-} // end Rps_TokenSource::parse_disjunction
+} // end Rps_TokenSource::raw_parse_disjunction
 
 
 
@@ -609,7 +685,7 @@ Rps_TokenSource::parse_disjunction(Rps_CallFrame*callframe, bool*pokparse)
 
 ////////////////
 Rps_Value
-Rps_TokenSource::parse_conjunction(Rps_CallFrame*callframe, bool*pokparse)
+Rps_TokenSource::raw_parse_conjunction(Rps_CallFrame*callframe, bool*pokparse)
 {
   RPS_ASSERT(rps_is_main_thread());
   RPS_ASSERT(callframe && callframe->is_good_call_frame());
@@ -760,31 +836,15 @@ Rps_TokenSource::parse_conjunction(Rps_CallFrame*callframe, bool*pokparse)
       {
         this->display_current_line_with_cursor(out);
       }));
-      _f.lextokv =  lookahead_token(&_,  0);
-      if (!_f.lextokv)
-        {
-          //end of input!
-          RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_conjunction¤" << callnum << " EOI at startpos:" << startpos
-                        << "  in:" << (*this)
-                        << " position:" << position_str() << std::endl
-                        << ".. curcptr:" << Rps_QuotedC_String(curcptr())
-                        << " token_deq:" << toksrc_token_deq
-                        << " conjvect:" << conjvect);
-          again = false;
-          break;
-        };
-      RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_conjunction¤" << callnum << " testing or lextokv=" << _f.lextokv
+      RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_conjunction¤" << callnum << " testing and"
                     << " position:" << position_str());
       RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_conjunction¤" << callnum << " conjvect:" << conjvect
                     << " at startpos:" << startpos
                     << "  in:" << (*this)
                     << " curcptr:" << Rps_QuotedC_String(curcptr()));
-      if (_f.lextokv.is_lextoken()
-          && _f.lextokv.to_lextoken()->lxkind() == RPS_ROOT_OB(_2wdmxJecnFZ02VGGFK) //repl_delimiter∈class
-          &&  _f.lextokv.to_lextoken()->lxval().is_object()
-          &&  _f.lextokv.to_lextoken()->lxval().to_object()->oid() == id_and_delim)
+      /// the and operator is skipped without making its lexical token
+      if (skip_delimiter(&_, _f.anddelimob))
         {
-          (void) get_token(&_); // consume the and operator
           RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_conjunction¤" << callnum << " startpos:" << startpos
                         << "  in:" << (*this)
                         << " position:" << position_str()
@@ -900,13 +960,13 @@ Rps_TokenSource::parse_conjunction(Rps_CallFrame*callframe, bool*pokparse)
   if (pokparse)
     *pokparse = true;
   return _f.conjv;
-} // end Rps_TokenSource::parse_conjunction
+} // end Rps_TokenSource::raw_parse_conjunction
 
 
 
 
 Rps_Value
-Rps_TokenSource::parse_comparison(Rps_CallFrame*callframe, bool*pokparse)
+Rps_TokenSource::raw_parse_comparison(Rps_CallFrame*callframe, bool*pokparse)
 {
   RPS_ASSERT(rps_is_main_thread());
   RPS_ASSERT(callframe && callframe->is_good_call_frame());
@@ -1057,7 +1117,7 @@ Rps_TokenSource::parse_comparison(Rps_CallFrame*callframe, bool*pokparse)
                << " startpos:" << startpos
                << std::endl
                << "… leftv=" << _f.leftv << " lextokv=" << _f.lextokv);
-} // end Rps_TokenSource::parse_comparison
+} // end Rps_TokenSource::raw_parse_comparison
 
 
 
@@ -1065,7 +1125,7 @@ Rps_TokenSource::parse_comparison(Rps_CallFrame*callframe, bool*pokparse)
 ////////////////////////////////////////////////////////////////
 
 Rps_Value
-Rps_TokenSource::parse_sum(Rps_CallFrame*callframe, bool*pokparse)
+Rps_TokenSource::raw_parse_sum(Rps_CallFrame*callframe, bool*pokparse)
 {
   RPS_ASSERT(rps_is_main_thread());
   RPS_ASSERT(callframe && callframe->is_good_call_frame());
@@ -1488,13 +1548,13 @@ Rps_TokenSource::parse_sum(Rps_CallFrame*callframe, bool*pokparse)
   {
     this->display_current_line_with_cursor(out);
   }));
-} // end Rps_TokenSource::parse_sum
+} // end Rps_TokenSource::raw_parse_sum
 
 
 // a comparand - something on left or right side of compare operators such as < or !=
 // is a sequence of terms with additive operators
 Rps_Value
-Rps_TokenSource::parse_comparand(Rps_CallFrame*callframe, bool*pokparse)
+Rps_TokenSource::raw_parse_comparand(Rps_CallFrame*callframe, bool*pokparse)
 {
   RPS_ASSERT(rps_is_main_thread());
   RPS_ASSERT(callframe && callframe->is_good_call_frame());
@@ -1666,12 +1726,12 @@ Rps_TokenSource::parse_comparand(Rps_CallFrame*callframe, bool*pokparse)
   })
       << std::endl
       << RPS_FULL_BACKTRACE_HERE(1, "Rps_TokenSource::parse_comparand incomplete"));
-} // end Rps_TokenSource::parse_comparand
+} // end Rps_TokenSource::raw_parse_comparand
 
 
 
 Rps_Value
-Rps_TokenSource::parse_factor(Rps_CallFrame*callframe, bool*pokparse)
+Rps_TokenSource::raw_parse_factor(Rps_CallFrame*callframe, bool*pokparse)
 {
   RPS_ASSERT(rps_is_main_thread());
   RPS_ASSERT(callframe && callframe->is_good_call_frame());
@@ -1683,6 +1743,7 @@ Rps_TokenSource::parse_factor(Rps_CallFrame*callframe, bool*pokparse)
                  Rps_Value leftv;
                  Rps_Value rightv;
                  Rps_ObjectRef binoperob;
+                 Rps_ObjectRef operdelimob;
                  Rps_ObjectRef plusdelimob;
                  Rps_ObjectRef plusbinopob;
                  Rps_ObjectRef minusdelimob;
@@ -1752,20 +1813,18 @@ Rps_TokenSource::parse_factor(Rps_CallFrame*callframe, bool*pokparse)
         *pokparse = false;
       return nullptr;
     }
-  _f.lextokv =  lookahead_token(&_,  0);
-  RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_factor¤" << callnum << " lextokv-at0=" << _f.lextokv
+  /// the + or - delimiter is looked ahead raw, without making its lexical token
+  _f.operdelimob = lookahead_delimiter();
+  RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_factor¤" << callnum << " operdelimob=" << _f.operdelimob
                 << " in " << (*this) << " at " <<  startpos);
-
-  if (_f.lextokv.is_lextoken()
-      && _f.lextokv.to_lextoken()->lxkind() == RPS_ROOT_OB(_2wdmxJecnFZ02VGGFK) //repl_delimiter∈class
-      &&  _f.lextokv.to_lextoken()->lxval().is_object())
+  if (_f.operdelimob)
     {
-      if (_f.lextokv.to_lextoken()->lxval().to_object() ==  _f.plusdelimob)
+      if (_f.operdelimob ==  _f.plusdelimob)
         _f.binoperob = _f.plusbinopob;
-      else if (_f.lextokv.to_lextoken()->lxval().to_object() == _f.minusdelimob)
+      else if (_f.operdelimob == _f.minusdelimob)
         _f.binoperob = _f.minusbinopob;
     }
-  RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_factor¤" << callnum << " lextokv=" << _f.lextokv
+  RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_factor¤" << callnum << " operdelimob=" << _f.operdelimob
                 << " in:" << (*this) << " at " <<  startpos << " binoperob=" << _f.binoperob
                 << " position:" << position_str()
                 << " curcptr:" << Rps_QuotedC_String(curcptr())
@@ -1774,8 +1833,10 @@ Rps_TokenSource::parse_factor(Rps_CallFrame*callframe, bool*pokparse)
     {
       bool okright = false;
       /// consume the + or - delimiter…
-      _f.lexgotokv = get_token(&_);
-      RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_factor¤" << callnum << " lexgotokv=" << _f.lexgotokv
+      if (!skip_delimiter(&_, _f.operdelimob))
+        RPS_FATALOUT("Rps_TokenSource::parse_factor¤" << callnum << " failed to skip " << _f.operdelimob
+                     << " at " << position_str());
+      RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_factor¤" << callnum << " skipped operdelimob=" << _f.operdelimob
                     << " in:" << (*this) << " at "
                     <<  startpos << " binoperob=" << _f.binoperob
                     << " curcptr:" << Rps_QuotedC_String(curcptr())
@@ -1785,11 +1846,10 @@ Rps_TokenSource::parse_factor(Rps_CallFrame*callframe, bool*pokparse)
       {
         this->display_current_line_with_cursor(out);
       }));
-      RPS_ASSERT(_f.lexgotokv  == _f.lextokv);
       _f.rightv = parse_term(&_, &okright);
       if (!okright)
         {
-          RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_factor¤" << callnum << " FAIL right-term lexgotokv=" << _f.lexgotokv
+          RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_factor¤" << callnum << " FAIL right-term operdelimob=" << _f.operdelimob
                         << " in:" << (*this) << " at "
                         <<  startpos << " binoperob=" << _f.binoperob
                         << " curcptr:" << Rps_QuotedC_String(curcptr())
@@ -1829,14 +1889,14 @@ Rps_TokenSource::parse_factor(Rps_CallFrame*callframe, bool*pokparse)
                << " curcptr:" << Rps_QuotedC_String(curcptr())
                << " token_deq:" << toksrc_token_deq
                << std::endl << RPS_FULL_BACKTRACE_HERE(1, "Rps_TokenSource::parse_factor incomplete"));
-} // end Rps_TokenSource::parse_factor
+} // end Rps_TokenSource::raw_parse_factor
 
 
 
 /// a term is a sequence of factors with multiplicative operators
 /// between them…. All the operators should be the same. Otherwise we build intermediate subexpressions
 Rps_Value
-Rps_TokenSource::parse_term(Rps_CallFrame*callframe, bool*pokparse)
+Rps_TokenSource::raw_parse_term(Rps_CallFrame*callframe, bool*pokparse)
 {
   RPS_ASSERT(rps_is_main_thread());
   static long callcnt;
@@ -1846,7 +1906,6 @@ Rps_TokenSource::parse_term(Rps_CallFrame*callframe, bool*pokparse)
                  callframe,
                  Rps_Value restermv;
                  Rps_Value lextokv;
-                 Rps_Value lexopertokv;
                  Rps_Value lexgotokv;
                  Rps_Value leftv;
                  Rps_Value rightv;
@@ -2005,49 +2064,27 @@ Rps_TokenSource::parse_term(Rps_CallFrame*callframe, bool*pokparse)
         this->display_current_line_with_cursor(out);
       }));
       again = false;
-      _f.lextokv = lookahead_token(&_,  0);
-      RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_term¤" << callnum << " after leftv=" << _f.leftv << " lextokv=" << _f.lextokv
+      _f.curoperob = nullptr;
+      /// the operator following the left operand is looked ahead raw,
+      /// without making its lexical token
+      _f.lexoperdelimob = lookahead_delimiter();
+      RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_term¤" << callnum << " after leftv=" << _f.leftv
+                    << " operandvect=" << operandvect
+                    << " lexoperdelimob=" << _f.lexoperdelimob
                     << " in:" << (*this) << " at " <<  startpos << " loopcnt#" << loopcnt
                     << " curcptr " << Rps_QuotedC_String(curcptr())
                     << " token_deq:" << toksrc_token_deq
                     << std::endl
-                    << RPS_FULL_BACKTRACE_HERE(1, "Rps_TokenSource::parse_term after left"));
-      _f.lexopertokv = lookahead_token(&_,  1);
-      RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_term¤" << callnum << " after leftv=" << _f.leftv << " lextokv="
-                    << _f.lextokv
-                    << " lexopertokv=" << _f.lexopertokv
-                    << " pos:" << position_str() << " startpos:" << startpos
-                    << " curcptr " << Rps_QuotedC_String(curcptr()) << "@" << (void*)curcptr()
-                    << std::endl
-                    << Rps_Do_Output([&](std::ostream& out)
-      {
-        this->display_current_line_with_cursor(out);
-      }));
-      usleep (250000);    // for debugging
-      RPS_POSSIBLE_BREAKPOINT();
-      _f.lextokv = get_token(&_);
-      RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_term¤" << callnum << " got token after leftv=" << _f.leftv
-                    << " operandvect=" << operandvect
-                    << " got lextok=" << _f.lextokv << std::endl
-                    << "… lexopertokv=" << _f.lexopertokv << "  in:" << (*this) << std::endl
-                    << "… @! " << position_str()
-                    << " curcptr " << Rps_QuotedC_String(curcptr()) << "@" << (void*)curcptr()
-                    << std::endl
                     << Rps_Do_Output([&](std::ostream& out)
       {
         this->display_current_line_with_cursor(out);
       })
           << std::endl << RPS_FULL_BACKTRACE_HERE(1, "Rps_TokenSource::parse_term after-left"));
-      if (!_f.lextokv)
-        break;
-      if (_f.lexopertokv && _f.lexopertokv.is_lextoken()
-          &&  _f.lexopertokv.to_lextoken()->lxkind()
-          == RPS_ROOT_OB(_2wdmxJecnFZ02VGGFK) //repl_delimiter∈class
-          &&  _f.lexopertokv.to_lextoken()->lxval().is_object())
+      RPS_POSSIBLE_BREAKPOINT();
+      if (_f.lexoperdelimob)
         {
-          _f.lexoperdelimob =  _f.lexopertokv.to_lextoken()->lxval().to_object();
           RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_term¤" << callnum << " got token after leftv=" << _f.leftv
-                        << " got lexopertokv=" << _f.lexopertokv << " bindelimob=" << _f.bindelimob
+                        << " bindelimob=" << _f.bindelimob
                         << " lexoperdelimob=" << _f.lexoperdelimob
                         << " binoperob=" << _f.binoperob
                         << " @! " << position_str() << std::endl
@@ -2061,25 +2098,25 @@ Rps_TokenSource::parse_term(Rps_CallFrame*callframe, bool*pokparse)
           }));
           if (_f.lexoperdelimob == _f.multdelimob)
             {
-              RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_term¤" << callnum << " lexopertokv:" << _f.lexopertokv << " multiply at " << position_str()
+              RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_term¤" << callnum << " lexoperdelimob:" << _f.lexoperdelimob << " multiply at " << position_str()
                             << std::endl << "… token_deq:" << toksrc_token_deq << " startpos:" << startpos);
               _f.curoperob = _f.multbinopob;
             }
           else if (_f.lexoperdelimob == _f.divdelimob)
             {
-              RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_term¤" << callnum << " lexopertokv:" << _f.lexopertokv << " divide at " << position_str()
+              RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_term¤" << callnum << " lexoperdelimob:" << _f.lexoperdelimob << " divide at " << position_str()
                             << std::endl << "… token_deq:" << toksrc_token_deq << " startpos:" << startpos);
               _f.curoperob = _f.divbinopob;
             }
           else if (_f.lexoperdelimob == _f.moddelimob)
             {
-              RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_term¤" << callnum << " lexopertokv:" << _f.lexopertokv << " modulus at " << position_str()
+              RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_term¤" << callnum << " lexoperdelimob:" << _f.lexoperdelimob << " modulus at " << position_str()
                             << std::endl << "… token_deq:" << toksrc_token_deq << " startpos:" << startpos);
               _f.curoperob = _f.modbinopob;
             }
           else
             {
-              RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_term¤" << callnum << " lexopertokv:" << _f.lexopertokv
+              RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_term¤" << callnum << " lexoperdelimob:" << _f.lexoperdelimob
                             << " strange lexoperdelimob:" << _f.lexoperdelimob << " :!-> return leftv:" << _f.leftv
                             << std::endl << "… token_deq:" << toksrc_token_deq << " startpos:" << startpos
                             <<" curcptr " << Rps_QuotedC_String(curcptr()));
@@ -2088,7 +2125,7 @@ Rps_TokenSource::parse_term(Rps_CallFrame*callframe, bool*pokparse)
               return _f.leftv;
             }
           RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_term¤" << callnum << " got token after leftv=" << _f.leftv << " curoperob=" << _f.curoperob
-                        << " lexopertokv=" << _f.lexopertokv);
+                        << " lexoperdelimob=" << _f.lexoperdelimob);
         }
       RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_term¤" << callnum << " operandvect:" << operandvect
                     << " curoperob=" << _f.curoperob << " binoperob=" << _f.binoperob << " lexoperdelimob=" << _f.lexoperdelimob
@@ -2107,6 +2144,9 @@ Rps_TokenSource::parse_term(Rps_CallFrame*callframe, bool*pokparse)
           if (_f.binoperob == _f.curoperob)
             {
               bool okright = false;
+              if (!skip_delimiter(&_, _f.lexoperdelimob)) // consume the operator
+                RPS_FATALOUT("Rps_TokenSource::parse_term¤" << callnum << " failed to skip " << _f.lexoperdelimob
+                             << " at " << position_str());
               RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_term¤" << callnum << " operandvect:" << operandvect << " leftv=" << _f.leftv
                             << " before parse_primary of right" << position_str());
               _f.rightv = parse_primary(&_, &okright);
@@ -2222,13 +2262,13 @@ Rps_TokenSource::parse_term(Rps_CallFrame*callframe, bool*pokparse)
                    << " leftv=" << _f.leftv << std::endl
                    << RPS_FULL_BACKTRACE_HERE(1, "Rps_TokenSource::parse_term/INCOMPLETE"));
     }
-} // end Rps_TokenSource::parse_term
+} // end Rps_TokenSource::raw_parse_term
 
 
 /// a term is a sequence of factors with multiplicative operators
 /// between them…. All the operators should be the same. Otherwise we build intermediate subexpressions
 Rps_Value
-Rps_TokenSource::parse_product(Rps_CallFrame*callframe, bool*pokparse)
+Rps_TokenSource::raw_parse_product(Rps_CallFrame*callframe, bool*pokparse)
 {
   RPS_ASSERT(rps_is_main_thread());
   static long callcnt;
@@ -2335,7 +2375,7 @@ Rps_TokenSource::parse_product(Rps_CallFrame*callframe, bool*pokparse)
 /// evaluated to a value; the *pokparse flag, when given, is set to
 /// true if and only if parsing was successful.
 Rps_Value
-Rps_TokenSource::parse_primary(Rps_CallFrame*callframe,  bool*pokparse)
+Rps_TokenSource::raw_parse_primary(Rps_CallFrame*callframe, bool*pokparse)
 {
   RPS_ASSERT(rps_is_main_thread());
   static long callcnt;
@@ -2563,9 +2603,9 @@ Rps_TokenSource::parse_primary(Rps_CallFrame*callframe,  bool*pokparse)
           {
             this->display_current_line_with_cursor(out);
           }));
-          /// we did consume the leftparen-
-          _f.lexgotokv = get_token(&_);
-          //WRONG _f.lexgotokv = lookahead_token(&_, 0);
+          /// we consume the leftparen
+          _f.lexgotokv = _f.lextokv;
+          consume_front_token(&_);
           RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_primary¤" << callnum << " got leftparen before parsing-subexpression"
                         << "  in:" << (*this) << std::endl
                         << "… lextokv:" << _f.lextokv << std::endl
@@ -2692,7 +2732,7 @@ Rps_TokenSource::parse_primary(Rps_CallFrame*callframe,  bool*pokparse)
                << " startpos:" << startpos
                << " curcptr:" << Rps_QuotedC_String(curcptr())
                << " token_deq:" << toksrc_token_deq);
-} // end Rps_TokenSource::parse_primary
+} // end Rps_TokenSource::raw_parse_primary
 
 
 bool
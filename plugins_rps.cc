@@ -0,0 +1,476 @@
+/****************************************************************
+ * file plugins_rps.cc
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Description:
+ *      This file is part of the Reflective Persistent System.
+ *
+ *      It has the registry of plugins, which can be loaded, unloaded
+ *      and reloaded while running, and a cache of resolved symbols.
+ *
+ * Author(s):
+ *      Basile Starynkevitch <basile@starynkevitch.net>
+ *      Abhishek Chakravarti <abhishek@taranjali.org>
+ *      Nimesh Neema <nimeshneema@gmail.com>
+ *
+ *      © Copyright (C) 2025 The Reflective Persistent System Team
+ *      team@refpersys.org & http://refpersys.org/
+ *
+ * License:
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+
+#include "refpersys.hh"
+
+#include <link.h>
+
+extern "C" const char rps_plugins_gitid[];
+const char rps_plugins_gitid[]= RPS_GITID;
+
+extern "C" const char rps_plugins_date[];
+const char rps_plugins_date[]= __DATE__;
+
+extern "C" const char rps_plugins_shortgitid[];
+const char rps_plugins_shortgitid[]= RPS_SHORTGITID;
+
+
+/// dlopen, dlsym and dlclose are not reentrant, and the registry
+/// (that is rps_plugins_vector after startup) is shared by threads
+static std::recursive_mutex rps_plugin_mtx;
+
+/// cache of successfully resolved symbols, prefilled by
+/// rps_plugin_scan_symbols; lookups only take a shared lock, so can
+/// run in parallel
+static std::shared_mutex rps_plugin_symmtx;
+static std::unordered_map<std::string,void*> rps_plugin_symcache;
+
+/// dlopen handles of previous versions of reloaded plugins, and of
+/// unloaded plugins; they are never dlclose-d, since other threads
+/// may still run their code
+static std::vector<void*> rps_plugin_retired_dlh;
+
+/// load addresses of the unloaded plugins, whose symbols are ignored
+/// although they stay in the global scope, under rps_plugin_mtx
+static std::set<ElfW(Addr)> rps_plugin_unloaded_addrset;
+
+static bool
+rps_plugin_is_unloaded_address(void*ad)
+{
+  if (rps_plugin_unloaded_addrset.empty())
+    return false;
+  Dl_info info;
+  struct link_map* lm = nullptr;
+  memset (&info, 0, sizeof(info));
+  if (!dladdr1(ad, &info, (void**)&lm, RTLD_DL_LINKMAP) || !lm)
+    return false;
+  return rps_plugin_unloaded_addrset.find(lm->l_addr) != rps_plugin_unloaded_addrset.end();
+} // end rps_plugin_is_unloaded_address
+
+void*
+rps_plugin_dlsym(const char*symname)
+{
+  RPS_ASSERT(symname != nullptr);
+  {
+    std::shared_lock<std::shared_mutex> rgu(rps_plugin_symmtx);
+    auto it = rps_plugin_symcache.find(symname);
+    if (it != rps_plugin_symcache.end())
+      return it->second;
+  }
+  std::lock_guard<std::recursive_mutex> gu(rps_plugin_mtx);
+  void* ad = nullptr;
+  /// newest plugins first, since a reloaded plugin is still in the
+  /// global scope under its previous version
+  for (auto rit = rps_plugins_vector.rbegin();
+       !ad && rit != rps_plugins_vector.rend(); rit++)
+    if (rit->plugin_dlh)
+      ad = dlsym(rit->plugin_dlh, symname);
+  if (!ad && rps_proghdl)
+    ad = dlsym(rps_proghdl, symname);
+  if (ad && rps_plugin_is_unloaded_address(ad))
+    ad = nullptr;
+  if (ad)
+    {
+      std::unique_lock<std::shared_mutex> wgu(rps_plugin_symmtx);
+      rps_plugin_symcache.insert({symname, ad});
+    };
+  return ad;
+} // end rps_plugin_dlsym
+
+void
+rps_plugin_forget_symbols(void)
+{
+  std::unique_lock<std::shared_mutex> wgu(rps_plugin_symmtx);
+  rps_plugin_symcache.clear();
+} // end rps_plugin_forget_symbols
+
+/// the number of symbols of a dynamic symbol table, known from its
+/// SysV hash table or else from its GNU hash table
+static unsigned
+rps_plugin_nb_dynsyms(const ElfW(Word)*hashtab, const ElfW(Word)*gnuhashtab)
+{
+  if (hashtab)
+    return hashtab[1];
+  if (!gnuhashtab)
+    return 0;
+  ElfW(Word) nbuckets = gnuhashtab[0];
+  ElfW(Word) symoffset = gnuhashtab[1];
+  ElfW(Word) bloomsize = gnuhashtab[2];
+  const ElfW(Addr)* bloom = reinterpret_cast<const ElfW(Addr)*>(gnuhashtab+4);
+  const ElfW(Word)* buckets = reinterpret_cast<const ElfW(Word)*>(bloom+bloomsize);
+  const ElfW(Word)* chain = buckets+nbuckets;
+  ElfW(Word) last = 0;
+  for (ElfW(Word) ix=0; ix<nbuckets; ix++)
+    if (buckets[ix] > last)
+      last = buckets[ix];
+  if (last < symoffset)
+    return symoffset;
+  /// the last chain ends with its lowest bit set
+  while (!(chain[last-symoffset] & 1))
+    last++;
+  return last+1;
+} // end rps_plugin_nb_dynsyms
+
+/// dl_iterate_phdr callback adding the defined symbols of a loaded
+/// object which have one of our prefixes
+static int
+rps_plugin_scan_object(struct dl_phdr_info*info, size_t, void*data)
+{
+  auto symap = static_cast<std::unordered_map<std::string,void*>*>(data);
+  if (rps_plugin_unloaded_addrset.find(info->dlpi_addr) != rps_plugin_unloaded_addrset.end())
+    return 0;
+  const ElfW(Dyn)* dyn = nullptr;
+  for (int ix=0; ix<(int)info->dlpi_phnum; ix++)
+    if (info->dlpi_phdr[ix].p_type == PT_DYNAMIC)
+      dyn = reinterpret_cast<const ElfW(Dyn)*>(info->dlpi_addr + info->dlpi_phdr[ix].p_vaddr);
+  if (!dyn)
+    return 0;
+  /// the dynamic linker usually relocates these addresses in place,
+  /// but not for every object (e.g. the vDSO)
+  auto relocated = [&](ElfW(Addr) ad) -> ElfW(Addr)
+  {
+    return (ad < info->dlpi_addr)?(ad + info->dlpi_addr):ad;
+  };
+  const ElfW(Sym)* symtab = nullptr;
+  const char* strtab = nullptr;
+  const ElfW(Word)* hashtab = nullptr;
+  const ElfW(Word)* gnuhashtab = nullptr;
+  for (; dyn->d_tag != DT_NULL; dyn++)
+    switch (dyn->d_tag)
+      {
+      case DT_SYMTAB:
+        symtab = reinterpret_cast<const ElfW(Sym)*>(relocated(dyn->d_un.d_ptr));
+        break;
+      case DT_STRTAB:
+        strtab = reinterpret_cast<const char*>(relocated(dyn->d_un.d_ptr));
+        break;
+      case DT_HASH:
+        hashtab = reinterpret_cast<const ElfW(Word)*>(relocated(dyn->d_un.d_ptr));
+        break;
+      case DT_GNU_HASH:
+        gnuhashtab = reinterpret_cast<const ElfW(Word)*>(relocated(dyn->d_un.d_ptr));
+        break;
+      default:
+        break;
+      };
+  if (!symtab || !strtab)
+    return 0;
+  unsigned nbsyms = rps_plugin_nb_dynsyms(hashtab, gnuhashtab);
+  for (unsigned ix=0; ix<nbsyms; ix++)
+    {
+      const ElfW(Sym)* sym = symtab+ix;
+      if (sym->st_shndx == SHN_UNDEF || sym->st_value == 0)
+        continue;
+      int symtyp = sym->st_info & 0xf;
+      if (symtyp != STT_FUNC && symtyp != STT_OBJECT)
+        continue;
+      const char* name = strtab + sym->st_name;
+      if (name[0] != 'r' || name[1] != 'p' || name[2] != 's')
+        continue;
+      if (!strncmp(name, RPS_APPLYINGFUN_PREFIX "_", sizeof(RPS_APPLYINGFUN_PREFIX))
+          || !strncmp(name, RPS_GETTERFUN_PREFIX "_", sizeof(RPS_GETTERFUN_PREFIX))
+          || !strncmp(name, RPS_PAYLOADING_PREFIX, sizeof(RPS_PAYLOADING_PREFIX)-1))
+        /// later objects win, like in rps_plugin_dlsym
+        (*symap)[name] = reinterpret_cast<void*>(info->dlpi_addr + sym->st_value);
+    };
+  return 0;
+} // end rps_plugin_scan_object
+
+unsigned
+rps_plugin_scan_symbols(void)
+{
+  std::unordered_map<std::string,void*> symap;
+  {
+    std::lock_guard<std::recursive_mutex> gu(rps_plugin_mtx);
+    dl_iterate_phdr(rps_plugin_scan_object, &symap);
+  }
+  unsigned nbsyms = symap.size();
+  std::unique_lock<std::shared_mutex> wgu(rps_plugin_symmtx);
+  for (auto& it: symap)
+    rps_plugin_symcache.insert_or_assign(it.first, it.second);
+  RPS_DEBUG_LOG(LOAD, "rps_plugin_scan_symbols found " << nbsyms << " symbols");
+  return nbsyms;
+} // end rps_plugin_scan_symbols
+
+/// the index of a plugin in rps_plugins_vector, or -1
+static int
+rps_plugin_index(const char*plugname)
+{
+  RPS_ASSERT(plugname != nullptr);
+  std::string name(plugname);
+  int namlen = name.length();
+  if (namlen > 4 && name.substr(namlen-3) == ".so")
+    name.erase(namlen-3);
+  for (int ix=0; ix<(int)rps_plugins_vector.size(); ix++)
+    if (rps_plugins_vector[ix].plugin_name == name)
+      return ix;
+  return -1;
+} // end rps_plugin_index
+
+static void
+rps_plugin_run_init(Rps_Plugin*plugin)
+{
+  RPS_ASSERT(plugin != nullptr && plugin->plugin_dlh != nullptr);
+  void* dopluginad = dlsym(plugin->plugin_dlh, RPS_PLUGIN_INIT_NAME);
+  if (!dopluginad)
+    throw RPS_RUNTIME_ERROR_OUT("cannot find symbol " RPS_PLUGIN_INIT_NAME " in plugin "
+                                << plugin->plugin_name << ":" << dlerror());
+  rps_plugin_init_sig_t* pluginit = reinterpret_cast<rps_plugin_init_sig_t*>(dopluginad);
+  (*pluginit)(plugin);
+} // end rps_plugin_run_init
+
+/// rebind every applying function or magic getter defined in the
+/// shared object of oldlm, using rebindfun on its symbol name; the
+/// functions replaced by the trampoline of a compiled routine are
+/// rebound in the routine table
+static unsigned
+rps_plugin_rebind(struct link_map*oldlm, const std::function<void*(const char*)>&rebindfun)
+{
+  auto rebindad = [&](const Rps_ObjectZone*obz, void*oldad) -> void*
+  {
+    Dl_info info;
+    struct link_map* lm = nullptr;
+    memset (&info, 0, sizeof(info));
+    if (!dladdr1(oldad, &info, (void**)&lm, RTLD_DL_LINKMAP) || lm != oldlm)
+      return oldad;
+    void* newad = info.dli_sname?rebindfun(info.dli_sname):nullptr;
+    RPS_DEBUG_LOG(LOAD, "rps_plugin_rebind " << Rps_ObjectRef(const_cast<Rps_ObjectZone*>(obz))
+                  << " " << (info.dli_sname?:"?") << " from " << oldad << " to " << newad);
+    return newad;
+  };
+  return Rps_ObjectZone::rebind_native_functions(rebindad)
+         + rps_jit_rebind_original_functions(rebindad);
+} // end rps_plugin_rebind
+
+bool
+rps_load_plugin(const char*path, bool runinit)
+{
+  RPS_ASSERT(path != nullptr);
+  std::lock_guard<std::recursive_mutex> gu(rps_plugin_mtx);
+  std::string pathstr(path);
+  const char* bnplug = basename(pathstr.c_str());
+  if (rps_plugin_index(bnplug) >= 0)
+    {
+      RPS_WARNOUT("rps_load_plugin: plugin " << bnplug << " from " << path
+                  << " is already loaded");
+      return false;
+    };
+  void* dlh = dlopen(path, RTLD_NOW|RTLD_GLOBAL);
+  if (!dlh)
+    {
+      RPS_WARNOUT("rps_load_plugin failed to dlopen " << path << " : " << dlerror());
+      return false;
+    };
+  /// loading again an unloaded plugin gives its retired handle
+  if (struct link_map* lm = nullptr;
+      !dlinfo(dlh, RTLD_DI_LINKMAP, &lm) && lm)
+    rps_plugin_unloaded_addrset.erase(lm->l_addr);
+  rps_plugins_vector.push_back(Rps_Plugin(bnplug, dlh, path));
+  rps_plugin_forget_symbols();
+  rps_plugin_scan_symbols();
+  RPS_INFORMOUT("loaded plugin#" << (rps_plugins_vector.size()-1) << " from " << path
+                << " from process pid#" << (int)getpid()
+                << " basenamed " << Rps_QuotedC_String(bnplug));
+  if (runinit)
+    {
+      try
+        {
+          rps_plugin_run_init(&rps_plugins_vector.back());
+        }
+      catch (std::exception& exc)
+        {
+          RPS_WARNOUT("rps_load_plugin failed to initialize plugin " << bnplug
+                      << " got exception " << exc.what());
+          return false;
+        }
+    };
+  return true;
+} // end rps_load_plugin
+
+bool
+rps_unload_plugin(const char*plugname)
+{
+  std::lock_guard<std::recursive_mutex> gu(rps_plugin_mtx);
+  int ix = rps_plugin_index(plugname);
+  if (ix < 0)
+    {
+      RPS_WARNOUT("rps_unload_plugin: no plugin " << plugname);
+      return false;
+    };
+  Rps_Plugin plugin = rps_plugins_vector[ix];
+  struct link_map* lm = nullptr;
+  if (dlinfo(plugin.plugin_dlh, RTLD_DI_LINKMAP, &lm) || !lm)
+    RPS_FATALOUT("rps_unload_plugin: no link map for " << plugin.plugin_name
+                 << " : " << dlerror());
+  unsigned nbunbound = rps_plugin_rebind(lm, [](const char*) -> void*
+  {
+    return nullptr;
+  });
+  rps_plugins_vector.erase(rps_plugins_vector.begin()+ix);
+  /// like in rps_reload_plugin, agenda threads may still run the
+  /// unbound functions, so the handle is retired and its symbols
+  /// ignored by later lookups
+  rps_plugin_retired_dlh.push_back(plugin.plugin_dlh);
+  rps_plugin_unloaded_addrset.insert(lm->l_addr);
+  rps_plugin_forget_symbols();
+  rps_plugin_scan_symbols();
+  RPS_INFORMOUT("unloaded plugin " << plugin.plugin_name
+                << " unbinding " << nbunbound << " functions");
+  return true;
+} // end rps_unload_plugin
+
+bool
+rps_reload_plugin(const char*plugname, bool runinit)
+{
+  std::lock_guard<std::recursive_mutex> gu(rps_plugin_mtx);
+  int ix = rps_plugin_index(plugname);
+  if (ix < 0)
+    {
+      RPS_WARNOUT("rps_reload_plugin: no plugin " << plugname);
+      return false;
+    };
+  Rps_Plugin& plugin = rps_plugins_vector[ix];
+  if (plugin.plugin_path.empty())
+    {
+      RPS_WARNOUT("rps_reload_plugin: plugin " << plugin.plugin_name
+                  << " has no known path");
+      return false;
+    };
+  /// dlopen-ing the same path again would give the old handle, so the
+  /// new version is copied into an anonymous memfd_create(2) file and
+  /// dlopen-ed thru /proc/self/fd/, with nothing visible in the file
+  /// system. That descriptor is never closed: the retired handles
+  /// stay loaded, and glibc would give one of them again for a reused
+  /// /proc/self/fd/ path.
+  int srcfd = open(plugin.plugin_path.c_str(), O_RDONLY|O_CLOEXEC);
+  if (srcfd < 0)
+    {
+      RPS_WARNOUT("rps_reload_plugin failed to open " << plugin.plugin_path
+                  << " : " << strerror(errno));
+      return false;
+    };
+  std::string memname = plugin.plugin_name + "-g"
+                        + std::to_string(plugin.plugin_generation+1);
+  int memfd = memfd_create(memname.c_str(), MFD_CLOEXEC);
+  if (memfd < 0)
+    {
+      RPS_WARNOUT("rps_reload_plugin failed to memfd_create for " << plugin.plugin_path
+                  << " : " << strerror(errno));
+      close(srcfd);
+      return false;
+    };
+  char copybuf[8192];
+  ssize_t nbr = 0;
+  bool copied = true;
+  while (copied && (nbr = read(srcfd, copybuf, sizeof(copybuf))) != 0)
+    {
+      if (nbr < 0)
+        {
+          copied = (errno == EINTR);
+          continue;
+        };
+      for (ssize_t off = 0; off < nbr && copied; )
+        {
+          ssize_t nbw = write(memfd, copybuf+off, nbr-off);
+          if (nbw > 0)
+            off += nbw;
+          else
+            copied = (nbw < 0 && errno == EINTR);
+        };
+    };
+  int copyerr = errno;
+  close(srcfd);
+  if (!copied)
+    {
+      RPS_WARNOUT("rps_reload_plugin failed to copy " << plugin.plugin_path
+                  << " : " << strerror(copyerr));
+      close(memfd);
+      return false;
+    };
+  char procpath[64];
+  memset (procpath, 0, sizeof(procpath));
+  snprintf(procpath, sizeof(procpath), "/proc/self/fd/%d", memfd);
+  void* newdlh = dlopen(procpath, RTLD_NOW|RTLD_GLOBAL);
+  if (!newdlh)
+    {
+      RPS_WARNOUT("rps_reload_plugin failed to dlopen " << plugin.plugin_path
+                  << " : " << dlerror());
+      close(memfd);
+      return false;
+    };
+  void* olddlh = plugin.plugin_dlh;
+  struct link_map* oldlm = nullptr;
+  if (dlinfo(olddlh, RTLD_DI_LINKMAP, &oldlm) || !oldlm)
+    RPS_FATALOUT("rps_reload_plugin: no link map for " << plugin.plugin_name
+                 << " : " << dlerror());
+  unsigned nbmissing = 0;
+  unsigned nbrebound = rps_plugin_rebind(oldlm, [&](const char*symname) -> void*
+  {
+    void* newad = dlsym(newdlh, symname);
+    if (!newad)
+      {
+        /// keep the old function, its code stays mapped
+        nbmissing++;
+        return dlsym(olddlh, symname);
+      }
+    return newad;
+  });
+  plugin.plugin_dlh = newdlh;
+  plugin.plugin_generation++;
+  rps_plugin_retired_dlh.push_back(olddlh);
+  rps_plugin_forget_symbols();
+  rps_plugin_scan_symbols();
+  RPS_INFORMOUT("reloaded plugin " << plugin.plugin_name << " generation#"
+                << plugin.plugin_generation << " from " << plugin.plugin_path
+                << " rebinding " << nbrebound << " functions"
+                << (nbmissing?", keeping ":"")
+                << (nbmissing?std::to_string(nbmissing):std::string(""))
+                << (nbmissing?" missing ones":""));
+  if (runinit)
+    {
+      try
+        {
+          rps_plugin_run_init(&plugin);
+        }
+      catch (std::exception& exc)
+        {
+          RPS_WARNOUT("rps_reload_plugin failed to initialize plugin " << plugin.plugin_name
+                      << " got exception " << exc.what());
+          return false;
+        }
+    };
+  return true;
+} // end rps_reload_plugin
+
+/*** end of file plugins_rps.cc ***/
@@ -291,6 +291,7 @@ extern "C" std::string rps_cpluspluseditor_str;
 extern "C" std::string rps_cplusplusflags_str;
 extern "C" std::string rps_dumpdir_str;
 extern "C" std::vector<std::string> rps_command_vec;
+extern "C" std::string rps_repl_script_path;
 extern "C" std::string rps_test_repl_string;
 extern "C" std::string rps_publisher_url_str;
 extern "C" bool rps_without_quick_tests;
@@ -484,17 +485,21 @@ extern "C" bool rps_run_repl;
 extern "C" void rps_jsonrpc_initialize(void);
 extern "C" void rps_gccjit_initialize(void);
 extern "C" void rps_gccjit_finalize(void); // passed to atexit(3)
+extern "C" void rps_jit_gc_mark(Rps_GarbageCollector&gc);
+extern "C" void rps_jit_forget_dead(Rps_GarbageCollector&gc);
 
-/// Our event loop can call C++ closures before the poll(2) system
-/// call in the event loop. This C++ closure (or std::function) could
-/// add additional sources to the event loop. This
+/// Our event loop can call C++ closures before waiting in the event
+/// loop. This C++ closure (or std::function) could add additional
+/// sources to be poll(2)-ed with the epoll(7) file descriptor. This
 /// rps_register_event_loop_prepoller function returns some index for
 /// the unregistering function.
 extern "C" int rps_register_event_loop_prepoller(std::function<void (struct pollfd*, int& npoll, Rps_CallFrame*)> fun);
 extern "C" void rps_unregister_event_loop_prepoller(int rank);
 extern "C" bool rps_is_active_event_loop(void);
 
-/// register C function input handler
+/// register C function input or output handler; it stays registered
+/// (with edge-triggered readiness, so it should read or write till
+/// EAGAIN) until removed
 extern "C" void rps_event_loop_add_input_fd_handler
 (int fd,
  Rps_EventHandler_sigt*cfun,
@@ -515,7 +520,8 @@ extern "C" void rps_do_stop_event_loop(void);
 // in eventloop_rps.cc, tell if the event loop is running.
 extern "C" bool rps_event_loop_is_running(void);
 /* return true, and fill the information, about entry#ix in event loop
-   internal data, or else return false */
+   internal data, or else return false; ix is twice the file
+   descriptor, plus one for output handlers */
 extern "C" bool rps_event_loop_get_entry(int ix,
     Rps_EventHandler_sigt** pfun, struct pollfd*po, const char**pexpl, void**pdata);
 // in eventloop_rps.cc, give the counter for the loop, or -1 if it is
@@ -724,8 +730,11 @@ struct Rps_Plugin
 {
   std::string plugin_name;
   void* plugin_dlh;
-  Rps_Plugin (const char*name, void*dlh)
-    : plugin_name(name), plugin_dlh(dlh)
+  std::string plugin_path;      // the shared object, for reloading
+  unsigned plugin_generation;   // incremented at each reload
+  Rps_Plugin (const char*name, void*dlh, const char*path=nullptr)
+    : plugin_name(name), plugin_dlh(dlh),
+      plugin_path(path?path:""), plugin_generation(0)
   {
     int plnamlen = plugin_name.length();
     if (plnamlen > 4
@@ -746,6 +755,24 @@ extern "C" const char*rps_get_plugin_cstr_argument(const Rps_Plugin*plugin);
 
 extern "C" std::vector<Rps_Plugin> rps_plugins_vector;
 
+/// The plugin registry, in plugins_rps.cc, can load, unload and
+/// reload plugins while running.  Resolved symbols are cached; the
+/// most recently loaded plugin defining a symbol wins.
+extern "C" void* rps_plugin_dlsym(const char*symname);
+extern "C" void rps_plugin_forget_symbols(void);
+/// prefill the cache with the applying functions, magic getters and
+/// payload loaders of the dynamic symbol tables of the program and
+/// its plugins; gives the number of symbols found
+extern "C" unsigned rps_plugin_scan_symbols(void);
+extern "C" bool rps_load_plugin(const char*path, bool runinit);
+/// the functions of the unloaded plugin are unbound, and its symbols
+/// are no longer found; its handle is retired, never dlclose-d, since
+/// other threads may still run its code
+extern "C" bool rps_unload_plugin(const char*plugname);
+/// the applying functions and magic getters of the reloaded plugin
+/// are atomically rebound to its new version
+extern "C" bool rps_reload_plugin(const char*plugname, bool runinit);
+
 ////////////////////////////////////////////////////////////////
 
 struct Rps_Status
@@ -826,6 +853,10 @@ enum rps_progoption_en
   RPSPROGOPT_NO_TERMINAL,
   RPSPROGOPT_NO_ASLR,
   RPSPROGOPT_NO_QUICK_TESTS,
+  RPSPROGOPT_NO_IO_URING,
+  RPSPROGOPT_INTERN_STRINGS,
+  RPSPROGOPT_JIT_THRESHOLD,
+  RPSPROGOPT_REPL_SCRIPT,
   RPSPROGOPT_TEST_REPL_LEXER,
   RPSPROGOPT_RUN_DELAY,
   RPSPROGOPT_RUN_AFTER_LOAD,
@@ -1068,10 +1099,11 @@ while (0)
 #define RPS_ASSERT_CALLFRAME(Callframe) \
     RPS_ASSERT((Callframe) != nullptr && (Callframe)->is_good_call_frame())
 #else
-#define RPS_ASSERT(Cond) do { if (false && (Cond)) rps_fatal_stop_at(__FILE_,__LINE__); } while(0)
+#define RPS_ASSERT(Cond) do { if (false && (Cond)) rps_fatal_stop_at(__FILE__,__LINE__); } while(0)
 #define RPS_ASSERTPRINTF(Cond,Fmt,...)  do { if (false && (Cond)) \
       fprintf(stderr, Fmt "\n", ##__VA_ARGS__); } while(0)
-#define RPS_ASSERT(Callframe)
+#define RPS_ASSERT_CALLFRAME(Callframe) \
+    RPS_ASSERT((Callframe) != nullptr && (Callframe)->is_good_call_frame())
 
 #endif /*NDEBUG*/
 
@@ -1251,7 +1283,9 @@ rps_timer_cpu_elapsed(const rps_timer *hnd)
    binary executable code with a call; don't forget to flush the
    caches! */
 
-#ifndef RPS_BASENAME
+/* When refpersys.hh is precompiled for plugins (see GNUmakefile), the
+   RPS_BASENAME of each plugin is defined only after it is included. */
+#if !defined(RPS_BASENAME) && !defined(RPS_PLUGIN_PCH)
 #error RPS_BASENAME should be a string and is needed here
 #endif
 
@@ -1677,6 +1711,7 @@ class Rps_TupleOb;
 class Rps_LexTokenZone;
 class Rps_ClosureZone;
 class Rps_InstanceZone;
+class Rps_InstanceAttrSite;
 class Rps_GarbageCollector;
 class Rps_Loader; // in load_rps.cc
 class Rps_Dumper; // in dump_rps.cc
@@ -1801,6 +1836,8 @@ public:
   static constexpr unsigned max_output_depth = 5;
   inline void output(std::ostream&out, unsigned depth=0, unsigned maxdepth= max_output_depth) const;
   Rps_Value get_attr(Rps_CallFrame*stkf, const Rps_ObjectRef obattr) const;
+  /// get an attribute, for instances thru the slot cached in a call site
+  Rps_Value get_attr(Rps_CallFrame*stkf, const Rps_ObjectRef obattr, Rps_InstanceAttrSite&site) const;
   Rps_Value get_physical_attr(const Rps_ObjectRef obattr) const;
   inline void clear(void);
   inline Rps_Value& operator = (std::nullptr_t)
@@ -2376,8 +2413,24 @@ std::ostream& operator << (std::ostream& out, const Rps_Backtracer& rpb)
 
 ////////////////////////////////////////////////////// garbage collector
 
+/// forbidding the garbage collection waits for a running one to end,
+/// and nests; prefer the Rps_GarbageCollectionForbidder guard below
 extern "C" void rps_forbid_garbage_collection(void);
 extern "C" void rps_allow_garbage_collection(void);
+class Rps_GarbageCollectionForbidder
+{
+public:
+  Rps_GarbageCollectionForbidder()
+  {
+    rps_forbid_garbage_collection();
+  };
+  ~Rps_GarbageCollectionForbidder()
+  {
+    rps_allow_garbage_collection();
+  };
+  Rps_GarbageCollectionForbidder(const Rps_GarbageCollectionForbidder&) = delete;
+  Rps_GarbageCollectionForbidder& operator=(const Rps_GarbageCollectionForbidder&) = delete;
+};                              // end class Rps_GarbageCollectionForbidder
 
 /* Our top level function to call the garbage collector; the optional
    argument C++ std::function is marking more local data, e.g. calling
@@ -2401,6 +2454,7 @@ class Rps_GarbageCollector
   uint64_t gc_nbmark;
   uint64_t gc_nbdelete;
   uint64_t gc_nbroots;
+  uint64_t gc_nblivewords; // words of surviving quasizones
   double gc_startrealtime;
   double gc_startelapsedtime;
   double gc_startprocesstime;
@@ -2438,6 +2492,10 @@ public:
   {
     return gc_nbdelete;
   };
+  uint64_t nb_live_words() const
+  {
+    return gc_nblivewords;
+  };
   void mark_obj(Rps_ObjectZone* ob);
   void mark_obj(Rps_ObjectRef ob);
   void mark_value(Rps_Value val, unsigned depth=0);
@@ -2479,11 +2537,14 @@ class Rps_QuasiZone : public Rps_TypedZone
   static uint32_t qz_cnt;
   // the cumulated amount of allocated words
   static std::atomic<uint64_t> qz_alloc_cumulw;
+  // the live words allocated by Rps_CountingAllocator for containers
+  static std::atomic<uint64_t> qz_external_livew;
   uint32_t qz_rank;             // the rank in qz_zonvec;
 protected:
   inline void* operator new (std::size_t siz, std::nullptr_t);
   inline void* operator new (std::size_t siz, unsigned wordgap);
   static constexpr uint16_t qz_gcmark_bit = 1;
+  static constexpr uint16_t qz_interned_bit = 2; // for Rps_String
 public:
   /// gives the number of machine words (8 bytes) allocated since
   /// start of process...
@@ -2491,6 +2552,15 @@ public:
   {
     return qz_alloc_cumulw.load();
   };
+  /// gives the number of machine words currently used by the heap
+  /// containers inside payloads and objects
+  static uint64_t external_live_wordcount()
+  {
+    return qz_external_livew.load();
+  };
+  /// called by Rps_CountingAllocator
+  static inline void note_external_allocation(std::size_t nbytes);
+  static inline void note_external_deallocation(std::size_t nbytes);
   static void initialize(void);
   static inline Rps_QuasiZone*nth_zone(uint32_t rk);
   static inline Rps_QuasiZone*raw_nth_zone(uint32_t rk, Rps_GarbageCollector&);
@@ -2586,6 +2656,44 @@ public:
 // end class Rps_QuasiZone;
 
 
+/// A stateless standard allocator for the containers owned by
+/// objects and payloads, so that their external memory is counted in
+/// Rps_QuasiZone::cumulative_allocated_wordcount (hence in the
+/// garbage collection pacing) and in external_live_wordcount.
+template <typename T> class Rps_CountingAllocator
+{
+public:
+  typedef T value_type;
+  Rps_CountingAllocator() noexcept {};
+  template <typename U> Rps_CountingAllocator(const Rps_CountingAllocator<U>&) noexcept {};
+  T* allocate(std::size_t n)
+  {
+    Rps_QuasiZone::note_external_allocation(n*sizeof(T));
+    return static_cast<T*>(::operator new(n*sizeof(T)));
+  };
+  void deallocate(T* p, std::size_t n) noexcept
+  {
+    Rps_QuasiZone::note_external_deallocation(n*sizeof(T));
+    ::operator delete(p);
+  };
+  template <typename U> bool operator == (const Rps_CountingAllocator<U>&) const noexcept
+  {
+    return true;
+  };
+  template <typename U> bool operator != (const Rps_CountingAllocator<U>&) const noexcept
+  {
+    return false;
+  };
+};        // end template Rps_CountingAllocator
+
+/// counted containers, used inside objects and payloads
+typedef std::vector<Rps_Value, Rps_CountingAllocator<Rps_Value>> rps_counted_valvect_t;
+typedef std::map<Rps_ObjectRef, Rps_Value, std::less<Rps_ObjectRef>,
+        Rps_CountingAllocator<std::pair<const Rps_ObjectRef, Rps_Value>>> rps_counted_objvalmap_t;
+typedef std::map<std::string, Rps_Value, std::less<std::string>,
+        Rps_CountingAllocator<std::pair<const std::string, Rps_Value>>> rps_counted_strvalmap_t;
+
+
 
 //////////////////////////////////////////////////////////// zone values
 class Rps_ZoneValue : public Rps_QuasiZone
@@ -2672,6 +2780,20 @@ std::string rps_glob_plain_file_path(const char*shellpat, const char*dirpath);
 extern "C"
 int rps_compute_cstr_two_64bits_hash(int64_t ht[2], const char*cstr, int len= -1);
 
+/// Vectorized UTF-8 routines of utf8_rps.cc, using SSE2 or AVX2 when
+/// the processor has them. rps_utf8_check behaves like u8_check,
+/// giving nullptr for valid UTF-8 or else the first invalid byte;
+/// rps_utf8_count gives the number of characters of a valid UTF-8
+/// string; rps_fast_compute_cstr_two_64bits_hash gives the very same
+/// results as rps_compute_cstr_two_64bits_hash.
+extern "C" size_t rps_utf8_ascii_prefix(const char*s, size_t len);
+extern "C" const char* rps_utf8_check(const char*s, size_t len);
+extern "C" size_t rps_utf8_count(const char*s, size_t len);
+extern "C"
+int rps_fast_compute_cstr_two_64bits_hash(int64_t ht[2], const char*cstr, int len= -1);
+/// compare the above routines with GNU libunistring and time them
+extern "C" void rps_utf8_benchmark(unsigned nbloops);
+
 static inline Rps_HashInt rps_hash_cstr(const char*cstr, int len= -1);
 
 class Rps_String : public Rps_LazyHashedZoneValue
@@ -2710,6 +2832,18 @@ public:
   virtual Json::Value dump_json(Rps_Dumper*) const;
   static const Rps_String* make(const char*cstr, int len= -1);
   static inline const Rps_String* make(const std::string&s);
+  /// give the unique string of that content, from the weak intern
+  /// table; Rps_String::make uses it with the --intern-strings
+  /// program option
+  static const Rps_String* make_interned(const char*cstr, int len= -1);
+  bool is_interned(void) const
+  {
+    return qz_gcinfo.load() & qz_interned_bit;
+  };
+  /// called by the garbage collector after marking, to remove the
+  /// dead interned strings
+  static void gc_clear_dead_interned(Rps_GarbageCollector&gc);
+  static unsigned nb_interned(void);
   const char*cstr() const
   {
     return _sbuf;
@@ -2723,6 +2857,10 @@ public:
     if (zv.stored_type() == Rps_Type::String)
       {
         auto othstr = reinterpret_cast<const Rps_String*>(&zv);
+        if (othstr == this)
+          return true;
+        if (is_interned() && othstr->is_interned())
+          return false;
         auto lh = lazy_hash();
         auto othlh = othstr->lazy_hash();
         if (lh != 0 && othlh != 0 && lh != othlh) return false;
@@ -2878,7 +3016,58 @@ protected:
   void really_gc_mark(Rps_GarbageCollector&gc, unsigned depth);
   std::string toksrc_linebuf;
   Rps_DequVal toksrc_token_deq;
+  long toksrc_tokpos;           // number of consumed tokens
   Rps_StringValue* toksrc_ptrnameval;
+public:
+  /// the memoized parsing rules for packrat parsing
+  enum parse_rule_en : uint8_t
+  {
+    ParseRule_None=0,
+    ParseRule_Expression,
+    ParseRule_Disjunction,
+    ParseRule_Conjunction,
+    ParseRule_Comparison,
+    ParseRule_Comparand,
+    ParseRule_Sum,
+    ParseRule_Product,
+    ParseRule_Factor,
+    ParseRule_Term,
+    ParseRule_Primary,
+    ParseRule__Last
+  };
+protected:
+  /// the packrat memo, keyed by rule and token position. Only parses
+  /// which did not consume any token are memoized, since the memo is
+  /// cleared when the token deque is shifted; the lexed line is kept
+  /// because reading another line may give more tokens.
+  struct parse_memo_st
+  {
+    Rps_Value pmemo_result;
+    int pmemo_line;
+    bool pmemo_ok;
+  };
+  std::unordered_map<uint64_t,parse_memo_st> toksrc_parse_memo;
+  static uint64_t parse_memo_key(parse_rule_en rule, long tokpos)
+  {
+    return (((uint64_t)rule)<<56) | (uint64_t)tokpos;
+  };
+  void note_consumed_token(void)
+  {
+    toksrc_tokpos++;
+    toksrc_parse_memo.clear();
+  };
+  Rps_Value parse_memoized(Rps_CallFrame*callframe, parse_rule_en rule, bool*pokparse,
+                           Rps_Value (Rps_TokenSource::*rawparser)(Rps_CallFrame*,bool*));
+  Rps_Value raw_parse_expression(Rps_CallFrame*callframe, bool*pokparse);
+  Rps_Value raw_parse_disjunction(Rps_CallFrame*callframe, bool*pokparse);
+  Rps_Value raw_parse_conjunction(Rps_CallFrame*callframe, bool*pokparse);
+  Rps_Value raw_parse_comparison(Rps_CallFrame*callframe, bool*pokparse);
+  Rps_Value raw_parse_comparand(Rps_CallFrame*callframe, bool*pokparse);
+  Rps_Value raw_parse_sum(Rps_CallFrame*callframe, bool*pokparse);
+  Rps_Value raw_parse_product(Rps_CallFrame*callframe, bool*pokparse);
+  Rps_Value raw_parse_factor(Rps_CallFrame*callframe, bool*pokparse);
+  Rps_Value raw_parse_term(Rps_CallFrame*callframe, bool*pokparse);
+  Rps_Value raw_parse_primary(Rps_CallFrame*callframe, bool*pokparse);
   Rps_TokenSource(std::string name);
   void set_name(std::string name)
   {
@@ -2896,13 +3085,52 @@ protected:
   };
   void advance_cursor_bytes(unsigned nb)
   {
+    toksrc_parse_memo.clear();
     toksrc_col += nb;
     if (toksrc_col > (int) toksrc_linebuf.size())
       toksrc_col = toksrc_linebuf.size();
   };
   Rps_Value get_delimiter(Rps_CallFrame*callframe);
+  /// byte length of the longest known delimiter starting at curp, or
+  /// 0; its value is put in *pdelimv when given
+  int delimiter_length_at(const char*curp, Rps_Value*pdelimv=nullptr) const;
 public:
   static constexpr unsigned max_gc_depth = 128;
+  /// the kind of lexical token, as recognized from its first bytes by
+  /// the table-driven automaton of lexer_rps.cc
+  enum lexkind_en : uint8_t
+  {
+    LexKind_None=0,             // end of line
+    LexKind_Number,
+    LexKind_Infinity,
+    LexKind_Namoid,
+    LexKind_ShortString,
+    LexKind_RawString,          // may span several lines
+    LexKind_CodeChunk,          // may span several lines
+    LexKind_Delimiter,
+    LexKind_Bad
+  };
+  static lexkind_en lexical_kind_at(const char*curp);
+  /// a token scanned by the lexer without allocating any garbage
+  /// collected zone; it is converted to a Rps_LexTokenZone only when
+  /// the parser keeps it, and operator delimiters are skipped raw
+  struct raw_token_st
+  {
+    lexkind_en rawtok_kind;
+    int rawtok_line;
+    int rawtok_col;             // byte column
+    int rawtok_len;             // byte length, till the end of line for multi-line tokens
+    Rps_ObjectRef rawtok_delim; // the delimiter object, for delimiters
+  };
+  /// fill the raw token starting at the cursor after spaces, without
+  /// moving the cursor; false at end of line
+  bool scan_raw_token(raw_token_st&rawtok) const;
+  /// the delimiter starting the next token, or null; a token not yet
+  /// in the token deque is scanned raw, without being lexed
+  Rps_ObjectRef lookahead_delimiter(void) const;
+  /// consume the next token when it is the given delimiter, without
+  /// making a lexical token if it was not yet in the token deque
+  bool skip_delimiter(Rps_CallFrame*callframe, Rps_ObjectRef delimob);
   const char*curcptr(void) const
   {
     if (toksrc_linebuf.empty())
@@ -2934,6 +3162,15 @@ public:
   {
     return toksrc_token_deq;
   };
+  /// the token position counts the consumed tokens
+  long token_position(void) const
+  {
+    return toksrc_tokpos;
+  };
+  unsigned parse_memo_size(void) const
+  {
+    return toksrc_parse_memo.size();
+  };
   void consume_front_token(Rps_CallFrame*callframe, bool *psuccess=nullptr);
   void append_back_new_token(Rps_CallFrame*callframe, Rps_Value tokenv);
   virtual bool get_line(void) =0; // gives true when another line has been read
@@ -3038,6 +3275,10 @@ public:
   /// on lexical error, get_token returns null and does not change the position
   Rps_LexTokenValue get_token(Rps_CallFrame*callframe);
 private:
+  /// make the lexical token of a raw token scanned at the cursor
+  Rps_LexTokenValue token_of_raw(Rps_CallFrame*callframe, const raw_token_st&rawtok);
+  /// move the cursor after the given raw token, the one scanned at the cursor
+  void skip_raw_token(const raw_token_st&rawtok);
   Rps_LexTokenValue get__number__token(Rps_CallFrame*callframe, const char*curp);
   Rps_LexTokenValue get__infinity__token(Rps_CallFrame*callframe, const char*curp);
   Rps_LexTokenValue get__namoid__token(Rps_CallFrame*callframe, const char*curp);
@@ -3298,6 +3539,72 @@ typedef Rps_TwoValues rps_applyingfun_t (Rps_CallFrame*callerframe,
 #define RPS_APPLYINGFUN_PREFIX "rpsapply"
 // by convention, the extern "C" applying function inside the fictuous connective _45vHaB3kVHiDzT42h0
 // would be named rpsapply_45vHaB3kVHiDzT42h0
+
+// machine code generated at runtime (by GNU lightning or libgccjit)
+// has a plain C signature, with every value passed as a raw word (see
+// Rps_Value::unsafe_wptr) and both results stored in the results
+// array; it is called by a trampoline installed as the applying
+// function of its connective.  See gccjit_rps.cc and lightgen_rps.cc
+//
+// Since raw words in registers are invisible to the garbage
+// collector, the routine gets its own call frame whose words are the
+// slots array.  The trampoline fills the first rps_jit_arg_slots
+// slots with the closure and the four arguments; the generated code
+// stores in the other slots every value which is live across a call
+// to the runtime, and the result of every such call.
+typedef void rps_jitroutine_t(Rps_CallFrame*callframe, const void*closure,
+                              const void*arg0, const void*arg1,
+                              const void*arg2, const void*arg3,
+                              const std::vector<Rps_Value>*restargs,
+                              const void**slots,
+                              const void**results);
+constexpr unsigned rps_jit_arg_slots = 5;
+constexpr unsigned rps_jit_max_slots = 128;
+enum rps_jit_tier_en
+{
+  RPS_JIT_TIER_NONE,
+  RPS_JIT_TIER_BASELINE,    // quickly generated by GNU lightning
+  RPS_JIT_TIER_OPTIMIZED,   // slowly generated by libgccjit
+};
+/// install a routine of a given tier in a connective, unless it
+/// already has one of a higher tier; the constants are kept alive;
+/// nbslots counts all the slots, including the rps_jit_arg_slots ones
+extern "C" bool rps_install_jit_routine(Rps_ObjectZone*obconn,
+                                        rps_jitroutine_t*routine,
+                                        const std::vector<Rps_Value>& constants,
+                                        unsigned nbslots,
+                                        enum rps_jit_tier_en tier);
+extern "C" enum rps_jit_tier_en rps_jit_routine_tier(const Rps_ObjectZone*obconn);
+/// the applying function of a connective, or the native one which
+/// the trampoline of its compiled routine replaced; that is the one
+/// to dump, since compiled routines are not persistent
+extern "C" rps_applyingfun_t* rps_jit_native_applying_function(const Rps_ObjectZone*obconn);
+/// like Rps_ObjectZone::rebind_native_functions, for the native
+/// applying functions which compiled routines replaced by their
+/// trampoline; gives the number of rebound functions
+extern unsigned rps_jit_rebind_original_functions(const std::function<void*(const Rps_ObjectZone*,void*)>&rebindfun);
+/// the runtime called by generated machine code, giving the main result
+extern "C" const void* rps_jit_runtime_apply(Rps_CallFrame*callframe, const void*closure,
+    const void*arg0, const void*arg1,
+    const void*arg2, const void*arg3);
+extern "C" const void* rps_jit_runtime_send(Rps_CallFrame*callframe, const void*receiver,
+    const void*selector, const void*arg0, const void*arg1,
+    const void*arg2, const void*arg3);
+/// connectives applied that many times are queued, then compiled by
+/// GNU lightning in agenda worker threads when their class has a
+/// lightning_generate_code method; zero means never.  Set by the
+/// --jit-threshold program option, else rps_jit_default_hot_threshold
+constexpr unsigned rps_jit_default_hot_threshold = 1000;
+extern "C" unsigned rps_jit_hot_threshold;
+extern "C" void rps_lightning_queue_hot_connective(Rps_ObjectZone*obconn);
+/// compile the queued hot connectives; called by agenda worker
+/// threads at tasklet boundaries
+extern "C" void rps_lightning_compile_hot_connectives(Rps_CallFrame*callerframe);
+/// drive a connective past the threshold, compile and apply it; for
+/// the !test_hot_connective REPL command
+extern "C" void rps_lightning_test_hot_connective(Rps_CallFrame*callerframe);
+extern "C" void rps_lightning_gc_mark_hot_queue(Rps_GarbageCollector&gc);
+
 class Rps_Payload;
 class Rps_ObjectZone : public Rps_ZoneValue
 {
@@ -3323,11 +3630,12 @@ private:
   std::atomic<Rps_ObjectZone*> ob_class;
   std::atomic<Rps_ObjectZone*> ob_space;
   std::atomic<double> ob_mtime;
-  std::map<Rps_ObjectRef, Rps_Value> ob_attrs;
-  std::vector<Rps_Value> ob_comps;
+  rps_counted_objvalmap_t ob_attrs;
+  rps_counted_valvect_t ob_comps;
   std::atomic<Rps_Payload*> ob_payload;
   std::atomic<rps_magicgetterfun_t*> ob_magicgetterfun;
   std::atomic<rps_applyingfun_t*> ob_applyingfun;
+  mutable std::atomic<uint32_t> ob_applycount;
   /// constructors
   Rps_ObjectZone(Rps_Id oid, registermode_en regmod);
   Rps_ObjectZone(void);
@@ -3478,10 +3786,28 @@ public:
   Rps_Value instance_from_components(Rps_CallFrame*stkf, Rps_ObjectRef obinstclass) const;
   // get atomic fields
   inline double get_mtime(void) const;
-  inline rps_applyingfun_t*get_applyingfun(const Rps_ClosureValue&) const
+  /// the applying function for a closure, counting the applications
+  /// to queue hot connectives for compilation
+  inline rps_applyingfun_t*get_applyingfun(Rps_CallFrame*, const Rps_ClosureValue&) const
   {
+    count_application();
     return ob_applyingfun.load();
   };
+  /// once past the threshold, only a relaxed load is done, so hot
+  /// connectives applied by many threads share their cache line
+  inline void count_application(void) const
+  {
+    unsigned threshold = rps_jit_hot_threshold;
+    if (RPS_UNLIKELY(threshold > 0)
+        && ob_applycount.load(std::memory_order_relaxed) < threshold
+        && ob_applycount.fetch_add(1, std::memory_order_relaxed)+1 == threshold)
+      rps_lightning_queue_hot_connective(const_cast<Rps_ObjectZone*>(this));
+  };
+  /// the applications counted so far, at most rps_jit_hot_threshold
+  unsigned application_count(void) const
+  {
+    return ob_applycount.load(std::memory_order_relaxed);
+  };
   inline rps_applyingfun_t* get_applying_ptrfun() const
   {
     return ob_applyingfun.load();
@@ -3616,6 +3942,10 @@ public:
   // call a given C++ closure on every possible object ref, till that
   // closure returns true. Return the number of matches, or else 0
   static int autocomplete_oid(const char*prefix, const std::function<bool(const Rps_ObjectZone*)>&stopfun);
+  // call rebindfun on the applying function and magic getter of
+  // every object having one, and atomically replace them by its
+  // result. Return the number of replaced functions.
+  static unsigned rebind_native_functions(const std::function<void*(const Rps_ObjectZone*,void*)>&rebindfun);
 };                              // end class Rps_ObjectZone
 
 //////////////////////////////////////////////////////////// object payloads
@@ -3993,13 +4323,16 @@ class Rps_TreeZone : public Rps_LazyHashedZoneValue
   mutable std::atomic<bool> _treetransient;
   mutable std::atomic<bool> _treemetatransient;
   mutable std::atomic<int32_t> _treemetarank;
+  // for instances, the number of leading attribute/value pairs laid
+  // out by the class shape; zero otherwise
+  unsigned _treenbattrs;
   mutable std::atomic<Rps_ObjectZone*> _treemetaob;
   Rps_ObjectRef _treeconnob;
   Rps_Value _treesons[RPS_FLEXIBLE_DIM+1];
   Rps_TreeZone(unsigned len, Rps_ObjectRef obr=nullptr)
     : Rps_LazyHashedZoneValue(treety), _treelen(len),
       _treetransient(false), _treemetatransient(false),
-      _treemetarank(0), _treemetaob(nullptr),
+      _treemetarank(0), _treenbattrs(0), _treemetaob(nullptr),
       _treeconnob(obr)
   {
     memset ((void*)_treesons, 0, sizeof(Rps_Value)*len);
@@ -4224,9 +4557,84 @@ public:
 };    // end Rps_ClosureValue
 
 
+/// per-thread pool of rest argument vectors, one per nesting depth of
+/// bound applications, in values_rps.cc
+extern thread_local std::deque<std::vector<Rps_Value>> rps_bound_restargs_pool;
+extern thread_local unsigned rps_bound_restargs_depth;
+
+/// A closure bound for repeated application with Arity arguments, in
+/// tight loops.  Its applying function is resolved once, so each
+/// application only counts itself for the JIT and checks that the
+/// connective still has it (it changes when a plugin is reloaded or
+/// a routine is JIT-compiled).
+/// Applications with more than four arguments reuse a per-thread
+/// pool of rest argument vectors instead of allocating one.  The
+/// closure should also be kept in the caller's frame, for the
+/// garbage collector.
+template <unsigned Arity> class Rps_BoundClosure
+{
+  Rps_ClosureValue bc_clos;
+  Rps_ObjectZone* bc_connob;
+  rps_applyingfun_t* bc_appfun;
+  unsigned bc_nbrebind;
+  inline rps_applyingfun_t* validated_applying_function(Rps_CallFrame*callerframe);
+public:
+  static constexpr unsigned arity = Arity;
+  Rps_BoundClosure() : bc_clos(), bc_connob(nullptr), bc_appfun(nullptr), bc_nbrebind(0) {};
+  inline Rps_BoundClosure(Rps_CallFrame*callerframe, const Rps_ClosureValue clos);
+  bool is_bound(void) const
+  {
+    return bc_appfun != nullptr;
+  };
+  const Rps_ClosureValue& closure(void) const
+  {
+    return bc_clos;
+  };
+  /// how many times the applying function changed since binding
+  unsigned nb_rebindings(void) const
+  {
+    return bc_nbrebind;
+  };
+  template <typename... Args>
+  inline Rps_TwoValues apply(Rps_CallFrame*callerframe, const Args&... args);
+};    // end Rps_BoundClosure
+
+
 
 //////////////////////////////////////////////// instances
 
+/// The shape of instances of a given class is computed once from its
+/// attribute set: each attribute gets a fixed slot, and the son
+/// 2*slot of an instance is that attribute, the son 2*slot+1 its
+/// value.  Shapes are immutable and never freed, since call sites
+/// may keep slots computed from them.
+class Rps_InstanceShape
+{
+  const unsigned ishape_serial;
+  const unsigned ishape_nbattrs;
+  std::unordered_map<const Rps_ObjectZone*,unsigned> ishape_slots;
+  static std::atomic<unsigned> ishape_counter;
+  Rps_InstanceShape(const Rps_SetOb*attrset);
+public:
+  static const Rps_InstanceShape* make(const Rps_SetOb*attrset);
+  unsigned serial(void) const
+  {
+    return ishape_serial;
+  };
+  unsigned nb_attributes(void) const
+  {
+    return ishape_nbattrs;
+  };
+  /// the slot of an attribute, or -1 if it is not in the shape
+  int slot(const Rps_ObjectZone*obattr) const
+  {
+    auto it = ishape_slots.find(obattr);
+    if (it == ishape_slots.end())
+      return -1;
+    return (int)it->second;
+  };
+};    // end Rps_InstanceShape
+
 unsigned constexpr rps_instance_k1 = 8161;
 unsigned constexpr rps_instance_k2 = 9151;
 unsigned constexpr rps_instance_k3 = 10151;
@@ -4263,6 +4671,28 @@ public:
   virtual Rps_ObjectRef compute_class(Rps_CallFrame*stkf) const;
   /// get the set of attributes in a class
   static const Rps_SetOb* class_attrset(Rps_ObjectRef obclass);
+  /// get the shape of instances of a class, without locking it
+  static const Rps_InstanceShape* class_shape(Rps_ObjectRef obclass);
+  /// the number of leading attribute/value pairs
+  unsigned nb_attribute_slots(void) const
+  {
+    return _treenbattrs;
+  };
+  /// the value of the attribute in a given slot, or null if the
+  /// instance has not that attribute there; this is how every
+  /// attribute read is validated, so a wrong slot is harmless
+  Rps_Value attribute_at_slot(unsigned slot, const Rps_ObjectRef obattr) const
+  {
+    if (slot >= _treenbattrs || !obattr)
+      return nullptr;
+    const Rps_Value*sons = raw_const_data_sons();
+    if (sons[2*slot].to_object() != obattr.optr())
+      return nullptr;
+    return sons[2*slot+1];
+  };
+  /// get an attribute thru the class shape; if given, *pslot is the
+  /// slot found, or -1
+  Rps_Value get_attr(const Rps_ObjectRef obattr, int*pslot=nullptr) const;
   /// make a instance with given class and components and no attributes
   static Rps_InstanceZone* load_from_json(Rps_Loader*ld, const Json::Value& jv);
   /// later fill such an empty instance
@@ -4286,6 +4716,35 @@ public:
 };    // end class Rps_InstanceZone
 
 
+/// A per call site cache of the slot of some attribute in instances,
+/// typically a static local in the routine reading it.  The slot is
+/// computed at first access from the class shape, and later reads
+/// just check it.  Rps_Value::get_attr without a site shares a few
+/// of them, chosen by the attribute hash.
+class Rps_InstanceAttrSite
+{
+  std::atomic<int> ias_slot;
+public:
+  Rps_InstanceAttrSite() : ias_slot(-1) {};
+  Rps_Value get(const Rps_InstanceZone*inst, const Rps_ObjectRef obattr)
+  {
+    if (!inst || !obattr)
+      return nullptr;
+    int slot = ias_slot.load(std::memory_order_relaxed);
+    if (RPS_LIKELY(slot >= 0))
+      {
+        Rps_Value val = inst->attribute_at_slot((unsigned)slot, obattr);
+        if (RPS_LIKELY(!val.is_empty()))
+          return val;
+      };
+    Rps_Value val = inst->get_attr(obattr, &slot);
+    if (slot >= 0 && !val.is_empty())
+      ias_slot.store(slot, std::memory_order_relaxed);
+    return val;
+  };
+};    // end Rps_InstanceAttrSite
+
+
 class Rps_InstanceValue : public Rps_Value
 {
 public:
@@ -4349,6 +4808,8 @@ public:
 class Rps_ProtoCallFrame;
 typedef Rps_ProtoCallFrame Rps_CallFrame;
 typedef void Rps_CallFrameOutputSig_t(std::ostream&/*out*/, const Rps_ProtoCallFrame*/*frame*/,unsigned/*depth*/,unsigned /*maxdepth*/);
+/// an additional garbage collection marker of a frame, given its data
+typedef void Rps_CallFrameMarkerSig_t(Rps_GarbageCollector*/*gc*/, const void*/*data*/);
 ////////////////////////////////////////////////////////////////
 //// the common superclass of our call frames
 class Rps_ProtoCallFrame : public Rps_TypedZone /// actually Rps_CallFrame
@@ -4363,11 +4824,17 @@ protected:
   Rps_ClosureValue cfram_clos; // the invoking closure, if any
   intptr_t* cfram_xtradata;
   std::atomic<Rps_CallFrameOutputSig_t*> cfram_outputter;
-  std::function<void(Rps_GarbageCollector*)> cfram_marker;
+  /// a plain function pointer and its data, so frames are cheap to
+  /// create and destroy
+  Rps_CallFrameMarkerSig_t* cfram_markfun;
+  const void* cfram_markdata;
+  /// the precise marker of the fields at cfram_xtradata, if known
+  Rps_CallFrameMarkerSig_t* cfram_fieldsmarker;
 public:
   static constexpr unsigned _cfram_max_size_ = 1024;
   static std::atomic<int> _cfram_output_depth_;
-  Rps_ProtoCallFrame(unsigned size, void*xdata, Rps_ObjectRef obdescr=nullptr, Rps_CallFrame*prev=nullptr)
+  Rps_ProtoCallFrame(unsigned size, void*xdata, Rps_ObjectRef obdescr=nullptr, Rps_CallFrame*prev=nullptr,
+                     Rps_CallFrameMarkerSig_t*fieldsmarker=nullptr)
     : Rps_TypedZone(Rps_Type::CallFrame),
       cfram_size(size),
       cfram_descr(obdescr),
@@ -4377,7 +4844,9 @@ public:
       cfram_clos(nullptr),
       cfram_xtradata((intptr_t*) xdata),
       cfram_outputter(nullptr),
-      cfram_marker()
+      cfram_markfun(nullptr),
+      cfram_markdata(nullptr),
+      cfram_fieldsmarker(fieldsmarker)
   {
     // ensure that if some size is given, the xdata is a suitably
     // aligned pointer...
@@ -4389,18 +4858,22 @@ public:
   }; // end Rps_ProtoCallFrame constructor
   ~Rps_ProtoCallFrame()
   {
+    rps_curthread_callframe = cfram_prev;
+#ifndef NDEBUG
+    /// clearing a dying frame only helps debugging, since the garbage
+    /// collector never sees it
     if (cfram_size > 0)
       {
         assert (cfram_xtradata != nullptr);
         memset ((void*)cfram_xtradata, 0, cfram_size*sizeof(intptr_t));
       }
-    rps_curthread_callframe = cfram_prev;
     cfram_xtradata = nullptr;
     cfram_descr = nullptr;
     cfram_prev = nullptr;
     cfram_state = nullptr;
     cfram_rankstate = 0;
     cfram_clos = nullptr;
+#endif /*NDEBUG*/
   }; // end Rps_ProtoCallFrame destructor
   void set_outputter(std::nullptr_t)
   {
@@ -4444,13 +4917,15 @@ public:
   {
     return cfram_prev;
   };
-  void set_additional_gc_marker(const std::function<void(Rps_GarbageCollector*)>& gcmarkfun)
+  void set_gc_marker(Rps_CallFrameMarkerSig_t*markfun, const void*markdata=nullptr)
   {
-    cfram_marker = gcmarkfun;
+    cfram_markfun = markfun;
+    cfram_markdata = markdata;
   };
-  void clear_additional_gc_marker(void)
+  void clear_gc_marker(void)
   {
-    cfram_marker = nullptr;
+    cfram_markfun = nullptr;
+    cfram_markdata = nullptr;
   };
   bool is_good_call_frame() const
   {
@@ -4496,6 +4971,10 @@ public:
 
 extern "C" Rps_TwoValues rps_full_evaluate_repl_expr(Rps_CallFrame*callframe,Rps_Value expr,Rps_ObjectRef envob);
 extern "C" Rps_Value rps_simple_evaluate_repl_expr(Rps_CallFrame*callframe,Rps_Value expr,Rps_ObjectRef envob);
+/// REPL expression objects are compiled into evaluator nodes, cached
+/// until the expression object is mutated; the cache is weak, and the
+/// garbage collector makes it forget the dead expression objects
+extern "C" void rps_repl_compiled_forget_dead(Rps_GarbageCollector&gc);
 extern "C" void rps_interpret_repl_statement(Rps_CallFrame*callframe, Rps_ObjectRef stmtob,Rps_ObjectRef envob);
 
 
@@ -4538,8 +5017,260 @@ operator << (std::ostream&out, Rps_ShowCallFrame scf)
   return out;
 };                              // end  operator << (std::ostream&, Rps_ShowCallFrame)
 
+/// Precise marking of the fields of RPS_LOCALFRAME and
+/// RPS_LEANLOCALFRAME frames.  Their struct of fields is an aggregate,
+/// so its fields are counted at compile time (by aggregate
+/// initialization from rps_frame_anyfield_st), then decomposed by a
+/// structured binding.  Only values, object references and pointers
+/// to zones are marked, objects without any virtual call; other
+/// fields (numbers, strings, C++ pointers...) are skipped, so should
+/// be marked by an additional marker if needed.  Fields should not be
+/// C arrays.  Frames with more than rps_frame_max_precise_fields
+/// fields are still scanned conservatively, word by word.
+struct rps_frame_anyfield_st
+{
+  template <typename T> operator T() const; // only in unevaluated contexts
+};
+constexpr unsigned rps_frame_max_precise_fields = 32;
+
+template <typename Fields, typename IxSeq, typename = void>
+struct rps_frame_initializable : std::false_type {};
+template <typename Fields, std::size_t... Ix>
+struct rps_frame_initializable<Fields, std::index_sequence<Ix...>,
+         std::void_t<decltype(Fields{(void(Ix), rps_frame_anyfield_st{})...})>>
+           : std::true_type {};
+
+/// the number of fields, or 0 when we cannot mark them precisely
+template <typename Fields, unsigned N=0>
+constexpr unsigned rps_frame_nb_fields(void)
+{
+  if constexpr (!std::is_aggregate<Fields>::value || N > rps_frame_max_precise_fields)
+    return 0;
+  else if constexpr (rps_frame_initializable<Fields, std::make_index_sequence<N+1>>::value)
+    return rps_frame_nb_fields<Fields,N+1>();
+  else
+    return N;
+} // end rps_frame_nb_fields
+
+template <typename T>
+inline void
+rps_frame_mark_field(Rps_GarbageCollector*gc, const T&fld)
+{
+  if constexpr (std::is_same<T,Rps_ObjectRef>::value)
+    {
+      if (!fld.is_empty())
+        gc->mark_obj(fld);
+    }
+  else if constexpr (std::is_base_of<Rps_Value,T>::value)
+    {
+      if (fld.is_empty() || !fld.is_ptr())
+        return;
+      if (fld.is_object())
+        gc->mark_obj(fld.as_object());
+      else
+        fld.gc_mark(*gc, 0);
+    }
+  else if constexpr (std::is_pointer<T>::value
+                     && std::is_base_of<Rps_ZoneValue,
+                     std::remove_cv_t<std::remove_pointer_t<T>>>::value)
+    {
+      if (fld)
+        gc->mark_value(Rps_Value(static_cast<const Rps_ZoneValue*>(fld)));
+    }
+} // end rps_frame_mark_field
+
+template <typename... Ts>
+inline void
+rps_frame_mark_fields(Rps_GarbageCollector*gc, const Ts&... flds)
+{
+  (rps_frame_mark_field(gc, flds), ...);
+} // end rps_frame_mark_fields
+
+/// the precise marker of a frame whose fields are at data, used by
+/// Rps_ProtoCallFrame::gc_mark_frame
+template <typename Fields>
+void
+rps_frame_fields_marker(Rps_GarbageCollector*gc, const void*data)
+{
+  constexpr unsigned nbfields = rps_frame_nb_fields<Fields>();
+  static_assert(nbfields > 0);
+  const Fields* flds = static_cast<const Fields*>(data);
+  if constexpr (nbfields == 1)
+    {
+      auto& [f0] = *flds;
+      rps_frame_mark_fields(gc, f0);
+    }
+  else if constexpr (nbfields == 2)
+    {
+      auto& [f0,f1] = *flds;
+      rps_frame_mark_fields(gc, f0,f1);
+    }
+  else if constexpr (nbfields == 3)
+    {
+      auto& [f0,f1,f2] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2);
+    }
+  else if constexpr (nbfields == 4)
+    {
+      auto& [f0,f1,f2,f3] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3);
+    }
+  else if constexpr (nbfields == 5)
+    {
+      auto& [f0,f1,f2,f3,f4] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3,f4);
+    }
+  else if constexpr (nbfields == 6)
+    {
+      auto& [f0,f1,f2,f3,f4,f5] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3,f4,f5);
+    }
+  else if constexpr (nbfields == 7)
+    {
+      auto& [f0,f1,f2,f3,f4,f5,f6] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3,f4,f5,f6);
+    }
+  else if constexpr (nbfields == 8)
+    {
+      auto& [f0,f1,f2,f3,f4,f5,f6,f7] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3,f4,f5,f6,f7);
+    }
+  else if constexpr (nbfields == 9)
+    {
+      auto& [f0,f1,f2,f3,f4,f5,f6,f7,f8] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3,f4,f5,f6,f7,f8);
+    }
+  else if constexpr (nbfields == 10)
+    {
+      auto& [f0,f1,f2,f3,f4,f5,f6,f7,f8,f9] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3,f4,f5,f6,f7,f8,f9);
+    }
+  else if constexpr (nbfields == 11)
+    {
+      auto& [f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10);
+    }
+  else if constexpr (nbfields == 12)
+    {
+      auto& [f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11);
+    }
+  else if constexpr (nbfields == 13)
+    {
+      auto& [f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12);
+    }
+  else if constexpr (nbfields == 14)
+    {
+      auto& [f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13);
+    }
+  else if constexpr (nbfields == 15)
+    {
+      auto& [f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14);
+    }
+  else if constexpr (nbfields == 16)
+    {
+      auto& [f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15);
+    }
+  else if constexpr (nbfields == 17)
+    {
+      auto& [f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16);
+    }
+  else if constexpr (nbfields == 18)
+    {
+      auto& [f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17);
+    }
+  else if constexpr (nbfields == 19)
+    {
+      auto& [f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17,f18] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17,f18);
+    }
+  else if constexpr (nbfields == 20)
+    {
+      auto& [f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17,f18,f19] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17,f18,f19);
+    }
+  else if constexpr (nbfields == 21)
+    {
+      auto& [f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17,f18,f19,f20] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17,f18,f19,f20);
+    }
+  else if constexpr (nbfields == 22)
+    {
+      auto& [f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17,f18,f19,f20,f21] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17,f18,f19,f20,f21);
+    }
+  else if constexpr (nbfields == 23)
+    {
+      auto& [f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17,f18,f19,f20,f21,f22] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17,f18,f19,f20,f21,f22);
+    }
+  else if constexpr (nbfields == 24)
+    {
+      auto& [f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17,f18,f19,f20,f21,f22,f23] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17,f18,f19,f20,f21,f22,f23);
+    }
+  else if constexpr (nbfields == 25)
+    {
+      auto& [f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17,f18,f19,f20,f21,f22,f23,f24] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17,f18,f19,f20,f21,f22,f23,f24);
+    }
+  else if constexpr (nbfields == 26)
+    {
+      auto& [f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17,f18,f19,f20,f21,f22,f23,f24,f25] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17,f18,f19,f20,f21,f22,f23,f24,f25);
+    }
+  else if constexpr (nbfields == 27)
+    {
+      auto& [f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17,f18,f19,f20,f21,f22,f23,f24,f25,f26] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17,f18,f19,f20,f21,f22,f23,f24,f25,f26);
+    }
+  else if constexpr (nbfields == 28)
+    {
+      auto& [f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17,f18,f19,f20,f21,f22,f23,f24,f25,f26,f27] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17,f18,f19,f20,f21,f22,f23,f24,f25,f26,f27);
+    }
+  else if constexpr (nbfields == 29)
+    {
+      auto& [f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17,f18,f19,f20,f21,f22,f23,f24,f25,f26,f27,f28] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17,f18,f19,f20,f21,f22,f23,f24,f25,f26,f27,f28);
+    }
+  else if constexpr (nbfields == 30)
+    {
+      auto& [f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17,f18,f19,f20,f21,f22,f23,f24,f25,f26,f27,f28,f29] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17,f18,f19,f20,f21,f22,f23,f24,f25,f26,f27,f28,f29);
+    }
+  else if constexpr (nbfields == 31)
+    {
+      auto& [f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17,f18,f19,f20,f21,f22,f23,f24,f25,f26,f27,f28,f29,f30] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17,f18,f19,f20,f21,f22,f23,f24,f25,f26,f27,f28,f29,f30);
+    }
+  else if constexpr (nbfields == 32)
+    {
+      auto& [f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17,f18,f19,f20,f21,f22,f23,f24,f25,f26,f27,f28,f29,f30,f31] = *flds;
+      rps_frame_mark_fields(gc, f0,f1,f2,f3,f4,f5,f6,f7,f8,f9,f10,f11,f12,f13,f14,f15,f16,f17,f18,f19,f20,f21,f22,f23,f24,f25,f26,f27,f28,f29,f30,f31);
+    }
+} // end rps_frame_fields_marker
+
+/// the precise marker for Fields, or else nullptr to scan conservatively
+template <typename Fields>
+constexpr Rps_CallFrameMarkerSig_t*
+rps_frame_precise_marker(void)
+{
+  if constexpr (rps_frame_nb_fields<Fields>() > 0)
+    return &rps_frame_fields_marker<Fields>;
+  else
+    return nullptr;
+} // end rps_frame_precise_marker
+
 template <unsigned WordSize> class Rps_SizedCallFrame;
 template <typename FrameFields> class Rps_FieldedCallFrame;
+template <typename FrameFields> class Rps_LeanFieldedCallFrame;
 
 template <unsigned WordSize> class Rps_SizedCallFrame
   : public Rps_ProtoCallFrame
@@ -4561,6 +5292,11 @@ template <typename FrameFields> class  Rps_FieldedCallFrame :
   public Rps_ProtoCallFrame
 {
   FrameFields cfram_fields;
+  std::function<void(Rps_GarbageCollector*)> cfram_marker;
+  static void call_marker(Rps_GarbageCollector*gc, const void*data)
+  {
+    (*static_cast<const std::function<void(Rps_GarbageCollector*)>*>(data))(gc);
+  };
 public:
   typedef  Rps_FieldedCallFrame<FrameFields> This_frame;
   FrameFields& fields()
@@ -4576,15 +5312,47 @@ public:
     return cfram_fields;
   };
   Rps_FieldedCallFrame (Rps_ObjectRef obdescr=nullptr, Rps_CallFrame*prev=nullptr)
-    :  Rps_ProtoCallFrame(sizeof(FrameFields)/sizeof(void*), &cfram_fields, obdescr, prev)
+    :  Rps_ProtoCallFrame(sizeof(FrameFields)/sizeof(void*), &cfram_fields, obdescr, prev,
+                          rps_frame_precise_marker<FrameFields>()),
+       cfram_marker()
   {
   };
   ~Rps_FieldedCallFrame ()
   {
   };
+  void set_additional_gc_marker(const std::function<void(Rps_GarbageCollector*)>& gcmarkfun)
+  {
+    cfram_marker = gcmarkfun;
+    set_gc_marker(call_marker, &cfram_marker);
+  };
+  void clear_additional_gc_marker(void)
+  {
+    clear_gc_marker();
+    cfram_marker = nullptr;
+  };
 };                              // end of Rps_FieldedCallFrame template
 
 
+/// a lean frame for hot routines, without any std::function; an
+/// additional marker is set with set_gc_marker
+template <typename FrameFields> class  Rps_LeanFieldedCallFrame :
+  public Rps_ProtoCallFrame
+{
+  FrameFields cfram_fields;
+public:
+  typedef  Rps_LeanFieldedCallFrame<FrameFields> This_frame;
+  FrameFields* fieldsptr()
+  {
+    return &cfram_fields;
+  };
+  Rps_LeanFieldedCallFrame (Rps_ObjectRef obdescr=nullptr, Rps_CallFrame*prev=nullptr)
+    :  Rps_ProtoCallFrame(sizeof(FrameFields)/sizeof(void*), &cfram_fields, obdescr, prev,
+                          rps_frame_precise_marker<FrameFields>())
+  {
+  };
+};                              // end of Rps_LeanFieldedCallFrame template
+
+
 
 #define RPS_LOCALFRAME_ATBIS(Lin,Descr,Prev,...)        \
   struct RpsFrameData##Lin {__VA_ARGS__; };             \
@@ -4613,6 +5381,23 @@ public:                                                 \
 #define RPS_LOCALFRAME(Descr,Prev,...)              \
   RPS_LOCALFRAME_AT(__LINE__,Descr,Prev,__VA_ARGS__)
 
+/// same as RPS_LOCALFRAME, but with a lean frame, whose additional
+/// marker (if any) is a plain function given to _.set_gc_marker
+#define RPS_LEANLOCALFRAME_ATBIS(Lin,Descr,Prev,...)    \
+  struct RpsLeanFrameData##Lin {__VA_ARGS__; };         \
+  Rps_LeanFieldedCallFrame<RpsLeanFrameData##Lin>       \
+    _((Descr),(Prev));                                  \
+  auto& _f = *_.fieldsptr();                            \
+  /*end RPS_LEANLOCALFRAME_ATBIS*/
+#define RPS_LEANLOCALFRAME_AT(Lin,Descr,Prev,...)       \
+  RPS_LEANLOCALFRAME_ATBIS(Lin,Descr,Prev,__VA_ARGS__)
+#define RPS_LEANLOCALFRAME(Descr,Prev,...)              \
+  RPS_LEANLOCALFRAME_AT(__LINE__,Descr,Prev,__VA_ARGS__)
+
+/// measure the cost of pushing and popping regular and lean frames,
+/// shown in the LOWREP debug log
+extern "C" void rps_callframe_benchmark(Rps_CallFrame*callerframe, unsigned nbloops);
+
 #define RPS_LOCALRETURN(Val) do {                   \
   RPS_ASSERT(_.previous_call_frame() != nullptr);   \
   _.previous_call_frame()->clear_closure();         \
@@ -4649,12 +5434,16 @@ class Rps_PayloadClassInfo : public Rps_Payload
   // nil for them.  See
   // https://gitlab.com/bstarynk/refpersys/-/wikis/Immutable-instances-in-RefPerSys
   mutable std::atomic<const Rps_SetOb*> pclass_attrset;
+  // the shape of immutable instances, lazily computed from
+  // pclass_attrset and never freed
+  mutable std::atomic<const Rps_InstanceShape*> pclass_shape;
   virtual ~Rps_PayloadClassInfo()
   {
     pclass_super = nullptr;
     pclass_methdict.clear();
     pclass_symbname = nullptr;
     pclass_attrset.store(nullptr);
+    pclass_shape.store(nullptr);
   };
 protected:
   virtual void gc_mark(Rps_GarbageCollector&gc) const;
@@ -4703,6 +5492,9 @@ public:
   {
     return  pclass_attrset.load();
   };
+  const Rps_InstanceShape*instance_shape(void) const;
+  /// for a new class, before making any of its instances
+  void put_attributes_set(const Rps_SetOb*setob);
   void loader_put_symbname(Rps_ObjectRef obr, Rps_Loader*ld);
   void loader_put_attrset(const Rps_SetOb*setob, Rps_Loader*ld);
   ///
@@ -4731,6 +5523,367 @@ public:
 
 
 
+////////////////////////////////////////////////////////////////
+/// An open addressing hash table keyed by objects, using their
+/// obhash() with linear probing in a power of two array of keys. The
+/// values (if any, since Rps_NoValueTag is empty, for sets) are in a
+/// parallel array. Its iteration order is arbitrary.
+struct Rps_NoValueTag {};
+template <typename Val_t> class Rps_ObjHashTable
+{
+  static constexpr bool oht_hasvals = !std::is_empty<Val_t>::value;
+  static constexpr unsigned oht_mincapacity = 16;
+  std::vector<Rps_ObjectZone*, Rps_CountingAllocator<Rps_ObjectZone*>> oht_keys;
+  std::vector<Val_t, Rps_CountingAllocator<Val_t>> oht_vals;
+  unsigned oht_count;           // number of live keys
+  unsigned oht_used;            // live keys and tombstones
+  static Rps_ObjectZone* tombstone(void)
+  {
+    return reinterpret_cast<Rps_ObjectZone*>(uintptr_t(1));
+  };
+  static unsigned hash_index(const Rps_ObjectZone*obz, unsigned mask)
+  {
+    /// obhash is well spread, but mix it for small masks
+    return (unsigned)(((uint64_t)obz->obhash() * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+  };
+  /// the index of the key, or -1
+  int index_of(const Rps_ObjectZone*obz) const
+  {
+    unsigned cap = oht_keys.size();
+    if (!obz || cap == 0)
+      return -1;
+    unsigned mask = cap-1;
+    for (unsigned ix = hash_index(obz, mask), n=0; n<cap; ix = (ix+1) & mask, n++)
+      {
+        const Rps_ObjectZone*curk = oht_keys[ix];
+        if (curk == obz)
+          return (int)ix;
+        if (!curk)
+          return -1;
+      };
+    return -1;
+  };
+  void rehash(unsigned newcap)
+  {
+    RPS_ASSERT(newcap >= oht_mincapacity && (newcap & (newcap-1)) == 0);
+    decltype(oht_keys) oldkeys(newcap, nullptr);
+    decltype(oht_vals) oldvals;
+    if (oht_hasvals)
+      oldvals.resize(newcap);
+    oldkeys.swap(oht_keys);
+    oldvals.swap(oht_vals);
+    unsigned mask = newcap-1;
+    for (unsigned oldix=0; oldix<oldkeys.size(); oldix++)
+      {
+        Rps_ObjectZone*curk = oldkeys[oldix];
+        if (!curk || curk == tombstone())
+          continue;
+        unsigned ix = hash_index(curk, mask);
+        while (oht_keys[ix])
+          ix = (ix+1) & mask;
+        oht_keys[ix] = curk;
+        if (oht_hasvals)
+          oht_vals[ix] = std::move(oldvals[oldix]);
+      };
+    oht_used = oht_count;
+  };
+public:
+  Rps_ObjHashTable() : oht_keys(), oht_vals(), oht_count(0), oht_used(0) {};
+  unsigned size(void) const
+  {
+    return oht_count;
+  };
+  bool empty(void) const
+  {
+    return oht_count == 0;
+  };
+  void clear(void)
+  {
+    oht_keys.clear();
+    oht_vals.clear();
+    oht_count = oht_used = 0;
+  };
+  bool contains(const Rps_ObjectZone*obz) const
+  {
+    return index_of(obz) >= 0;
+  };
+  const Val_t* find(const Rps_ObjectZone*obz) const
+  {
+    static_assert(oht_hasvals, "Rps_ObjHashTable::find without values");
+    int ix = index_of(obz);
+    return (ix >= 0)?&oht_vals[ix]:nullptr;
+  };
+  /// add or replace, return true if the key was added
+  bool put(Rps_ObjectZone*obz, const Val_t& val = Val_t{})
+  {
+    RPS_ASSERT(obz != nullptr && obz != tombstone());
+    int oldix = index_of(obz);
+    if (oldix >= 0)
+      {
+        if (oht_hasvals)
+          oht_vals[oldix] = val;
+        return false;
+      };
+    if (10*(oht_used+1) > 7*oht_keys.size())
+      {
+        unsigned newcap = oht_mincapacity;
+        while (10*(oht_count+1) > 4*newcap)
+          newcap *= 2;
+        rehash(newcap);
+      };
+    unsigned mask = oht_keys.size()-1;
+    unsigned ix = hash_index(obz, mask);
+    while (oht_keys[ix] && oht_keys[ix] != tombstone())
+      ix = (ix+1) & mask;
+    if (!oht_keys[ix])
+      oht_used++;
+    oht_keys[ix] = obz;
+    if (oht_hasvals)
+      oht_vals[ix] = val;
+    oht_count++;
+    return true;
+  };
+  /// return true if the key was removed
+  bool remove(const Rps_ObjectZone*obz)
+  {
+    int ix = index_of(obz);
+    if (ix < 0)
+      return false;
+    oht_keys[ix] = tombstone();
+    if (oht_hasvals)
+      oht_vals[ix] = Val_t{};
+    oht_count--;
+    return true;
+  };
+  /// apply fun to every key and value, in arbitrary order
+  template <typename Fun_t> void each(Fun_t fun) const
+  {
+    static const Val_t noval{};
+    for (unsigned ix=0; ix<oht_keys.size(); ix++)
+      {
+        Rps_ObjectZone*curk = oht_keys[ix];
+        if (curk && curk != tombstone())
+          fun(curk, oht_hasvals?oht_vals[ix]:noval);
+      }
+  };
+  /// apply fun to every key and value, in arbitrary order, till it
+  /// returns true; then return true
+  template <typename Fun_t> bool each_until(Fun_t fun) const
+  {
+    static const Val_t noval{};
+    for (unsigned ix=0; ix<oht_keys.size(); ix++)
+      {
+        Rps_ObjectZone*curk = oht_keys[ix];
+        if (curk && curk != tombstone()
+            && fun(curk, oht_hasvals?oht_vals[ix]:noval))
+          return true;
+      }
+    return false;
+  };
+};        // end template Rps_ObjHashTable
+
+
+/// A container of objects, mapped to values or not, backed by an
+/// ordered tree when small and by an Rps_ObjHashTable when big. The
+/// backend can be forced per container. Ordered iteration is
+/// available on demand, e.g. for dumping. Iteration is in place, so
+/// the iterated function may replace values but should not add or
+/// remove keys, which could rehash or rebalance the container; this
+/// is asserted.
+template <typename Val_t> class Rps_ObjHybridMap
+{
+public:
+  typedef std::map<Rps_ObjectRef, Val_t, std::less<Rps_ObjectRef>,
+          Rps_CountingAllocator<std::pair<const Rps_ObjectRef, Val_t>>> tree_t;
+  enum backend_en
+  {
+    Backend_Auto,
+    Backend_Tree,
+    Backend_Hash
+  };
+  /// in Backend_Auto mode, switch to hashing above that size
+  static constexpr unsigned auto_hash_threshold = 24;
+private:
+  tree_t ohm_tree;
+  Rps_ObjHashTable<Val_t> ohm_hash;
+  backend_en ohm_mode;
+  bool ohm_hashed;
+  mutable unsigned ohm_iterating; // depth of the running iterations
+  struct iteration_guard
+  {
+    const Rps_ObjHybridMap* ig_map;
+    iteration_guard(const Rps_ObjHybridMap*m) : ig_map(m)
+    {
+      ig_map->ohm_iterating++;
+    };
+    ~iteration_guard()
+    {
+      ig_map->ohm_iterating--;
+    };
+  };
+  void switch_to_hash(void)
+  {
+    for (auto& it: ohm_tree)
+      ohm_hash.put(it.first.optr(), it.second);
+    ohm_tree.clear();
+    ohm_hashed = true;
+  };
+  void switch_to_tree(void)
+  {
+    ohm_hash.each([&](Rps_ObjectZone*obz, const Val_t&val)
+    {
+      ohm_tree.insert({Rps_ObjectRef(obz), val});
+    });
+    ohm_hash.clear();
+    ohm_hashed = false;
+  };
+public:
+  Rps_ObjHybridMap() : ohm_tree(), ohm_hash(), ohm_mode(Backend_Auto), ohm_hashed(false),
+    ohm_iterating(0) {};
+  backend_en backend_mode(void) const
+  {
+    return ohm_mode;
+  };
+  bool is_hashed(void) const
+  {
+    return ohm_hashed;
+  };
+  void set_backend_mode(backend_en mode)
+  {
+    RPS_ASSERT(ohm_iterating == 0);
+    ohm_mode = mode;
+    if (mode == Backend_Hash && !ohm_hashed)
+      switch_to_hash();
+    else if (mode == Backend_Tree && ohm_hashed)
+      switch_to_tree();
+  };
+  unsigned size(void) const
+  {
+    return ohm_hashed?ohm_hash.size():(unsigned)ohm_tree.size();
+  };
+  bool empty(void) const
+  {
+    return size() == 0;
+  };
+  void clear(void)
+  {
+    RPS_ASSERT(ohm_iterating == 0);
+    ohm_tree.clear();
+    ohm_hash.clear();
+    ohm_hashed = (ohm_mode == Backend_Hash);
+  };
+  bool contains(const Rps_ObjectRef obr) const
+  {
+    if (!obr)
+      return false;
+    if (ohm_hashed)
+      return ohm_hash.contains(obr.optr());
+    return ohm_tree.find(obr) != ohm_tree.end();
+  };
+  const Val_t* find(const Rps_ObjectRef obr) const
+  {
+    if (!obr)
+      return nullptr;
+    if (ohm_hashed)
+      return ohm_hash.find(obr.optr());
+    auto it = ohm_tree.find(obr);
+    return (it != ohm_tree.end())?&it->second:nullptr;
+  };
+  /// add or replace, return true if the key was added
+  bool put(const Rps_ObjectRef obr, const Val_t& val = Val_t{})
+  {
+    RPS_ASSERT(obr);
+    if (ohm_hashed)
+      {
+        RPS_ASSERT(ohm_iterating == 0 || ohm_hash.contains(obr.optr()));
+        return ohm_hash.put(obr.optr(), val);
+      };
+    auto it = ohm_tree.find(obr);
+    if (it != ohm_tree.end())
+      {
+        it->second = val;
+        return false;
+      };
+    RPS_ASSERT(ohm_iterating == 0);
+    ohm_tree.insert({obr, val});
+    if (ohm_mode == Backend_Auto && ohm_tree.size() > auto_hash_threshold)
+      switch_to_hash();
+    return true;
+  };
+  /// return true if the key was removed
+  bool remove(const Rps_ObjectRef obr)
+  {
+    if (!obr)
+      return false;
+    RPS_ASSERT(ohm_iterating == 0);
+    if (ohm_hashed)
+      return ohm_hash.remove(obr.optr());
+    return ohm_tree.erase(obr) > 0;
+  };
+  /// apply fun to every object and value, in arbitrary order
+  template <typename Fun_t> void each(Fun_t fun) const
+  {
+    iteration_guard guard(this);
+    if (ohm_hashed)
+      ohm_hash.each([&](Rps_ObjectZone*obz, const Val_t&val)
+    {
+      fun(Rps_ObjectRef(obz), val);
+    });
+    else
+      for (auto& it: ohm_tree)
+        fun(it.first, it.second);
+  };
+  /// apply fun to every object and value, in arbitrary order, till it
+  /// returns true; then return true
+  template <typename Fun_t> bool each_until(Fun_t fun) const
+  {
+    iteration_guard guard(this);
+    if (ohm_hashed)
+      return ohm_hash.each_until([&](Rps_ObjectZone*obz, const Val_t&val)
+    {
+      return fun(Rps_ObjectRef(obz), val);
+    });
+    for (auto& it: ohm_tree)
+      if (fun(it.first, it.second))
+        return true;
+    return false;
+  };
+  /// apply fun to every object and value, in the Rps_ObjectRef order
+  template <typename Fun_t> void each_ordered(Fun_t fun) const
+  {
+    if (!ohm_hashed)
+      {
+        each(fun);
+        return;
+      };
+    iteration_guard guard(this);
+    std::vector<std::pair<Rps_ObjectRef,const Val_t*>> vec;
+    vec.reserve(ohm_hash.size());
+    ohm_hash.each([&](Rps_ObjectZone*obz, const Val_t&val)
+    {
+      vec.push_back({Rps_ObjectRef(obz), &val});
+    });
+    std::sort(vec.begin(), vec.end(),
+              [](const std::pair<Rps_ObjectRef,const Val_t*>&l,
+                 const std::pair<Rps_ObjectRef,const Val_t*>&r)
+    {
+      return l.first < r.first;
+    });
+    for (auto& p: vec)
+      fun(p.first, *p.second);
+  };
+  std::vector<Rps_ObjectRef> sorted_keys(void) const
+  {
+    std::vector<Rps_ObjectRef> vec;
+    vec.reserve(size());
+    each_ordered([&](Rps_ObjectRef obr, const Val_t&)
+    {
+      vec.push_back(obr);
+    });
+    return vec;
+  };
+};        // end template Rps_ObjHybridMap
+
 ////////////////////////////////////////////////////////////////
 ////// mutable set of objects payload - for PaylSetOb, objects of
 ////// class `mutable_set` _0J1C39JoZiv03qA2HA
@@ -4741,7 +5894,7 @@ class Rps_PayloadSetOb : public Rps_Payload
   friend class Rps_ObjectZone;
   friend Rps_PayloadSetOb*
   Rps_QuasiZone::rps_allocate1<Rps_PayloadSetOb,Rps_ObjectZone*>(Rps_ObjectZone*);
-  std::set<Rps_ObjectRef> psetob;
+  Rps_ObjHybridMap<Rps_NoValueTag> psetob;
   inline Rps_PayloadSetOb(Rps_ObjectZone*owner);
   Rps_PayloadSetOb(Rps_ObjectRef obr) :
     Rps_PayloadSetOb(obr?obr.optr():nullptr) {};
@@ -4770,48 +5923,46 @@ public:
   inline Rps_PayloadSetOb(Rps_ObjectZone*obz, Rps_Loader*ld);
   bool contains(const Rps_ObjectZone* obelem) const
   {
-    return obelem && psetob.find(Rps_ObjectRef(obelem)) != psetob.end();
+    return obelem && psetob.contains(Rps_ObjectRef(obelem));
   };
   bool contains(const Rps_ObjectRef obr) const
   {
-    return obr && psetob.find(obr) != psetob.end();
+    return obr && psetob.contains(obr);
   };
   unsigned cardinal(void) const
   {
     return (unsigned) psetob.size();
   };
+  /// force or not the hash table backend
+  void set_backend_mode(Rps_ObjHybridMap<Rps_NoValueTag>::backend_en mode)
+  {
+    psetob.set_backend_mode(mode);
+  };
   void add(const Rps_ObjectZone* obelem)
   {
     if (obelem)
-      psetob.insert(Rps_ObjectRef(obelem));
+      psetob.put(Rps_ObjectRef(obelem));
   };
   void add (const Rps_ObjectRef obrelem)
   {
     if (!obrelem.is_empty())
-      psetob.insert(obrelem);
+      psetob.put(obrelem);
   };
   void remove(const Rps_ObjectZone* obelem)
   {
-    if (obelem) psetob.erase(Rps_ObjectRef(obelem));
+    if (obelem) psetob.remove(Rps_ObjectRef(obelem));
   };
   void remove (const Rps_ObjectRef obrelem)
   {
-    if (obrelem) psetob.erase(obrelem);
+    if (obrelem) psetob.remove(obrelem);
   };
   Rps_SetValue to_set() const
   {
-    return Rps_SetValue(psetob);
+    return Rps_SetValue(psetob.sorted_keys());
   };
   Rps_TupleValue to_tuple() const
   {
-    std::vector<Rps_ObjectRef> vecob;
-    vecob.reserve(cardinal());
-    for (auto obrelem: psetob)
-      {
-        RPS_ASSERT(obrelem);
-        vecob.push_back(obrelem);
-      };
-    return Rps_TupleValue(vecob);
+    return Rps_TupleValue(psetob.sorted_keys());
   };
   virtual void output_payload(std::ostream&out, unsigned depth, unsigned maxdepth) const;
 };                              // end Rps_PayloadSetOb
@@ -4900,7 +6051,7 @@ class Rps_PayloadVectVal : public Rps_Payload
   friend  rpsldpysig_t rpsldpy_vectval;
   friend Rps_PayloadVectVal*
   Rps_QuasiZone::rps_allocate1<Rps_PayloadVectVal,Rps_ObjectZone*>(Rps_ObjectZone*);
-  std::vector<Rps_Value> pvectval;
+  rps_counted_valvect_t pvectval;
   inline Rps_PayloadVectVal(Rps_ObjectZone*owner);
   Rps_PayloadVectVal(Rps_ObjectRef obr) :
     Rps_PayloadVectVal(obr?obr.optr():nullptr) {};
@@ -4977,9 +6128,20 @@ class Rps_PayloadStrBuf : public Rps_Payload
   Rps_PayloadStrBuf(Rps_ObjectRef obr) :
     Rps_PayloadStrBuf(obr?obr.optr():nullptr) {};
   virtual ~Rps_PayloadStrBuf();
-  mutable std::stringbuf strbuf_buffer;
+  /// the content is a rope of chunks, so appending and prepending
+  /// don't move the previous content
+  std::deque<std::string> strbuf_chunks;
+  size_t strbuf_size;
+  /// the last exported string, valid till the content changes
+  mutable const Rps_String* strbuf_cachedstr;
   int strbuf_indent;
   bool strbuf_transient;
+  static constexpr size_t strbuf_chunk_size = 4096;
+  void coalesce_chunks(void) const;
+  void changed_content(void)
+  {
+    strbuf_cachedstr = nullptr;
+  };
 protected:
   virtual void gc_mark(Rps_GarbageCollector&gc) const;
   virtual void dump_scan(Rps_Dumper*du) const;
@@ -4992,17 +6154,6 @@ public:
   {
     return "string_buffer";
   };
-  std::stringbuf& string_buffer(void)
-  {
-    return strbuf_buffer;
-  };
-  const std::stringbuf& const_string_buffer(void) const
-  {
-    return strbuf_buffer;
-  };
-  //std::ostringstream* output_string_stream_ptr(void) { return &strbuf_stream; };
-  //const std::ostream& output_stream(void) const { return strbuf_out; };
-  //std::ostringstream& output_string_stream(void) { return strbuf_out; };
   int indentation(void) const
   {
     return strbuf_indent;
@@ -5033,18 +6184,25 @@ public:
   };
   inline Rps_PayloadStrBuf(Rps_ObjectZone*obz, Rps_Loader*ld);
   static inline Rps_ObjectRef the_string_buffer_class(void);
-  //- unsigned buffer_length(void) const
-  //- {
-  //-  return strbuf_buffer.size();
-  //- };
-  std::string buffer_cppstring(void) const
+  size_t buffer_length(void) const
   {
-    return strbuf_buffer.str();
+    return strbuf_size;
   };
+  std::string buffer_cppstring(void) const;
+  /// the returned string is shared till the buffer changes
   Rps_StringValue buffer_stringval(void);
   void clear_buffer(void);
   void append_string(const std::string&str);
   void prepend_string(const std::string&str);
+  /// append the indentation, the line and a newline
+  void append_indented_line(const std::string&line);
+  /// append a newline then the indentation
+  void append_newline_indented(void);
+  /// write the whole content with writev(2), return false on failure
+  /// with errno set
+  bool write_to_fd(int fd) const;
+  bool write_to_file(const std::string&path) const;
+  void output_to(std::ostream&out) const;
   //  virtual void output_payload(std::ostream&out, unsigned depth, unsigned maxdepth) const;
 };                              // end of class Rps_PayloadStrBuf
 
@@ -5091,7 +6249,7 @@ public:
   void iterate_apply(Rps_CallFrame*callframe, Rps_Value closv);
   virtual void output_payload(std::ostream&out, unsigned depth, unsigned maxdepth) const;
 private:
-  std::map<std::string, Rps_Value> dict_map;
+  rps_counted_strvalmap_t dict_map;
   bool dict_is_transient;
 }; // end class Rps_PayloadStringDict
 
@@ -5252,7 +6410,7 @@ extern "C" rpsldpysig_t rpsldpy_objmap;
 // descriptive value and is subclassed by Rps_PayloadEnvironment
 class Rps_PayloadObjMap : public Rps_Payload
 {
-  std::map<Rps_ObjectRef,Rps_Value> obm_map;
+  Rps_ObjHybridMap<Rps_Value> obm_map;
   Rps_Value obm_descr;
   friend class Rps_ObjectRef;
   friend class Rps_ObjectZone;
@@ -5282,11 +6440,19 @@ protected:
   {
     return false;
   };
+  /// called by put_obmap when a key is added and by remove_obmap
+  /// when a key is removed, but not when a value is just replaced
+  virtual void obmap_keys_changed(void) {};
 public:
   size_t get_obmap_size() const
   {
     return obm_map.size();
   };
+  /// force or not the hash table backend
+  void set_backend_mode(Rps_ObjHybridMap<Rps_Value>::backend_en mode)
+  {
+    obm_map.set_backend_mode(mode);
+  };
   virtual const std::string payload_type_name(void) const
   {
     return "objmap";
@@ -5310,23 +6476,25 @@ public:
   {
     obm_descr = d;
   };
+  /// iterate in place and in arbitrary order, till the function
+  /// returns true; it may replace values but should not add or remove
+  /// keys of this object map, which is asserted
   template <typename Data_t>
   void do_each_obmap_entry(Data_t tpd, std::function<bool(Data_t, Rps_ObjectRef,Rps_Value,void*)>fun, void*clientdata=nullptr) const
   {
-    for (auto it: obm_map)
-      {
-        if (fun(tpd, it.first, it.second, clientdata))
-          break;
-      }
+    obm_map.each_until([&](Rps_ObjectRef obr, const Rps_Value&val)
+    {
+      return fun(tpd, obr, val, clientdata);
+    });
   }; ///-end templated do_each_obmap_entry
+  /// like do_each_obmap_entry, with the same restriction
   void do_each_entry(Rps_CallFrame*cf, std::function<bool(Rps_CallFrame*,Rps_ObjectRef,Rps_Value,void*)> f,
                      void* clientdata=nullptr) const
   {
-    for (auto it: obm_map)
-      {
-        if (f(cf, it.first, it.second, clientdata))
-          break;
-      }
+    obm_map.each_until([&](Rps_ObjectRef obr, const Rps_Value&val)
+    {
+      return f(cf, obr, val, clientdata);
+    });
   };
   virtual void output_payload(std::ostream&out, unsigned depth, unsigned maxdepth) const;
 };                              // end Rps_PayloadObjMap
@@ -5372,9 +6540,59 @@ extern "C" int rps_environment_remove_deep_binding(Rps_CallFrame*callframe,
 
 
 
+/// The layout of flat environments: their variables, each at a slot
+/// index.  A layout is immutable once made.  Environments made by
+/// Rps_PayloadEnvironment::make share the layout of their scope (their
+/// class), which is replaced by an extended layout when one of them
+/// binds a new variable; slots of earlier variables keep their index.
+/// Loaded environments have their own layout of their dumped
+/// variables.
+class Rps_EnvironmentLayout
+{
+  std::vector<Rps_ObjectRef> envl_vars;
+  std::unordered_map<const Rps_ObjectZone*,unsigned> envl_index;
+public:
+  Rps_EnvironmentLayout(const std::vector<Rps_ObjectRef>&vars);
+  /// the variables of oldlayout at the same slots, then varob
+  Rps_EnvironmentLayout(const Rps_EnvironmentLayout&oldlayout, Rps_ObjectRef varob);
+  unsigned nb_slots(void) const
+  {
+    return envl_vars.size();
+  };
+  Rps_ObjectRef slot_variable(unsigned ix) const
+  {
+    RPS_ASSERT(ix < envl_vars.size());
+    return envl_vars[ix];
+  };
+  /// the slot of a variable, or -1 if it is not in the layout
+  int slot_index(Rps_ObjectRef varob) const
+  {
+    if (!varob)
+      return -1;
+    auto it = envl_index.find(varob.optr());
+    return (it != envl_index.end())?(int)it->second:-1;
+  };
+  void gc_mark(Rps_GarbageCollector&gc) const;
+};                              // end Rps_EnvironmentLayout
+
 class Rps_PayloadEnvironment : public Rps_PayloadObjMap
 {
   Rps_ObjectRef env_parent;
+  /// flat environments bind the variables of their layout in slots,
+  /// other bindings go to the inherited object map
+  std::shared_ptr<const Rps_EnvironmentLayout> env_layout;
+  std::vector<Rps_Value> env_slots;
+  /// the scope whose layout this environment follows, or null
+  Rps_ObjectRef env_scope;
+  /// the current layout of every scope, only ever extended
+  static std::mutex env_scope_mtx;
+  static std::map<Rps_ObjectZone*,std::shared_ptr<const Rps_EnvironmentLayout>> env_scope_layouts;
+  static std::shared_ptr<const Rps_EnvironmentLayout> scope_layout(Rps_ObjectRef scopeob, Rps_ObjectRef varob=nullptr);
+  void adopt_scope_layout(Rps_ObjectRef scopeob, Rps_ObjectRef varob=nullptr);
+  /// bumped when any environment gains or loses a binding, or changes
+  /// its parent; compiled REPL expressions in cmdrepl_rps.cc validate
+  /// their resolved variables against it
+  static std::atomic<uint64_t> env_generation;
   friend class Rps_ObjectRef;
   friend class Rps_ObjectZone;
   friend rpsldpysig_t rpsldpy_environment;
@@ -5388,6 +6606,7 @@ protected:
     Rps_PayloadObjMap(obr?obr.optr():nullptr) {};
   virtual ~Rps_PayloadEnvironment()
   {
+    env_generation.fetch_add(1);
   };
   virtual uint32_t wordsize(void) const
   {
@@ -5400,11 +6619,21 @@ protected:
   {
     return false;
   };
+  virtual void obmap_keys_changed(void)
+  {
+    env_generation.fetch_add(1);
+  };
 public:
   virtual const std::string payload_type_name(void) const
   {
     return "environment";
   };
+  static uint64_t generation(void)
+  {
+    return env_generation.load();
+  };
+  /// called by the garbage collector to keep the scope layouts
+  static void gc_mark_scope_layouts(Rps_GarbageCollector&gc);
   virtual void output_payload(std::ostream&out, unsigned depth, unsigned maxdepth) const;
   inline Rps_PayloadEnvironment(Rps_ObjectZone*obz, Rps_Loader*ld);
   static Rps_ObjectZone* make(Rps_CallFrame*cf, Rps_ObjectRef classob=nullptr, Rps_ObjectRef spaceob=nullptr);
@@ -5418,6 +6647,37 @@ public:
     return  env_parent;
   };
   void put_parent_environment(Rps_ObjectRef envob);
+  bool is_flat(void) const
+  {
+    return env_layout != nullptr;
+  };
+  const Rps_EnvironmentLayout* layout(void) const
+  {
+    return env_layout.get();
+  };
+  int slot_index(Rps_ObjectRef varob) const
+  {
+    return env_layout?env_layout->slot_index(varob):-1;
+  };
+  Rps_Value get_slot(unsigned ix) const
+  {
+    RPS_ASSERT(ix < env_slots.size());
+    return env_slots[ix];
+  };
+  /// reassigning a bound slot does not change the environment
+  /// generation, binding or unbinding it does
+  void put_slot(unsigned ix, Rps_Value val);
+  /// bindings are looked up in the slots, then in the object map; a
+  /// null slot is unbound
+  Rps_Value get_binding(Rps_ObjectRef varob, bool*pmissing=nullptr) const;
+  bool has_binding(Rps_ObjectRef varob) const;
+  void put_binding(Rps_ObjectRef varob, Rps_Value val);
+  unsigned nb_bindings(void) const;
+  /// like Rps_PayloadObjMap::do_each_entry, but also with the bound
+  /// slots, which come first; the slots are walked by index, so
+  /// binding variables meanwhile is safe there
+  void do_each_entry(Rps_CallFrame*cf, std::function<bool(Rps_CallFrame*,Rps_ObjectRef,Rps_Value,void*)> f,
+                     void* clientdata=nullptr) const;
 #pragma message "Rps_PayloadEnvironment not fully implemented"
 };                              // end Rps_PayloadEnvironment
 
@@ -5527,6 +6787,15 @@ extern "C" bool rps_generate_cplusplus_code(Rps_CallFrame*callerframe,
     Rps_ObjectRef obmodule,
     Rps_Value genparamv=nullptr);
 
+/// in-memory code generation using libgccjit, installing the applying
+/// functions of connectives; see gccjit_rps.cc
+extern "C" bool rps_generate_gccjit_code(Rps_CallFrame*callerframe,
+    Rps_ObjectRef obmodule,
+    Rps_Value genparamv=nullptr);
+/// emit, compile and apply a routine, checking its result; for the
+/// !test_jit_routine REPL command
+extern "C" void rps_gccjit_test_routine(Rps_CallFrame*callerframe);
+
 
 ////................................................................
 //// load and dump routines.  See files load_rps.cc and dump_rps.cc
@@ -5572,6 +6841,10 @@ extern "C" void rps_repl_lexer_test(void);
 
 extern "C" void rps_do_repl_commands_vec(const std::vector<std::string>&cmdvec);
 
+/// run a REPL script file, one command per line, and report per
+/// command timing and allocations
+extern "C" void rps_do_repl_script_file(const std::string&path);
+
 
 /// this routine set some native data in loaded heap, like the size of
 /// predefined types...
@@ -5767,6 +7040,28 @@ public:
   static Rps_ObjectRef fetch_tasklet_to_run(void);
   static void run_agenda_worker(int ix);
   static void do_garbage_collect(int ix, Rps_CallFrame*callframe);
+  /// Cheap safepoint poll, done at tasklet boundaries and which could
+  /// be done inside long running tasklets. When a garbage collection
+  /// is pending, the calling agenda worker thread publishes its
+  /// current call frame and parks until the collection has ended.
+  static inline void gc_safepoint(Rps_CallFrame*callframe);
+  /// Called at allocation sites with the new cumulated word count;
+  /// requests a garbage collection once enough words have been
+  /// allocated since the previous one. It only uses atomics and
+  /// never parks.
+  static inline void note_allocation(uint64_t cumulw);
+  /// The safepoint poll of zone allocations, before the new zone
+  /// exists: an agenda worker thread parks there with its innermost
+  /// call frame, so every live value should be in some call frame.
+  static inline void allocation_safepoint(void);
+  /// true while an agenda worker thread is collecting, all the other
+  /// ones being parked
+  static inline bool collecting_garbage(void)
+  {
+    return agenda_gc_collecting_.load(std::memory_order_acquire);
+  };
+  /// output statistics about the time to reach safepoints
+  static void output_safepoint_statistics(std::ostream&out);
 protected:
   static void dump_scan_agenda(Rps_Dumper*du);
   static void dump_json_agenda(Rps_Dumper*du, Json::Value&jv);
@@ -5781,6 +7076,20 @@ private:
   static std::atomic<uint64_t> agenda_cumulw_gc_;
   // once a megaword has been allocated, we want to garbage collect, hence:
   static constexpr uint64_t agenda_gc_threshold = 1<<20;
+  /// the elapsed real time when the pending garbage collection was requested
+  static std::atomic<double> agenda_gc_request_elapsed_;
+  /// number of worker threads parked at a safepoint or idle, and the
+  /// GC epoch, incremented at the end of every agenda garbage
+  /// collection
+  static std::atomic<int> agenda_gc_parked_count_;
+  static std::atomic<uint64_t> agenda_gc_epoch_;
+  /// set by the parked worker thread running the garbage collector
+  static std::atomic<bool> agenda_gc_collecting_;
+  static int nb_running_workers(void);
+  /// time to safepoint statistics, in seconds, under agenda_mtx_
+  static double agenda_tts_cumul_;
+  static double agenda_tts_max_;
+  static long agenda_tts_count_;
   static std::atomic<std::thread*> agenda_thread_array_[RPS_NBJOBS_MAX+2];
   static std::atomic<workthread_state_en> agenda_work_thread_state_[RPS_NBJOBS_MAX+2];
   /// the call frames below makes sense only during garbage collection....
@@ -6019,6 +7328,73 @@ extern "C" void rps_postpone_quit(void);
 extern "C" void rps_postpone_exit_with_dump(void);
 extern "C" void rps_postpone_child_process(void);
 
+/// post, from any thread, a message to the event loop of the main
+/// thread, applying the closure to both arguments, or calling the
+/// function. Messages posted together are handled after a single
+/// wakeup.
+extern "C" void rps_event_loop_post_closure(Rps_ClosureValue clos,
+    Rps_Value arg0, Rps_Value arg1);
+extern "C" void rps_event_loop_post_function(const std::function<void(Rps_CallFrame*)>& fun);
+extern "C" void rps_event_loop_gc_mark_main_channel(Rps_GarbageCollector&gc);
+
+////////////////////////////////////////////////////////////////
+/// Asynchronous whole file reads and writes, see asyncio_rps.cc. They
+/// use the Linux io_uring(7) when available, and not disabled by the
+/// --no-io-uring program option; submissions are batched till some
+/// wait. Otherwise they fall back to blocking read(2) or write(2)
+/// done when waiting.
+extern "C" bool rps_without_io_uring;
+/// set by the --intern-strings program option
+extern "C" bool rps_intern_strings;
+class Rps_AsyncFileIo   /// all member functions are static...
+{
+public:
+  typedef long ticket_t;
+  static void initialize(void);
+  /// register the completion eventfd(2) in the event loop
+  static void initialize_in_event_loop(void);
+  static bool has_io_uring(void);
+  /// start reading or writing some whole file, return a positive ticket
+  static ticket_t submit_read_file(const std::string& path);
+  static ticket_t submit_write_file(const std::string& path, std::string&& content);
+  /// wait for the read to complete and give the file content, or
+  /// throw some std::runtime_error
+  static std::string wait_read(ticket_t tick);
+  /// wait for the write to complete, or throw some std::runtime_error
+  static void wait_write(ticket_t tick);
+  /// for tasklets: read some file, then apply the closure to the
+  /// string content and the errno (or 0). The closure is applied from
+  /// the event loop, or immediately (using the given caller frame)
+  /// without io_uring or without running event loop.
+  static ticket_t async_read_file_then(Rps_CallFrame*callerframe, const std::string& path, Rps_ClosureValue clos);
+  static void gc_mark(Rps_GarbageCollector&gc);
+};                              // end class Rps_AsyncFileIo
+
+////////////////////////////////////////////////////////////////
+/// Timers, in a hierarchical timer wheel (see eventloop_rps.cc) driven
+/// by the single timerfd(2) of the event loop, with a millisecond
+/// tick. Scheduling and cancelling is O(1) and can be done from any
+/// thread. A closure timer is applied from the event loop thread to
+/// its timer id; a tasklet timer adds its tasklet object to the agenda.
+class Rps_TimerWheel   /// all member functions are static...
+{
+public:
+  typedef uint64_t timer_id_t;
+  /// called from the timerfd handler of the event loop
+  static void fire_expired_timers(Rps_CallFrame*callframe);
+  /// the delay is in seconds, the deadline is some rps_monotonic_real_time
+  static timer_id_t schedule_closure_after(double delay, Rps_ClosureValue clos);
+  static timer_id_t schedule_closure_at(double deadline, Rps_ClosureValue clos);
+  static timer_id_t schedule_tasklet_after(double delay, Rps_Agenda::agenda_prio_en prio,
+      Rps_ObjectRef obtasklet);
+  static timer_id_t schedule_tasklet_at(double deadline, Rps_Agenda::agenda_prio_en prio,
+                                        Rps_ObjectRef obtasklet);
+  /// return true if the timer was pending
+  static bool cancel(timer_id_t tid);
+  static unsigned nb_pending_timers(void);
+  static void gc_mark(Rps_GarbageCollector&gc);
+};                              // end class Rps_TimerWheel
+
 ////////////////////////////////////////////////////////////////
 struct rpscarbrepl_stack;
 extern "C" const size_t rpscarbrepl_stack_size;
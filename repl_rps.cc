@@ -1047,14 +1047,19 @@ rps_repl_builtin_env_command(Rps_CallFrame*callframe, Rps_ObjectRef obenvarg, co
         _f.descrv = paylenv->get_descr();
         if (_f.descrv)
           outs << "descriptor:" << _f.descrv << std::endl;
-        std::function<bool(Rps_CallFrame*,Rps_ObjectRef,Rps_Value,void*)> outfun
-          = [&](Rps_CallFrame*cf,Rps_ObjectRef obvar,Rps_Value value,void*d)
+        /// the bindings are shown sorted by variable
+        std::vector<Rps_ObjectRef> varvect;
+        std::function<bool(Rps_CallFrame*,Rps_ObjectRef,Rps_Value,void*)> collectfun
+          = [&](Rps_CallFrame*,Rps_ObjectRef obvar,Rps_Value,void*d)
         {
-          outs << "*" << obvar << "::" << value << std::endl;
+          varvect.push_back(obvar);
           RPS_ASSERT(d == nullptr);
           return false;
         };
-        paylenv->do_each_entry(&_, outfun);
+        paylenv->do_each_entry(&_, collectfun);
+        rps_sort_object_vector_for_display(varvect);
+        for (Rps_ObjectRef obvar: varvect)
+          outs << "*" << obvar << "::" << paylenv->get_binding(obvar) << std::endl;
       }
     else
       outs << " [without environment payload]";
@@ -1422,6 +1427,257 @@ rps_repl_builtin_parse_primary_command(Rps_CallFrame*callframe, Rps_ObjectRef ob
     RPS_WARNOUT("failed parse_primary " << cp << " in " << intoksrc);
 } // end rps_repl_builtin_parse_primary_command
 
+/// the first word after a builtin command, or an empty string with
+/// a warning
+static std::string
+rps_repl_builtin_word_argument(const char*builtincmd, Rps_TokenSource& intoksrc,
+                               const char*what)
+{
+  const char*cp = intoksrc.curcptr();
+  while (cp && isspace(*cp))
+    cp++;
+  const char*endp = cp;
+  while (endp && *endp && !isspace(*endp))
+    endp++;
+  if (!cp || endp == cp)
+    {
+      RPS_WARNOUT("no " << what << " given to !" << builtincmd << " builtin");
+      return std::string();
+    };
+  return std::string(cp, endp-cp);
+} // end rps_repl_builtin_word_argument
+
+/// the object named by the first word after a builtin command, or
+/// null with a warning
+static Rps_ObjectRef
+rps_repl_builtin_object_argument(Rps_CallFrame*callframe, const char*builtincmd,
+                                 Rps_TokenSource& intoksrc)
+{
+  std::string obname = rps_repl_builtin_word_argument(builtincmd, intoksrc, "object");
+  if (obname.empty())
+    return nullptr;
+  Rps_ObjectRef ob = Rps_ObjectRef::find_object_or_null_by_string(callframe, obname);
+  if (!ob)
+    RPS_WARNOUT("unknown object " << Rps_QuotedC_String(obname)
+                << " given to !" << builtincmd << " builtin");
+  return ob;
+} // end rps_repl_builtin_object_argument
+
+
+void
+rps_repl_builtin_gccjit_command(Rps_CallFrame*callframe, Rps_ObjectRef obenvarg, const char*builtincmd,
+                                Rps_TokenSource& intoksrc,
+                                const char*title)
+{
+  RPS_LOCALFRAME(RPS_CALL_FRAME_UNDESCRIBED,
+                 /*callerframe:*/callframe,
+                 Rps_ObjectRef obenv;
+                 Rps_ObjectRef obmodule;
+                );
+  _f.obenv = obenvarg;
+  _f.obmodule = rps_repl_builtin_object_argument(&_, builtincmd, intoksrc);
+  if (!_f.obmodule)
+    return;
+  double startrealt = rps_wallclock_real_time();
+  if (rps_generate_gccjit_code(&_, _f.obmodule, nullptr))
+    RPS_INFORMOUT(std::endl << "!gccjit compiled and installed module " << _f.obmodule
+                  << " in " << (rps_wallclock_real_time() - startrealt) << " s");
+  else
+    RPS_WARNOUT("!gccjit failed for module " << _f.obmodule);
+} // end rps_repl_builtin_gccjit_command
+
+/// !unload_plugin <name> and !reload_plugin <name>, where the name is
+/// the basename of the plugin without .so
+void
+rps_repl_builtin_plugin_command(Rps_CallFrame*callframe, Rps_ObjectRef obenvarg, const char*builtincmd,
+                                Rps_TokenSource& intoksrc,
+                                const char*title)
+{
+  RPS_LOCALFRAME(RPS_CALL_FRAME_UNDESCRIBED,
+                 /*callerframe:*/callframe,
+                 Rps_ObjectRef obenv;
+                );
+  _f.obenv = obenvarg;
+  std::string plugname = rps_repl_builtin_word_argument(builtincmd, intoksrc, "plugin");
+  if (plugname.empty())
+    return;
+  bool ok = false;
+  if (!strcmp(builtincmd, "unload_plugin"))
+    ok = rps_unload_plugin(plugname.c_str());
+  else
+    ok = rps_reload_plugin(plugname.c_str(), /*runinit:*/false);
+  if (ok)
+    RPS_INFORMOUT(std::endl << "!" << builtincmd << " done for plugin " << plugname);
+  else
+    RPS_WARNOUT("!" << builtincmd << " failed for plugin " << plugname
+                << " in " << title);
+} // end rps_repl_builtin_plugin_command
+
+/// applying functions of the !test_bound_closure command; the second
+/// one replaces the first, like a reloaded plugin would
+static Rps_TwoValues
+rps_bound_closure_test_succ(Rps_CallFrame*, const Rps_Value arg0,
+                            const Rps_Value, const Rps_Value, const Rps_Value,
+                            const std::vector<Rps_Value>*)
+{
+  return Rps_TwoValues(Rps_Value::make_tagged_int(arg0.as_int()+1));
+} // end rps_bound_closure_test_succ
+
+static Rps_TwoValues
+rps_bound_closure_test_twice(Rps_CallFrame*, const Rps_Value arg0,
+                             const Rps_Value, const Rps_Value, const Rps_Value,
+                             const std::vector<Rps_Value>*restargs)
+{
+  intptr_t sum = 2*arg0.as_int();
+  if (restargs)
+    for (Rps_Value restv: *restargs)
+      sum += restv.as_int();
+  return Rps_TwoValues(Rps_Value::make_tagged_int(sum));
+} // end rps_bound_closure_test_twice
+
+/// apply bound closures in a loop, then change the applying function
+/// of their connective and check that they are rebound
+static void
+rps_repl_builtin_test_bound_closure_command(Rps_CallFrame*callframe,
+    [[maybe_unused]] Rps_ObjectRef obenvarg,
+    const char*builtincmd,
+    [[maybe_unused]] Rps_TokenSource& intoksrc,
+    const char*title)
+{
+  RPS_LOCALFRAME(RPS_CALL_FRAME_UNDESCRIBED,
+                 /*callerframe:*/callframe,
+                 Rps_ObjectRef obconn;
+                 Rps_Value closv;
+                );
+  constexpr int nbloops = 1000;
+  _f.obconn = Rps_ObjectRef::make_object(&_, Rps_ObjectRef::the_object_class());
+  _f.obconn->put_applying_function(rps_bound_closure_test_succ);
+  _f.closv = Rps_ClosureValue(_f.obconn, {});
+  Rps_BoundClosure<1> boundclos1(&_, Rps_ClosureValue(_f.closv));
+  Rps_BoundClosure<6> boundclos6(&_, Rps_ClosureValue(_f.closv));
+  if (!boundclos1.is_bound() || !boundclos6.is_bound())
+    RPS_FATALOUT("!" << builtincmd << " failed to bind " << _f.closv << " in " << title);
+  intptr_t count = 0;
+  for (int ix=0; ix<nbloops; ix++)
+    count = boundclos1.apply(&_, Rps_Value::make_tagged_int(count)).main().as_int();
+  if (count != nbloops || boundclos1.nb_rebindings() != 0)
+    RPS_FATALOUT("!" << builtincmd << " got " << count << " after " << nbloops
+                 << " bound applications, with " << boundclos1.nb_rebindings()
+                 << " rebindings");
+  unsigned nbrebound = Rps_ObjectZone::rebind_native_functions
+                       ([&](const Rps_ObjectZone*obz, void*oldfun) -> void*
+  {
+    if (obz == _f.obconn.optr())
+      return reinterpret_cast<void*>(rps_bound_closure_test_twice);
+    return oldfun;
+  });
+  intptr_t twice = boundclos1.apply(&_, Rps_Value::make_tagged_int(count)).main().as_int();
+  intptr_t sum6 = boundclos6.apply(&_, Rps_Value::make_tagged_int(1),
+                                   Rps_Value::make_tagged_int(2), Rps_Value::make_tagged_int(3),
+                                   Rps_Value::make_tagged_int(4), Rps_Value::make_tagged_int(5),
+                                   Rps_Value::make_tagged_int(6)).main().as_int();
+  if (nbrebound != 1 || twice != 2*count || sum6 != 13
+      || boundclos1.nb_rebindings() != 1 || boundclos6.nb_rebindings() != 1)
+    RPS_FATALOUT("!" << builtincmd << " wrong rebinding: nbrebound=" << nbrebound
+                 << " twice=" << twice << " sum6=" << sum6
+                 << " rebindings=" << boundclos1.nb_rebindings()
+                 << "," << boundclos6.nb_rebindings());
+  RPS_INFORMOUT(std::endl << "!" << builtincmd << " done, " << nbloops
+                << " bound applications of " << _f.closv
+                << ", then rebound after changing the applying function of " << _f.obconn);
+} // end rps_repl_builtin_test_bound_closure_command
+
+/// make instances of a new class, then read their attributes thru a
+/// call site cache and thru the shared ones of Rps_Value::get_attr
+static void
+rps_repl_builtin_test_instance_attr_command(Rps_CallFrame*callframe,
+    [[maybe_unused]] Rps_ObjectRef obenvarg,
+    const char*builtincmd,
+    [[maybe_unused]] Rps_TokenSource& intoksrc,
+    const char*title)
+{
+  RPS_LOCALFRAME(RPS_CALL_FRAME_UNDESCRIBED,
+                 /*callerframe:*/callframe,
+                 Rps_ObjectRef obclass;
+                 Rps_ObjectRef obattra;
+                 Rps_ObjectRef obattrb;
+                 Rps_SetValue attrset;
+                 Rps_Value instv;
+                );
+  constexpr int nbinst = 100;
+  static Rps_InstanceAttrSite sitea;
+  static Rps_InstanceAttrSite siteb;
+  _f.obattra = Rps_ObjectRef::make_object(&_, Rps_ObjectRef::the_object_class());
+  _f.obattrb = Rps_ObjectRef::make_object(&_, Rps_ObjectRef::the_object_class());
+  _f.attrset = Rps_SetValue({_f.obattra, _f.obattrb});
+  _f.obclass = Rps_ObjectRef::make_object(&_, Rps_ObjectRef::the_class_class());
+  {
+    std::lock_guard<std::recursive_mutex> gucla(*(_f.obclass->objmtxptr()));
+    auto paylcl = _f.obclass->put_new_plain_payload<Rps_PayloadClassInfo>();
+    paylcl->put_superclass(RPS_ROOT_OB(_6ulDdOP2ZNr001cqVZ)); //immutable_instance∈class
+    paylcl->put_attributes_set(_f.attrset.as_set());
+  }
+  for (int ix=0; ix<nbinst; ix++)
+    {
+      _f.instv = Rps_Value(Rps_InstanceZone::make_from_attributes
+                           (_f.obclass,
+      {
+        {_f.obattra, Rps_Value::make_tagged_int(ix)},
+        {_f.obattrb, Rps_Value::make_tagged_int(-ix)}
+      }), Rps_Value::Rps_ValPtrTag{});
+      intptr_t va = _f.instv.get_attr(&_, _f.obattra, sitea).as_int();
+      intptr_t vb = _f.instv.get_attr(&_, _f.obattrb, siteb).as_int();
+      intptr_t va2 = _f.instv.get_attr(&_, _f.obattra).as_int();
+      if (va != ix || vb != -ix || va2 != ix)
+        RPS_FATALOUT("!" << builtincmd << " in " << title << " wrong attributes of " << _f.instv
+                     << " #" << ix << ": a=" << va << " b=" << vb << " shared a=" << va2);
+    };
+  if (_f.instv.get_attr(&_, _f.obclass, sitea))
+    RPS_FATALOUT("!" << builtincmd << " in " << title << " found non-attribute " << _f.obclass
+                 << " in " << _f.instv);
+  RPS_INFORMOUT(std::endl << "!" << builtincmd << " done, read attributes of "
+                << nbinst << " instances of " << _f.obclass);
+} // end rps_repl_builtin_test_instance_attr_command
+
+/// compile with libgccjit a routine for a connective, then apply it
+static void
+rps_repl_builtin_test_jit_routine_command(Rps_CallFrame*callframe,
+    Rps_ObjectRef obenvarg,
+    const char*builtincmd,
+    [[maybe_unused]] Rps_TokenSource& intoksrc,
+    [[maybe_unused]] const char*title)
+{
+  RPS_LOCALFRAME(RPS_CALL_FRAME_UNDESCRIBED,
+                 /*callerframe:*/callframe,
+                 Rps_ObjectRef obenv;
+                );
+  _f.obenv = obenvarg;
+  double startrealt = rps_wallclock_real_time();
+  rps_gccjit_test_routine(&_);
+  RPS_INFORMOUT(std::endl << "!" << builtincmd << " done, routine compiled and applied in "
+                << (rps_wallclock_real_time() - startrealt) << " s");
+} // end rps_repl_builtin_test_jit_routine_command
+
+/// apply a connective till the baseline JIT compiles it
+static void
+rps_repl_builtin_test_hot_connective_command(Rps_CallFrame*callframe,
+    Rps_ObjectRef obenvarg,
+    const char*builtincmd,
+    [[maybe_unused]] Rps_TokenSource& intoksrc,
+    [[maybe_unused]] const char*title)
+{
+  RPS_LOCALFRAME(RPS_CALL_FRAME_UNDESCRIBED,
+                 /*callerframe:*/callframe,
+                 Rps_ObjectRef obenv;
+                );
+  _f.obenv = obenvarg;
+  double startrealt = rps_wallclock_real_time();
+  rps_lightning_test_hot_connective(&_);
+  RPS_INFORMOUT(std::endl << "!" << builtincmd << " done, connective compiled after "
+                << rps_jit_hot_threshold << " applications in "
+                << (rps_wallclock_real_time() - startrealt) << " s");
+} // end rps_repl_builtin_test_hot_connective_command
+
 ////////////////////////////////////////////////////////////////
 
 void
@@ -1549,6 +1805,30 @@ rps_do_builtin_repl_command(Rps_CallFrame*callframe, Rps_ObjectRef obenvarg, con
     {
       rps_repl_builtin_pfd_command(&_, _f.obenv, builtincmd, intoksrc, title);
     }
+  else if (!strcmp(builtincmd, "gccjit"))
+    {
+      rps_repl_builtin_gccjit_command(&_, _f.obenv, builtincmd, intoksrc, title);
+    }
+  else if (!strcmp(builtincmd, "unload_plugin") || !strcmp(builtincmd, "reload_plugin"))
+    {
+      rps_repl_builtin_plugin_command(&_, _f.obenv, builtincmd, intoksrc, title);
+    }
+  else if (!strcmp(builtincmd, "test_bound_closure"))
+    {
+      rps_repl_builtin_test_bound_closure_command(&_, _f.obenv, builtincmd, intoksrc, title);
+    }
+  else if (!strcmp(builtincmd, "test_instance_attr"))
+    {
+      rps_repl_builtin_test_instance_attr_command(&_, _f.obenv, builtincmd, intoksrc, title);
+    }
+  else if (!strcmp(builtincmd, "test_jit_routine"))
+    {
+      rps_repl_builtin_test_jit_routine_command(&_, _f.obenv, builtincmd, intoksrc, title);
+    }
+  else if (!strcmp(builtincmd, "test_hot_connective"))
+    {
+      rps_repl_builtin_test_hot_connective_command(&_, _f.obenv, builtincmd, intoksrc, title);
+    }
   else
     RPS_WARNOUT("invalid builtin " << builtincmd << " in "
                 << intoksrc << " / " << title)    ;
@@ -1813,11 +2093,9 @@ rps_do_repl_commands_vec(const std::vector<std::string>&cmdvec)
                 );
   RPS_ASSERT(rps_is_main_thread());
   int nbcmd = (int) (cmdvec.size());
-  _f.envob = Rps_ObjectRef::make_object(&_,
-                                        RPS_ROOT_OB(_5LMLyzRp6kq04AMM8a) //environment∈class
-                                       );
-  auto paylenv = _f.envob->put_new_plain_payload<Rps_PayloadEnvironment>();
-  RPS_ASSERT(paylenv);
+  _f.envob = Rps_PayloadEnvironment::make(&_,
+             RPS_ROOT_OB(_5LMLyzRp6kq04AMM8a) //environment∈class
+                                          );
   RPS_DEBUG_LOG(REPL, "rps_do_repl_commands_vec start nbcmd:" << nbcmd
                 << RPS_OBJECT_DISPLAY(_f.envob));
   for (int cix=0; cix<nbcmd; cix++)
@@ -1873,5 +2151,145 @@ rps_do_repl_commands_vec(const std::vector<std::string>&cmdvec)
 
 
 
+//////////////////////////////////////////////////////////////// REPL scripts
+
+/// A REPL script file has one command per line.  A line ending with
+/// a backslash continues on the next one; empty lines and lines
+/// starting with # are skipped.  The script is read inline by the
+/// main thread, one command at a time, since lexing, parsing and
+/// evaluation want the main thread and reading a line is cheap.
+struct rps_repl_script_cmd_st
+{
+  std::string scmd_text;
+  int scmd_line;                // first line of the command
+  bool scmd_badutf8;
+};
+
+class Rps_ReplScriptReader
+{
+  const std::string rsr_path;
+  std::ifstream rsr_ins;
+  int rsr_lineno;
+public:
+  Rps_ReplScriptReader(const std::string&path);
+  ~Rps_ReplScriptReader();
+  /// read the next command, return false at end of script
+  bool next_command(rps_repl_script_cmd_st&cmd);
+};                              // end Rps_ReplScriptReader
+
+Rps_ReplScriptReader::Rps_ReplScriptReader(const std::string&path)
+  : rsr_path(path), rsr_ins(path), rsr_lineno(0)
+{
+  if (!rsr_ins)
+    RPS_WARNOUT("cannot read REPL script " << rsr_path
+                << ":" << strerror(errno));
+} // end Rps_ReplScriptReader::Rps_ReplScriptReader
+
+Rps_ReplScriptReader::~Rps_ReplScriptReader()
+{
+  rsr_ins.close();
+} // end Rps_ReplScriptReader::~Rps_ReplScriptReader
+
+bool
+Rps_ReplScriptReader::next_command(rps_repl_script_cmd_st&cmd)
+{
+  std::string linbuf;
+  cmd = rps_repl_script_cmd_st {"", 0, false};
+  while (rsr_ins && std::getline(rsr_ins, linbuf))
+    {
+      rsr_lineno++;
+      if (cmd.scmd_text.empty())
+        {
+          size_t ix = linbuf.find_first_not_of(" \t");
+          if (ix == std::string::npos || linbuf[ix] == '#')
+            continue;
+          cmd.scmd_line = rsr_lineno;
+        }
+      bool continued = !linbuf.empty() && linbuf.back() == '\\';
+      if (continued)
+        linbuf.pop_back();
+      cmd.scmd_text += linbuf;
+      if (!continued)
+        break;
+      cmd.scmd_text += ' ';
+    };
+  if (cmd.scmd_text.empty())
+    return false;
+  cmd.scmd_badutf8 =
+    rps_utf8_check(cmd.scmd_text.c_str(), cmd.scmd_text.size()) != nullptr;
+  return true;
+} // end Rps_ReplScriptReader::next_command
+
+/// run every command of the REPL script file at path, in a fresh
+/// environment, reporting the time and allocation of each
+void
+rps_do_repl_script_file(const std::string&path)
+{
+  RPS_LOCALFRAME(RPS_CALL_FRAME_UNDESCRIBED,
+                 /*callerframe:*/RPS_NULL_CALL_FRAME,
+                 Rps_ObjectRef envob;
+                );
+  RPS_ASSERT(rps_is_main_thread());
+  _f.envob = Rps_PayloadEnvironment::make(&_,
+             RPS_ROOT_OB(_5LMLyzRp6kq04AMM8a) //environment∈class
+                                          );
+  std::string basepath = path;
+  if (auto slashpos = basepath.rfind('/'); slashpos != std::string::npos)
+    basepath.erase(0, slashpos+1);
+  int nbcmd = 0;
+  int nbfail = 0;
+  double sumelapsed = 0.0, sumcpu = 0.0;
+  uint64_t sumwords = 0;
+  Rps_ReplScriptReader reader(path);
+  rps_repl_script_cmd_st cmd;
+  while (reader.next_command(cmd))
+    {
+      char title[80];
+      memset (title, 0, sizeof(title));
+      snprintf(title, sizeof(title), "ReplScript:%s:%d",
+               basepath.c_str(), cmd.scmd_line);
+      nbcmd++;
+      if (cmd.scmd_badutf8)
+        {
+          RPS_WARNOUT("REPL script " << path << " line " << cmd.scmd_line
+                      << " is not valid UTF-8, skipped");
+          nbfail++;
+          continue;
+        };
+      struct rps_timer cmdtim;
+      rps_timer_start(&cmdtim);
+      uint64_t startwords = Rps_QuasiZone::cumulative_allocated_wordcount();
+      bool failed = false;
+      try
+        {
+          rps_do_one_repl_command(&_, _f.envob, cmd.scmd_text, title);
+        }
+      catch (std::exception&ex)
+        {
+          failed = true;
+          RPS_WARNOUT("REPL script " << path << " line " << cmd.scmd_line
+                      << " command " << Rps_Cjson_String(cmd.scmd_text)
+                      << " failed with exception: " << ex.what());
+        }
+      rps_timer_stop(&cmdtim);
+      uint64_t nbwords = Rps_QuasiZone::cumulative_allocated_wordcount() - startwords;
+      double elapsed = cmdtim.monotonic_stop - cmdtim.monotonic_start;
+      double cpu = cmdtim.cpu_stop - cmdtim.cpu_start;
+      if (failed)
+        nbfail++;
+      sumelapsed += elapsed;
+      sumcpu += cpu;
+      sumwords += nbwords;
+      RPS_INFORMOUT("REPL script " << title << (failed?" FAILED":"")
+                    << " in " << elapsed << " elapsed, " << cpu << " cpu seconds,"
+                    << " allocated " << nbwords << " words");
+    };
+  RPS_INFORMOUT("REPL script " << path << " ran " << nbcmd << " commands ("
+                << nbfail << " failed) in " << sumelapsed << " elapsed, "
+                << sumcpu << " cpu seconds, allocated " << sumwords << " words");
+} // end rps_do_repl_script_file
+
+
+
 
 // end of file repl_rps.cc
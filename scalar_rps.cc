@@ -119,9 +119,11 @@ rps_compute_cstr_two_64bits_hash(int64_t ht[2], const char*cstr, int len)
 const Rps_String*
 Rps_String::make(const char*cstr, int len)
 {
+  if (rps_intern_strings)
+    return make_interned(cstr, len);
   cstr = normalize_cstr(cstr);
   len = normalize_len(cstr, len);
-  if (u8_check(reinterpret_cast<const uint8_t*>(cstr), len))
+  if (rps_utf8_check(cstr, len))
     throw std::domain_error("invalid UTF-8 string");
   Rps_String* str
     = rps_allocate_with_wordgap<Rps_String> (len/sizeof(void*)+1, cstr, len);
@@ -129,6 +131,84 @@ Rps_String::make(const char*cstr, int len)
 } // end of Rps_String::make
 
 
+
+/// The weak intern table of strings is sharded to limit lock
+/// contention between threads; each shard maps a 64 bits hash
+/// (computed by rps_compute_cstr_two_64bits_hash) to the interned
+/// strings of that hash. Entries are not GC roots: dead strings are
+/// removed by Rps_String::gc_clear_dead_interned after marking.
+#define RPS_STRING_INTERN_SHARDS 64
+struct rps_string_intern_shard_st
+{
+  std::mutex sis_mtx;
+  std::unordered_multimap<uint64_t, Rps_String*> sis_map;
+};
+static rps_string_intern_shard_st rps_string_intern_shards[RPS_STRING_INTERN_SHARDS];
+
+const Rps_String*
+Rps_String::make_interned(const char*cstr, int len)
+{
+  cstr = normalize_cstr(cstr);
+  len = normalize_len(cstr, len);
+  if (rps_utf8_check(cstr, len))
+    throw std::domain_error("invalid UTF-8 string");
+  int64_t ht[2] = {0,0};
+  rps_fast_compute_cstr_two_64bits_hash(ht, cstr, len);
+  uint64_t key = (uint64_t)ht[0] ^ (((uint64_t)ht[1] << 17) | ((uint64_t)ht[1] >> 47));
+  auto& shard = rps_string_intern_shards[(uint64_t)ht[1] % RPS_STRING_INTERN_SHARDS];
+  std::lock_guard<std::mutex> gu(shard.sis_mtx);
+  auto range = shard.sis_map.equal_range(key);
+  for (auto it = range.first; it != range.second; it++)
+    {
+      Rps_String* oldstr = it->second;
+      RPS_ASSERT(oldstr != nullptr);
+      if ((int)oldstr->_bytsiz == len && !memcmp(oldstr->_sbuf, cstr, len))
+        {
+          /// a garbage collection might be running between its
+          /// marking and its sweeping phases, so keep that string
+          /// alive: the GC mark is anyway cleared at start of every GC.
+          oldstr->qz_gcinfo.fetch_or(qz_gcmark_bit);
+          return oldstr;
+        }
+    };
+  Rps_String* str
+    = rps_allocate_with_wordgap<Rps_String> (len/sizeof(void*)+1, cstr, len);
+  str->qz_gcinfo.fetch_or(qz_interned_bit);
+  shard.sis_map.insert({key, str});
+  return str;
+} // end of Rps_String::make_interned
+
+
+void
+Rps_String::gc_clear_dead_interned(Rps_GarbageCollector&gc)
+{
+  for (auto& shard : rps_string_intern_shards)
+    {
+      std::lock_guard<std::mutex> gu(shard.sis_mtx);
+      for (auto it = shard.sis_map.begin(); it != shard.sis_map.end(); )
+        {
+          if (it->second->is_gcmarked(gc))
+            it++;
+          else
+            it = shard.sis_map.erase(it);
+        }
+    }
+} // end of Rps_String::gc_clear_dead_interned
+
+
+unsigned
+Rps_String::nb_interned(void)
+{
+  unsigned nb = 0;
+  for (auto& shard : rps_string_intern_shards)
+    {
+      std::lock_guard<std::mutex> gu(shard.sis_mtx);
+      nb += shard.sis_map.size();
+    }
+  return nb;
+} // end of Rps_String::nb_interned
+
+
 Json::Value
 Rps_String::dump_json(Rps_Dumper*du) const
 {
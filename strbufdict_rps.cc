@@ -32,6 +32,8 @@
  ******************************************************************************/
 #include "refpersys.hh"
 
+#include <sys/uio.h>
+
 
 
 extern "C" const char rps_strbufdict_gitid[];
@@ -46,7 +48,9 @@ const char rps_strbufdict_shortgitid[]= RPS_SHORTGITID;
 
 Rps_PayloadStrBuf::Rps_PayloadStrBuf(Rps_ObjectZone*obz)
   : Rps_Payload(Rps_Type::PaylStrBuf, obz),
-    strbuf_buffer(),
+    strbuf_chunks(),
+    strbuf_size(0),
+    strbuf_cachedstr(nullptr),
     strbuf_indent(0),
     strbuf_transient(false)
 {
@@ -58,8 +62,10 @@ Rps_PayloadStrBuf::~Rps_PayloadStrBuf()
 } // end Rps_PayloadStrBuf::~Rps_PayloadStrBuf
 
 void
-Rps_PayloadStrBuf::gc_mark([[maybe_unused]] Rps_GarbageCollector& gc) const
+Rps_PayloadStrBuf::gc_mark(Rps_GarbageCollector& gc) const
 {
+  if (strbuf_cachedstr)
+    gc.mark_value(Rps_StringValue(strbuf_cachedstr));
 } // end Rps_PayloadStrBuf::gc_mark
 
 
@@ -69,7 +75,14 @@ Rps_PayloadStrBuf::append_string(const std::string&str)
   if (str.empty())
     return;
   std::lock_guard<std::recursive_mutex> gu(*owner()->objmtxptr());
-  strbuf_buffer.sputn(str.c_str(), str.size());
+  changed_content();
+  /// small strings are gathered in the last chunk
+  if (!strbuf_chunks.empty()
+      && strbuf_chunks.back().size() + str.size() <= strbuf_chunk_size)
+    strbuf_chunks.back().append(str);
+  else
+    strbuf_chunks.push_back(str);
+  strbuf_size += str.size();
 } // end Rps_PayloadStrBuf::append_string
 
 void
@@ -78,22 +91,139 @@ Rps_PayloadStrBuf::prepend_string(const std::string&str)
   if (str.empty())
     return;
   std::lock_guard<std::recursive_mutex> gu(*owner()->objmtxptr());
-#warning Rps_PayloadStrBuf::prepend_string implementation is inefficient
-  if (strbuf_buffer.str().empty())
-    {
-      strbuf_buffer.sputn(str.c_str(), str.size());
-      return;
-    }
+  changed_content();
+  if (!strbuf_chunks.empty()
+      && strbuf_chunks.front().size() + str.size() <= strbuf_chunk_size)
+    strbuf_chunks.front().insert(0, str);
   else
-    {
-      /// inefficient; TODO: improve
-      std::string oldcont = strbuf_buffer.str();
-      std::string newcont = str + oldcont;
-      strbuf_buffer.sputn(newcont.c_str(), newcont.size());
-      return;
-    }
+    strbuf_chunks.push_front(str);
+  strbuf_size += str.size();
 } // end Rps_PayloadStrBuf::prepend_string
 
+void
+Rps_PayloadStrBuf::append_indented_line(const std::string&line)
+{
+  std::lock_guard<std::recursive_mutex> gu(*owner()->objmtxptr());
+  if (strbuf_indent > 0)
+    append_string(std::string(strbuf_indent, ' '));
+  append_string(line);
+  append_string("\n");
+} // end Rps_PayloadStrBuf::append_indented_line
+
+void
+Rps_PayloadStrBuf::append_newline_indented(void)
+{
+  std::string str("\n");
+  if (strbuf_indent > 0)
+    str.append(strbuf_indent, ' ');
+  append_string(str);
+} // end Rps_PayloadStrBuf::append_newline_indented
+
+/// gather all the chunks in one, under the owner's lock
+void
+Rps_PayloadStrBuf::coalesce_chunks(void) const
+{
+  if (strbuf_chunks.size() <= 1)
+    return;
+  std::string whole;
+  whole.reserve(strbuf_size);
+  for (const std::string& chk: strbuf_chunks)
+    whole.append(chk);
+  auto& chunks = const_cast<std::deque<std::string>&>(strbuf_chunks);
+  chunks.clear();
+  chunks.push_back(std::move(whole));
+} // end Rps_PayloadStrBuf::coalesce_chunks
+
+std::string
+Rps_PayloadStrBuf::buffer_cppstring(void) const
+{
+  std::lock_guard<std::recursive_mutex> gu(*owner()->objmtxptr());
+  if (strbuf_chunks.size() == 1)
+    return strbuf_chunks.front();
+  std::string whole;
+  whole.reserve(strbuf_size);
+  for (const std::string& chk: strbuf_chunks)
+    whole.append(chk);
+  return whole;
+} // end Rps_PayloadStrBuf::buffer_cppstring
+
+Rps_StringValue
+Rps_PayloadStrBuf::buffer_stringval(void)
+{
+  std::lock_guard<std::recursive_mutex> gu(*owner()->objmtxptr());
+  if (!strbuf_cachedstr)
+    {
+      coalesce_chunks();
+      if (strbuf_chunks.empty())
+        strbuf_cachedstr = Rps_String::make("");
+      else
+        strbuf_cachedstr = Rps_String::make(strbuf_chunks.front());
+    };
+  return Rps_StringValue(strbuf_cachedstr);
+} // end Rps_PayloadStrBuf::buffer_stringval
+
+bool
+Rps_PayloadStrBuf::write_to_fd(int fd) const
+{
+  std::lock_guard<std::recursive_mutex> gu(*owner()->objmtxptr());
+  std::vector<struct iovec> iovvec;
+  iovvec.reserve(strbuf_chunks.size());
+  for (const std::string& chk: strbuf_chunks)
+    if (!chk.empty())
+      iovvec.push_back(iovec{(void*)chk.data(), chk.size()});
+  size_t ix = 0;
+  while (ix < iovvec.size())
+    {
+      int nbiov = std::min<size_t>(iovvec.size() - ix, IOV_MAX);
+      errno = 0;
+      ssize_t nbw = writev(fd, iovvec.data()+ix, nbiov);
+      if (nbw < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          return false;
+        };
+      /// skip the written iovecs, and adjust a partially written one
+      while (nbw > 0 && ix < iovvec.size())
+        {
+          if ((size_t)nbw >= iovvec[ix].iov_len)
+            {
+              nbw -= iovvec[ix].iov_len;
+              ix++;
+            }
+          else
+            {
+              iovvec[ix].iov_base = (char*)iovvec[ix].iov_base + nbw;
+              iovvec[ix].iov_len -= nbw;
+              nbw = 0;
+            }
+        };
+    };
+  return true;
+} // end Rps_PayloadStrBuf::write_to_fd
+
+bool
+Rps_PayloadStrBuf::write_to_file(const std::string&path) const
+{
+  int fd = open(path.c_str(), O_WRONLY|O_CREAT|O_TRUNC|O_CLOEXEC, 0644);
+  if (fd < 0)
+    return false;
+  bool ok = write_to_fd(fd);
+  int err = errno;
+  if (close(fd) && ok)
+    return false;
+  errno = err;
+  return ok;
+} // end Rps_PayloadStrBuf::write_to_file
+
+void
+Rps_PayloadStrBuf::output_to(std::ostream&out) const
+{
+  std::lock_guard<std::recursive_mutex> gu(*owner()->objmtxptr());
+  for (const std::string& chk: strbuf_chunks)
+    out.write(chk.data(), chk.size());
+} // end Rps_PayloadStrBuf::output_to
+
 void
 Rps_PayloadStrBuf::dump_scan(Rps_Dumper*du) const
 {
@@ -136,19 +266,18 @@ Rps_PayloadStrBuf::dump_json_content(Rps_Dumper*du, Json::Value&jv) const
   RPS_ASSERT(jv.type() == Json::objectValue);
   if (strbuf_transient)
     return;
-  const std::string&str = strbuf_buffer.str();
-  auto eol = str.find('\n');
-  if (eol > 0)
+  const std::string str = buffer_cppstring();
+  /// the loader appends a newline after each line
+  if (!str.empty() && str.back() == '\n')
     {
-      auto begit = str.begin();
       Json::Value jarr(Json::arrayValue);
-      while (eol > 0)
+      size_t begpos = 0;
+      while (begpos < str.size())
         {
-          auto eolit = begit+eol;
-          std::string linstr = str.substr(begit-str.begin(),eolit-str.begin());
-          jarr.append(Json::Value(linstr));
-          begit = eolit;
-          eol = str.find(begit+1-str.begin(), '\n');
+          size_t eolpos = str.find('\n', begpos);
+          RPS_ASSERT(eolpos != std::string::npos);
+          jarr.append(Json::Value(str.substr(begpos, eolpos-begpos)));
+          begpos = eolpos+1;
         }
       jv["strbuf_lines"] = jarr;
     }
@@ -206,7 +335,10 @@ void
 Rps_PayloadStrBuf::clear_buffer()
 {
 /// clear the buffer
-  strbuf_buffer = std::stringbuf("");
+  std::lock_guard<std::recursive_mutex> gu(*owner()->objmtxptr());
+  changed_content();
+  strbuf_chunks.clear();
+  strbuf_size = 0;
 } // end Rps_PayloadStrBuf::clear_buffer
 
 ////////////////////////////////////////////////////////////////
@@ -389,11 +521,12 @@ Rps_PayloadStringDict::iterate_apply(Rps_CallFrame*callerframe, Rps_Value closar
   if (!_f.obown)
     return;
   _f.closv = closarg;
+  Rps_BoundClosure<3> boundclos(&_, Rps_ClosureValue(_f.closv));
   for (auto it : dict_map)
     {
       _f.curstrv = Rps_StringValue(it.first);
       _f.curval = it.second;
-      Rps_TwoValues pair = Rps_ClosureValue(_f.closv).apply3(&_, _f.obown, _f.curstrv, _f.curval);
+      Rps_TwoValues pair = boundclos.apply(&_, _f.obown, _f.curstrv, _f.curval);
       if (!pair)
         return;
       _f.curstrv = nullptr;
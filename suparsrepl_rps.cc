@@ -159,7 +159,7 @@ Rps_TokenSource::parse_symmetrical_binaryop(Rps_CallFrame*callframe,
       &&  _f.lextokv.to_lextoken()->lxval().is_object()
       &&  _f.lextokv.to_lextoken()->lxval().to_object() == bindelim)
     {
-      (void) get_token(&_); // consume the operator
+      consume_front_token(&_); // consume the operator
     }
   else
     {
@@ -336,8 +336,7 @@ Rps_TokenSource::parse_asymmetrical_binaryop(Rps_CallFrame*callframe,
       RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_asymmetrical_binop¤" << callnum << " " << opername << " beforeA rightop "
                     << " token_deq:" << toksrc_token_deq
                     << " curcptr:" << curcptr());
-#warning perhaps Rps_TokenSource::consume_front_token(&_) should be called here?
-      (void) get_token(&_); // consume the operator
+      consume_front_token(&_); // consume the operator
       RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_asymmetrical_binop¤" << callnum << " " << opername << " beforeB rightop "
                     << " token_deq:" << toksrc_token_deq
                     << " curcptr:" << curcptr());
@@ -479,7 +478,7 @@ Rps_TokenSource::parse_polyop(Rps_CallFrame*callframe, Rps_ObjectRef polyoper, R
                     << " token_deq:" << toksrc_token_deq
                     << " curcptr:" << curcptr()
                     << " startpos:" << startpos);
-      (void) get_token(&_); // consume the operator delimiter
+      consume_front_token(&_); // consume the operator delimiter
       RPS_DEBUG_LOG(REPL, "Rps_TokenSource::parse_polyop¤" << callnum << " " << opername << " loop polydelim:" << polydelim  << " curpos:" << position_str()
                     << " token_deq:" << toksrc_token_deq
                     << " curcptr:" << curcptr()
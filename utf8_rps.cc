@@ -0,0 +1,397 @@
+/****************************************************************
+ * file utf8_rps.cc
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Description:
+ *      This file is part of the Reflective Persistent System.
+ *      It implements fast UTF-8 validation, counting and hashing, with
+ *      SSE2 or AVX2 code chosen at runtime on x86-64.
+ *
+ * Author(s):
+ *      Basile Starynkevitch <basile@starynkevitch.net>
+ *      Abhishek Chakravarti <abhishek@taranjali.org>
+ *      Nimesh Neema <nimeshneema@gmail.com>
+ *
+ *      © Copyright (C) 2025 The Reflective Persistent System Team
+ *      team@refpersys.org & http://refpersys.org/
+ *
+ * License:
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "refpersys.hh"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+extern "C" const char rps_utf8_gitid[];
+const char rps_utf8_gitid[]= RPS_GITID;
+
+extern "C" const char rps_utf8_date[];
+const char rps_utf8_date[]= __DATE__;
+
+extern "C" const char rps_utf8_shortgitid[];
+const char rps_utf8_shortgitid[]= RPS_SHORTGITID;
+
+
+/// Most strings handled by RefPerSys (identifiers, JSON lines of the
+/// persistent store, C++ code) are pure ASCII. A valid multi-byte
+/// UTF-8 sequence never contains an ASCII byte, so ASCII runs can be
+/// skipped in bulk by vector code, and the remaining non-ASCII runs
+/// are given to GNU libunistring as before.
+
+typedef size_t rps_utf8_scanfun_t(const char*s, size_t len);
+
+/// the offset of the first non-ASCII byte, or len
+static size_t
+rps_utf8_ascii_prefix_scalar(const char*s, size_t len)
+{
+  size_t i = 0;
+  for (; i + 8 <= len; i += 8)
+    {
+      uint64_t w = 0;
+      memcpy(&w, s+i, 8);
+      if (w & 0x8080808080808080ULL)
+        break;
+    };
+  while (i < len && !((unsigned char)s[i] & 0x80))
+    i++;
+  return i;
+} // end rps_utf8_ascii_prefix_scalar
+
+/// the number of bytes which are not continuation bytes, that is of
+/// UTF-8 characters in a valid string
+static size_t
+rps_utf8_count_scalar(const char*s, size_t len)
+{
+  size_t cnt = 0;
+  for (size_t i = 0; i < len; i++)
+    cnt += ((unsigned char)s[i] & 0xc0) != 0x80;
+  return cnt;
+} // end rps_utf8_count_scalar
+
+#if defined(__x86_64__)
+/// SSE2 is always available on x86-64
+static size_t
+rps_utf8_ascii_prefix_sse2(const char*s, size_t len)
+{
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16)
+    {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s+i));
+      unsigned m = (unsigned) _mm_movemask_epi8(v);
+      if (m)
+        return i + __builtin_ctz(m);
+    };
+  return i + rps_utf8_ascii_prefix_scalar(s+i, len-i);
+} // end rps_utf8_ascii_prefix_sse2
+
+static size_t
+rps_utf8_count_sse2(const char*s, size_t len)
+{
+  size_t cnt = 0, i = 0;
+  /// continuation bytes 0x80..0xbf are -128..-65 as signed chars
+  const __m128i lim = _mm_set1_epi8(-65);
+  for (; i + 16 <= len; i += 16)
+    {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s+i));
+      unsigned m = (unsigned) _mm_movemask_epi8(_mm_cmpgt_epi8(v, lim));
+      cnt += __builtin_popcount(m);
+    };
+  return cnt + rps_utf8_count_scalar(s+i, len-i);
+} // end rps_utf8_count_sse2
+
+__attribute__((target("avx2")))
+static size_t
+rps_utf8_ascii_prefix_avx2(const char*s, size_t len)
+{
+  size_t i = 0;
+  for (; i + 32 <= len; i += 32)
+    {
+      __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s+i));
+      unsigned m = (unsigned) _mm256_movemask_epi8(v);
+      if (m)
+        return i + __builtin_ctz(m);
+    };
+  return i + rps_utf8_ascii_prefix_sse2(s+i, len-i);
+} // end rps_utf8_ascii_prefix_avx2
+
+__attribute__((target("avx2")))
+static size_t
+rps_utf8_count_avx2(const char*s, size_t len)
+{
+  size_t cnt = 0, i = 0;
+  const __m256i lim = _mm256_set1_epi8(-65);
+  for (; i + 32 <= len; i += 32)
+    {
+      __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s+i));
+      unsigned m = (unsigned) _mm256_movemask_epi8(_mm256_cmpgt_epi8(v, lim));
+      cnt += __builtin_popcount(m);
+    };
+  return cnt + rps_utf8_count_sse2(s+i, len-i);
+} // end rps_utf8_count_avx2
+#endif /*__x86_64__*/
+
+
+/// the scanning routines are chosen once, on the first call,
+/// according to the running processor.
+static rps_utf8_scanfun_t*
+rps_utf8_ascii_prefix_routine(void)
+{
+  static rps_utf8_scanfun_t*const fun = []() -> rps_utf8_scanfun_t*
+  {
+#if defined(__x86_64__)
+    if (__builtin_cpu_supports("avx2"))
+      return rps_utf8_ascii_prefix_avx2;
+    return rps_utf8_ascii_prefix_sse2;
+#else
+    return rps_utf8_ascii_prefix_scalar;
+#endif
+  }();
+  return fun;
+} // end rps_utf8_ascii_prefix_routine
+
+static rps_utf8_scanfun_t*
+rps_utf8_count_routine(void)
+{
+  static rps_utf8_scanfun_t*const fun = []() -> rps_utf8_scanfun_t*
+  {
+#if defined(__x86_64__)
+    if (__builtin_cpu_supports("avx2"))
+      return rps_utf8_count_avx2;
+    return rps_utf8_count_sse2;
+#else
+    return rps_utf8_count_scalar;
+#endif
+  }();
+  return fun;
+} // end rps_utf8_count_routine
+
+
+size_t
+rps_utf8_ascii_prefix(const char*s, size_t len)
+{
+  if (!s || len == 0)
+    return 0;
+  return (*rps_utf8_ascii_prefix_routine())(s, len);
+} // end rps_utf8_ascii_prefix
+
+
+const char*
+rps_utf8_check(const char*s, size_t len)
+{
+  if (!s)
+    return nullptr;
+  auto prefixfun = rps_utf8_ascii_prefix_routine();
+  const char*end = s + len;
+  const char*pc = s;
+  while (pc < end)
+    {
+      pc += (*prefixfun)(pc, end - pc);
+      if (pc >= end)
+        break;
+      const char*runend = pc;
+      while (runend < end && ((unsigned char)*runend & 0x80))
+        runend++;
+      const uint8_t*bad
+        = u8_check(reinterpret_cast<const uint8_t*>(pc), runend - pc);
+      if (RPS_UNLIKELY(bad != nullptr))
+        return reinterpret_cast<const char*>(bad);
+      pc = runend;
+    };
+  return nullptr;
+} // end rps_utf8_check
+
+
+size_t
+rps_utf8_count(const char*s, size_t len)
+{
+  if (!s || len == 0)
+    return 0;
+  return (*rps_utf8_count_routine())(s, len);
+} // end rps_utf8_count
+
+
+
+/// The hash arithmetic of rps_compute_cstr_two_64bits_hash is a serial
+/// chain and is kept exactly. Only the decoding of each character is
+/// made faster: pure ASCII strings (detected by vector code) are
+/// hashed without any decoding, and ASCII bytes of other strings
+/// avoid the call to u8_mbtouc.
+template <bool AllAscii>
+static inline int
+rps_utf8_decode_for_hash(ucs4_t*puc, const char*pc, const char*end)
+{
+  unsigned char c = (unsigned char) *pc;
+  if (AllAscii || c < 0x80)
+    {
+      *puc = c;
+      return 1;
+    };
+  return u8_mbtouc(puc, (const uint8_t*)pc, end - pc);
+} // end rps_utf8_decode_for_hash
+
+template <bool AllAscii>
+static int
+rps_utf8_hash_loop(int64_t ht[2], const char*cstr, int len)
+{
+  int64_t h0=len, h1=60899;
+  const char*end = cstr + len;
+  int utf8cnt = 0;
+  for (const char*pc = cstr; pc < end; )
+    {
+      ucs4_t uc1=0, uc2=0, uc3=0, uc4=0;
+      int l1 = rps_utf8_decode_for_hash<AllAscii>(&uc1, pc, end);
+      if (l1<0)
+        return 0;
+      utf8cnt ++;
+      pc += l1;
+      if (pc >= end)
+        break;
+      h0 = (h0 * 60869) ^ (uc1 * 5059 + (h1 & 0xff));
+      int l2 = rps_utf8_decode_for_hash<AllAscii>(&uc2, pc, end);
+      if (l2<0)
+        return 0;
+      h1 = (h1 * 53087) ^ (uc2 * 43063 + utf8cnt + (h0 & 0xff));
+      utf8cnt ++;
+      pc += l2;
+      if (pc >= end)
+        break;
+      int l3 = rps_utf8_decode_for_hash<AllAscii>(&uc3, pc, end);
+      if (l3<0)
+        return 0;
+      h1 = (h1 * 73063) ^ (uc3 * 53089 + (h0 & 0xff));
+      utf8cnt ++;
+      pc += l3;
+      if (pc >= end)
+        break;
+      int l4 = rps_utf8_decode_for_hash<AllAscii>(&uc4, pc, end);
+      if (l4<0)
+        return 0;
+      h0 = (h0 * 73019) ^ (uc4 * 23057 + 11 * (h1 & 0x1ff));
+      utf8cnt ++;
+      pc += l4;
+      if (pc >= end)
+        break;
+    }
+  ht[0] = h0;
+  ht[1] = h1;
+  return utf8cnt;
+} // end rps_utf8_hash_loop
+
+int
+rps_fast_compute_cstr_two_64bits_hash(int64_t ht[2], const char*cstr, int len)
+{
+  if (!ht || !cstr)
+    return 0;
+  if (len < 0)
+    len = strlen(cstr);
+  ht[0] = 0;
+  ht[1] = 0;
+  if (len == 0)
+    return 0;
+  if (rps_utf8_ascii_prefix(cstr, len) == (size_t)len)
+    return rps_utf8_hash_loop<true>(ht, cstr, len);
+  return rps_utf8_hash_loop<false>(ht, cstr, len);
+} // end rps_fast_compute_cstr_two_64bits_hash
+
+
+
+/// Compare the routines above with the GNU libunistring ones, on a
+/// few sample strings repeated nbloops times. Any difference is
+/// fatal. Timings are shown in the LOWREP debug log.
+void
+rps_utf8_benchmark(unsigned nbloops)
+{
+  static const char*const samples[] =
+  {
+    "",
+    "a",
+    "_0BAnB0wuyOsyD3Xs",
+    "temporary_cplusplus_code",
+    "{ \"oid\" : \"_1Io89yIORqn02SXx4p\", \"mtime\" : 1598282587.18, \"class\" : \"_41OFI3r0S1t03qdB2E\" }",
+    "Reflective Persistent System – système réflexif persistant",
+    "Δοκιμή UTF-8 ελληνικά και кириллица и 日本語のテキスト",
+    "mixed ascii then accents éèêë at the end of a rather long line of text",
+    "emoji \xf0\x9f\x98\x80 and \xf0\x9f\x8c\x8d inside",
+    "invalid \xc3\x28 sequence",
+    "truncated at end \xe2\x82",
+    "surrogate \xed\xa0\x80 here",
+  };
+  std::string bigascii, bigmixed;
+  for (int i=0; i<64; i++)
+    {
+      bigascii += "const Rps_String* Rps_String::make(const char*cstr, int len);\n";
+      bigmixed += (i%8==0)?"λ-calcul «réflexif» ":"plain ascii text of a line\n";
+    };
+  std::vector<std::string> vecstr;
+  for (const char*s : samples)
+    vecstr.push_back(s);
+  vecstr.push_back(bigascii);
+  vecstr.push_back(bigmixed);
+  if (nbloops == 0)
+    nbloops = 1;
+  double libstart = rps_monotonic_real_time();
+  size_t libsum = 0;
+  for (unsigned n=0; n<nbloops; n++)
+    for (auto& str : vecstr)
+      {
+        int64_t ht[2] = {0,0};
+        const uint8_t*bad = u8_check((const uint8_t*)str.c_str(), str.size());
+        libsum += bad?0:u8_mbsnlen((const uint8_t*)str.c_str(), str.size());
+        libsum += rps_compute_cstr_two_64bits_hash(ht, str.c_str(), str.size());
+        libsum += (size_t)(ht[0] ^ ht[1]);
+      };
+  double libend = rps_monotonic_real_time();
+  size_t fastsum = 0;
+  for (unsigned n=0; n<nbloops; n++)
+    for (auto& str : vecstr)
+      {
+        int64_t ht[2] = {0,0};
+        const char*bad = rps_utf8_check(str.c_str(), str.size());
+        fastsum += bad?0:rps_utf8_count(str.c_str(), str.size());
+        fastsum += rps_fast_compute_cstr_two_64bits_hash(ht, str.c_str(), str.size());
+        fastsum += (size_t)(ht[0] ^ ht[1]);
+      };
+  double fastend = rps_monotonic_real_time();
+  for (auto& str : vecstr)
+    {
+      int64_t libht[2] = {0,0}, fastht[2] = {0,0};
+      const uint8_t*libbad = u8_check((const uint8_t*)str.c_str(), str.size());
+      const char*fastbad = rps_utf8_check(str.c_str(), str.size());
+      int libcnt = rps_compute_cstr_two_64bits_hash(libht, str.c_str(), str.size());
+      int fastcnt = rps_fast_compute_cstr_two_64bits_hash(fastht, str.c_str(), str.size());
+      if ((const char*)libbad != fastbad
+          || libcnt != fastcnt || libht[0] != fastht[0] || libht[1] != fastht[1]
+          || (!libbad && u8_mbsnlen((const uint8_t*)str.c_str(), str.size())
+              != rps_utf8_count(str.c_str(), str.size())))
+        RPS_FATALOUT("rps_utf8_benchmark mismatch for " << Rps_Cjson_String(str.c_str(), str.size()));
+    };
+  RPS_ASSERT(libsum == fastsum);
+  RPS_DEBUG_LOG(LOWREP, "rps_utf8_benchmark " << nbloops << " loops on "
+                << vecstr.size() << " strings: libunistring "
+                << (libend - libstart) << " sec, vectorized "
+                << (fastend - libend) << " sec"
+#if defined(__x86_64__)
+                << (__builtin_cpu_supports("avx2")?" with AVX2":" with SSE2")
+#endif
+               );
+} // end rps_utf8_benchmark
+
+
+/// adding a pragma which works for both GCC and Clang
+#pragma message "compiled utf8_rps.cc"
+
+//// end of file utf8_rps.cc
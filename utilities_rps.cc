@@ -1218,6 +1218,18 @@ rps_parse1opt (int key, char *arg, struct argp_state *state)
       rps_command_vec.push_back(std::string(arg));
     }
     return 0;
+    case RPSPROGOPT_REPL_SCRIPT:
+    {
+      if (side_effect)
+        {
+          if (!rps_repl_script_path.empty())
+            RPS_FATALOUT("only one --repl-script=SCRIPT_FILE can"
+                         " be given, but already got "
+                         << rps_repl_script_path);
+          rps_repl_script_path = std::string(arg);
+        }
+    }
+    return 0;
     case RPSPROGOPT_INTERFACEFIFO:
     {
       rps_put_fifo_prefix(arg);
@@ -1238,6 +1250,14 @@ rps_parse1opt (int key, char *arg, struct argp_state *state)
       rps_nbjobs = nbjobs;
     }
     return 0;
+    case RPSPROGOPT_JIT_THRESHOLD:
+    {
+      int threshold = atoi(arg);
+      if (threshold < 0)
+        RPS_FATALOUT("invalid --jit-threshold=" << arg);
+      rps_jit_hot_threshold = (unsigned)threshold;
+    }
+    return 0;
     case RPSPROGOPT_PUBLISH_ME:
     {
       if (!rps_publisher_url_str.empty())
@@ -1490,6 +1510,16 @@ rps_parse1opt (int key, char *arg, struct argp_state *state)
       rps_without_quick_tests = true;
     }
     return 0;
+    case RPSPROGOPT_NO_IO_URING:
+    {
+      rps_without_io_uring = true;
+    }
+    return 0;
+    case RPSPROGOPT_INTERN_STRINGS:
+    {
+      rps_intern_strings = true;
+    }
+    return 0;
     case RPSPROGOPT_TEST_REPL_LEXER:
     {
       if (side_effect)
@@ -1550,14 +1580,9 @@ rps_parse1opt (int key, char *arg, struct argp_state *state)
     return 0;
     case RPSPROGOPT_PLUGIN_AFTER_LOAD:
     {
-      void* dlh = dlopen(arg, RTLD_NOW|RTLD_GLOBAL);
-      if (!dlh)
-        RPS_FATALOUT("failed to dlopen plugin " << arg << " : " << dlerror());
-      const char* bnplug = basename(arg);
-      Rps_Plugin curplugin(bnplug, dlh);
-      RPS_INFORMOUT("loaded plugin#" << rps_plugins_vector.size() << " from " << arg << " from process pid#" << (int)getpid()
-                    << " basenamed " << Rps_QuotedC_String(bnplug));
-      rps_plugins_vector.push_back(curplugin);
+      /// the plugin is initialized by rps_run_loaded_application
+      if (!rps_load_plugin(arg, false))
+        RPS_FATALOUT("failed to load plugin " << arg);
     }
     return 0;
     case RPSPROGOPT_PLUGIN_ARG:
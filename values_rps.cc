@@ -124,6 +124,7 @@ std::recursive_mutex Rps_QuasiZone::qz_mtx;
 std::vector<Rps_QuasiZone*> Rps_QuasiZone::qz_zonvec(100);
 uint32_t Rps_QuasiZone::qz_cnt;
 std::atomic<uint64_t> Rps_QuasiZone::qz_alloc_cumulw;
+std::atomic<uint64_t> Rps_QuasiZone::qz_external_livew;
 
 void
 Rps_QuasiZone::initialize(void)
@@ -582,7 +583,7 @@ Rps_ClosureValue::apply_vect(Rps_CallFrame*callerframe, const std::vector<Rps_Va
       return apply4(callerframe, argvec[0], argvec[1], argvec[2], argvec[3]);
     default:
     {
-      rps_applyingfun_t*appfun = obconn->get_applyingfun(*this);
+      rps_applyingfun_t*appfun = obconn->get_applyingfun(callerframe, *this);
       if (!appfun)
         return nullptr;
       std::vector<Rps_Value> restvec(arity-4);
@@ -596,6 +597,10 @@ Rps_ClosureValue::apply_vect(Rps_CallFrame*callerframe, const std::vector<Rps_Va
     }
 } // end Rps_ClosureValue::apply_vect
 
+/// a deque, so growing it keeps the vectors used by outer applications
+thread_local std::deque<std::vector<Rps_Value>> rps_bound_restargs_pool;
+thread_local unsigned rps_bound_restargs_depth;
+
 Rps_TwoValues
 Rps_ClosureValue::apply_ilist(Rps_CallFrame*callerframe, const std::initializer_list<Rps_Value>& argil) const
 {
@@ -645,6 +650,16 @@ Rps_ClosureZone::compute_class(Rps_CallFrame*) const
 
 Rps_Value
 Rps_Value::get_attr(Rps_CallFrame*stkf, const Rps_ObjectRef obattr) const
+{
+  static constexpr unsigned nbsharedsites = 61;
+  static Rps_InstanceAttrSite sharedsites[nbsharedsites];
+  if (obattr.is_empty())
+    return nullptr;
+  return get_attr(stkf, obattr, sharedsites[obattr->obhash() % nbsharedsites]);
+} // end Rps_Value::get_attr
+
+Rps_Value
+Rps_Value::get_attr(Rps_CallFrame*stkf, const Rps_ObjectRef obattr, Rps_InstanceAttrSite&site) const
 {
   // in principle, obattr type is always Object, but we need to be
   // absolutely sure, even in case of bugs, so we do check it
@@ -660,9 +675,11 @@ Rps_Value::get_attr(Rps_CallFrame*stkf, const Rps_ObjectRef obattr) const
       auto it = thisob->ob_attrs.find(obattr);
       if (it != thisob->ob_attrs.end())
         return it->second;
-    };
+    }
+  else if (is_instance())
+    return site.get(as_instance(), obattr);
   return nullptr;
-} // end Rps_Value::get_attr
+} // end Rps_Value::get_attr with site
 
 
 Rps_ObjectRef
@@ -694,13 +711,13 @@ Rps_ClosureValue
 Rps_Value::closure_for_method_selector(Rps_CallFrame*callerframe, Rps_ObjectRef obselectorarg) const
 {
   // our frame descriptor is the `closure_for_method_selector` symbol
-  RPS_LOCALFRAME(RPS_ROOT_OB(_6JbWqOsjX5T03M1eGM),
-                 callerframe,
-                 Rps_Value val; // the current value
-                 Rps_ObjectRef obselect; // the attribute
-                 Rps_ObjectRef obcurclass; // the current class
-                 Rps_ClosureValue closval; // the resulting closure
-                );
+  RPS_LEANLOCALFRAME(RPS_ROOT_OB(_6JbWqOsjX5T03M1eGM),
+                     callerframe,
+                     Rps_Value val; // the current value
+                     Rps_ObjectRef obselect; // the attribute
+                     Rps_ObjectRef obcurclass; // the current class
+                     Rps_ClosureValue closval; // the resulting closure
+                    );
   _f.val = Rps_Value(*this);
   _f.obselect = obselectorarg;
   _f.obcurclass = _f.val.compute_class(&_);